@@ -0,0 +1,363 @@
+#include "generators.h"
+#include "cli/json_line.h"
+#include "core/async_task.h"
+#include "core/text_encoding.h"
+#include "core/worker_pool.h"
+#include "core/zip_archive.h"
+#include "formats/bulk_edit.h"
+#include "formats/sox_binary.h"
+#include "formats/sox_encoding.h"
+#include "formats/sox_skill_info.h"
+#include "formats/sox_text.h"
+#include "formats/stg_format.h"
+#include "formats/structural_diff.h"
+#include "formats/text_search_index.h"
+#include "mods/backup_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string filter;
+    std::string out;
+    std::string label;
+    size_t scale = 1;
+    double minSeconds = 0.25;
+    size_t minSamples = 5;
+};
+
+struct Result {
+    std::string name;
+    size_t samples = 0;
+    uint64_t bytes = 0;
+    double minNs = 0;
+    double medianNs = 0;
+    double meanNs = 0;
+    double mbPerSec = 0;
+};
+
+// Stops the optimizer from discarding results it can prove are unused.
+volatile size_t gSink = 0;
+
+void consume(size_t value) { gSink = gSink + value; }
+
+// One benchmark: fn runs the measured operation once; bytes is the input size
+// used for throughput. setup, if given, runs untimed before every sample.
+struct Case {
+    std::string name;
+    uint64_t bytes = 0;
+    std::function<void()> fn;
+    std::function<void()> setup = {};
+};
+
+Result runCase(const Case& c, const Options& options) {
+    if (c.setup) c.setup();
+    c.fn(); // Warm caches and lazily initialized tables.
+
+    std::vector<double> samples;
+    auto deadline = Clock::now() + std::chrono::duration<double>(options.minSeconds);
+    while (samples.size() < options.minSamples || Clock::now() < deadline) {
+        if (c.setup) c.setup();
+        auto start = Clock::now();
+        c.fn();
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+    }
+
+    std::sort(samples.begin(), samples.end());
+    Result r;
+    r.name = c.name;
+    r.samples = samples.size();
+    r.bytes = c.bytes;
+    r.minNs = samples.front();
+    r.medianNs = samples[samples.size() / 2];
+    double total = 0;
+    for (double s : samples) total += s;
+    r.meanNs = total / static_cast<double>(samples.size());
+    if (r.medianNs > 0) {
+        r.mbPerSec = static_cast<double>(c.bytes) / (1024.0 * 1024.0) / (r.medianNs * 1e-9);
+    }
+    return r;
+}
+
+// Adds load, save and validate cases for one generated file. Returns false if
+// the generator produced something the format rejects.
+template <typename Format>
+bool addFormatCases(std::vector<Case>& cases, const std::string& prefix, const std::vector<std::byte>& data) {
+    auto bytes = data.size();
+    cases.push_back({prefix + ".load", bytes, [&data] {
+        Format format;
+        consume(format.load(data) ? 1 : 0);
+    }});
+
+    auto loaded = std::make_shared<Format>();
+    if (!loaded->load(data)) {
+        std::fprintf(stderr, "generated %s data failed to load\n", prefix.c_str());
+        return false;
+    }
+    cases.push_back({prefix + ".save", bytes, [loaded] { consume(loaded->save().size()); }});
+    cases.push_back({prefix + ".validate", bytes, [loaded] { consume(loaded->validate().size()); }});
+    return true;
+}
+
+// Points the per-user config directory at dir so backups made by the suite
+// never touch the real one.
+void redirectConfigDir(const std::string& dir) {
+#if defined(_WIN32)
+    _putenv_s("APPDATA", dir.c_str());
+#else
+    setenv("XDG_CONFIG_HOME", dir.c_str(), 1);
+    setenv("HOME", dir.c_str(), 1);
+#endif
+}
+
+uint64_t directoryBytes(const fs::path& dir) {
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::recursive_directory_iterator(dir, ec)) {
+        if (entry.is_regular_file(ec)) total += entry.file_size(ec);
+    }
+    return total;
+}
+
+std::vector<kuf::ZipFileSource> zipSources(const fs::path& dir) {
+    std::vector<kuf::ZipFileSource> files;
+    std::error_code ec;
+    for (const auto& entry : fs::recursive_directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        files.push_back({entry.path().string(), fs::relative(entry.path(), dir).generic_string()});
+    }
+    std::sort(files.begin(), files.end(),
+              [](const auto& a, const auto& b) { return a.archiveName < b.archiveName; });
+    return files;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* name) -> const char* {
+            size_t len = std::strlen(name);
+            if (arg.compare(0, len, name) == 0 && arg.size() > len && arg[len] == '=') {
+                return argv[i] + len + 1;
+            }
+            return nullptr;
+        };
+        if (const char* v = value("--filter")) {
+            options.filter = v;
+        } else if (const char* v = value("--out")) {
+            options.out = v;
+        } else if (const char* v = value("--label")) {
+            options.label = v;
+        } else if (const char* v = value("--scale")) {
+            options.scale = static_cast<size_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--min-time")) {
+            options.minSeconds = std::max(0.0, std::atof(v));
+        } else {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void printUsage() {
+    std::fprintf(stderr,
+                 "usage: kufeditor_bench [--filter=<substring>] [--scale=<n>] [--min-time=<seconds>]\n"
+                 "                       [--label=<name>] [--out=<file.json>]\n\n"
+                 "Generates synthetic corpora from fixed seeds and times load, save, validate,\n"
+                 "hex decode, CP949 conversion, zip pack/unpack, backup copy and bulk edit\n"
+                 "planning. Results are written as JSON to --out, or stdout, for comparison\n"
+                 "between builds.\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    using namespace kuf;
+    using namespace kuf::bench;
+
+    const size_t scale = options.scale;
+    std::fprintf(stderr, "generating corpora (scale %zu)...\n", scale);
+
+    auto troopData = generateTroopSox(1024 * scale, 1);
+    auto skillData = generateSkillSox(1024 * scale, 2);
+    auto textData = generateTextSox(4000 * scale, 3);
+    // A merged localization table, well past the old 10,000-entry limit.
+    auto largeTextData = generateTextSox(200000 * scale, 7);
+    StgScale stgScale;
+    stgScale.units *= scale;
+    stgScale.areas *= scale;
+    stgScale.variables *= scale;
+    stgScale.events *= scale;
+    auto stgData = generateStg(stgScale, 4);
+    auto encodedTroops = soxEncode(troopData);
+    auto cp949 = generateCp949Text(256 * 1024 * scale, 5);
+
+    std::error_code ec;
+    auto stamp = Clock::now().time_since_epoch().count();
+    fs::path scratch = fs::temp_directory_path(ec) / ("kufeditor_bench_" + std::to_string(stamp));
+    fs::remove_all(scratch, ec);
+    fs::path gameDir = scratch / "game";
+    fs::path zipPath = scratch / "pack.zip";
+    fs::path unpackDir = scratch / "unpack";
+    size_t gameFiles = writeGameTree(gameDir.string(), 16 * 1024 * 1024 * scale, 6);
+    uint64_t gameBytes = directoryBytes(gameDir);
+    auto sources = zipSources(gameDir);
+    redirectConfigDir((scratch / "config").string());
+
+    std::vector<Case> cases;
+    bool generated = addFormatCases<SoxBinary>(cases, "troop_sox", troopData) &&
+                     addFormatCases<SoxSkillInfo>(cases, "skill_sox", skillData) &&
+                     addFormatCases<SoxText>(cases, "text_sox", textData) &&
+                     addFormatCases<SoxText>(cases, "text_sox_large", largeTextData) &&
+                     addFormatCases<StgFormat>(cases, "stg", stgData);
+    if (!generated) {
+        fs::remove_all(scratch, ec);
+        return 1;
+    }
+
+    // A rebalance over tens of thousands of records, the size the bulk edit
+    // bar has to keep interactive.
+    SoxBinary troopSource;
+    troopSource.load(troopData);
+    std::vector<TroopInfo> bulkTroops;
+    bulkTroops.reserve(50000 * scale);
+    while (bulkTroops.size() < 50000 * scale) {
+        bulkTroops.push_back(troopSource.troops()[bulkTroops.size() % troopSource.troops().size()]);
+    }
+    auto bulkEdit = std::get<BulkEdit>(BulkEdit::compile(
+        "defaultUnitHp *= 1 + 20%, resist* = min(resist*, 300) where job != 3", BulkEditTarget::Troops));
+    cases.push_back({"bulk_edit.plan", bulkTroops.size() * sizeof(TroopInfo),
+                     [&] { consume(bulkEdit.plan(bulkTroops).changeCount()); }});
+
+    // Project-wide text search over the merged localization table: building
+    // one file's index, then queries that have to stay interactive.
+    cases.push_back({"text_search.index", largeTextData.size(), [&] {
+        TextSearchIndex index;
+        consume(index.addFile("Text.sox", largeTextData) ? 1 : 0);
+    }});
+    TextSearchIndex searchIndex;
+    searchIndex.addFile("Text.sox", largeTextData);
+    auto substringQuery = std::get<TextQuery>(TextQuery::compile("qwe", {}));
+    auto regexQuery = std::get<TextQuery>(TextQuery::compile("qwe[a-z]* [a-z]+", {true, false}));
+    cases.push_back({"text_search.substring", largeTextData.size(),
+                     [&] { consume(searchIndex.search(substringQuery).hits.size()); }});
+    cases.push_back({"text_search.regex", largeTextData.size(),
+                     [&] { consume(searchIndex.search(regexQuery).hits.size()); }});
+
+    // Structural diffs of a mission and the merged table with a few edits,
+    // the per-file cost of comparing two game versions.
+    auto editedStg = stgData;
+    for (size_t unit = 0; unit < stgScale.units; unit += 64) {
+        float positionX = 1.0f + static_cast<float>(unit);
+        std::memcpy(editedStg.data() + kStgHeaderSize + unit * kStgUnitSize + 0x44, &positionX, 4);
+    }
+    auto editedText = largeTextData;
+    editedText[editedText.size() / 2] = std::byte{'#'};
+    cases.push_back({"diff.stg", stgData.size(),
+                     [&] { consume(diffStructure("Bench.stg", stgData, editedStg)->records.size()); }});
+    cases.push_back({"diff.text_large", largeTextData.size(),
+                     [&] { consume(diffStructure("Text.sox", largeTextData, editedText)->records.size()); }});
+
+    cases.push_back({"hex.decode", encodedTroops.size(), [&] {
+        auto decoded = soxDecode(encodedTroops);
+        consume(decoded ? decoded->size() : 0);
+    }});
+    cases.push_back({"hex.encode", troopData.size(), [&] { consume(soxEncode(troopData).size()); }});
+    cases.push_back({"cp949.to_utf8", cp949.size(), [&] { consume(cp949ToUtf8(cp949).size()); }});
+
+    cases.push_back({"zip.pack", gameBytes, [&] {
+        ZipWriter writer;
+        bool ok = writer.create(zipPath.string()) && writer.addFiles(sources) && writer.finalize();
+        consume(ok ? 1 : 0);
+    }});
+    cases.push_back({"zip.unpack", gameBytes,
+                     [&] {
+                         ZipReader reader;
+                         consume(reader.open(zipPath.string()) && reader.extractAll(unpackDir.string()) ? 1 : 0);
+                     },
+                     [&] {
+                         std::error_code removeEc;
+                         fs::remove_all(unpackDir, removeEc);
+                         if (!fs::exists(zipPath, removeEc)) {
+                             ZipWriter writer;
+                             (void)(writer.create(zipPath.string()) && writer.addFiles(sources) && writer.finalize());
+                         }
+                     }});
+    cases.push_back({"backup.copy", gameBytes,
+                     [&] {
+                         AsyncTask task;
+                         consume(BackupManager::createBackup(gameDir.string(), task) ? 1 : 0);
+                     },
+                     [] {
+                         // Backups are named by timestamp; clear the last one so
+                         // every sample copies into a fresh directory.
+                         if (auto latest = BackupManager::latestBackup()) BackupManager::deleteBackup(*latest);
+                     }});
+
+    std::vector<Result> results;
+    for (const auto& c : cases) {
+        if (!options.filter.empty() && c.name.find(options.filter) == std::string::npos) continue;
+        std::fprintf(stderr, "  %-20s", c.name.c_str());
+        auto r = runCase(c, options);
+        std::fprintf(stderr, " %12.0f ns  %9.1f MB/s  (%zu samples)\n", r.medianNs, r.mbPerSec, r.samples);
+        results.push_back(std::move(r));
+    }
+    if (auto latest = BackupManager::latestBackup()) BackupManager::deleteBackup(*latest);
+    fs::remove_all(scratch, ec);
+
+    cli::JsonLine json;
+    json.field("suite", "kufeditor_bench")
+        .field("version", 1)
+        .field("label", options.label)
+        .field("scale", scale)
+        .field("threads", WorkerPool::shared().threadCount() + 1)
+        .field("gameFiles", gameFiles)
+        .beginArray("results");
+    for (const auto& r : results) {
+        json.beginObject()
+            .field("name", r.name)
+            .field("samples", r.samples)
+            .field("bytes", r.bytes)
+            .field("minNs", r.minNs)
+            .field("medianNs", r.medianNs)
+            .field("meanNs", r.meanNs)
+            .field("mbPerSec", r.mbPerSec)
+            .end();
+    }
+    json.end();
+
+    std::string text = json.str() + "\n";
+    if (options.out.empty()) {
+        std::fwrite(text.data(), 1, text.size(), stdout);
+    } else {
+        std::FILE* f = std::fopen(options.out.c_str(), "wb");
+        if (!f) {
+            std::fprintf(stderr, "cannot write %s\n", options.out.c_str());
+            return 1;
+        }
+        std::fwrite(text.data(), 1, text.size(), f);
+        std::fclose(f);
+    }
+    return 0;
+}
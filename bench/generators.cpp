@@ -0,0 +1,333 @@
+#include "generators.h"
+#include "core/text_encoding.h"
+#include "formats/sox_binary.h"
+#include "formats/sox_skill_info.h"
+#include "formats/stg_format.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace kuf::bench {
+
+namespace {
+
+void appendU32(std::vector<std::byte>& v, uint32_t value) {
+    size_t pos = v.size();
+    v.resize(pos + 4);
+    std::memcpy(v.data() + pos, &value, 4);
+}
+
+void appendU16(std::vector<std::byte>& v, uint16_t value) {
+    size_t pos = v.size();
+    v.resize(pos + 2);
+    std::memcpy(v.data() + pos, &value, 2);
+}
+
+std::string randomWord(BenchRng& rng, size_t minLength, size_t maxLength) {
+    static constexpr char kLetters[] = "abcdefghijklmnopqrstuvwxyz";
+    size_t length = static_cast<size_t>(rng.nextInt(static_cast<int32_t>(minLength), static_cast<int32_t>(maxLength)));
+    std::string word(length, 'a');
+    for (auto& c : word) c = kLetters[rng.next() % 26];
+    return word;
+}
+
+std::string randomSentence(BenchRng& rng, size_t words) {
+    std::string sentence;
+    for (size_t i = 0; i < words; ++i) {
+        if (i > 0) sentence += ' ';
+        sentence += randomWord(rng, 2, 9);
+    }
+    sentence[0] = static_cast<char>(sentence[0] - 'a' + 'A');
+    sentence += '.';
+    return sentence;
+}
+
+StgParamValue intParam(int32_t value) {
+    StgParamValue param;
+    param.type = StgParamType::Int;
+    param.intValue = value;
+    return param;
+}
+
+// Catalog types whose parameters are (TroopID), (TroopID, AreaID),
+// (VariableID, Value) and (EventID), so generated scripts reference real objects.
+constexpr uint32_t kConditionTypes[] = {1, 5, 19, 16};
+constexpr uint32_t kActionTypes[] = {2, 9, 55, 87};
+
+StgScriptEntry randomEntry(BenchRng& rng, bool action, const StgScale& scale) {
+    StgScriptEntry entry;
+    size_t kind = rng.next() % 4;
+    entry.typeId = action ? kActionTypes[kind] : kConditionTypes[kind];
+    auto pick = [&](size_t count, int32_t base) {
+        return base + rng.nextInt(0, static_cast<int32_t>(count > 0 ? count - 1 : 0));
+    };
+    switch (kind) {
+        case 0:
+            entry.params.push_back(intParam(pick(scale.units, 1000)));
+            break;
+        case 1:
+            entry.params.push_back(intParam(pick(scale.units, 1000)));
+            entry.params.push_back(intParam(pick(scale.areas, 0)));
+            break;
+        case 2:
+            entry.params.push_back(intParam(pick(scale.variables, 0)));
+            entry.params.push_back(intParam(rng.nextInt(0, 10)));
+            if (!action) entry.params.push_back(intParam(rng.nextInt(0, 5)));
+            break;
+        default:
+            entry.params.push_back(intParam(pick(scale.events, 0)));
+            break;
+    }
+    return entry;
+}
+
+bool writeFile(const fs::path& path, const void* data, size_t size) {
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+std::vector<std::byte> generateTroopSox(size_t count, uint64_t seed) {
+    // Start from an empty table and let SoxBinary lay out the records.
+    std::vector<std::byte> empty;
+    appendU32(empty, 100);
+    appendU32(empty, 0);
+    empty.resize(empty.size() + 64, std::byte{0});
+
+    SoxBinary sox;
+    sox.load(empty);
+
+    BenchRng rng(seed);
+    auto& troops = sox.troops();
+    troops.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto& t = troops[i];
+        t.job = rng.nextInt(0, 42);
+        t.typeId = rng.nextInt(0, 7);
+        t.moveSpeed = rng.nextFloat(100.0f, 800.0f);
+        t.rotateRate = rng.nextFloat(1.0f, 10.0f);
+        t.moveAcceleration = rng.nextFloat(50.0f, 400.0f);
+        t.moveDeceleration = rng.nextFloat(50.0f, 400.0f);
+        t.sightRange = rng.nextFloat(1000.0f, 5000.0f);
+        t.attackRangeMax = rng.nextFloat(100.0f, 3000.0f);
+        t.attackRangeMin = rng.nextFloat(0.0f, 100.0f);
+        t.attackFrontRange = rng.nextFloat(0.0f, 200.0f);
+        t.directAttack = rng.nextFloat(5.0f, 80.0f);
+        t.indirectAttack = rng.nextFloat(0.0f, 60.0f);
+        t.defense = rng.nextFloat(5.0f, 80.0f);
+        t.baseWidth = rng.nextFloat(50.0f, 300.0f);
+        t.resistMelee = rng.nextFloat(0.5f, 1.5f);
+        t.resistRanged = rng.nextFloat(0.5f, 1.5f);
+        t.resistFrontal = rng.nextFloat(0.5f, 1.5f);
+        t.resistExplosion = rng.nextFloat(0.5f, 1.5f);
+        t.resistFire = rng.nextFloat(0.5f, 1.5f);
+        t.resistIce = rng.nextFloat(0.5f, 1.5f);
+        t.resistLightning = rng.nextFloat(0.5f, 1.5f);
+        t.resistHoly = rng.nextFloat(0.5f, 1.5f);
+        t.resistCurse = rng.nextFloat(0.5f, 1.5f);
+        t.resistEarth = rng.nextFloat(0.5f, 1.5f);
+        t.maxUnitSpeedMultiplier = rng.nextFloat(1.0f, 2.0f);
+        t.defaultUnitHp = rng.nextFloat(100.0f, 2000.0f);
+        t.formationRandom = rng.nextInt(0, 3);
+        t.defaultUnitNumX = rng.nextInt(1, 8);
+        t.defaultUnitNumY = rng.nextInt(1, 8);
+        t.unitHpLevelUp = rng.nextFloat(1.0f, 50.0f);
+        for (auto& level : t.levelUpData) {
+            level.skillId = rng.nextInt(0, 60);
+            level.bonusPerLevel = rng.nextFloat(0.0f, 5.0f);
+        }
+        t.damageDistribution = rng.nextFloat(0.0f, 1.0f);
+    }
+    return sox.save();
+}
+
+std::vector<std::byte> generateSkillSox(size_t count, uint64_t seed) {
+    // SoxSkillInfo needs at least one record to load; start from one empty record.
+    std::vector<std::byte> seedFile;
+    appendU32(seedFile, 100);
+    appendU32(seedFile, 1);
+    appendU32(seedFile, 0);
+    appendU16(seedFile, 0);
+    appendU16(seedFile, 0);
+    appendU32(seedFile, 1);
+    appendU32(seedFile, 1);
+    seedFile.resize(seedFile.size() + 64, std::byte{0});
+
+    SoxSkillInfo sox;
+    sox.load(seedFile);
+
+    BenchRng rng(seed);
+    auto& skills = sox.skills();
+    skills.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto& s = skills[i];
+        s.id = static_cast<int32_t>(i);
+        s.locKey = "SKILL_" + randomWord(rng, 4, 12);
+        s.iconPath = "Interface/Icons/" + randomWord(rng, 4, 12) + ".dds";
+        s.skillType = static_cast<uint32_t>(rng.nextInt(1, 2));
+        s.maxLevel = static_cast<uint32_t>(rng.nextInt(1, 10));
+    }
+    return sox.save();
+}
+
+std::vector<std::byte> generateTextSox(size_t count, uint64_t seed) {
+    BenchRng rng(seed);
+    std::vector<std::byte> data;
+    appendU32(data, 100);
+    appendU32(data, static_cast<uint32_t>(count));
+    for (size_t i = 0; i < count; ++i) {
+        std::string text = randomSentence(rng, static_cast<size_t>(rng.nextInt(2, 16)));
+        appendU32(data, static_cast<uint32_t>(i));
+        appendU16(data, static_cast<uint16_t>(text.size()));
+        size_t pos = data.size();
+        data.resize(pos + text.size());
+        std::memcpy(data.data() + pos, text.data(), text.size());
+    }
+    return data;
+}
+
+std::vector<std::byte> generateStg(const StgScale& scale, uint64_t seed) {
+    // Header, no units and an empty but parsed tail, so events are serialized
+    // from their fields rather than raw bytes.
+    std::vector<std::byte> empty(kStgHeaderSize, std::byte{0});
+    uint32_t magic = 0x3E9;
+    std::memcpy(empty.data(), &magic, 4);
+    for (int i = 0; i < 4; ++i) appendU32(empty, 0); // Areas, variables, blocks, footer.
+
+    StgFormat stg;
+    stg.load(empty);
+
+    BenchRng rng(seed);
+    stg.header().mapFile = "Bench.map";
+    stg.header().aiScriptFile = "Bench.ai";
+
+    auto& units = stg.units();
+    units.resize(scale.units);
+    for (size_t i = 0; i < scale.units; ++i) {
+        auto& u = units[i];
+        u.unitName = "Unit" + std::to_string(i);
+        u.uniqueId = static_cast<uint32_t>(1000 + i);
+        u.ucd = static_cast<UCD>(rng.nextInt(0, 3));
+        u.isHero = (i % 16 == 0) ? 1 : 0;
+        u.positionX = rng.nextFloat(0.0f, 40000.0f);
+        u.positionY = rng.nextFloat(0.0f, 40000.0f);
+        u.direction = static_cast<Direction>(rng.nextInt(0, 7));
+        u.leaderJobType = static_cast<uint8_t>(rng.nextInt(0, 42));
+        u.leaderLevel = static_cast<uint8_t>(rng.nextInt(1, 60));
+        u.troopInfoIndex = rng.nextInt(-1, 42);
+        u.formationType = static_cast<uint32_t>(rng.nextInt(1, 15));
+        u.gridX = static_cast<uint32_t>(rng.nextInt(1, 8));
+        u.gridY = static_cast<uint32_t>(rng.nextInt(1, 8));
+    }
+    stg.header().unitCount = static_cast<uint32_t>(scale.units);
+
+    for (size_t i = 0; i < scale.areas; ++i) {
+        StgArea area;
+        area.description = "Area" + std::to_string(i);
+        area.areaId = static_cast<uint32_t>(i);
+        area.boundX1 = rng.nextFloat(0.0f, 30000.0f);
+        area.boundY1 = rng.nextFloat(0.0f, 30000.0f);
+        area.boundX2 = area.boundX1 + rng.nextFloat(500.0f, 5000.0f);
+        area.boundY2 = area.boundY1 + rng.nextFloat(500.0f, 5000.0f);
+        stg.areas().push_back(area);
+    }
+
+    for (size_t i = 0; i < scale.variables; ++i) {
+        StgVariable var;
+        var.name = "var_" + randomWord(rng, 3, 10);
+        var.variableId = static_cast<uint32_t>(i);
+        var.initialValue = intParam(0);
+        stg.variables().push_back(var);
+    }
+
+    StgEventBlock block;
+    block.events.reserve(scale.events);
+    for (size_t i = 0; i < scale.events; ++i) {
+        StgEvent event;
+        event.description = "Event " + std::to_string(i);
+        event.eventId = static_cast<uint32_t>(i);
+        event.modified = true;
+        for (size_t e = 0; e < scale.entriesPerEvent; ++e) {
+            event.conditions.push_back(randomEntry(rng, false, scale));
+            event.actions.push_back(randomEntry(rng, true, scale));
+        }
+        block.events.push_back(std::move(event));
+    }
+    stg.eventBlocks().push_back(std::move(block));
+
+    return stg.save();
+}
+
+std::string generateCp949Text(size_t byteCount, uint64_t seed) {
+    // Random Hangul syllables (U+AC00..U+D7A3) with ASCII spaces, encoded as
+    // UTF-8 and converted once. Each syllable is two bytes in CP949.
+    BenchRng rng(seed);
+    std::string utf8;
+    utf8.reserve(byteCount * 3 / 2);
+    size_t cp949Bytes = 0;
+    while (cp949Bytes < byteCount) {
+        if (rng.next() % 6 == 0) {
+            utf8 += ' ';
+            cp949Bytes += 1;
+            continue;
+        }
+        uint32_t cp = 0xAC00 + static_cast<uint32_t>(rng.next() % 11172);
+        utf8 += static_cast<char>(0xE0 | (cp >> 12));
+        utf8 += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        utf8 += static_cast<char>(0x80 | (cp & 0x3F));
+        cp949Bytes += 2;
+    }
+    return utf8ToCp949(utf8);
+}
+
+size_t writeGameTree(const std::string& dir, size_t totalBytes, uint64_t seed) {
+    fs::path root(dir);
+    size_t written = 0;
+    size_t files = 0;
+    uint64_t fileSeed = seed;
+
+    auto add = [&](const fs::path& rel, const std::vector<std::byte>& data) {
+        if (writeFile(root / rel, data.data(), data.size())) {
+            written += data.size();
+            ++files;
+        }
+    };
+
+    add("Data/SOX/TroopInfo.sox", generateTroopSox(256, ++fileSeed));
+    add("Data/SOX/SkillInfo.sox", generateSkillSox(256, ++fileSeed));
+    add("Data/SOX/ENG/Text.sox", generateTextSox(2000, ++fileSeed));
+
+    StgScale missionScale;
+    missionScale.units = 64;
+    missionScale.events = 128;
+    for (int i = 0; written < totalBytes / 2 && i < 64; ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "Data/Missions/E%04d.stg", 1001 + i);
+        add(name, generateStg(missionScale, ++fileSeed));
+    }
+
+    // Assets such as textures and audio are already compressed; random bytes
+    // stand in for them.
+    BenchRng rng(++fileSeed);
+    for (int i = 0; written < totalBytes; ++i) {
+        std::vector<std::byte> blob(256 * 1024);
+        for (size_t j = 0; j + 8 <= blob.size(); j += 8) {
+            uint64_t v = rng.next();
+            std::memcpy(blob.data() + j, &v, 8);
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "Assets/blob%03d.dds", i);
+        add(name, blob);
+    }
+    return files;
+}
+
+} // namespace kuf::bench
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kuf::bench {
+
+// Small deterministic generator (SplitMix64). Standard library distributions
+// differ between implementations, so corpora are built from this alone and
+// are byte-identical on every platform for a given seed.
+class BenchRng {
+public:
+    explicit BenchRng(uint64_t seed) : state_(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [lo, hi].
+    int32_t nextInt(int32_t lo, int32_t hi) {
+        auto span = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo + 1);
+        return static_cast<int32_t>(lo + static_cast<int64_t>(next() % span));
+    }
+
+    // Uniform in [lo, hi).
+    float nextFloat(float lo, float hi) {
+        return lo + (hi - lo) * static_cast<float>(next() >> 40) / static_cast<float>(1ULL << 24);
+    }
+
+private:
+    uint64_t state_;
+};
+
+// Mission size for generateStg.
+struct StgScale {
+    size_t units = 256;
+    size_t areas = 64;
+    size_t variables = 64;
+    size_t events = 512;
+    size_t entriesPerEvent = 4; // Conditions and actions each.
+};
+
+// Troop SOX with count records of plausible values.
+std::vector<std::byte> generateTroopSox(size_t count, uint64_t seed);
+
+// SkillInfo SOX with count records.
+std::vector<std::byte> generateSkillSox(size_t count, uint64_t seed);
+
+// Text SOX with count printable ASCII entries.
+std::vector<std::byte> generateTextSox(size_t count, uint64_t seed);
+
+// STG mission with a parsed tail scaled by scale. Script entries use catalog
+// types so reference-carrying parameters point at generated objects.
+std::vector<std::byte> generateStg(const StgScale& scale, uint64_t seed);
+
+// About byteCount bytes of CP949-encoded Korean text.
+std::string generateCp949Text(size_t byteCount, uint64_t seed);
+
+// Writes a small game directory under dir: SOX and STG files in Data/ and a
+// few incompressible asset blobs, roughly totalBytes in all. Returns the
+// number of files written.
+size_t writeGameTree(const std::string& dir, size_t totalBytes, uint64_t seed);
+
+} // namespace kuf::bench
@@ -0,0 +1,831 @@
+#include "cli/commands.h"
+#include "cli/game_file.h"
+#include "cli/json_line.h"
+#include "core/file_io.h"
+#include "core/worker_pool.h"
+#include "formats/sox_binary.h"
+#include "formats/sox_encoding.h"
+#include "formats/sox_skill_info.h"
+#include "formats/sox_text.h"
+#include "formats/stg_corpus.h"
+#include "formats/stg_format.h"
+#include "formats/stg_merge.h"
+#include "formats/structural_diff.h"
+#include "mods/backup_manager.h"
+#include "mods/mod_manager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <variant>
+
+namespace fs = std::filesystem;
+
+namespace kuf::cli {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void emit(std::FILE* out, const std::string& line) {
+    std::fwrite(line.data(), 1, line.size(), out);
+    std::fputc('\n', out);
+}
+
+void emit(std::FILE* out, const JsonLine& line) {
+    emit(out, line.str());
+}
+
+int usageError(const std::string& message) {
+    std::fprintf(stderr, "kufeditor-cli: %s\n", message.c_str());
+    return kExitUsage;
+}
+
+// Runs fn for every index on the shared pool and prints the returned lines in
+// index order. Lines are flushed as soon as every earlier line is done, so the
+// output streams during long runs yet stays deterministic.
+void forEachOrdered(std::FILE* out, size_t count, const std::function<std::string(size_t)>& fn) {
+    std::vector<std::string> lines(count);
+    std::unique_ptr<std::atomic<bool>[]> ready(new std::atomic<bool>[count]);
+    for (size_t i = 0; i < count; ++i) ready[i].store(false);
+    std::mutex printMutex;
+    size_t nextToPrint = 0;
+
+    WorkerPool::shared().parallelFor(count, [&](size_t i) {
+        lines[i] = fn(i);
+        ready[i].store(true, std::memory_order_release);
+
+        std::unique_lock lock(printMutex, std::try_to_lock);
+        if (!lock.owns_lock()) return;
+        while (nextToPrint < count && ready[nextToPrint].load(std::memory_order_acquire)) {
+            emit(out, lines[nextToPrint]);
+            std::string().swap(lines[nextToPrint]);
+            ++nextToPrint;
+        }
+    });
+
+    // Whoever held the lock last may have missed lines finished after its scan.
+    for (; nextToPrint < count; ++nextToPrint) emit(out, lines[nextToPrint]);
+    std::fflush(out);
+}
+
+JsonLine fileLine(const InputFile& file) {
+    JsonLine line;
+    line.field("file", file.path.generic_string());
+    return line;
+}
+
+void describeFormat(JsonLine& line, const GameFile& file) {
+    line.field("format", file.format->formatName());
+    line.field("version", gameVersionName(file.format->detectedVersion()));
+    line.field("records", recordCount(*file.format));
+    if (file.soxEncoded) line.field("hexEncoded", true);
+}
+
+// Loads one input for the per-file commands. On failure fills line with a
+// status and returns false.
+bool loadForCommand(const InputFile& input, GameFile& file, JsonLine& line) {
+    if (!loadGameFile(input.path, file)) {
+        line.field("status", "unreadable");
+        return false;
+    }
+    if (!file.format) {
+        line.field("status", "unrecognized");
+        return false;
+    }
+    return true;
+}
+
+// --- validate ---------------------------------------------------------------
+
+int validateFiles(const std::vector<InputFile>& files, bool quiet, std::FILE* out) {
+    auto start = Clock::now();
+    std::atomic<size_t> errors{0}, warnings{0}, failed{0};
+
+    forEachOrdered(out, files.size(), [&](size_t i) -> std::string {
+        JsonLine line = fileLine(files[i]);
+        GameFile file;
+        if (!loadForCommand(files[i], file, line)) {
+            ++failed;
+            return line.str();
+        }
+        describeFormat(line, file);
+
+        auto issues = file.format->validate();
+        size_t fileErrors = 0;
+        line.beginArray("issues");
+        for (const auto& issue : issues) {
+            if (issue.severity == Severity::Error) ++fileErrors;
+            if (issue.severity == Severity::Warning) ++warnings;
+            if (quiet && issue.severity != Severity::Error) continue;
+            line.beginObject()
+                .field("severity", severityName(issue.severity))
+                .field("record", issue.recordIndex)
+                .field("field", issue.field)
+                .field("message", issue.message)
+                .end();
+        }
+        line.end();
+        errors += fileErrors;
+        if (fileErrors > 0) ++failed;
+        line.field("status", fileErrors > 0 ? "invalid" : "ok");
+        return line.str();
+    });
+
+    emit(out, JsonLine()
+             .field("summary", "validate")
+             .field("files", files.size())
+             .field("failed", failed.load())
+             .field("errors", errors.load())
+             .field("warnings", warnings.load())
+             .field("threads", WorkerPool::shared().threadCount() + 1)
+             .field("seconds", secondsSince(start)));
+    return failed.load() > 0 ? kExitFailed : kExitOk;
+}
+
+// --- dump-json --------------------------------------------------------------
+
+void writeParam(JsonLine& line, const StgParamValue& param) {
+    line.beginObject();
+    switch (param.type) {
+        case StgParamType::Int: line.field("int", param.intValue); break;
+        case StgParamType::Float: line.field("float", param.floatValue); break;
+        case StgParamType::String: line.field("string", param.stringValue); break;
+        case StgParamType::Enum: line.field("enum", param.intValue); break;
+    }
+    line.end();
+}
+
+void writeScript(JsonLine& line, std::string_view key, const std::vector<StgScriptEntry>& entries) {
+    line.beginArray(key);
+    for (const auto& entry : entries) {
+        line.beginObject().field("type", entry.typeId).beginArray("params");
+        for (const auto& param : entry.params) writeParam(line, param);
+        line.end().end();
+    }
+    line.end();
+}
+
+void dumpTroops(JsonLine& line, const SoxBinary& sox) {
+    line.field("headerVersion", sox.version());
+    line.beginArray("troops");
+    for (const auto& t : sox.troops()) {
+        line.beginObject()
+            .field("job", t.job)
+            .field("typeId", t.typeId)
+            .field("moveSpeed", t.moveSpeed)
+            .field("rotateRate", t.rotateRate)
+            .field("moveAcceleration", t.moveAcceleration)
+            .field("moveDeceleration", t.moveDeceleration)
+            .field("sightRange", t.sightRange)
+            .field("attackRangeMax", t.attackRangeMax)
+            .field("attackRangeMin", t.attackRangeMin)
+            .field("attackFrontRange", t.attackFrontRange)
+            .field("directAttack", t.directAttack)
+            .field("indirectAttack", t.indirectAttack)
+            .field("defense", t.defense)
+            .field("baseWidth", t.baseWidth)
+            .field("resistMelee", t.resistMelee)
+            .field("resistRanged", t.resistRanged)
+            .field("resistFrontal", t.resistFrontal)
+            .field("resistExplosion", t.resistExplosion)
+            .field("resistFire", t.resistFire)
+            .field("resistIce", t.resistIce)
+            .field("resistLightning", t.resistLightning)
+            .field("resistHoly", t.resistHoly)
+            .field("resistCurse", t.resistCurse)
+            .field("resistEarth", t.resistEarth)
+            .field("maxUnitSpeedMultiplier", t.maxUnitSpeedMultiplier)
+            .field("defaultUnitHp", t.defaultUnitHp)
+            .field("formationRandom", t.formationRandom)
+            .field("defaultUnitNumX", t.defaultUnitNumX)
+            .field("defaultUnitNumY", t.defaultUnitNumY)
+            .field("unitHpLevelUp", t.unitHpLevelUp)
+            .beginArray("levelUpData");
+        for (const auto& level : t.levelUpData) {
+            line.beginObject()
+                .field("skillId", level.skillId)
+                .field("bonusPerLevel", level.bonusPerLevel)
+                .end();
+        }
+        line.end().field("damageDistribution", t.damageDistribution).end();
+    }
+    line.end();
+}
+
+void dumpSkills(JsonLine& line, const SoxSkillInfo& sox) {
+    line.field("headerVersion", sox.version());
+    line.beginArray("skills");
+    for (const auto& s : sox.skills()) {
+        line.beginObject()
+            .field("id", s.id)
+            .field("locKey", s.locKey)
+            .field("iconPath", s.iconPath)
+            .field("skillType", s.skillType)
+            .field("maxLevel", s.maxLevel)
+            .end();
+    }
+    line.end();
+}
+
+void dumpText(JsonLine& line, const SoxText& sox) {
+    line.beginArray("entries");
+    for (size_t i = 0; i < sox.entryCount(); ++i) {
+        line.beginObject().field("maxLength", sox.maxLength(i)).field("text", sox.text(i)).end();
+    }
+    line.end();
+}
+
+void dumpStg(JsonLine& line, const StgFormat& stg) {
+    const auto& h = stg.header();
+    line.beginObject("header")
+        .field("mapFile", h.mapFile)
+        .field("bitmapFile", h.bitmapFile)
+        .field("defaultCameraFile", h.defaultCameraFile)
+        .field("userCameraFile", h.userCameraFile)
+        .field("settingsFile", h.settingsFile)
+        .field("skyCloudEffects", h.skyCloudEffects)
+        .field("aiScriptFile", h.aiScriptFile)
+        .field("cubemapTexture", h.cubemapTexture)
+        .end();
+
+    line.beginArray("units");
+    for (const auto& u : stg.units()) {
+        line.beginObject()
+            .field("uniqueId", u.uniqueId)
+            .field("name", u.unitName)
+            .field("ucd", static_cast<int>(u.ucd))
+            .field("isHero", u.isHero != 0)
+            .field("isEnabled", u.isEnabled != 0)
+            .field("positionX", u.positionX)
+            .field("positionY", u.positionY)
+            .field("direction", static_cast<int>(u.direction))
+            .field("leaderJobType", u.leaderJobType)
+            .field("leaderModelId", u.leaderModelId)
+            .field("leaderLevel", u.leaderLevel)
+            .field("officerCount", u.officerCount)
+            .field("troopInfoIndex", u.troopInfoIndex)
+            .field("formationType", u.formationType)
+            .field("gridX", u.gridX)
+            .field("gridY", u.gridY)
+            .end();
+    }
+    line.end();
+
+    line.beginArray("areas");
+    for (const auto& a : stg.areas()) {
+        line.beginObject()
+            .field("areaId", a.areaId)
+            .field("description", a.description)
+            .field("boundX1", a.boundX1)
+            .field("boundY1", a.boundY1)
+            .field("boundX2", a.boundX2)
+            .field("boundY2", a.boundY2)
+            .end();
+    }
+    line.end();
+
+    line.beginArray("variables");
+    for (const auto& v : stg.variables()) {
+        line.beginObject().field("variableId", v.variableId).field("name", v.name);
+        line.beginArray("initialValue");
+        writeParam(line, v.initialValue);
+        line.end().end();
+    }
+    line.end();
+
+    line.beginArray("events");
+    for (const auto& block : stg.eventBlocks()) {
+        for (const auto& e : block.events) {
+            line.beginObject().field("eventId", e.eventId).field("description", e.description);
+            writeScript(line, "conditions", e.conditions);
+            writeScript(line, "actions", e.actions);
+            line.end();
+        }
+    }
+    line.end();
+    line.field("tailParsed", stg.tailParsed());
+}
+
+// --- diff -------------------------------------------------------------------
+
+// Field-level detail for each record in file order.
+void writeRecordChanges(JsonLine& line, const StructuralDiff& diff) {
+    line.beginArray("changes");
+    for (const auto& record : diff.records) {
+        line.beginObject().field("key", record.key).field("kind", recordChangeKindName(record.kind));
+        if (!record.fields.empty()) {
+            line.beginArray("fields");
+            for (const auto& f : record.fields) {
+                line.beginObject().field("field", f.field).field("before", f.before).field("after", f.after).end();
+            }
+            line.end();
+        }
+        line.end();
+    }
+    line.end();
+}
+
+// --- merge ------------------------------------------------------------------
+
+struct MergeTriple {
+    fs::path relative;
+    fs::path base;   // Empty when the file is missing from that version.
+    fs::path ours;
+    fs::path theirs;
+};
+
+std::vector<MergeTriple> tripleFiles(const std::string& base, const std::string& ours, const std::string& theirs) {
+    std::error_code ec;
+    if (!fs::is_directory(base, ec) || !fs::is_directory(ours, ec) || !fs::is_directory(theirs, ec)) {
+        return {{fs::path(ours).filename(), base, ours, theirs}};
+    }
+
+    std::map<std::string, MergeTriple> byPath;
+    auto add = [&byPath](const std::string& dir, fs::path MergeTriple::*side) {
+        for (auto& f : collectGameFiles({dir})) {
+            auto& triple = byPath[f.relative.generic_string()];
+            triple.relative = f.relative;
+            triple.*side = f.path;
+        }
+    };
+    add(base, &MergeTriple::base);
+    add(ours, &MergeTriple::ours);
+    add(theirs, &MergeTriple::theirs);
+
+    std::vector<MergeTriple> triples;
+    triples.reserve(byPath.size());
+    for (auto& [key, triple] : byPath) triples.push_back(std::move(triple));
+    return triples;
+}
+
+void writeMergeConflicts(JsonLine& line, const std::vector<StgMergeConflict>& conflicts) {
+    line.beginArray("conflicts");
+    for (const auto& conflict : conflicts) {
+        line.beginObject().field("key", conflict.key).field("reason", conflict.reason);
+        if (!conflict.fields.empty()) line.field("fields", conflict.fields);
+        line.end();
+    }
+    line.end();
+}
+
+} // namespace
+
+CommandArgs CommandArgs::parse(int argc, char** argv, int first) {
+    CommandArgs args;
+    bool onlyPositional = false;
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (!onlyPositional && arg == "--") {
+            onlyPositional = true;
+            continue;
+        }
+        if (onlyPositional || arg.size() < 3 || arg.compare(0, 2, "--") != 0) {
+            args.positional.push_back(std::move(arg));
+            continue;
+        }
+        auto eq = arg.find('=');
+        if (eq == std::string::npos) {
+            args.flags.insert(arg.substr(2));
+        } else {
+            args.options[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+        }
+    }
+    return args;
+}
+
+std::string CommandArgs::option(const std::string& name, const std::string& fallback) const {
+    auto it = options.find(name);
+    return it != options.end() ? it->second : fallback;
+}
+
+int runValidate(const CommandArgs& args, std::FILE* out) {
+    if (args.positional.empty()) return usageError("validate: expected files or directories");
+    return validateFiles(collectGameFiles(args.positional), args.flag("errors-only"), out);
+}
+
+int runConvert(const CommandArgs& args, std::FILE* out) {
+    std::string outDir = args.option("out");
+    std::string to = args.option("to", "same");
+    if (args.positional.empty() || outDir.empty()) {
+        return usageError("convert: expected --out=<dir> and files or directories");
+    }
+    if (to != "same" && to != "binary" && to != "hex") {
+        return usageError("convert: --to must be same, binary or hex");
+    }
+
+    auto files = collectGameFiles(args.positional);
+    auto start = Clock::now();
+    std::atomic<size_t> failed{0};
+    std::atomic<uint64_t> bytesWritten{0};
+
+    forEachOrdered(out, files.size(), [&](size_t i) -> std::string {
+        JsonLine line = fileLine(files[i]);
+        GameFile file;
+        if (!loadForCommand(files[i], file, line)) {
+            ++failed;
+            return line.str();
+        }
+
+        // Binary and hex only differ for SOX; missions are always written as-is.
+        bool isMission = dynamic_cast<const StgFormat*>(file.format.get()) != nullptr;
+        if (!isMission && to != "same") file.soxEncoded = (to == "hex");
+
+        auto data = file.save();
+        fs::path dest = fs::path(outDir) / files[i].relative;
+        if (data.empty() || !writeWholeFile(dest, data)) {
+            ++failed;
+            line.field("status", "write-failed").field("output", dest.generic_string());
+            return line.str();
+        }
+        bytesWritten += data.size();
+        line.field("format", file.format->formatName())
+            .field("output", dest.generic_string())
+            .field("hexEncoded", file.soxEncoded)
+            .field("bytes", data.size())
+            .field("identical", data == file.raw)
+            .field("status", "ok");
+        return line.str();
+    });
+
+    emit(out, JsonLine()
+             .field("summary", "convert")
+             .field("files", files.size())
+             .field("failed", failed.load())
+             .field("bytesWritten", bytesWritten.load())
+             .field("seconds", secondsSince(start)));
+    return failed.load() > 0 ? kExitFailed : kExitOk;
+}
+
+int runDumpJson(const CommandArgs& args, std::FILE* out) {
+    if (args.positional.empty()) return usageError("dump-json: expected files or directories");
+
+    auto files = collectGameFiles(args.positional);
+    auto start = Clock::now();
+    std::atomic<size_t> failed{0};
+
+    forEachOrdered(out, files.size(), [&](size_t i) -> std::string {
+        JsonLine line = fileLine(files[i]);
+        GameFile file;
+        if (!loadForCommand(files[i], file, line)) {
+            ++failed;
+            return line.str();
+        }
+        describeFormat(line, file);
+        if (auto* binary = dynamic_cast<const SoxBinary*>(file.format.get())) {
+            dumpTroops(line, *binary);
+        } else if (auto* skills = dynamic_cast<const SoxSkillInfo*>(file.format.get())) {
+            dumpSkills(line, *skills);
+        } else if (auto* text = dynamic_cast<const SoxText*>(file.format.get())) {
+            dumpText(line, *text);
+        } else if (auto* stg = dynamic_cast<const StgFormat*>(file.format.get())) {
+            dumpStg(line, *stg);
+        }
+        return line.str();
+    });
+
+    emit(out, JsonLine()
+             .field("summary", "dump-json")
+             .field("files", files.size())
+             .field("failed", failed.load())
+             .field("seconds", secondsSince(start)));
+    return failed.load() > 0 ? kExitFailed : kExitOk;
+}
+
+int runDiff(const CommandArgs& args, std::FILE* out) {
+    if (args.positional.size() != 2) return usageError("diff: expected <base> <modified>");
+
+    bool withFields = args.flag("fields");
+    auto start = Clock::now();
+    auto files = diffPaths(args.positional[0], args.positional[1]);
+    size_t changed = 0, failed = 0;
+
+    for (const auto& file : files) {
+        JsonLine line;
+        line.field("file", file.path).field("status", fileDiffStatusName(file.status));
+        switch (file.status) {
+            case FileDiffStatus::Identical:
+                break;
+            case FileDiffStatus::Unreadable:
+                ++failed;
+                break;
+            case FileDiffStatus::Added:
+            case FileDiffStatus::Removed:
+                ++changed;
+                break;
+            case FileDiffStatus::Changed: {
+                ++changed;
+                if (!file.diff) {
+                    // No record structure; only whole-file differences can be reported.
+                    line.field("wholeFile", true);
+                    break;
+                }
+                std::vector<std::string> keys;
+                keys.reserve(file.diff->records.size());
+                for (const auto& record : file.diff->records) keys.push_back(record.key);
+                std::sort(keys.begin(), keys.end());
+                line.field("records", keys).field("unchanged", file.diff->unchanged);
+                if (withFields) writeRecordChanges(line, *file.diff);
+                break;
+            }
+        }
+        emit(out, line);
+    }
+
+    emit(out, JsonLine()
+             .field("summary", "diff")
+             .field("files", files.size())
+             .field("changed", changed)
+             .field("failed", failed)
+             .field("seconds", secondsSince(start)));
+    if (failed > 0) return kExitError;
+    return changed > 0 ? kExitFailed : kExitOk;
+}
+
+int runMerge(const CommandArgs& args, std::FILE* out) {
+    std::string outPath = args.option("out");
+    std::string prefer = args.option("prefer", "ours");
+    if (args.positional.size() != 3 || outPath.empty()) {
+        return usageError("merge: expected --out=<path> <base> <ours> <theirs>");
+    }
+    if (prefer != "ours" && prefer != "theirs") return usageError("merge: --prefer must be ours or theirs");
+
+    auto triples = tripleFiles(args.positional[0], args.positional[1], args.positional[2]);
+    bool singleFile = triples.size() == 1 && !fs::is_directory(args.positional[1]);
+    StgMergePrefer preferSide = prefer == "theirs" ? StgMergePrefer::Theirs : StgMergePrefer::Ours;
+    auto start = Clock::now();
+    std::atomic<size_t> merged{0}, conflicted{0}, failed{0};
+
+    forEachOrdered(out, triples.size(), [&](size_t i) -> std::string {
+        const auto& triple = triples[i];
+        JsonLine line;
+        line.field("file", triple.relative.generic_string());
+
+        // A version missing from a side stays nullopt, so "deleted" compares
+        // like any other content below.
+        using Content = std::optional<std::vector<std::byte>>;
+        Content base, ours, theirs;
+        auto read = [](const fs::path& path, Content& content) {
+            if (path.empty()) return true;
+            return readFileBytes(path, content.emplace());
+        };
+        if (!read(triple.base, base) || !read(triple.ours, ours) || !read(triple.theirs, theirs)) {
+            ++failed;
+            line.field("status", "unreadable");
+            return line.str();
+        }
+
+        fs::path dest = singleFile ? fs::path(outPath) : fs::path(outPath) / triple.relative;
+        auto keep = [&](const Content& content, const char* status) {
+            if (!content) {
+                line.field("status", "removed");
+            } else if (!writeWholeFile(dest, *content)) {
+                ++failed;
+                line.field("status", "write-failed").field("output", dest.generic_string());
+            } else {
+                line.field("status", status).field("output", dest.generic_string());
+            }
+            return line.str();
+        };
+
+        // Whole-file shortcuts: one side unchanged means the other side wins.
+        if (ours == theirs || theirs == base) return keep(ours, "ours");
+        if (ours == base) return keep(theirs, "theirs");
+
+        bool isMission = triple.relative.extension() == ".stg";
+        if (!isMission || !base || !ours || !theirs) {
+            // No record structure to merge, or one side deleted a file the
+            // other changed: keep the preferred version whole.
+            ++conflicted;
+            line.field("wholeFile", true);
+            return keep(preferSide == StgMergePrefer::Theirs ? theirs : ours, "conflict");
+        }
+
+        auto result = mergeStg(*base, *ours, *theirs, preferSide);
+        if (auto* error = std::get_if<std::string>(&result)) {
+            ++failed;
+            line.field("status", "failed").field("error", *error);
+            return line.str();
+        }
+        auto& mergeResult = std::get<StgMergeResult>(result);
+        if (mergeResult.clean()) {
+            ++merged;
+        } else {
+            ++conflicted;
+            writeMergeConflicts(line, mergeResult.conflicts);
+        }
+        line.field("takenFromTheirs", mergeResult.takenFromTheirs).field("fieldMerged", mergeResult.fieldMerged);
+        return keep(mergeResult.merged, mergeResult.clean() ? "merged" : "conflict");
+    });
+
+    emit(out, JsonLine()
+             .field("summary", "merge")
+             .field("files", triples.size())
+             .field("merged", merged.load())
+             .field("conflicts", conflicted.load())
+             .field("failed", failed.load())
+             .field("seconds", secondsSince(start)));
+    return failed.load() > 0 || conflicted.load() > 0 ? kExitFailed : kExitOk;
+}
+
+int runBackup(const CommandArgs& args, std::FILE* out) {
+    if (args.positional.size() != 1) return usageError("backup: expected <gameDir>");
+    const std::string& gameDir = args.positional[0];
+    auto start = Clock::now();
+
+    // The managers report through an AsyncTask; they are called directly here
+    // so the work runs on this thread and the task only carries the error.
+    AsyncTask task;
+    if (!BackupManager::createBackup(gameDir, task)) {
+        emit(out, JsonLine().field("summary", "backup").field("status", "failed").field("error", task.error()));
+        return kExitFailed;
+    }
+
+    auto backup = BackupManager::latestBackup();
+    JsonLine line;
+    line.field("summary", "backup").field("status", "ok");
+    if (backup) {
+        line.field("path", backup->path)
+            .field("timestamp", backup->timestamp)
+            .field("files", backup->fileCount)
+            .field("bytes", backup->totalBytes);
+    }
+
+    int result = kExitOk;
+    if (backup && args.flag("verify")) {
+        auto report = BackupManager::verifyBackup(*backup, gameDir, task);
+        if (!report) {
+            line.field("verified", false).field("error", task.error());
+            result = kExitFailed;
+        } else {
+            line.field("verified", report->clean())
+                .field("matched", report->matchedCount)
+                .field("missing", report->missingFiles)
+                .field("extra", report->extraFiles)
+                .field("modified", report->modifiedFiles);
+            if (!report->clean()) result = kExitFailed;
+        }
+    }
+    line.field("seconds", secondsSince(start));
+    emit(out, line);
+    return result;
+}
+
+int runApplyMod(const CommandArgs& args, std::FILE* out) {
+    if (args.positional.size() != 2) return usageError("apply-mod: expected <mod.zip> <gameDir>");
+    const std::string& zipPath = args.positional[0];
+    const std::string& gameDir = args.positional[1];
+    auto start = Clock::now();
+    AsyncTask task;
+
+    // Finish or roll back an install a previous run left behind before touching
+    // the game directory again.
+    if (ModManager::hasInterruptedInstall()) {
+        bool recovered = ModManager::recoverInterruptedInstall(task);
+        emit(out, JsonLine().field("event", "recovered-interrupted-install").field("ok", recovered));
+        if (!recovered) {
+            emit(out, JsonLine().field("summary", "apply-mod").field("status", "failed").field("error", task.error()));
+            return kExitFailed;
+        }
+    }
+
+    // The mod is installed straight from its archive; --import also copies it
+    // into the library.
+    auto loaded = args.flag("import") ? ModManager::importMod(zipPath) : ModManager::readMod(zipPath);
+    if (auto* error = std::get_if<std::string>(&loaded)) {
+        emit(out, JsonLine().field("summary", "apply-mod").field("status", "failed").field("error", *error));
+        return kExitFailed;
+    }
+    const auto& mod = std::get<ModInfo>(loaded);
+
+    bool ok = ModManager::installMod(mod, gameDir, task);
+    JsonLine line;
+    line.field("summary", "apply-mod")
+        .field("status", ok ? "ok" : "failed")
+        .field("name", mod.metadata.name)
+        .field("version", mod.metadata.version)
+        .field("zip", mod.zipPath);
+    if (!ok) line.field("error", task.error());
+    line.field("seconds", secondsSince(start));
+    emit(out, line);
+    return ok ? kExitOk : kExitFailed;
+}
+
+int runBench(const CommandArgs& args, std::FILE* out) {
+    if (args.positional.empty()) return usageError("bench: expected files or directories");
+    int iterations = std::max(1, std::atoi(args.option("iterations", "3").c_str()));
+
+    // Read everything up front so the timed passes measure parsing and
+    // serialization, not the disk.
+    auto files = collectGameFiles(args.positional);
+    std::vector<std::vector<std::byte>> contents(files.size());
+    std::vector<char> readable(files.size(), 0);
+    WorkerPool::shared().parallelFor(files.size(), [&](size_t i) {
+        readable[i] = readFileBytes(files[i].path, contents[i]) ? 1 : 0;
+    });
+
+    uint64_t totalBytes = 0;
+    for (size_t i = 0; i < files.size(); ++i) totalBytes += contents[i].size();
+
+    std::atomic<size_t> parsed{0}, roundTripped{0};
+    std::vector<double> passSeconds;
+    for (int pass = 0; pass < iterations; ++pass) {
+        parsed = 0;
+        roundTripped = 0;
+        auto start = Clock::now();
+        WorkerPool::shared().parallelFor(files.size(), [&](size_t i) {
+            if (!readable[i]) return;
+            bool soxEncoded = false;
+            auto format = parseGameData(files[i].path, contents[i], soxEncoded);
+            if (!format) return;
+            ++parsed;
+            auto data = format->save();
+            if (soxEncoded) data = soxEncode(data);
+            if (data == contents[i]) ++roundTripped;
+        });
+        passSeconds.push_back(secondsSince(start));
+    }
+
+    std::sort(passSeconds.begin(), passSeconds.end());
+    double best = passSeconds.front();
+    double median = passSeconds[passSeconds.size() / 2];
+    emit(out, JsonLine()
+             .field("summary", "bench")
+             .field("files", files.size())
+             .field("bytes", totalBytes)
+             .field("parsed", parsed.load())
+             .field("roundTripped", roundTripped.load())
+             .field("iterations", iterations)
+             .field("threads", WorkerPool::shared().threadCount() + 1)
+             .field("bestSeconds", best)
+             .field("medianSeconds", median)
+             .field("filesPerSecond", best > 0 ? static_cast<double>(files.size()) / best : 0.0)
+             .field("megabytesPerSecond", best > 0 ? static_cast<double>(totalBytes) / (1024.0 * 1024.0) / best : 0.0));
+    return parsed.load() == files.size() ? kExitOk : kExitFailed;
+}
+
+int runCorpus(const CommandArgs& args, std::FILE* out) {
+    if (args.positional.size() != 1) return usageError("corpus: expected <dir>");
+
+    auto start = Clock::now();
+    StgCorpus corpus;
+    corpus.load(args.positional[0]);
+    double loadSeconds = secondsSince(start);
+
+    for (const auto& mission : corpus.missions()) {
+        emit(out, JsonLine()
+                 .field("mission", mission.path)
+                 .field("units", mission.stg.unitCount())
+                 .field("events", mission.eventCount)
+                 .field("variables", mission.stg.variables().size())
+                 .field("tailParsed", mission.stg.tailParsed()));
+    }
+    for (const auto& failure : corpus.failures()) {
+        emit(out, JsonLine().field("mission", failure.path).field("error", failure.error));
+    }
+
+    for (int32_t troop : corpus.troopTypes()) {
+        emit(out, JsonLine()
+                 .field("troopInfoIndex", troop)
+                 .field("units", corpus.unitsWithTroop(troop).size())
+                 .field("missions", corpus.missionsWithTroop(troop).size()));
+    }
+    for (const auto& hero : corpus.heroes()) {
+        JsonLine line;
+        line.field("heroJobType", hero.jobType).field("heroModelId", hero.modelId).beginArray("missions");
+        uint32_t last = UINT32_MAX;
+        for (const auto& ref : hero.units) {
+            if (ref.mission == last) continue;
+            line.value(corpus.missions()[ref.mission].path);
+            last = ref.mission;
+        }
+        emit(out, line.end());
+    }
+    for (const auto& name : corpus.variableNames()) {
+        emit(out, JsonLine().field("variable", name).field("missions", corpus.missionsWithVariable(name).size()));
+    }
+
+    emit(out, JsonLine()
+             .field("summary", "corpus")
+             .field("missions", corpus.missions().size())
+             .field("failed", corpus.failures().size())
+             .field("units", corpus.totalUnitCount())
+             .field("events", corpus.totalEventCount())
+             .field("troopTypes", corpus.troopTypes().size())
+             .field("heroes", corpus.heroes().size())
+             .field("loadSeconds", loadSeconds));
+    return corpus.failures().empty() ? kExitOk : kExitFailed;
+}
+
+} // namespace kuf::cli
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace kuf::cli {
+
+// Exit codes shared by every subcommand.
+constexpr int kExitOk = 0;
+constexpr int kExitFailed = 1; // Some files failed, diff found differences or
+                               // merge left conflicts.
+constexpr int kExitUsage = 2;
+constexpr int kExitError = 3; // diff could not read an input file.
+
+// Parsed command line after the subcommand name. Options are written as
+// --name=value, flags as --name; everything else is positional.
+struct CommandArgs {
+    std::vector<std::string> positional;
+    std::map<std::string, std::string> options;
+    std::set<std::string> flags;
+
+    static CommandArgs parse(int argc, char** argv, int first);
+
+    bool flag(const std::string& name) const { return flags.count(name) > 0; }
+    std::string option(const std::string& name, const std::string& fallback = {}) const;
+};
+
+// Each subcommand writes one JSON object per line to out, ending with a
+// summary object, and returns one of the exit codes above. Usage errors go to
+// stderr.
+int runValidate(const CommandArgs& args, std::FILE* out);
+int runConvert(const CommandArgs& args, std::FILE* out);
+int runDumpJson(const CommandArgs& args, std::FILE* out);
+int runDiff(const CommandArgs& args, std::FILE* out);
+int runMerge(const CommandArgs& args, std::FILE* out);
+int runBackup(const CommandArgs& args, std::FILE* out);
+int runApplyMod(const CommandArgs& args, std::FILE* out);
+int runBench(const CommandArgs& args, std::FILE* out);
+int runCorpus(const CommandArgs& args, std::FILE* out);
+
+} // namespace kuf::cli
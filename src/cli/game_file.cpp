@@ -0,0 +1,131 @@
+#include "cli/game_file.h"
+#include "core/file_io.h"
+#include "formats/sox_binary.h"
+#include "formats/sox_encoding.h"
+#include "formats/sox_skill_info.h"
+#include "formats/sox_text.h"
+#include "formats/stg_format.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace kuf::cli {
+
+namespace {
+
+template <typename Format>
+std::unique_ptr<IFileFormat> tryLoad(std::span<const std::byte> data) {
+    auto format = std::make_unique<Format>();
+    if (!format->load(data)) return nullptr;
+    return format;
+}
+
+} // namespace
+
+std::vector<std::byte> GameFile::save() const {
+    if (!format) return {};
+    auto data = format->save();
+    if (soxEncoded) data = soxEncode(data);
+    return data;
+}
+
+std::unique_ptr<IFileFormat> parseGameData(const fs::path& path, std::span<const std::byte> data,
+                                           bool& soxEncoded) {
+    soxEncoded = false;
+    if (lowerExtension(path.string()) == ".stg") {
+        if (auto stg = tryLoad<StgFormat>(data)) return stg;
+    }
+
+    // SOX files are normally pure binary. Decode if hex-encoded (non-standard).
+    std::vector<std::byte> decoded;
+    std::span<const std::byte> parseData = data;
+    if (isSoxEncoded(data)) {
+        if (auto d = soxDecode(data)) {
+            decoded = std::move(*d);
+            parseData = decoded;
+            soxEncoded = true;
+        }
+    }
+
+    if (auto binary = tryLoad<SoxBinary>(parseData)) return binary;
+    if (auto skills = tryLoad<SoxSkillInfo>(parseData)) return skills;
+    if (auto text = tryLoad<SoxText>(parseData)) return text;
+    soxEncoded = false;
+    return nullptr;
+}
+
+bool loadGameFile(const fs::path& path, GameFile& out) {
+    out.path = path;
+    if (!readFileBytes(path, out.raw)) return false;
+    out.format = parseGameData(path, out.raw, out.soxEncoded);
+    return true;
+}
+
+bool isGameDataFile(const fs::path& path) {
+    std::string ext = lowerExtension(path.string());
+    return ext == ".sox" || ext == ".stg";
+}
+
+std::vector<InputFile> collectGameFiles(const std::vector<std::string>& inputs) {
+    std::vector<InputFile> files;
+    for (const auto& input : inputs) {
+        std::error_code ec;
+        if (fs::is_directory(input, ec)) {
+            fs::path root(input);
+            for (auto it = fs::recursive_directory_iterator(root, ec);
+                 !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec) && isGameDataFile(it->path())) {
+                    files.push_back({it->path(), it->path().lexically_relative(root)});
+                }
+            }
+        } else {
+            fs::path file(input);
+            files.push_back({file, file.filename()});
+        }
+    }
+    std::sort(files.begin(), files.end(),
+              [](const InputFile& a, const InputFile& b) { return a.path < b.path; });
+    files.erase(std::unique(files.begin(), files.end(),
+                            [](const InputFile& a, const InputFile& b) { return a.path == b.path; }),
+                files.end());
+    return files;
+}
+
+size_t recordCount(const IFileFormat& format) {
+    if (auto* binary = dynamic_cast<const SoxBinary*>(&format)) return binary->recordCount();
+    if (auto* skills = dynamic_cast<const SoxSkillInfo*>(&format)) return skills->recordCount();
+    if (auto* text = dynamic_cast<const SoxText*>(&format)) return text->entryCount();
+    if (auto* stg = dynamic_cast<const StgFormat*>(&format)) return stg->unitCount();
+    return 0;
+}
+
+bool writeWholeFile(const fs::path& path, std::span<const std::byte> data) {
+    std::error_code ec;
+    if (path.has_parent_path()) fs::create_directories(path.parent_path(), ec);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+const char* severityName(Severity severity) {
+    switch (severity) {
+        case Severity::Info: return "info";
+        case Severity::Warning: return "warning";
+        case Severity::Error: return "error";
+    }
+    return "unknown";
+}
+
+const char* gameVersionName(GameVersion version) {
+    switch (version) {
+        case GameVersion::Crusaders: return "crusaders";
+        case GameVersion::Heroes: return "heroes";
+        case GameVersion::Unknown: break;
+    }
+    return "unknown";
+}
+
+} // namespace kuf::cli
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "formats/file_format.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace kuf::cli {
+
+// A game data file parsed with the same detection order as the editor:
+// .stg files as missions, everything else as (optionally hex-encoded) SOX
+// tried as troop, skill and text tables in turn.
+struct GameFile {
+    std::filesystem::path path;
+    std::vector<std::byte> raw;
+    bool soxEncoded = false;
+    std::unique_ptr<IFileFormat> format; // Null when no parser accepted the file.
+
+    // Serializes the parsed file, re-encoding to hex when the input was hex.
+    std::vector<std::byte> save() const;
+};
+
+// Reads and parses one file. Returns false only when the file cannot be read;
+// an unrecognized file is returned with a null format.
+bool loadGameFile(const std::filesystem::path& path, GameFile& out);
+
+// Parses bytes that are already in memory, as loadGameFile does.
+std::unique_ptr<IFileFormat> parseGameData(const std::filesystem::path& path,
+                                           std::span<const std::byte> data, bool& soxEncoded);
+
+// True for extensions the editor can open (.sox, .stg).
+bool isGameDataFile(const std::filesystem::path& path);
+
+// A file found by collectGameFiles. relative is the path below the directory
+// argument it was found in, or just the file name for files named explicitly.
+struct InputFile {
+    std::filesystem::path path;
+    std::filesystem::path relative;
+};
+
+// Expands the arguments into a sorted list of game data files. Directories are
+// walked recursively; files named explicitly are kept whatever their extension.
+std::vector<InputFile> collectGameFiles(const std::vector<std::string>& inputs);
+
+// Number of troops, skills, text entries or mission units in a parsed file.
+size_t recordCount(const IFileFormat& format);
+
+bool writeWholeFile(const std::filesystem::path& path, std::span<const std::byte> data);
+
+const char* severityName(Severity severity);
+const char* gameVersionName(GameVersion version);
+
+} // namespace kuf::cli
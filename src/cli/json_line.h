@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace kuf::cli {
+
+// Builds one JSON object for JSON Lines output. Fields are appended in call
+// order; nested objects and arrays are opened with beginObject/beginArray and
+// closed with end().
+class JsonLine {
+public:
+    JsonLine() { open('{', '}'); }
+
+    JsonLine& field(std::string_view key, std::string_view value) {
+        writeKey(key);
+        writeString(value);
+        return *this;
+    }
+    JsonLine& field(std::string_view key, const char* value) { return field(key, std::string_view(value)); }
+    JsonLine& field(std::string_view key, const std::string& value) { return field(key, std::string_view(value)); }
+
+    JsonLine& field(std::string_view key, bool value) {
+        writeKey(key);
+        out_ += value ? "true" : "false";
+        return *this;
+    }
+
+    template <typename T>
+        requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+    JsonLine& field(std::string_view key, T value) {
+        writeKey(key);
+        writeNumber(value);
+        return *this;
+    }
+
+    JsonLine& field(std::string_view key, const std::vector<std::string>& values) {
+        beginArray(key);
+        for (const auto& v : values) value(v);
+        return end();
+    }
+
+    // Pass an empty key for an object or array nested directly in an array.
+    JsonLine& beginObject(std::string_view key = {}) {
+        key.empty() ? separate() : writeKey(key);
+        open('{', '}');
+        return *this;
+    }
+
+    JsonLine& beginArray(std::string_view key = {}) {
+        key.empty() ? separate() : writeKey(key);
+        open('[', ']');
+        return *this;
+    }
+
+    JsonLine& end() {
+        out_ += scopes_.back().closer;
+        scopes_.pop_back();
+        return *this;
+    }
+
+    // Array elements.
+    JsonLine& value(std::string_view v) {
+        separate();
+        writeString(v);
+        return *this;
+    }
+
+    template <typename T>
+        requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+    JsonLine& value(T v) {
+        separate();
+        writeNumber(v);
+        return *this;
+    }
+
+    // Closes every open scope and returns the line, without a trailing newline.
+    std::string str() const {
+        std::string line = out_;
+        for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) line += it->closer;
+        return line;
+    }
+
+private:
+    struct Scope {
+        char closer;
+        bool empty;
+    };
+
+    void open(char opener, char closer) {
+        out_ += opener;
+        scopes_.push_back({closer, true});
+    }
+
+    void separate() {
+        if (!scopes_.back().empty) out_ += ',';
+        scopes_.back().empty = false;
+    }
+
+    void writeKey(std::string_view key) {
+        separate();
+        writeString(key);
+        out_ += ':';
+    }
+
+    template <typename T>
+    void writeNumber(T v) {
+        if constexpr (std::is_floating_point_v<T>) {
+            if (!std::isfinite(v)) {
+                out_ += "null";
+                return;
+            }
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.9g", static_cast<double>(v));
+            out_ += buf;
+        } else {
+            out_ += std::to_string(v);
+        }
+    }
+
+    void writeString(std::string_view s) {
+        out_ += '"';
+        for (char c : s) {
+            switch (c) {
+                case '"': out_ += "\\\""; break;
+                case '\\': out_ += "\\\\"; break;
+                case '\n': out_ += "\\n"; break;
+                case '\r': out_ += "\\r"; break;
+                case '\t': out_ += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char buf[8];
+                        std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                        out_ += buf;
+                    } else {
+                        out_ += c;
+                    }
+                    break;
+            }
+        }
+        out_ += '"';
+    }
+
+    std::string out_;
+    std::vector<Scope> scopes_;
+};
+
+} // namespace kuf::cli
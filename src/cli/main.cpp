@@ -0,0 +1,65 @@
+#include "cli/commands.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+struct Subcommand {
+    const char* name;
+    int (*run)(const kuf::cli::CommandArgs& args, std::FILE* out);
+    const char* usage;
+};
+
+constexpr Subcommand kSubcommands[] = {
+    {"validate", kuf::cli::runValidate, "validate [--errors-only] <path>..."},
+    {"convert", kuf::cli::runConvert, "convert --out=<dir> [--to=same|binary|hex] <path>..."},
+    {"dump-json", kuf::cli::runDumpJson, "dump-json <path>..."},
+    {"diff", kuf::cli::runDiff, "diff [--fields] <base> <modified>"},
+    {"merge", kuf::cli::runMerge, "merge [--prefer=ours|theirs] --out=<path> <base> <ours> <theirs>"},
+    {"backup", kuf::cli::runBackup, "backup [--verify] <gameDir>"},
+    {"apply-mod", kuf::cli::runApplyMod, "apply-mod [--import] <mod.zip> <gameDir>"},
+    {"bench", kuf::cli::runBench, "bench [--iterations=<n>] <path>..."},
+    {"corpus", kuf::cli::runCorpus, "corpus <dir>"},
+};
+
+void printUsage(std::FILE* out) {
+    std::fprintf(out, "usage: kufeditor-cli <command> [options]\n\ncommands:\n");
+    for (const auto& cmd : kSubcommands) {
+        std::fprintf(out, "  %s\n", cmd.usage);
+    }
+    std::fprintf(out,
+                 "\nPaths may be files or directories; directories are searched for .sox and\n"
+                 ".stg files. Results are written to stdout as one JSON object per line.\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage(stderr);
+        return kuf::cli::kExitUsage;
+    }
+    if (std::strcmp(argv[1], "--help") == 0 || std::strcmp(argv[1], "-h") == 0 ||
+        std::strcmp(argv[1], "help") == 0) {
+        printUsage(stdout);
+        return kuf::cli::kExitOk;
+    }
+
+    // Lines are assembled in full before writing; a large buffer keeps corpus
+    // runs from issuing one write per file.
+    static char outputBuffer[1 << 16];
+    std::setvbuf(stdout, outputBuffer, _IOFBF, sizeof(outputBuffer));
+
+    for (const auto& cmd : kSubcommands) {
+        if (std::strcmp(argv[1], cmd.name) == 0) {
+            int result = cmd.run(kuf::cli::CommandArgs::parse(argc, argv, 2), stdout);
+            std::fflush(stdout);
+            return result;
+        }
+    }
+
+    std::fprintf(stderr, "kufeditor-cli: unknown command '%s'\n\n", argv[1]);
+    printUsage(stderr);
+    return kuf::cli::kExitUsage;
+}
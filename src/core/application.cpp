@@ -1,4 +1,5 @@
 #include "core/application.h"
+#include "core/document_watcher.h"
 #include "core/window.h"
 #include "core/imgui_context.h"
 #include "core/recent_files.h"
@@ -6,11 +7,15 @@
 #include "ui/views/home_view.h"
 #include "ui/views/validation_log.h"
 #include "ui/views/mod_manager_view.h"
+#include "ui/views/profiler_view.h"
+#include "ui/views/text_search_view.h"
+#include "ui/views/structural_diff_view.h"
 #include "ui/dialogs/file_dialog.h"
 #include "ui/dialogs/settings_dialog.h"
 #include "ui/tabs/editor_tab.h"
 #include "ui/tabs/troop_editor_tab.h"
 #include "ui/tabs/stg_editor_tab.h"
+#include "ui/tabs/text_editor_tab.h"
 #include "formats/sox_binary.h"
 #include "formats/sox_text.h"
 #include "formats/stg_format.h"
@@ -19,6 +24,9 @@
 #include <imgui_impl_opengl3.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 
@@ -39,11 +47,17 @@ std::string getFileName(const std::string& path) {
 Application::Application() {
     window_ = std::make_unique<Window>("KUF Editor", 1280, 720);
     imgui_ = std::make_unique<ImGuiContext>(window_->handle());
+    framePacer_ = FramePacer(window_->refreshRate());
 
     // Create views.
     homeView_ = std::make_unique<HomeView>();
     validationLog_ = std::make_unique<ValidationLogView>();
     modManagerView_ = std::make_unique<ModManagerView>();
+    textSearchView_ = std::make_unique<TextSearchView>();
+    structuralDiffView_ = std::make_unique<StructuralDiffView>();
+#if KUF_ENABLE_PROFILER
+    profilerView_ = std::make_unique<ProfilerView>();
+#endif
 
     modManagerView_->setOnError([this](const std::string& msg) {
         pendingPopupMessage_ = msg;
@@ -52,6 +66,8 @@ Application::Application() {
 
     // Create tab manager.
     tabManager_ = std::make_unique<TabManager>();
+    documentWatcher_ = std::make_unique<DocumentWatcher>(*tabManager_);
+    documentWatcher_->setOnWake([]() { Window::wake(); });
 
     // Create dialogs.
     settingsDialog_ = std::make_unique<SettingsDialog>();
@@ -75,6 +91,12 @@ Application::Application() {
         setGameDirectory(dir);
     });
 
+    tabManager_->setOnDocumentLoaded([this](OpenDocument* doc) {
+        if (doc && doc->undoStack) {
+            size_t budgetMB = static_cast<size_t>(std::max(1, settingsDialog_->config().undoHistoryMB));
+            doc->undoStack->setMemoryBudget(budgetMB * 1024 * 1024);
+        }
+    });
     tabManager_->setOnDocumentOpened([this](OpenDocument* doc) {
         if (doc && !doc->path.empty()) {
             recentFiles_->add(doc->path);
@@ -83,6 +105,35 @@ Application::Application() {
         }
     });
 
+    textSearchView_->setOnOpenEntry([this](const std::string& path, size_t entry) {
+        openFile(path);
+        if (auto* textTab = dynamic_cast<TextEditorTab*>(tabManager_->activeTab())) {
+            textTab->selectEntry(entry);
+        }
+    });
+    textSearchView_->setOnReplace([this](const std::string& path, const TextQuery& query,
+                                         std::string_view replacement) {
+        return tabManager_->replaceText(path, query, replacement,
+                                        "Replace in " + getFileName(path));
+    });
+
+    structuralDiffView_->setOnOpenFile([this](const std::string& path) { openFile(path); });
+
+    documentWatcher_->setOnGameFilesChanged([this](const std::vector<std::string>&) {
+        textSearchView_->refresh();
+    });
+    documentWatcher_->setOnReloaded([this](OpenDocument* doc, const DocumentReload& reload) {
+        if (!reload.error.empty()) {
+            pendingPopupMessage_ = "Cannot reload " + doc->filename + ": " + reload.error;
+            showErrorPopup_ = true;
+        } else if (!reload.conflicts.empty()) {
+            pendingPopupMessage_ = doc->filename + " changed on disk. Kept your edits for " +
+                                   std::to_string(reload.conflicts.size()) + " conflicting record(s).";
+            showErrorPopup_ = true;
+        }
+        updateValidationLog();
+    });
+
     validationLog_->setOnNavigate([this](size_t recordIndex) {
         auto* tab = tabManager_->activeTab();
         if (auto* troopTab = dynamic_cast<TroopEditorTab*>(tab)) {
@@ -99,9 +150,18 @@ Application::~Application() {
 }
 
 void Application::run() {
+    KUF_PROFILE_THREAD("main");
     while (running_ && !window_->shouldClose()) {
-        window_->pollEvents();
+        {
+            // Blocks while idle; any input ends the wait immediately.
+            KUF_PROFILE_ZONE("Window::waitEvents");
+            auto waitStart = std::chrono::steady_clock::now();
+            window_->waitEvents(framePacer_.nextWait(frameActivity()));
+            framePacer_.recordWait(
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count());
+        }
 
+        documentWatcher_->update();
         imgui_->beginFrame();
 
         handleKeyboardShortcuts();
@@ -109,6 +169,11 @@ void Application::run() {
 
         // Draw validation log (dockable).
         validationLog_->draw();
+        textSearchView_->draw();
+        structuralDiffView_->draw();
+#if KUF_ENABLE_PROFILER
+        profilerView_->draw();
+#endif
 
         // Draw dialogs.
         settingsDialog_->draw();
@@ -127,16 +192,38 @@ void Application::run() {
             ImGui::EndPopup();
         }
 
-        imgui_->endFrame();
+        {
+            KUF_PROFILE_ZONE("Render");
+            imgui_->endFrame();
 
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
-        window_->swapBuffers();
+        {
+            KUF_PROFILE_ZONE("Window::swapBuffers");
+            window_->swapBuffers();
+        }
+        KUF_PROFILE_FRAME();
     }
 }
 
+FrameActivity Application::frameActivity() {
+    FrameActivity activity;
+    uint64_t events = window_->eventCount();
+    activity.inputEvents = events != lastEventCount_;
+    lastEventCount_ = events;
+
+    const ImGuiIO& io = ImGui::GetIO();
+    activity.interacting = ImGui::IsAnyItemActive() || io.WantTextInput || ImGui::IsAnyMouseDown();
+    activity.hovering = ImGui::IsAnyItemHovered();
+    activity.backgroundWork = modManagerView_->busy() || textSearchView_->busy() || structuralDiffView_->busy() ||
+                              documentWatcher_->busy();
+    framePacer_.setEnabled(settingsDialog_->config().idleRendering);
+    return activity;
+}
+
 void Application::openFile(const std::string& path) {
     auto result = tabManager_->openFile(path);
 
@@ -154,12 +241,16 @@ void Application::openFile(const std::string& path) {
 void Application::setGameDirectory(const std::string& dir) {
     gameDirectory_ = dir;
     modManagerView_->setGameDirectory(dir);
+    textSearchView_->setGameDirectory(dir);
+    structuralDiffView_->setGameDirectory(dir);
+    documentWatcher_->setGameDirectory(dir);
 }
 
 void Application::saveActiveDocument() {
     auto* tab = tabManager_->activeTab();
     if (tab && tab->document()) {
         tabManager_->saveDocument(tab->document().get());
+        textSearchView_->refresh();
     }
 }
 
@@ -190,9 +281,14 @@ void Application::handleKeyboardShortcuts() {
     if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_S, ImGuiInputFlags_RouteGlobal)) {
         saveActiveDocument();
     }
+    if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiMod_Shift | ImGuiKey_F, ImGuiInputFlags_RouteGlobal)) {
+        textSearchView_->isOpen() = true;
+        ImGui::SetWindowFocus(textSearchView_->name().c_str());
+    }
 }
 
 void Application::updateValidationLog() {
+    KUF_PROFILE_ZONE("Application::updateValidationLog");
     auto* tab = tabManager_->activeTab();
     if (!tab || !tab->document()) {
         validationLog_->setIssues({});
@@ -212,6 +308,7 @@ void Application::updateValidationLog() {
 }
 
 void Application::drawMenuBar() {
+    KUF_PROFILE_ZONE("Application::drawMenuBar");
     if (ImGui::BeginMainMenuBar()) {
         if (ImGui::BeginMenu("File")) {
             if (ImGui::MenuItem("Open File...", "Ctrl+O")) {
@@ -300,6 +397,11 @@ void Application::drawMenuBar() {
             ImGui::MenuItem("Home", nullptr, &showHomeTab_);
             ImGui::MenuItem("Mod Manager", nullptr, &showModManager_);
             ImGui::MenuItem("Validation Log", nullptr, &validationLog_->isOpen());
+            ImGui::MenuItem("Text Search", "Ctrl+Shift+F", &textSearchView_->isOpen());
+            ImGui::MenuItem("Structural Diff", nullptr, &structuralDiffView_->isOpen());
+#if KUF_ENABLE_PROFILER
+            ImGui::MenuItem("Profiler", nullptr, &profilerView_->isOpen());
+#endif
             ImGui::EndMenu();
         }
 
@@ -313,6 +415,7 @@ void Application::drawMenuBar() {
 }
 
 void Application::drawTabBar() {
+    KUF_PROFILE_ZONE("Application::drawTabBar");
     ImGuiTabBarFlags tabBarFlags = ImGuiTabBarFlags_Reorderable |
                                    ImGuiTabBarFlags_AutoSelectNewTabs |
                                    ImGuiTabBarFlags_FittingPolicyScroll;
@@ -402,6 +505,7 @@ void Application::drawTabBar() {
 }
 
 void Application::drawDockspace() {
+    KUF_PROFILE_ZONE("Application::drawDockspace");
     ImGuiViewport* viewport = ImGui::GetMainViewport();
     ImGui::SetNextWindowPos(viewport->WorkPos);
     ImGui::SetNextWindowSize(viewport->WorkSize);
@@ -467,6 +571,15 @@ void Application::drawDockspace() {
     } else {
         ImGui::Text("Ready");
     }
+
+    if (framePacer_.enabled()) {
+        char skipped[64];
+        std::snprintf(skipped, sizeof(skipped), "%llu frames skipped",
+                      static_cast<unsigned long long>(framePacer_.skippedFrames()));
+        float width = ImGui::CalcTextSize(skipped).x;
+        ImGui::SameLine(ImGui::GetWindowWidth() - width - 8.0f);
+        ImGui::TextDisabled("%s", skipped);
+    }
     ImGui::EndChild();
 
     ImGui::End();
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "core/frame_pacer.h"
+#include "core/profiler.h"
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -16,6 +19,10 @@ class RecentFiles;
 class OpenDocument;
 class EditorTab;
 class ModManagerView;
+class ProfilerView;
+class TextSearchView;
+class StructuralDiffView;
+class DocumentWatcher;
 
 class Application {
 public:
@@ -33,6 +40,7 @@ private:
     void saveActiveDocument();
     void handleKeyboardShortcuts();
     void updateValidationLog();
+    FrameActivity frameActivity();
 
     std::unique_ptr<Window> window_;
     std::unique_ptr<ImGuiContext> imgui_;
@@ -40,8 +48,17 @@ private:
     std::unique_ptr<ValidationLogView> validationLog_;
     std::unique_ptr<SettingsDialog> settingsDialog_;
     std::unique_ptr<TabManager> tabManager_;
+    std::unique_ptr<DocumentWatcher> documentWatcher_;
     std::unique_ptr<RecentFiles> recentFiles_;
     std::unique_ptr<ModManagerView> modManagerView_;
+    std::unique_ptr<TextSearchView> textSearchView_;
+    std::unique_ptr<StructuralDiffView> structuralDiffView_;
+#if KUF_ENABLE_PROFILER
+    std::unique_ptr<ProfilerView> profilerView_;
+#endif
+
+    FramePacer framePacer_;
+    uint64_t lastEventCount_ = 0;
 
     std::string gameDirectory_;
     std::string pendingPopupMessage_;
@@ -52,6 +52,8 @@ AppConfig loadConfig() {
 
         cfg.lookupValue("fontSize", config.fontSize);
         cfg.lookupValue("maxRecentFiles", config.maxRecentFiles);
+        cfg.lookupValue("idleRendering", config.idleRendering);
+        cfg.lookupValue("undoHistoryMB", config.undoHistoryMB);
 
         if (cfg.exists("recentFiles")) {
             const libconfig::Setting& files = cfg.lookup("recentFiles");
@@ -75,6 +77,8 @@ void saveConfig(const AppConfig& config) {
     root.add("theme", libconfig::Setting::TypeInt) = static_cast<int>(config.theme);
     root.add("fontSize", libconfig::Setting::TypeFloat) = static_cast<double>(config.fontSize);
     root.add("maxRecentFiles", libconfig::Setting::TypeInt) = config.maxRecentFiles;
+    root.add("idleRendering", libconfig::Setting::TypeBoolean) = config.idleRendering;
+    root.add("undoHistoryMB", libconfig::Setting::TypeInt) = config.undoHistoryMB;
 
     libconfig::Setting& files = root.add("recentFiles", libconfig::Setting::TypeArray);
     for (const auto& path : config.recentFiles) {
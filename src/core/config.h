@@ -17,6 +17,8 @@ struct AppConfig {
     Theme theme = Theme::Dark;
     float fontSize = 17.0f;
     int maxRecentFiles = 10;
+    bool idleRendering = true; // Skip redraws while nothing changes.
+    int undoHistoryMB = 64;    // Undo history budget per open file.
     std::vector<std::string> recentFiles;
 };
 
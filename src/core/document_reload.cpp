@@ -0,0 +1,460 @@
+#include "core/document_reload.h"
+#include "core/file_io.h"
+#include "core/profiler.h"
+#include "formats/record_digest.h"
+#include "formats/sox_encoding.h"
+#include "formats/stg_merge.h"
+#include "undo/format_heap_bytes.h"
+#include "undo/set_field_command.h"
+#include "undo/set_text_command.h"
+#include "undo/snapshot_command.h"
+#include "undo/stg_event_command.h"
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+namespace kuf {
+
+namespace {
+
+using Bytes = std::vector<std::byte>;
+
+std::string fileNameOf(const std::string& path) {
+    auto pos = path.find_last_of("/\\");
+    return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+std::optional<DocumentKind> kindOf(const OpenDocument& doc) {
+    if (doc.stgData) return DocumentKind::Stg;
+    if (doc.skillData) return DocumentKind::Skill;
+    if (doc.binaryData) return DocumentKind::Troop;
+    if (doc.textData) return DocumentKind::Text;
+    return std::nullopt;
+}
+
+IFileFormat* formatOf(const OpenDocument& doc) {
+    if (doc.stgData) return doc.stgData.get();
+    if (doc.skillData) return doc.skillData.get();
+    if (doc.binaryData) return doc.binaryData.get();
+    if (doc.textData) return doc.textData.get();
+    return nullptr;
+}
+
+std::unique_ptr<IFileFormat> parse(DocumentKind kind, std::span<const std::byte> data) {
+    std::unique_ptr<IFileFormat> format;
+    switch (kind) {
+    case DocumentKind::Troop: format = std::make_unique<SoxBinary>(); break;
+    case DocumentKind::Skill: format = std::make_unique<SoxSkillInfo>(); break;
+    case DocumentKind::Text: format = std::make_unique<SoxText>(); break;
+    case DocumentKind::Stg: format = std::make_unique<StgFormat>(); break;
+    }
+    if (!format->load(data)) return nullptr;
+    return format;
+}
+
+// SOX documents are merged unencoded; the encoding only matters on save.
+std::optional<Bytes> unencoded(DocumentKind kind, Bytes data) {
+    if (kind == DocumentKind::Stg || !isSoxEncoded(data)) return data;
+    return soxDecode(data);
+}
+
+// --- merging ----------------------------------------------------------------
+
+struct Merge {
+    Bytes bytes;
+    std::vector<std::string> conflicts;
+    std::string error;
+};
+
+constexpr const char* kWholeFile = "whole file";
+
+// Both sides changed a file whose records cannot be paired up, e.g. because
+// a record was added on one side; the editor's version is kept.
+Merge keepOurs(const Bytes& ours) {
+    return {ours, {kWholeFile}, {}};
+}
+
+Merge mergeMission(const Bytes& base, const Bytes& ours, const Bytes& theirs) {
+    auto result = mergeStg(base, ours, theirs, StgMergePrefer::Ours);
+    if (auto* error = std::get_if<std::string>(&result)) return {{}, {}, *error};
+
+    auto& merged = std::get<StgMergeResult>(result);
+    Merge merge{std::move(merged.merged), {}, {}};
+    for (const auto& conflict : merged.conflicts) {
+        std::string text = conflict.key;
+        for (size_t i = 0; i < conflict.fields.size(); ++i) {
+            text += (i == 0 ? " (" : ", ") + conflict.fields[i];
+        }
+        if (!conflict.fields.empty()) text += ")";
+        merge.conflicts.push_back(std::move(text));
+    }
+    return merge;
+}
+
+bool sameLayout(const std::vector<RecordSpan>& a, const std::vector<RecordSpan>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].key != b[i].key || a[i].offset != b[i].offset || a[i].size != b[i].size) return false;
+    }
+    return true;
+}
+
+// Troop tables have fixed-size records at fixed offsets, so they merge as
+// byte ranges as long as no side changed the record count.
+Merge mergeTroops(const Bytes& base, const Bytes& ours, const Bytes& theirs) {
+    auto baseLayout = recordLayout("TroopInfo.sox", base);
+    auto oursLayout = recordLayout("TroopInfo.sox", ours);
+    auto theirsLayout = recordLayout("TroopInfo.sox", theirs);
+    if (!baseLayout || !oursLayout || !theirsLayout || !sameLayout(*baseLayout, *oursLayout) ||
+        !sameLayout(*baseLayout, *theirsLayout)) {
+        return keepOurs(ours);
+    }
+
+    Merge merge{ours, {}, {}};
+    for (const auto& span : *baseLayout) {
+        auto b = std::span(base).subspan(span.offset, span.size);
+        auto o = std::span(ours).subspan(span.offset, span.size);
+        auto t = std::span(theirs).subspan(span.offset, span.size);
+        bool oursChanged = !std::equal(o.begin(), o.end(), b.begin());
+        bool theirsChanged = !std::equal(t.begin(), t.end(), b.begin());
+        if (!theirsChanged) continue;
+        if (!oursChanged) {
+            std::copy(t.begin(), t.end(), merge.bytes.begin() + static_cast<std::ptrdiff_t>(span.offset));
+        } else if (!std::equal(o.begin(), o.end(), t.begin())) {
+            merge.conflicts.push_back(span.key);
+        }
+    }
+    return merge;
+}
+
+Merge mergeSkills(const Bytes& base, const Bytes& ours, const Bytes& theirs) {
+    SoxSkillInfo b, o, t;
+    if (!b.load(base) || !o.load(ours) || !t.load(theirs) || o.skills().size() != b.skills().size() ||
+        t.skills().size() != b.skills().size()) {
+        return keepOurs(ours);
+    }
+
+    Merge merge;
+    for (size_t i = 0; i < b.skills().size(); ++i) {
+        const auto& baseSkill = b.skills()[i];
+        if (t.skills()[i] == baseSkill) continue;
+        if (o.skills()[i] == baseSkill) {
+            o.skills()[i] = t.skills()[i];
+        } else if (!(o.skills()[i] == t.skills()[i])) {
+            merge.conflicts.push_back("skill:" + std::to_string(o.skills()[i].id));
+        }
+    }
+    merge.bytes = o.save();
+    return merge;
+}
+
+Merge mergeText(const Bytes& base, const Bytes& ours, const Bytes& theirs) {
+    SoxText b, o, t;
+    if (!b.load(base) || !o.load(ours) || !t.load(theirs) || o.entryCount() != b.entryCount() ||
+        t.entryCount() != b.entryCount()) {
+        return keepOurs(ours);
+    }
+
+    Merge merge;
+    for (size_t i = 0; i < b.entryCount(); ++i) {
+        if (t.text(i) == b.text(i)) continue;
+        if (o.text(i) == b.text(i)) {
+            o.setText(i, t.text(i));
+        } else if (o.text(i) != t.text(i)) {
+            merge.conflicts.push_back("text:" + std::to_string(i));
+        }
+    }
+    merge.bytes = o.save();
+    return merge;
+}
+
+// --- applying ---------------------------------------------------------------
+
+std::optional<ReloadRecord::Kind> recordKind(std::string_view key) {
+    std::string_view kind = key.substr(0, key.find_first_of(":#"));
+    if (kind == "header") return ReloadRecord::Kind::Header;
+    if (kind == "unit") return ReloadRecord::Kind::Unit;
+    if (kind == "area") return ReloadRecord::Kind::Area;
+    if (kind == "variable") return ReloadRecord::Kind::Variable;
+    if (kind == "event") return ReloadRecord::Kind::Event;
+    if (kind == "footer") return ReloadRecord::Kind::Footer;
+    if (kind == "troop") return ReloadRecord::Kind::Troop;
+    return std::nullopt;
+}
+
+// Records whose bytes differ between two versions with the same records in
+// the same order. Anything the spans cannot express is left for the
+// replay check in prepareReload to catch.
+std::vector<ReloadRecord> changedSpans(const std::string& fileName, const Bytes& ours, const Bytes& merged) {
+    std::vector<ReloadRecord> records;
+    auto oursLayout = recordLayout(fileName, ours);
+    auto mergedLayout = recordLayout(fileName, merged);
+    if (!oursLayout || !mergedLayout || oursLayout->size() != mergedLayout->size()) return records;
+
+    size_t counts[static_cast<size_t>(ReloadRecord::Kind::Text) + 1] = {};
+    for (size_t i = 0; i < oursLayout->size(); ++i) {
+        const auto& o = (*oursLayout)[i];
+        const auto& m = (*mergedLayout)[i];
+        auto kind = recordKind(o.key);
+        if (o.key != m.key || !kind) continue;
+        size_t index = counts[static_cast<size_t>(*kind)]++;
+        if (o.size != m.size || !std::equal(ours.begin() + static_cast<std::ptrdiff_t>(o.offset),
+                                            ours.begin() + static_cast<std::ptrdiff_t>(o.offset + o.size),
+                                            merged.begin() + static_cast<std::ptrdiff_t>(m.offset))) {
+            records.push_back({*kind, index});
+        }
+    }
+    return records;
+}
+
+std::vector<ReloadRecord> changedRecords(DocumentKind kind, const std::string& path, const Bytes& oursBytes,
+                                         const IFileFormat& ours, const Bytes& mergedBytes,
+                                         const IFileFormat& merged) {
+    std::vector<ReloadRecord> records;
+    switch (kind) {
+    case DocumentKind::Troop:
+    case DocumentKind::Stg:
+        return changedSpans(path, oursBytes, mergedBytes);
+    case DocumentKind::Skill: {
+        const auto& o = static_cast<const SoxSkillInfo&>(ours).skills();
+        const auto& m = static_cast<const SoxSkillInfo&>(merged).skills();
+        for (size_t i = 0; i < std::min(o.size(), m.size()); ++i) {
+            if (!(o[i] == m[i])) records.push_back({ReloadRecord::Kind::Skill, i});
+        }
+        break;
+    }
+    case DocumentKind::Text: {
+        const auto& o = static_cast<const SoxText&>(ours);
+        const auto& m = static_cast<const SoxText&>(merged);
+        for (size_t i = 0; i < std::min(o.entryCount(), m.entryCount()); ++i) {
+            if (o.text(i) != m.text(i)) records.push_back({ReloadRecord::Kind::Text, i});
+        }
+        break;
+    }
+    }
+    return records;
+}
+
+// Block and position of the index-th event counted across blocks.
+std::optional<std::pair<size_t, size_t>> eventSlot(const StgFormat& stg, size_t index) {
+    for (size_t b = 0; b < stg.eventBlocks().size(); ++b) {
+        size_t count = stg.eventBlocks()[b].events.size();
+        if (index < count) return std::make_pair(b, index);
+        index -= count;
+    }
+    return std::nullopt;
+}
+
+bool sameShape(const std::vector<StgScriptEntry>& a, const std::vector<StgScriptEntry>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const StgScriptEntry& x, const StgScriptEntry& y) {
+        return x.params.size() == y.params.size();
+    });
+}
+
+// True when every changed event keeps its number of conditions, actions and
+// parameters, so replacing it record by record changes no counts.
+bool eventShapesMatch(const IFileFormat& ours, const IFileFormat& merged, const std::vector<ReloadRecord>& records) {
+    const auto& o = static_cast<const StgFormat&>(ours);
+    const auto& m = static_cast<const StgFormat&>(merged);
+    for (const auto& record : records) {
+        if (record.kind != ReloadRecord::Kind::Event) continue;
+        auto oSlot = eventSlot(o, record.index);
+        auto mSlot = eventSlot(m, record.index);
+        if (!oSlot || !mSlot) return false;
+        const auto& a = o.eventBlocks()[oSlot->first].events[oSlot->second];
+        const auto& b = m.eventBlocks()[mSlot->first].events[mSlot->second];
+        if (!sameShape(a.conditions, b.conditions) || !sameShape(a.actions, b.actions)) return false;
+    }
+    return true;
+}
+
+template<typename T>
+CommandPtr setElement(std::vector<T>& target, const std::vector<T>& source, size_t index, const std::string& desc) {
+    if (index >= target.size() || index >= source.size()) return nullptr;
+    return makeSetFieldCommand(&target[index], source[index], desc);
+}
+
+// Copies one record of source over the same record of target.
+CommandPtr makeRecordCommand(IFileFormat& target, const IFileFormat& source, const ReloadRecord& record,
+                             const std::string& desc) {
+    size_t i = record.index;
+    switch (record.kind) {
+    case ReloadRecord::Kind::Header:
+        return makeSetFieldCommand(&static_cast<StgFormat&>(target).header(),
+                                   static_cast<const StgFormat&>(source).header(), desc);
+    case ReloadRecord::Kind::Unit:
+        return setElement(static_cast<StgFormat&>(target).units(), static_cast<const StgFormat&>(source).units(),
+                          i, desc);
+    case ReloadRecord::Kind::Area:
+        return setElement(static_cast<StgFormat&>(target).areas(), static_cast<const StgFormat&>(source).areas(),
+                          i, desc);
+    case ReloadRecord::Kind::Variable:
+        return setElement(static_cast<StgFormat&>(target).variables(),
+                          static_cast<const StgFormat&>(source).variables(), i, desc);
+    case ReloadRecord::Kind::Event: {
+        auto& to = static_cast<StgFormat&>(target);
+        const auto& from = static_cast<const StgFormat&>(source);
+        auto toSlot = eventSlot(to, i);
+        auto fromSlot = eventSlot(from, i);
+        if (!toSlot || !fromSlot) return nullptr;
+        // Addressed by position like the editor's own event commands, so the
+        // command does not depend on where the event vectors live.
+        return std::make_unique<StgEventCommand>(&to, toSlot->first, toSlot->second,
+                                                 to.eventBlocks()[toSlot->first].events[toSlot->second],
+                                                 from.eventBlocks()[fromSlot->first].events[fromSlot->second],
+                                                 desc);
+    }
+    case ReloadRecord::Kind::Footer:
+        return makeSetFieldCommand(&static_cast<StgFormat&>(target).footerEntries(),
+                                   static_cast<const StgFormat&>(source).footerEntries(), desc);
+    case ReloadRecord::Kind::Troop:
+        return setElement(static_cast<SoxBinary&>(target).troops(),
+                          static_cast<const SoxBinary&>(source).troops(), i, desc);
+    case ReloadRecord::Kind::Skill:
+        return setElement(static_cast<SoxSkillInfo&>(target).skills(),
+                          static_cast<const SoxSkillInfo&>(source).skills(), i, desc);
+    case ReloadRecord::Kind::Text: {
+        auto& text = static_cast<SoxText&>(target);
+        const auto& from = static_cast<const SoxText&>(source);
+        if (i >= text.entryCount() || i >= from.entryCount()) return nullptr;
+        auto command = std::make_unique<SetTextCommand>(&text, desc);
+        command->add(i, std::string(from.text(i)));
+        return command;
+    }
+    }
+    return nullptr;
+}
+
+CommandPtr makeReplaceCommand(DocumentKind kind, IFileFormat& target, const IFileFormat& source,
+                              const std::string& desc) {
+    switch (kind) {
+    case DocumentKind::Troop:
+        return makeSnapshotCommand(&static_cast<SoxBinary&>(target), static_cast<const SoxBinary&>(source), desc);
+    case DocumentKind::Skill:
+        return makeSnapshotCommand(&static_cast<SoxSkillInfo&>(target), static_cast<const SoxSkillInfo&>(source),
+                                   desc);
+    case DocumentKind::Text:
+        return makeSnapshotCommand(&static_cast<SoxText&>(target), static_cast<const SoxText&>(source), desc);
+    case DocumentKind::Stg:
+        return makeSnapshotCommand(&static_cast<StgFormat&>(target), static_cast<const StgFormat&>(source), desc);
+    }
+    return nullptr;
+}
+
+} // namespace
+
+std::optional<ReloadRequest> makeReloadRequest(const OpenDocument& doc) {
+    auto kind = kindOf(doc);
+    if (!kind || !doc.undoStack) return std::nullopt;
+    ReloadRequest request;
+    request.path = doc.path;
+    request.kind = *kind;
+    request.base = doc.rawData;
+    request.ours = formatOf(doc)->save();
+    request.revision = doc.undoStack->revision();
+    return request;
+}
+
+DocumentReload prepareReload(const ReloadRequest& request) {
+    KUF_PROFILE_ZONE("prepareReload");
+    DocumentReload reload;
+    reload.path = request.path;
+    reload.revision = request.revision;
+    if (!readFileBytes(request.path, reload.disk)) {
+        reload.error = "The file was removed or cannot be read.";
+        return reload;
+    }
+    if (reload.disk == request.base) {
+        reload.diskUnchanged = true;
+        return reload;
+    }
+
+    reload.diskEncoded = request.kind != DocumentKind::Stg && isSoxEncoded(reload.disk);
+    auto base = unencoded(request.kind, request.base);
+    auto theirs = unencoded(request.kind, reload.disk);
+    if (!theirs || !parse(request.kind, *theirs)) {
+        reload.error = "The changed file can no longer be parsed.";
+        return reload;
+    }
+
+    Merge merge;
+    if (!base || request.ours == *base) {
+        // No unsaved edits (or no usable base): the file on disk wins whole.
+        merge.bytes = *theirs;
+    } else {
+        switch (request.kind) {
+        case DocumentKind::Stg: merge = mergeMission(*base, request.ours, *theirs); break;
+        case DocumentKind::Troop: merge = mergeTroops(*base, request.ours, *theirs); break;
+        case DocumentKind::Skill: merge = mergeSkills(*base, request.ours, *theirs); break;
+        case DocumentKind::Text: merge = mergeText(*base, request.ours, *theirs); break;
+        }
+    }
+    if (!merge.error.empty()) {
+        reload.error = merge.error;
+        return reload;
+    }
+
+    auto ours = parse(request.kind, request.ours);
+    reload.merged = parse(request.kind, merge.bytes);
+    if (!ours || !reload.merged) {
+        reload.error = "The merged document failed to parse.";
+        return reload;
+    }
+    auto mergedBytes = reload.merged->save();
+    reload.matchesDisk = mergedBytes == *theirs;
+    reload.conflicts = std::move(merge.conflicts);
+
+    // Replaying the changed records on a copy of the document must give the
+    // merge exactly. Added, removed or reordered records, counts and block
+    // headers cannot be expressed that way and replace the whole document.
+    // So do events whose conditions, actions or parameters changed in number:
+    // counts inside a record are structure too.
+    reload.records = changedRecords(request.kind, request.path, request.ours, *ours, mergedBytes, *reload.merged);
+    bool shapesMatch = request.kind != DocumentKind::Stg || eventShapesMatch(*ours, *reload.merged, reload.records);
+    if (shapesMatch) {
+        for (const auto& record : reload.records) {
+            if (auto command = makeRecordCommand(*ours, *reload.merged, record, {})) command->execute();
+        }
+    }
+    if (!shapesMatch || ours->save() != mergedBytes) {
+        reload.replaceAll = true;
+        reload.records.clear();
+    }
+    return reload;
+}
+
+bool applyReload(OpenDocument& doc, DocumentReload& reload) {
+    KUF_PROFILE_ZONE("applyReload");
+    auto kind = kindOf(doc);
+    if (!kind || !doc.undoStack) return true;
+    UndoStack& undo = *doc.undoStack;
+    if (undo.revision() != reload.revision || undo.inTransaction()) return false;
+    if (!reload.error.empty() || reload.diskUnchanged) return true;
+
+    IFileFormat& target = *formatOf(doc);
+    std::string desc = "Reload " + fileNameOf(doc.path) + " from disk";
+    if (reload.replaceAll) {
+        // Earlier commands address records by pointer or position, and the
+        // records are about to move or be renumbered.
+        undo.clear();
+        undo.execute(makeReplaceCommand(*kind, target, *reload.merged, desc));
+    } else if (!reload.records.empty()) {
+        undo.sealMerge();
+        UndoTransaction transaction(undo, desc);
+        for (const auto& record : reload.records) {
+            if (auto command = makeRecordCommand(target, *reload.merged, record, desc)) {
+                undo.execute(std::move(command));
+            }
+        }
+        transaction.commit();
+    }
+
+    doc.rawData = std::move(reload.disk);
+    if (*kind != DocumentKind::Stg) doc.isSoxEncoded = reload.diskEncoded;
+    doc.dirty = !reload.matchesDisk;
+    return true;
+}
+
+} // namespace kuf
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "core/document.h"
+#include "formats/file_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kuf {
+
+// Kind of parsed data an OpenDocument holds.
+enum class DocumentKind {
+    Troop,
+    Skill,
+    Text,
+    Stg
+};
+
+// One record of a document. index counts records of that kind in document
+// order; events are counted across blocks.
+struct ReloadRecord {
+    enum class Kind {
+        Header,
+        Unit,
+        Area,
+        Variable,
+        Event,
+        Footer,
+        Troop,
+        Skill,
+        Text
+    };
+
+    Kind kind;
+    size_t index = 0;
+};
+
+// The state of an open document when a change to its file was noticed,
+// captured on the UI thread for prepareReload.
+struct ReloadRequest {
+    std::string path;
+    DocumentKind kind = DocumentKind::Stg;
+    std::vector<std::byte> base; // The file as last loaded or saved.
+    std::vector<std::byte> ours; // The document serialized now, unencoded.
+    uint64_t revision = 0;       // Undo revision ours was taken at.
+};
+
+// A change on disk merged with the document's unsaved edits, ready to apply.
+struct DocumentReload {
+    std::string path;
+    uint64_t revision = 0;
+    std::string error;           // The new file could not be read or parsed; nothing applies.
+    bool diskUnchanged = false;  // The file still matches the base, e.g. after our own save.
+
+    std::vector<std::byte> disk; // The file as now on disk; the document's next base.
+    bool diskEncoded = false;
+    std::unique_ptr<IFileFormat> merged;
+    // Records of merged that differ from the document. When replaceAll is set
+    // the structure changed (records added, removed or reordered, or an
+    // event's entry or parameter counts) and merged replaces the document as
+    // a whole instead.
+    std::vector<ReloadRecord> records;
+    bool replaceAll = false;
+    // Records edited both in the editor and on disk, which keep the editor's
+    // version, e.g. "unit:1001 (positionX)".
+    std::vector<std::string> conflicts;
+    bool matchesDisk = false;    // Once applied, the document equals the file on disk.
+};
+
+// Nullopt when the document holds no parsed data.
+std::optional<ReloadRequest> makeReloadRequest(const OpenDocument& doc);
+
+// Reads the file again and three-way merges it with the request: the base is
+// the file as the document last saw it, ours the document, theirs the new
+// file. Changes on only one side merge record by record, and by field for
+// STG units and areas. Thread-safe; runs on a task thread.
+DocumentReload prepareReload(const ReloadRequest& request);
+
+// Applies a prepared reload as one undo step, replacing only the records that
+// changed. Records are assigned in place and events by position, so no record
+// moves and earlier commands stay valid. A structural change, including an
+// event gaining or losing conditions, actions or parameters, replaces the
+// document and clears the history before it. Returns false
+// without touching the document when it was edited after the request was
+// made; prepare again from a new request.
+bool applyReload(OpenDocument& doc, DocumentReload& reload);
+
+} // namespace kuf
@@ -0,0 +1,107 @@
+#include "core/document_watcher.h"
+#include "core/profiler.h"
+#include "core/tab_manager.h"
+#include "core/worker_pool.h"
+
+namespace kuf {
+
+DocumentWatcher::DocumentWatcher(TabManager& tabs) : tabs_(tabs) {}
+
+void DocumentWatcher::setGameDirectory(const std::string& dir) {
+    gameDirectory_ = dir.empty() ? std::string() : FileWatcher::normalize(dir);
+    watcher_.watchDirectory(gameDirectory_);
+}
+
+void DocumentWatcher::update() {
+    KUF_PROFILE_ZONE("DocumentWatcher::update");
+    syncWatches();
+
+    auto changes = watcher_.takeChanges();
+    std::vector<std::string> gameFiles;
+    for (auto& path : changes) {
+        if (watched_.count(path)) queued_.insert(path);
+        if (FileWatcher::isUnder(path, gameDirectory_)) {
+            gameFiles.push_back(std::move(path));
+        }
+    }
+    if (!gameFiles.empty() && onGameFilesChanged_) onGameFilesChanged_(gameFiles);
+
+    if (task_.state() == AsyncTaskState::Completed || task_.state() == AsyncTaskState::Failed) {
+        applyFinished();
+    }
+    if (!busy() && !queued_.empty()) startReloads();
+}
+
+void DocumentWatcher::syncWatches() {
+    std::set<std::string> open;
+    for (const auto& tab : tabs_.tabs()) {
+        if (tab->document() && !tab->document()->path.empty()) {
+            open.insert(FileWatcher::normalize(tab->document()->path));
+        }
+    }
+    if (open == watched_) return;
+
+    for (const auto& path : watched_) {
+        if (!open.count(path)) {
+            watcher_.unwatchFile(path);
+            queued_.erase(path);
+        }
+    }
+    for (const auto& path : open) {
+        if (!watched_.count(path)) watcher_.watchFile(path);
+    }
+    watched_ = std::move(open);
+}
+
+OpenDocument* DocumentWatcher::findDocument(const std::string& normalPath) const {
+    for (const auto& tab : tabs_.tabs()) {
+        if (tab->document() && FileWatcher::normalize(tab->document()->path) == normalPath) {
+            return tab->document().get();
+        }
+    }
+    return nullptr;
+}
+
+void DocumentWatcher::applyFinished() {
+    auto reloads = std::move(pending_);
+    task_.reset();
+    if (!reloads) return;
+
+    for (auto& reload : *reloads) {
+        // The tab may have been closed while the reload was prepared.
+        OpenDocument* doc = findDocument(reload.path);
+        if (!doc) continue;
+        if (!applyReload(*doc, reload)) {
+            // Edited in the meantime; merge again against the new edits.
+            queued_.insert(reload.path);
+            continue;
+        }
+        if (!reload.diskUnchanged && onReloaded_) onReloaded_(doc, reload);
+    }
+}
+
+void DocumentWatcher::startReloads() {
+    std::vector<ReloadRequest> requests;
+    for (const auto& path : queued_) {
+        OpenDocument* doc = findDocument(path);
+        if (!doc) continue;
+        if (auto request = makeReloadRequest(*doc)) {
+            request->path = path;
+            requests.push_back(std::move(*request));
+        }
+    }
+    queued_.clear();
+    if (requests.empty()) return;
+
+    auto results = std::make_shared<std::vector<DocumentReload>>(requests.size());
+    pending_ = results;
+    task_.start([results, requests = std::move(requests)](AsyncTask& t) {
+        t.setProgress(0.0f, "Reloading changed files...");
+        WorkerPool::shared().parallelFor(requests.size(), [&](size_t i) {
+            (*results)[i] = prepareReload(requests[i]);
+        });
+        return true;
+    });
+}
+
+} // namespace kuf
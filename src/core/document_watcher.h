@@ -0,0 +1,67 @@
+#pragma once
+
+#include "core/async_task.h"
+#include "core/document_reload.h"
+#include "core/file_watcher.h"
+
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace kuf {
+
+class TabManager;
+
+// Keeps open documents in step with their files when other programs change
+// them. Every open document and the game directory are watched; a changed
+// document is re-read and merged with its unsaved edits on a task thread,
+// then applied on the UI thread as one undo step.
+class DocumentWatcher {
+public:
+    explicit DocumentWatcher(TabManager& tabs);
+
+    // Called on the watcher thread when a change is waiting, to wake the UI.
+    void setOnWake(std::function<void()> cb) { watcher_.setOnChange(std::move(cb)); }
+
+    // Called with files changed in the game directory, open or not.
+    void setOnGameFilesChanged(std::function<void(const std::vector<std::string>& paths)> cb) {
+        onGameFilesChanged_ = std::move(cb);
+    }
+
+    // Called after a reload was applied to doc or failed.
+    void setOnReloaded(std::function<void(OpenDocument* doc, const DocumentReload& reload)> cb) {
+        onReloaded_ = std::move(cb);
+    }
+
+    void setGameDirectory(const std::string& dir);
+
+    // Call once per frame on the UI thread. Cheap when nothing changed.
+    void update();
+
+    bool busy() const { return task_.state() == AsyncTaskState::Running; }
+
+private:
+    void syncWatches();
+    void applyFinished();
+    void startReloads();
+    OpenDocument* findDocument(const std::string& normalPath) const;
+
+    TabManager& tabs_;
+    FileWatcher watcher_;
+    std::string gameDirectory_;
+
+    // Normalized paths of open documents being watched, and of those waiting
+    // for a reload.
+    std::set<std::string> watched_;
+    std::set<std::string> queued_;
+
+    AsyncTask task_;
+    std::shared_ptr<std::vector<DocumentReload>> pending_;
+
+    std::function<void(const std::vector<std::string>&)> onGameFilesChanged_;
+    std::function<void(OpenDocument*, const DocumentReload&)> onReloaded_;
+};
+
+} // namespace kuf
@@ -0,0 +1,35 @@
+#include "core/file_io.h"
+
+#include <cctype>
+#include <fstream>
+
+namespace kuf {
+
+std::string lowerExtension(std::string_view path) {
+    auto dot = path.find_last_of('.');
+    if (dot == std::string_view::npos) return {};
+    auto separator = path.find_last_of("/\\");
+    if (separator != std::string_view::npos && separator > dot) return {};
+
+    std::string ext(path.substr(dot));
+    for (auto& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return ext;
+}
+
+bool readFileBytes(const std::filesystem::path& path, std::vector<std::byte>& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    auto size = file.tellg();
+    if (size < 0) return false;
+    file.seekg(0);
+    out.resize(static_cast<size_t>(size));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()), size));
+}
+
+std::optional<std::vector<std::byte>> readFileBytes(const std::filesystem::path& path) {
+    std::vector<std::byte> data;
+    if (!readFileBytes(path, data)) return std::nullopt;
+    return data;
+}
+
+} // namespace kuf
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kuf {
+
+// Extension of the last path component, lowercased and including the dot
+// (".sox"). Empty when the file name has no dot.
+std::string lowerExtension(std::string_view path);
+
+// Reads a whole file into out, reusing its capacity. False if the file cannot
+// be opened or read completely.
+bool readFileBytes(const std::filesystem::path& path, std::vector<std::byte>& out);
+std::optional<std::vector<std::byte>> readFileBytes(const std::filesystem::path& path);
+
+} // namespace kuf
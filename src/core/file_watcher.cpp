@@ -0,0 +1,343 @@
+#include "core/file_watcher.h"
+#include "core/profiler.h"
+
+#include <filesystem>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace kuf {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Quiet time after the last event before a burst is reported.
+constexpr int kSettleMs = 50;
+
+std::string parentOf(const std::string& path) {
+    return fs::path(path).parent_path().string();
+}
+
+// The directory and every directory below it.
+std::vector<std::string> directoryTree(const std::string& dir) {
+    std::vector<std::string> dirs;
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) return dirs;
+    dirs.push_back(dir);
+    for (fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        if (it->is_directory(ec)) dirs.push_back(it->path().string());
+    }
+    return dirs;
+}
+
+} // namespace
+
+FileWatcher::FileWatcher(Backend preferred, std::chrono::milliseconds pollInterval)
+    : backend_(preferred), pollInterval_(pollInterval) {
+    if (backend_ == Backend::Native && !startNative()) backend_ = Backend::Polling;
+    if (backend_ == Backend::Native) {
+        thread_ = std::thread([this]() { nativeLoop(); });
+    } else {
+        thread_ = std::thread([this]() { pollLoop(); });
+    }
+}
+
+FileWatcher::~FileWatcher() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+#ifdef __linux__
+    if (stopFd_[1] >= 0) {
+        char byte = 0;
+        [[maybe_unused]] auto written = ::write(stopFd_[1], &byte, 1);
+    }
+#endif
+    thread_.join();
+#ifdef __linux__
+    for (int fd : {inotifyFd_, stopFd_[0], stopFd_[1]}) {
+        if (fd >= 0) ::close(fd);
+    }
+#endif
+}
+
+std::string FileWatcher::normalize(const std::string& path) {
+    std::error_code ec;
+    auto absolute = fs::absolute(path, ec);
+    return (ec ? fs::path(path) : absolute).lexically_normal().string();
+}
+
+bool FileWatcher::isUnder(const std::string& path, const std::string& dir) {
+    if (dir.empty() || path.size() <= dir.size() || path.compare(0, dir.size(), dir) != 0) return false;
+    constexpr char kSeparator = static_cast<char>(fs::path::preferred_separator);
+    return dir.back() == kSeparator || path[dir.size()] == kSeparator;
+}
+
+void FileWatcher::watchFile(const std::string& path) {
+    std::string normal = normalize(path);
+    {
+        std::lock_guard lock(mutex_);
+        if (!files_.insert(normal).second) return;
+    }
+    addDirectoryWatches({parentOf(normal)});
+}
+
+void FileWatcher::unwatchFile(const std::string& path) {
+    std::string normal = normalize(path);
+    std::lock_guard lock(mutex_);
+    if (files_.erase(normal) == 0) return;
+    changes_.erase(normal);
+    releaseDirectoryWatch(parentOf(normal));
+}
+
+void FileWatcher::watchDirectory(const std::string& dir) {
+    std::string normal = dir.empty() ? std::string() : normalize(dir);
+    // Trailing separators would break the prefix test in isUnder.
+    while (normal.size() > 1 && normal.back() == static_cast<char>(fs::path::preferred_separator)) {
+        normal.pop_back();
+    }
+    {
+        std::lock_guard lock(mutex_);
+        if (normal == directory_) return;
+        std::string previous = std::move(directory_);
+        directory_ = normal;
+        std::vector<std::string> stale;
+        for (const auto& [watched, wd] : dirWatches_) {
+            if (watched == previous || isUnder(watched, previous)) stale.push_back(watched);
+        }
+        for (const auto& watched : stale) releaseDirectoryWatch(watched);
+    }
+    if (backend_ == Backend::Native && !normal.empty()) addDirectoryWatches(directoryTree(normal));
+}
+
+void FileWatcher::setOnChange(std::function<void()> cb) {
+    std::lock_guard lock(mutex_);
+    onChange_ = std::move(cb);
+}
+
+std::vector<std::string> FileWatcher::takeChanges() {
+    std::lock_guard lock(mutex_);
+    std::vector<std::string> changes(changes_.begin(), changes_.end());
+    changes_.clear();
+    return changes;
+}
+
+bool FileWatcher::isWatched(const std::string& path) const {
+    return files_.count(path) > 0 || isUnder(path, directory_);
+}
+
+void FileWatcher::publish(const std::set<std::string>& changed) {
+    std::function<void()> onChange;
+    {
+        std::lock_guard lock(mutex_);
+        bool added = false;
+        for (const auto& path : changed) {
+            // Files unwatched since the change was seen are dropped.
+            if (isWatched(path)) added |= changes_.insert(path).second;
+        }
+        if (!added) return;
+        onChange = onChange_;
+    }
+    if (onChange) onChange();
+}
+
+// --- inotify ----------------------------------------------------------------
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint32_t kWatchMask =
+    IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+} // namespace
+
+bool FileWatcher::startNative() {
+    inotifyFd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0) return false;
+    if (::pipe2(stopFd_, O_NONBLOCK | O_CLOEXEC) != 0) {
+        ::close(inotifyFd_);
+        inotifyFd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void FileWatcher::addDirectoryWatches(const std::vector<std::string>& dirs) {
+    if (backend_ != Backend::Native) return;
+    std::lock_guard lock(mutex_);
+    for (const auto& dir : dirs) {
+        if (dirWatches_.count(dir)) continue;
+        int wd = ::inotify_add_watch(inotifyFd_, dir.c_str(), kWatchMask);
+        if (wd < 0) continue; // Missing directory or out of watches; nothing to report from it.
+        watchDirs_[wd] = dir;
+        dirWatches_[dir] = wd;
+    }
+}
+
+// Called with mutex_ held.
+void FileWatcher::releaseDirectoryWatch(const std::string& dir) {
+    auto it = dirWatches_.find(dir);
+    if (it == dirWatches_.end()) return;
+    if (dir == directory_ || isUnder(dir, directory_)) return;
+    for (const auto& file : files_) {
+        if (parentOf(file) == dir) return;
+    }
+    ::inotify_rm_watch(inotifyFd_, it->second);
+    watchDirs_.erase(it->second);
+    dirWatches_.erase(it);
+}
+
+void FileWatcher::nativeLoop() {
+    KUF_PROFILE_THREAD("file watcher");
+    alignas(inotify_event) char buffer[16384];
+    pollfd fds[2] = {{inotifyFd_, POLLIN, 0}, {stopFd_[0], POLLIN, 0}};
+    std::set<std::string> pending;
+
+    while (true) {
+        int ready = ::poll(fds, 2, pending.empty() ? -1 : kSettleMs);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents != 0) break;
+        if (ready == 0) {
+            publish(pending);
+            pending.clear();
+            continue;
+        }
+
+        std::vector<std::string> newDirs;
+        ssize_t length;
+        while ((length = ::read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+            std::lock_guard lock(mutex_);
+            for (char* p = buffer; p < buffer + length;) {
+                auto* event = reinterpret_cast<inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+
+                auto dir = watchDirs_.find(event->wd);
+                if (dir == watchDirs_.end()) continue;
+                if (event->mask & IN_IGNORED) {
+                    dirWatches_.erase(dir->second);
+                    watchDirs_.erase(dir);
+                    continue;
+                }
+                if (event->len == 0) continue;
+
+                std::string path = dir->second + "/" + event->name;
+                if (event->mask & IN_ISDIR) {
+                    if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && isUnder(path, directory_)) {
+                        newDirs.push_back(path);
+                    }
+                } else if (isWatched(path)) {
+                    pending.insert(std::move(path));
+                }
+            }
+        }
+
+        // Files may land in a new directory before its watch exists, so its
+        // current contents count as changed.
+        for (const auto& dir : newDirs) {
+            auto tree = directoryTree(dir);
+            addDirectoryWatches(tree);
+            std::error_code ec;
+            for (const auto& sub : tree) {
+                for (fs::directory_iterator it(sub, ec), end; !ec && it != end; it.increment(ec)) {
+                    if (it->is_regular_file(ec)) pending.insert(it->path().string());
+                }
+            }
+        }
+    }
+}
+
+#else
+
+bool FileWatcher::startNative() {
+    return false;
+}
+
+void FileWatcher::addDirectoryWatches(const std::vector<std::string>&) {}
+
+void FileWatcher::releaseDirectoryWatch(const std::string&) {}
+
+void FileWatcher::nativeLoop() {}
+
+#endif
+
+// --- polling ----------------------------------------------------------------
+
+FileWatcher::Snapshot FileWatcher::snapshot() const {
+    Snapshot snap;
+    std::set<std::string> files;
+    {
+        std::lock_guard lock(mutex_);
+        files = files_;
+        snap.directory = directory_;
+    }
+
+    auto stamp = [](const fs::path& path) {
+        FileStamp s;
+        std::error_code ec;
+        s.size = fs::file_size(path, ec);
+        if (ec) return s;
+        auto modified = fs::last_write_time(path, ec);
+        if (ec) return s;
+        s.modified = static_cast<long long>(modified.time_since_epoch().count());
+        s.exists = true;
+        return s;
+    };
+    for (const auto& file : files) snap.stamps[file] = stamp(file);
+
+    std::error_code ec;
+    if (!snap.directory.empty() && fs::is_directory(snap.directory, ec)) {
+        for (fs::recursive_directory_iterator it(snap.directory, fs::directory_options::skip_permission_denied, ec),
+             end;
+             !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec)) snap.stamps[it->path().string()] = stamp(it->path());
+        }
+    }
+    return snap;
+}
+
+void FileWatcher::pollLoop() {
+    KUF_PROFILE_THREAD("file watcher");
+    Snapshot previous = snapshot();
+    while (true) {
+        {
+            std::unique_lock lock(mutex_);
+            if (wake_.wait_for(lock, pollInterval_, [this]() { return stopping_; })) break;
+        }
+
+        Snapshot current = snapshot();
+        // A new directory is a new baseline, not a change to every file in it.
+        bool sameDirectory = current.directory == previous.directory;
+        std::set<std::string> changed;
+        for (const auto& [path, stamp] : current.stamps) {
+            auto old = previous.stamps.find(path);
+            if (old == previous.stamps.end()) {
+                // Newly watched files start their baseline; new files in the
+                // directory were created.
+                if (sameDirectory && isUnder(path, current.directory) && stamp.exists) changed.insert(path);
+            } else if (!(old->second == stamp)) {
+                changed.insert(path);
+            }
+        }
+        if (sameDirectory) {
+            for (const auto& [path, stamp] : previous.stamps) {
+                if (stamp.exists && !current.stamps.count(path)) changed.insert(path);
+            }
+        }
+        if (!changed.empty()) publish(changed);
+        previous = std::move(current);
+    }
+}
+
+} // namespace kuf
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kuf {
+
+// Reports files changed on disk by other programs. On Linux changes come from
+// inotify with one watch per directory, so idle watching costs nothing however
+// many files are watched; elsewhere, or when inotify is unavailable, the
+// watched files are stat'ed every poll interval. Bursts of events, such as a
+// file written in several chunks, are reported once they settle.
+class FileWatcher {
+public:
+    enum class Backend {
+        Native,
+        Polling
+    };
+
+    explicit FileWatcher(Backend preferred = Backend::Native,
+                         std::chrono::milliseconds pollInterval = std::chrono::milliseconds(1000));
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Backend actually in use; Polling when Native was asked for but failed.
+    Backend backend() const { return backend_; }
+
+    // Files are watched by path, so a file replaced by a rename is still seen.
+    void watchFile(const std::string& path);
+    void unwatchFile(const std::string& path);
+
+    // Watches every file below dir, including directories created later.
+    // Replaces the previously watched directory; an empty dir stops watching.
+    void watchDirectory(const std::string& dir);
+
+    // Called on the watcher thread whenever changes are ready to take, e.g.
+    // to wake a UI loop blocked waiting for input.
+    void setOnChange(std::function<void()> cb);
+
+    // Normalized paths of watched files changed, created or removed since the
+    // last call, sorted.
+    std::vector<std::string> takeChanges();
+
+    // Absolute, lexically normal form of path, as takeChanges reports it.
+    static std::string normalize(const std::string& path);
+    // True when path lies below dir, not merely beside it with a longer name:
+    // /games/kuf2/a is not under /games/kuf.
+    static bool isUnder(const std::string& path, const std::string& dir);
+
+private:
+    struct FileStamp {
+        long long modified = 0;
+        unsigned long long size = 0;
+        bool exists = false;
+
+        bool operator==(const FileStamp&) const = default;
+    };
+
+    // Stamps of every watched file, and the directory walked to find them.
+    struct Snapshot {
+        std::string directory;
+        std::map<std::string, FileStamp> stamps;
+    };
+
+    bool isWatched(const std::string& path) const;
+    void publish(const std::set<std::string>& changed);
+
+    bool startNative();
+    void nativeLoop();
+    void addDirectoryWatches(const std::vector<std::string>& dirs);
+    void releaseDirectoryWatch(const std::string& dir);
+
+    void pollLoop();
+    Snapshot snapshot() const;
+
+    Backend backend_;
+    std::chrono::milliseconds pollInterval_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::set<std::string> files_;
+    std::string directory_;
+    std::set<std::string> changes_;
+    std::function<void()> onChange_;
+
+    // inotify state. Watch descriptors map to the directory they watch; the
+    // same directory is never watched twice.
+    int inotifyFd_ = -1;
+    int stopFd_[2] = {-1, -1};
+    std::map<int, std::string> watchDirs_;
+    std::map<std::string, int> dirWatches_;
+
+    std::thread thread_;
+};
+
+} // namespace kuf
@@ -0,0 +1,39 @@
+#include "core/frame_pacer.h"
+
+#include <cmath>
+
+namespace kuf {
+
+FramePacer::FramePacer(double refreshRate)
+    : frameSeconds_(1.0 / (refreshRate > 0.0 ? refreshRate : 60.0)) {}
+
+double FramePacer::nextWait(const FrameActivity& activity) {
+    if (!enabled_) return 0.0;
+
+    if (activity.inputEvents || activity.interacting) {
+        settleFrames_ = kSettleFrames;
+        return 0.0;
+    }
+    if (settleFrames_ > 0) {
+        --settleFrames_;
+        return 0.0;
+    }
+    if (activity.backgroundWork) return kBusyInterval;
+    if (activity.hovering) return kHoverInterval;
+    return kIdleInterval;
+}
+
+void FramePacer::recordWait(double seconds) {
+    if (seconds <= 0.0) return;
+    // A frame drawn right after the wait covers one refresh of it.
+    double frames = seconds / frameSeconds_ + skippedRemainder_ - 1.0;
+    if (frames <= 0.0) {
+        skippedRemainder_ = 0.0;
+        return;
+    }
+    double whole = std::floor(frames);
+    skippedFrames_ += static_cast<uint64_t>(whole);
+    skippedRemainder_ = frames - whole;
+}
+
+} // namespace kuf
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace kuf {
+
+// What happened during the frame that was just drawn.
+struct FrameActivity {
+    bool inputEvents = false;    // Window events were processed.
+    bool interacting = false;    // An item is active, text is being edited or a button is held.
+    bool hovering = false;       // Something is hovered and may open a delayed tooltip.
+    bool backgroundWork = false; // An AsyncTask is running and reporting progress.
+};
+
+// Decides how long the main loop may block waiting for events before it
+// draws again. Input always wakes the loop at once, so waiting never delays a
+// response; it only skips frames that would have looked like the last one.
+class FramePacer {
+public:
+    // Frames drawn at full rate after any input, so popups, hover state and
+    // layout changes triggered by it settle before the loop goes idle.
+    static constexpr int kSettleFrames = 3;
+    // Redraw interval while a background task reports progress (10 fps).
+    static constexpr double kBusyInterval = 0.1;
+    // Redraw interval while hovering, so tooltip delays still elapse.
+    static constexpr double kHoverInterval = 0.1;
+    // Longest wait when nothing at all is happening.
+    static constexpr double kIdleInterval = 1.0;
+
+    explicit FramePacer(double refreshRate = 60.0);
+
+    // Seconds to wait for events before the next frame, given what the last
+    // frame did. 0 means draw again immediately.
+    double nextWait(const FrameActivity& activity);
+
+    // Reports how long the loop actually waited. Each display refresh that
+    // passed without a frame counts as skipped.
+    void recordWait(double seconds);
+
+    uint64_t skippedFrames() const { return skippedFrames_; }
+
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    bool enabled() const { return enabled_; }
+
+private:
+    double frameSeconds_;
+    int settleFrames_ = kSettleFrames;
+    double skippedRemainder_ = 0.0;
+    uint64_t skippedFrames_ = 0;
+    bool enabled_ = true;
+};
+
+} // namespace kuf
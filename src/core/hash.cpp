@@ -0,0 +1,141 @@
+#include "core/hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace kuf {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t mixRound(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    acc ^= mixRound(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+// Consumes whole 32-byte stripes and returns the number of bytes used.
+size_t consumeStripes(uint64_t (&acc)[4], const unsigned char* p, size_t size) {
+    size_t used = 0;
+    uint64_t v1 = acc[0], v2 = acc[1], v3 = acc[2], v4 = acc[3];
+    while (size - used >= 32) {
+        v1 = mixRound(v1, read64(p + used));
+        v2 = mixRound(v2, read64(p + used + 8));
+        v3 = mixRound(v3, read64(p + used + 16));
+        v4 = mixRound(v4, read64(p + used + 24));
+        used += 32;
+    }
+    acc[0] = v1;
+    acc[1] = v2;
+    acc[2] = v3;
+    acc[3] = v4;
+    return used;
+}
+
+} // namespace
+
+Hash64::Hash64(uint64_t seed) : seed_(seed) {
+    acc_[0] = seed + kPrime1 + kPrime2;
+    acc_[1] = seed + kPrime2;
+    acc_[2] = seed;
+    acc_[3] = seed - kPrime1;
+}
+
+void Hash64::update(const void* data, size_t size) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    totalLength_ += size;
+
+    // Top up a partially filled stripe from a previous call first.
+    if (pendingSize_ > 0) {
+        size_t take = std::min(size, sizeof(pending_) - pendingSize_);
+        std::memcpy(pending_ + pendingSize_, p, take);
+        pendingSize_ += take;
+        p += take;
+        size -= take;
+        if (pendingSize_ < sizeof(pending_)) return;
+        consumeStripes(acc_, pending_, sizeof(pending_));
+        pendingSize_ = 0;
+    }
+
+    size_t used = consumeStripes(acc_, p, size);
+    if (used < size) {
+        std::memcpy(pending_, p + used, size - used);
+        pendingSize_ = size - used;
+    }
+}
+
+uint64_t Hash64::digest() const {
+    uint64_t h;
+    if (totalLength_ >= 32) {
+        h = rotl(acc_[0], 1) + rotl(acc_[1], 7) + rotl(acc_[2], 12) + rotl(acc_[3], 18);
+        h = mergeRound(h, acc_[0]);
+        h = mergeRound(h, acc_[1]);
+        h = mergeRound(h, acc_[2]);
+        h = mergeRound(h, acc_[3]);
+    } else {
+        h = seed_ + kPrime5;
+    }
+    h += totalLength_;
+
+    const unsigned char* p = pending_;
+    size_t remaining = pendingSize_;
+    while (remaining >= 8) {
+        h ^= mixRound(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+        remaining -= 8;
+    }
+    if (remaining >= 4) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+        remaining -= 4;
+    }
+    while (remaining > 0) {
+        h ^= static_cast<uint64_t>(*p) * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+        ++p;
+        --remaining;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t hash64(const void* data, size_t size, uint64_t seed) {
+    Hash64 hasher(seed);
+    hasher.update(data, size);
+    return hasher.digest();
+}
+
+} // namespace kuf
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace kuf {
+
+// Streaming 64-bit non-cryptographic hash (the XXH64 algorithm). Input is consumed
+// in 32-byte stripes across four independent accumulators, which keeps the inner
+// loop free of serial dependencies so it runs at memory bandwidth.
+class Hash64 {
+public:
+    explicit Hash64(uint64_t seed = 0);
+
+    void update(const void* data, size_t size);
+    void update(std::span<const std::byte> data) { update(data.data(), data.size()); }
+
+    uint64_t digest() const;
+
+private:
+    uint64_t seed_;
+    uint64_t acc_[4];
+    uint64_t totalLength_ = 0;
+    unsigned char pending_[32];
+    size_t pendingSize_ = 0;
+};
+
+// One-shot convenience wrapper around Hash64.
+uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+inline uint64_t hash64(std::span<const std::byte> data, uint64_t seed = 0) {
+    return hash64(data.data(), data.size(), seed);
+}
+
+} // namespace kuf
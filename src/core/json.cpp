@@ -77,13 +77,27 @@ std::string escapeJsonString(const std::string& s) {
     return result;
 }
 
-} // namespace
+// Reads a non-negative or negative JSON integer. Fractions and exponents are not used
+// by any of our files and stop the read.
+int64_t readJsonInteger(const std::string& text, size_t& pos) {
+    bool negative = false;
+    if (pos < text.size() && text[pos] == '-') {
+        negative = true;
+        ++pos;
+    }
+    int64_t value = 0;
+    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+        value = value * 10 + (text[pos] - '0');
+        ++pos;
+    }
+    return negative ? -value : value;
+}
 
-std::optional<ModMetadata> parseModJson(const std::string& text) {
+// Reads a mod.json object starting at the opening brace and leaves pos after the
+// closing brace. Unknown keys are skipped; required fields are not checked here.
+std::optional<ModMetadata> readModObject(const std::string& text, size_t& pos) {
     ModMetadata meta;
-    size_t pos = 0;
 
-    skipWhitespace(text, pos);
     if (pos >= text.size() || text[pos] != '{') return std::nullopt;
     ++pos;
 
@@ -115,38 +129,57 @@ std::optional<ModMetadata> parseModJson(const std::string& text) {
         skipWhitespace(text, pos);
         if (pos < text.size() && text[pos] == ',') ++pos;
     }
-
-    // Validate required fields.
-    if (meta.name.empty() || meta.version.empty() || meta.game.empty() || meta.files.empty()) {
-        return std::nullopt;
-    }
+    if (pos < text.size()) ++pos; // skip '}'
 
     return meta;
 }
 
-std::string serializeModJson(const ModMetadata& meta) {
-    std::ostringstream out;
+// Writes a mod.json object. Nested lines are prefixed with indent so the object
+// can be embedded in other documents.
+void writeModObject(std::ostringstream& out, const ModMetadata& meta, const std::string& indent) {
     out << "{\n";
-    out << "  \"name\": \"" << escapeJsonString(meta.name) << "\",\n";
-    out << "  \"version\": \"" << escapeJsonString(meta.version) << "\",\n";
+    out << indent << "  \"name\": \"" << escapeJsonString(meta.name) << "\",\n";
+    out << indent << "  \"version\": \"" << escapeJsonString(meta.version) << "\",\n";
     if (!meta.author.empty()) {
-        out << "  \"author\": \"" << escapeJsonString(meta.author) << "\",\n";
+        out << indent << "  \"author\": \"" << escapeJsonString(meta.author) << "\",\n";
     }
     if (!meta.description.empty()) {
-        out << "  \"description\": \"" << escapeJsonString(meta.description) << "\",\n";
+        out << indent << "  \"description\": \"" << escapeJsonString(meta.description) << "\",\n";
     }
-    out << "  \"game\": \"" << escapeJsonString(meta.game) << "\",\n";
+    out << indent << "  \"game\": \"" << escapeJsonString(meta.game) << "\",\n";
     if (!meta.created.empty()) {
-        out << "  \"created\": \"" << escapeJsonString(meta.created) << "\",\n";
+        out << indent << "  \"created\": \"" << escapeJsonString(meta.created) << "\",\n";
     }
-    out << "  \"files\": [\n";
+    out << indent << "  \"files\": [\n";
     for (size_t i = 0; i < meta.files.size(); ++i) {
-        out << "    \"" << escapeJsonString(meta.files[i]) << "\"";
+        out << indent << "    \"" << escapeJsonString(meta.files[i]) << "\"";
         if (i + 1 < meta.files.size()) out << ",";
         out << "\n";
     }
-    out << "  ]\n";
-    out << "}\n";
+    out << indent << "  ]\n";
+    out << indent << "}";
+}
+
+} // namespace
+
+std::optional<ModMetadata> parseModJson(const std::string& text) {
+    size_t pos = 0;
+    skipWhitespace(text, pos);
+    auto meta = readModObject(text, pos);
+    if (!meta) return std::nullopt;
+
+    // Validate required fields.
+    if (meta->name.empty() || meta->version.empty() || meta->game.empty() || meta->files.empty()) {
+        return std::nullopt;
+    }
+
+    return meta;
+}
+
+std::string serializeModJson(const ModMetadata& meta) {
+    std::ostringstream out;
+    writeModObject(out, meta, "");
+    out << "\n";
     return out.str();
 }
 
@@ -196,6 +229,8 @@ std::vector<InstalledModInfo> parseInstalledModsJson(const std::string& text) {
                             else if (k == "game") info.game = v;
                             else if (k == "installedAt") info.installedAt = v;
                             else if (k == "zipPath") info.zipPath = v;
+                            else if (k == "gameDir") info.gameDir = v;
+                            else if (k == "preimagePath") info.preimagePath = v;
                         } else {
                             while (pos < text.size() && text[pos] != ',' && text[pos] != '}') ++pos;
                         }
@@ -239,8 +274,13 @@ std::string serializeInstalledModsJson(const std::vector<InstalledModInfo>& mods
         out << "      \"author\": \"" << escapeJsonString(m.author) << "\",\n";
         out << "      \"game\": \"" << escapeJsonString(m.game) << "\",\n";
         out << "      \"installedAt\": \"" << escapeJsonString(m.installedAt) << "\",\n";
-        out << "      \"zipPath\": \"" << escapeJsonString(m.zipPath) << "\"\n";
-        out << "    }";
+        out << "      \"zipPath\": \"" << escapeJsonString(m.zipPath) << "\"";
+        if (!m.preimagePath.empty()) {
+            out << ",\n";
+            out << "      \"gameDir\": \"" << escapeJsonString(m.gameDir) << "\",\n";
+            out << "      \"preimagePath\": \"" << escapeJsonString(m.preimagePath) << "\"";
+        }
+        out << "\n    }";
         if (i + 1 < mods.size()) out << ",";
         out << "\n";
     }
@@ -248,4 +288,112 @@ std::string serializeInstalledModsJson(const std::vector<InstalledModInfo>& mods
     return out.str();
 }
 
+std::vector<ModIndexEntry> parseModIndexJson(const std::string& text) {
+    std::vector<ModIndexEntry> result;
+    size_t pos = 0;
+
+    skipWhitespace(text, pos);
+    if (pos >= text.size() || text[pos] != '{') return result;
+    ++pos;
+
+    while (pos < text.size() && text[pos] != '}') {
+        skipWhitespace(text, pos);
+        if (text[pos] != '"') { ++pos; continue; }
+
+        std::string key = readJsonString(text, pos);
+        skipWhitespace(text, pos);
+        if (pos >= text.size() || text[pos] != ':') return result;
+        ++pos;
+        skipWhitespace(text, pos);
+
+        if (key == "mods" && pos < text.size() && text[pos] == '[') {
+            ++pos; // skip '['
+            skipWhitespace(text, pos);
+
+            while (pos < text.size() && text[pos] != ']') {
+                if (text[pos] == '{') {
+                    ++pos;
+                    ModIndexEntry entry;
+                    bool hasMetadata = false;
+
+                    while (pos < text.size() && text[pos] != '}') {
+                        skipWhitespace(text, pos);
+                        if (text[pos] != '"') { ++pos; continue; }
+
+                        std::string k = readJsonString(text, pos);
+                        skipWhitespace(text, pos);
+                        if (pos >= text.size() || text[pos] != ':') break;
+                        ++pos;
+                        skipWhitespace(text, pos);
+
+                        if (k == "metadata" && pos < text.size() && text[pos] == '{') {
+                            if (auto meta = readModObject(text, pos)) {
+                                entry.mod.metadata = std::move(*meta);
+                                hasMetadata = true;
+                            }
+                        } else if (pos < text.size() && text[pos] == '"') {
+                            std::string v = readJsonString(text, pos);
+                            if (k == "zipPath") entry.mod.zipPath = v;
+                        } else if (k == "fileSize") {
+                            entry.mod.fileSize = static_cast<size_t>(readJsonInteger(text, pos));
+                        } else if (k == "modifiedTime") {
+                            entry.modifiedTime = readJsonInteger(text, pos);
+                        } else if (k == "invalid" && text.compare(pos, 4, "true") == 0) {
+                            entry.invalid = true;
+                            pos += 4;
+                        } else {
+                            while (pos < text.size() && text[pos] != ',' && text[pos] != '}') ++pos;
+                        }
+
+                        skipWhitespace(text, pos);
+                        if (pos < text.size() && text[pos] == ',') ++pos;
+                    }
+
+                    if (pos < text.size()) ++pos; // skip '}'
+                    if ((hasMetadata || entry.invalid) && !entry.mod.zipPath.empty()) {
+                        result.push_back(std::move(entry));
+                    }
+                } else {
+                    ++pos;
+                }
+                skipWhitespace(text, pos);
+                if (pos < text.size() && text[pos] == ',') ++pos;
+                skipWhitespace(text, pos);
+            }
+
+            if (pos < text.size()) ++pos; // skip ']'
+        } else {
+            while (pos < text.size() && text[pos] != ',' && text[pos] != '}') ++pos;
+        }
+
+        skipWhitespace(text, pos);
+        if (pos < text.size() && text[pos] == ',') ++pos;
+    }
+
+    return result;
+}
+
+std::string serializeModIndexJson(const std::vector<ModIndexEntry>& entries) {
+    std::ostringstream out;
+    out << "{\n  \"mods\": [\n";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto& e = entries[i];
+        out << "    {\n";
+        out << "      \"zipPath\": \"" << escapeJsonString(e.mod.zipPath) << "\",\n";
+        out << "      \"fileSize\": " << e.mod.fileSize << ",\n";
+        out << "      \"modifiedTime\": " << e.modifiedTime << ",\n";
+        if (e.invalid) {
+            out << "      \"invalid\": true";
+        } else {
+            out << "      \"metadata\": ";
+            writeModObject(out, e.mod.metadata, "      ");
+        }
+        out << "\n    }";
+        if (i + 1 < entries.size()) out << ",";
+        out << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
 } // namespace kuf
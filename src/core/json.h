@@ -9,6 +9,7 @@
 namespace kuf {
 
 struct InstalledModInfo;
+struct ModIndexEntry;
 
 std::optional<ModMetadata> parseModJson(const std::string& text);
 std::string serializeModJson(const ModMetadata& meta);
@@ -16,4 +17,7 @@ std::string serializeModJson(const ModMetadata& meta);
 std::vector<InstalledModInfo> parseInstalledModsJson(const std::string& text);
 std::string serializeInstalledModsJson(const std::vector<InstalledModInfo>& mods);
 
+std::vector<ModIndexEntry> parseModIndexJson(const std::string& text);
+std::string serializeModIndexJson(const std::vector<ModIndexEntry>& entries);
+
 } // namespace kuf
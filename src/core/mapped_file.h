@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace kuf {
+
+// Read-only memory mapping of a whole file. Pages are loaded on first touch, so
+// mapping a large asset costs address space rather than memory.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return opened_; }
+    size_t size() const { return size_; }
+    std::span<const std::byte> data() const { return {static_cast<const std::byte*>(data_), size_}; }
+
+private:
+    const void* data_ = nullptr;
+    size_t size_ = 0;
+    bool opened_ = false; // Empty files open successfully but have no mapping.
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#endif
+};
+
+} // namespace kuf
@@ -0,0 +1,319 @@
+#include "core/profiler.h"
+
+#if KUF_ENABLE_PROFILER
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace kuf::profiler {
+
+namespace {
+
+// Single-producer ring: the owning thread writes, endFrame reads. head and tail
+// only grow; slots are indexed modulo the capacity.
+struct ThreadRing {
+    static constexpr size_t kCapacity = 1u << 13;
+
+    std::array<ZoneEvent, kCapacity> events{};
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+    uint32_t index = 0;
+    std::string name;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+};
+
+// Never destroyed, so zones that close during static destruction still have
+// somewhere to go.
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+thread_local ThreadRing* tlsRing = nullptr;
+thread_local uint32_t tlsDepth = 0;
+
+ThreadRing& localRing() {
+    if (!tlsRing) {
+        auto& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        auto ring = std::make_unique<ThreadRing>();
+        ring->index = static_cast<uint32_t>(reg.rings.size());
+        ring->name = "thread " + std::to_string(ring->index);
+        tlsRing = ring.get();
+        reg.rings.push_back(std::move(ring));
+    }
+    return *tlsRing;
+}
+
+struct ZoneHistory {
+    std::string_view name;
+    std::array<uint64_t, kHistoryFrames> ns{};
+    std::array<uint32_t, kHistoryFrames> calls{};
+    uint64_t pendingNs = 0;
+    uint32_t pendingCalls = 0;
+};
+
+struct Collector {
+    std::mutex mutex;
+    // Keyed by contents: the same literal may have different addresses in
+    // different translation units.
+    std::unordered_map<std::string_view, size_t> zoneIndex;
+    std::vector<ZoneHistory> zones;
+    std::array<uint64_t, kHistoryFrames> frameNs{};
+    uint64_t frames = 0;
+    uint64_t frameStart = now();
+
+    bool capturing = false;
+    uint64_t captureStart = 0;
+    std::vector<ZoneEvent> capture;
+};
+
+Collector& collector() {
+    static Collector* instance = new Collector;
+    return *instance;
+}
+
+size_t windowSize(const Collector& c) {
+    return static_cast<size_t>(std::min<uint64_t>(c.frames, kHistoryFrames));
+}
+
+void appendEscaped(std::string& out, const char* text) {
+    for (const char* p = text; *p; ++p) {
+        unsigned char ch = static_cast<unsigned char>(*p);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += static_cast<char>(ch);
+        } else if (ch < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", ch);
+            out += buf;
+        } else {
+            out += static_cast<char>(ch);
+        }
+    }
+}
+
+} // namespace
+
+uint64_t now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void record(const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth) {
+    auto& ring = localRing();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= ThreadRing::kCapacity) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.events[head & (ThreadRing::kCapacity - 1)] = {name, startNs, endNs, ring.index, depth};
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+uint32_t enterZone() {
+    return tlsDepth++;
+}
+
+void leaveZone() {
+    --tlsDepth;
+}
+
+void setThreadName(const char* name) {
+    auto& ring = localRing();
+    std::lock_guard lock(registry().mutex);
+    ring.name = name;
+}
+
+void endFrame() {
+    auto& c = collector();
+    std::lock_guard lock(c.mutex);
+    uint64_t frameEnd = now();
+
+    std::vector<ThreadRing*> rings;
+    {
+        auto& reg = registry();
+        std::lock_guard regLock(reg.mutex);
+        for (auto& ring : reg.rings) rings.push_back(ring.get());
+    }
+
+    for (auto* ring : rings) {
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (uint64_t i = tail; i < head; ++i) {
+            const auto& event = ring->events[i & (ThreadRing::kCapacity - 1)];
+            std::string_view name(event.name);
+            auto [it, inserted] = c.zoneIndex.try_emplace(name, c.zones.size());
+            if (inserted) {
+                c.zones.emplace_back();
+                c.zones.back().name = name;
+            }
+            auto& zone = c.zones[it->second];
+            zone.pendingNs += event.endNs - event.startNs;
+            ++zone.pendingCalls;
+
+            if (c.capturing && event.startNs >= c.captureStart) {
+                c.capture.push_back(event);
+                if (c.capture.size() >= kMaxCaptureEvents) c.capturing = false;
+            }
+        }
+        ring->tail.store(head, std::memory_order_release);
+    }
+
+    size_t slot = static_cast<size_t>(c.frames % kHistoryFrames);
+    for (auto& zone : c.zones) {
+        zone.ns[slot] = zone.pendingNs;
+        zone.calls[slot] = zone.pendingCalls;
+        zone.pendingNs = 0;
+        zone.pendingCalls = 0;
+    }
+    c.frameNs[slot] = frameEnd - c.frameStart;
+    c.frameStart = frameEnd;
+    ++c.frames;
+}
+
+std::vector<ZoneSummary> summaries() {
+    auto& c = collector();
+    std::lock_guard lock(c.mutex);
+    size_t window = windowSize(c);
+    if (window == 0) return {};
+    size_t last = static_cast<size_t>((c.frames - 1) % kHistoryFrames);
+
+    std::vector<ZoneSummary> result;
+    for (const auto& zone : c.zones) {
+        uint64_t totalNs = 0, maxNs = 0, calls = 0;
+        for (size_t i = 0; i < window; ++i) {
+            totalNs += zone.ns[i];
+            maxNs = std::max(maxNs, zone.ns[i]);
+            calls += zone.calls[i];
+        }
+        if (calls == 0) continue;
+        ZoneSummary s;
+        s.name = zone.name;
+        s.callsPerFrame = static_cast<double>(calls) / static_cast<double>(window);
+        s.meanMs = static_cast<double>(totalNs) / static_cast<double>(window) * 1e-6;
+        s.maxMs = static_cast<double>(maxNs) * 1e-6;
+        s.lastMs = static_cast<double>(zone.ns[last]) * 1e-6;
+        result.push_back(s);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const ZoneSummary& a, const ZoneSummary& b) { return a.meanMs > b.meanMs; });
+    return result;
+}
+
+double meanFrameMs() {
+    auto& c = collector();
+    std::lock_guard lock(c.mutex);
+    size_t window = windowSize(c);
+    if (window == 0) return 0;
+    uint64_t total = 0;
+    for (size_t i = 0; i < window; ++i) total += c.frameNs[i];
+    return static_cast<double>(total) / static_cast<double>(window) * 1e-6;
+}
+
+double maxFrameMs() {
+    auto& c = collector();
+    std::lock_guard lock(c.mutex);
+    size_t window = windowSize(c);
+    uint64_t worst = 0;
+    for (size_t i = 0; i < window; ++i) worst = std::max(worst, c.frameNs[i]);
+    return static_cast<double>(worst) * 1e-6;
+}
+
+uint64_t droppedEvents() {
+    auto& reg = registry();
+    std::lock_guard lock(reg.mutex);
+    uint64_t total = 0;
+    for (const auto& ring : reg.rings) total += ring->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+void startCapture() {
+    auto& c = collector();
+    std::lock_guard lock(c.mutex);
+    c.capture.clear();
+    c.captureStart = now();
+    c.capturing = true;
+}
+
+void stopCapture() {
+    auto& c = collector();
+    std::lock_guard lock(c.mutex);
+    c.capturing = false;
+}
+
+bool capturing() {
+    auto& c = collector();
+    std::lock_guard lock(c.mutex);
+    return c.capturing;
+}
+
+size_t capturedEvents() {
+    auto& c = collector();
+    std::lock_guard lock(c.mutex);
+    return c.capture.size();
+}
+
+std::string chromeTraceJson() {
+    std::vector<std::pair<uint32_t, std::string>> threads;
+    {
+        auto& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        for (const auto& ring : reg.rings) threads.emplace_back(ring->index, ring->name);
+    }
+
+    auto& c = collector();
+    std::lock_guard lock(c.mutex);
+
+    std::string out;
+    out.reserve(64 + c.capture.size() * 96);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char buf[128];
+    for (const auto& [index, name] : threads) {
+        if (!first) out += ',';
+        first = false;
+        std::snprintf(buf, sizeof(buf), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                      index);
+        out += buf;
+        appendEscaped(out, name.c_str());
+        out += "\"}}";
+    }
+    for (const auto& event : c.capture) {
+        if (!first) out += ',';
+        first = false;
+        out += "{\"name\":\"";
+        appendEscaped(out, event.name);
+        // Timestamps are microseconds relative to the start of the capture.
+        std::snprintf(buf, sizeof(buf), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                      static_cast<double>(event.startNs - c.captureStart) * 1e-3,
+                      static_cast<double>(event.endNs - event.startNs) * 1e-3, event.thread);
+        out += buf;
+    }
+    out += "]}\n";
+    return out;
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::string json = chromeTraceJson();
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(json.data(), 1, json.size(), f) == json.size();
+    ok = std::fclose(f) == 0 && ok;
+    return ok;
+}
+
+} // namespace kuf::profiler
+
+#endif
@@ -0,0 +1,125 @@
+#pragma once
+
+// Frame profiler. Scopes marked with KUF_PROFILE_ZONE are timed into per-thread
+// ring buffers; the UI thread drains them once per frame into rolling per-zone
+// statistics and, while a capture is running, into a list of events that can
+// be written as a Chrome trace (chrome://tracing, Perfetto).
+//
+// Everything here compiles away unless KUF_ENABLE_PROFILER is set to 1 (the
+// CMake option of the same name), so zones can stay in hot code in release
+// builds.
+
+#ifndef KUF_ENABLE_PROFILER
+#define KUF_ENABLE_PROFILER 0
+#endif
+
+#if KUF_ENABLE_PROFILER
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kuf::profiler {
+
+// Nanoseconds on a steady clock.
+uint64_t now();
+
+// One timed scope. name must outlive the profiler; string literals and
+// __func__ do.
+struct ZoneEvent {
+    const char* name = nullptr;
+    uint64_t startNs = 0;
+    uint64_t endNs = 0;
+    uint32_t thread = 0;
+    uint32_t depth = 0;
+};
+
+// Appends a finished zone to the calling thread's ring. Wait-free; when the
+// ring is full the event is counted as dropped instead.
+void record(const char* name, uint64_t startNs, uint64_t endNs, uint32_t depth);
+
+// Nesting depth bookkeeping for the calling thread.
+uint32_t enterZone();
+void leaveZone();
+
+// Names the calling thread in trace output.
+void setThreadName(const char* name);
+
+// Rolling statistics for one zone over the last kHistoryFrames frames.
+// Times are inclusive of nested zones.
+struct ZoneSummary {
+    std::string_view name;
+    double callsPerFrame = 0;
+    double meanMs = 0; // Per frame.
+    double maxMs = 0;  // Worst single frame.
+    double lastMs = 0; // Most recent frame.
+};
+
+constexpr size_t kHistoryFrames = 120;
+
+// Drains every thread's ring and closes the current frame. Call once per frame
+// from the UI thread.
+void endFrame();
+
+// Per-zone statistics, slowest mean first.
+std::vector<ZoneSummary> summaries();
+
+// Mean and worst frame time over the same window.
+double meanFrameMs();
+double maxFrameMs();
+
+// Events lost to full rings since startup.
+uint64_t droppedEvents();
+
+// Capture of raw events for trace export. Capturing stops on its own once
+// kMaxCaptureEvents have been collected.
+constexpr size_t kMaxCaptureEvents = 1u << 20;
+
+void startCapture();
+void stopCapture();
+bool capturing();
+size_t capturedEvents();
+
+// Writes the last capture as Chrome trace JSON. Returns false if the file
+// cannot be written.
+bool writeChromeTrace(const std::string& path);
+
+// The same document as a string, mainly for tests.
+std::string chromeTraceJson();
+
+class Zone {
+public:
+    explicit Zone(const char* name) : name_(name), depth_(enterZone()), start_(now()) {}
+    ~Zone() {
+        record(name_, start_, now(), depth_);
+        leaveZone();
+    }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+private:
+    const char* name_;
+    uint32_t depth_;
+    uint64_t start_;
+};
+
+} // namespace kuf::profiler
+
+#define KUF_PROFILE_CONCAT_INNER(a, b) a##b
+#define KUF_PROFILE_CONCAT(a, b) KUF_PROFILE_CONCAT_INNER(a, b)
+#define KUF_PROFILE_ZONE(name) ::kuf::profiler::Zone KUF_PROFILE_CONCAT(kufProfileZone_, __LINE__)(name)
+#define KUF_PROFILE_FUNCTION() KUF_PROFILE_ZONE(__func__)
+#define KUF_PROFILE_FRAME() ::kuf::profiler::endFrame()
+#define KUF_PROFILE_THREAD(name) ::kuf::profiler::setThreadName(name)
+
+#else
+
+#define KUF_PROFILE_ZONE(name) ((void)0)
+#define KUF_PROFILE_FUNCTION() ((void)0)
+#define KUF_PROFILE_FRAME() ((void)0)
+#define KUF_PROFILE_THREAD(name) ((void)0)
+
+#endif
@@ -1,4 +1,6 @@
 #include "core/tab_manager.h"
+#include "core/file_io.h"
+#include "core/profiler.h"
 #include "ui/tabs/skill_editor_tab.h"
 #include "ui/tabs/troop_editor_tab.h"
 #include "ui/tabs/text_editor_tab.h"
@@ -8,7 +10,9 @@
 #include "formats/sox_text.h"
 #include "formats/sox_encoding.h"
 #include "formats/stg_format.h"
+#include "undo/set_text_command.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 
@@ -24,19 +28,10 @@ std::string getFileName(const std::string& path) {
     return path;
 }
 
-std::string getFileExtension(const std::string& path) {
-    auto pos = path.find_last_of('.');
-    if (pos != std::string::npos) {
-        std::string ext = path.substr(pos);
-        for (auto& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-        return ext;
-    }
-    return "";
-}
-
 } // namespace
 
 OpenFileResult TabManager::openFile(const std::string& path) {
+    KUF_PROFILE_ZONE("TabManager::openFile");
     // Check if file is already open.
     if (auto* existing = findTabByPath(path)) {
         activeTab_ = existing;
@@ -47,6 +42,12 @@ OpenFileResult TabManager::openFile(const std::string& path) {
     if (!doc) {
         return {nullptr, OpenResult::FileNotFound};
     }
+    if (onDocumentLoaded_) {
+        onDocumentLoaded_(doc.get());
+    }
+    if (onDocumentOpened_) {
+        onDocumentOpened_(doc.get());
+    }
 
     auto* tab = createTabForDocument(std::move(doc));
     if (tab) {
@@ -101,6 +102,9 @@ void TabManager::saveDocument(OpenDocument* doc) {
         file.write(reinterpret_cast<const char*>(data.data()),
                    static_cast<std::streamsize>(data.size()));
         doc->dirty = false;
+        // The saved bytes are the base for merging later changes made on
+        // disk, and let the file watcher recognize this save as our own.
+        doc->rawData = std::move(data);
     }
 }
 
@@ -112,6 +116,52 @@ void TabManager::saveAll() {
     }
 }
 
+std::optional<TextReplaceResult> TabManager::replaceText(const std::string& path, const TextQuery& query,
+                                                         std::string_view replacement,
+                                                         const std::string& description) {
+    KUF_PROFILE_ZONE("TabManager::replaceText");
+    // Matches are found in the open document when there is one, so unsaved
+    // edits in its tab are replaced too.
+    EditorTab* tab = findTabByPath(path);
+    auto doc = tab ? tab->document() : loadDocument(path);
+    if (!doc || !doc->textData) return std::nullopt;
+
+    SoxText& text = *doc->textData;
+    TextReplaceResult result;
+    auto command = std::make_unique<SetTextCommand>(&text, description);
+    for (size_t i = 0; i < text.entryCount(); ++i) {
+        auto replaced = query.replace(text.text(i), replacement);
+        if (!replaced || *replaced == text.text(i)) continue;
+        // The game rejects empty texts and has no room past an entry's length.
+        if (replaced->empty() || replaced->size() > text.maxLength(i)) {
+            ++result.skipped;
+            continue;
+        }
+        command->add(i, std::move(*replaced));
+    }
+
+    result.changed = command->size();
+    if (result.changed == 0) return result;
+
+    // A background tab keeps the undo step reachable after the replace.
+    if (!tab) {
+        if (onDocumentLoaded_) {
+            onDocumentLoaded_(doc.get());
+        }
+        createTabForDocument(doc);
+    }
+
+    // Saving would also write the user's unrelated unsaved edits.
+    result.unsaved = doc->dirty;
+    doc->undoStack->execute(std::move(command));
+
+    auto issues = text.validate();
+    result.blocked = std::any_of(issues.begin(), issues.end(),
+                                 [](const ValidationIssue& issue) { return issue.severity == Severity::Error; });
+    if (!result.blocked && !result.unsaved) saveDocument(doc.get());
+    return result;
+}
+
 std::shared_ptr<OpenDocument> TabManager::loadDocument(const std::string& path) {
     std::ifstream file(path, std::ios::binary | std::ios::ate);
     if (!file) return nullptr;
@@ -125,7 +175,7 @@ std::shared_ptr<OpenDocument> TabManager::loadDocument(const std::string& path)
     doc->rawData.resize(size);
     file.read(reinterpret_cast<char*>(doc->rawData.data()), size);
 
-    std::string ext = getFileExtension(path);
+    std::string ext = lowerExtension(path);
 
     // Try STG format first if extension matches.
     if (ext == ".stg") {
@@ -135,10 +185,6 @@ std::shared_ptr<OpenDocument> TabManager::loadDocument(const std::string& path)
             doc->undoStack->setOnChange([doc = doc.get()]() {
                 doc->dirty = true;
             });
-
-            if (onDocumentOpened_) {
-                onDocumentOpened_(doc.get());
-            }
             return doc;
         }
     }
@@ -163,10 +209,6 @@ std::shared_ptr<OpenDocument> TabManager::loadDocument(const std::string& path)
         doc->undoStack->setOnChange([doc = doc.get()]() {
             doc->dirty = true;
         });
-
-        if (onDocumentOpened_) {
-            onDocumentOpened_(doc.get());
-        }
         return doc;
     }
 
@@ -177,10 +219,6 @@ std::shared_ptr<OpenDocument> TabManager::loadDocument(const std::string& path)
         doc->undoStack->setOnChange([doc = doc.get()]() {
             doc->dirty = true;
         });
-
-        if (onDocumentOpened_) {
-            onDocumentOpened_(doc.get());
-        }
         return doc;
     }
 
@@ -191,17 +229,10 @@ std::shared_ptr<OpenDocument> TabManager::loadDocument(const std::string& path)
         doc->undoStack->setOnChange([doc = doc.get()]() {
             doc->dirty = true;
         });
-
-        if (onDocumentOpened_) {
-            onDocumentOpened_(doc.get());
-        }
         return doc;
     }
 
     // Unknown format - still return doc so we know the file exists.
-    if (onDocumentOpened_) {
-        onDocumentOpened_(doc.get());
-    }
     return doc;
 }
 
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "core/document.h"
+#include "formats/text_search_index.h"
 #include "ui/tabs/editor_tab.h"
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace kuf {
@@ -33,6 +36,15 @@ public:
     void saveDocument(OpenDocument* doc);
     void saveAll();
 
+    // Replaces every match of query in the text SOX at path as one undo step
+    // in its tab. A changed file without a tab gets one in the background,
+    // which is not made active or reported as opened. Replacements that are
+    // empty or longer than the entry allows are skipped. The file is saved
+    // only when it had no unsaved edits and has no validation errors;
+    // otherwise the tab stays dirty. nullopt when path is not a text SOX.
+    std::optional<TextReplaceResult> replaceText(const std::string& path, const TextQuery& query,
+                                                 std::string_view replacement, const std::string& description);
+
     EditorTab* activeTab() const { return activeTab_; }
     void setActiveTab(EditorTab* tab) { activeTab_ = tab; }
 
@@ -41,6 +53,11 @@ public:
     void setOnDocumentOpened(OnDocumentOpenedCallback cb) {
         onDocumentOpened_ = std::move(cb);
     }
+    // Called for every document that gets a tab, including background tabs
+    // that are not reported through setOnDocumentOpened.
+    void setOnDocumentLoaded(OnDocumentOpenedCallback cb) {
+        onDocumentLoaded_ = std::move(cb);
+    }
 
 private:
     std::shared_ptr<OpenDocument> loadDocument(const std::string& path);
@@ -50,6 +67,7 @@ private:
     std::vector<std::unique_ptr<EditorTab>> tabs_;
     EditorTab* activeTab_ = nullptr;
     OnDocumentOpenedCallback onDocumentOpened_;
+    OnDocumentOpenedCallback onDocumentLoaded_;
 };
 
 } // namespace kuf
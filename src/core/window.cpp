@@ -5,6 +5,16 @@
 
 namespace kuf {
 
+namespace {
+
+void countEvent(GLFWwindow* handle) {
+    if (auto* self = static_cast<uint64_t*>(glfwGetWindowUserPointer(handle))) {
+        ++*self;
+    }
+}
+
+} // namespace
+
 Window::Window(std::string_view title, int width, int height)
     : width_(width), height_(height) {
     if (!glfwInit()) {
@@ -30,6 +40,7 @@ Window::Window(std::string_view title, int width, int height)
 
     glfwMakeContextCurrent(window_);
     glfwSwapInterval(1);
+    installEventCounters();
 }
 
 Window::~Window() {
@@ -47,6 +58,45 @@ void Window::pollEvents() {
     glfwPollEvents();
 }
 
+void Window::waitEvents(double timeoutSeconds) {
+    if (timeoutSeconds > 0.0) {
+        glfwWaitEventsTimeout(timeoutSeconds);
+    } else {
+        glfwPollEvents();
+    }
+}
+
+void Window::wake() {
+    glfwPostEmptyEvent();
+}
+
+double Window::refreshRate() const {
+    if (GLFWmonitor* monitor = glfwGetPrimaryMonitor()) {
+        if (const GLFWvidmode* mode = glfwGetVideoMode(monitor); mode && mode->refreshRate > 0) {
+            return mode->refreshRate;
+        }
+    }
+    return 60.0;
+}
+
+// Installed before ImGui's GLFW backend, which chains to callbacks that are
+// already set, so both see every event.
+void Window::installEventCounters() {
+    glfwSetWindowUserPointer(window_, &eventCount_);
+    glfwSetKeyCallback(window_, [](GLFWwindow* w, int, int, int, int) { countEvent(w); });
+    glfwSetCharCallback(window_, [](GLFWwindow* w, unsigned int) { countEvent(w); });
+    glfwSetMouseButtonCallback(window_, [](GLFWwindow* w, int, int, int) { countEvent(w); });
+    glfwSetCursorPosCallback(window_, [](GLFWwindow* w, double, double) { countEvent(w); });
+    glfwSetCursorEnterCallback(window_, [](GLFWwindow* w, int) { countEvent(w); });
+    glfwSetScrollCallback(window_, [](GLFWwindow* w, double, double) { countEvent(w); });
+    glfwSetWindowFocusCallback(window_, [](GLFWwindow* w, int) { countEvent(w); });
+    glfwSetWindowSizeCallback(window_, [](GLFWwindow* w, int, int) { countEvent(w); });
+    glfwSetFramebufferSizeCallback(window_, [](GLFWwindow* w, int, int) { countEvent(w); });
+    glfwSetWindowRefreshCallback(window_, [](GLFWwindow* w) { countEvent(w); });
+    glfwSetWindowIconifyCallback(window_, [](GLFWwindow* w, int) { countEvent(w); });
+    glfwSetDropCallback(window_, [](GLFWwindow* w, int, const char**) { countEvent(w); });
+}
+
 void Window::swapBuffers() {
     glfwSwapBuffers(window_);
 }
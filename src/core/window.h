@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -17,16 +18,31 @@ public:
 
     bool shouldClose() const;
     void pollEvents();
+    // Blocks until an event arrives or timeoutSeconds pass; polls when the
+    // timeout is not positive.
+    void waitEvents(double timeoutSeconds);
+    // Wakes a waitEvents call from any thread.
+    static void wake();
     void swapBuffers();
 
+    // Input and window events received so far. Compare two readings to tell
+    // whether anything happened in between.
+    uint64_t eventCount() const { return eventCount_; }
+
+    // Refresh rate of the primary monitor, 60 if unknown.
+    double refreshRate() const;
+
     GLFWwindow* handle() const { return window_; }
     int width() const { return width_; }
     int height() const { return height_; }
 
 private:
+    void installEventCounters();
+
     GLFWwindow* window_ = nullptr;
     int width_;
     int height_;
+    uint64_t eventCount_ = 0;
 };
 
 } // namespace kuf
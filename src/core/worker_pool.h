@@ -0,0 +1,154 @@
+#pragma once
+
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kuf {
+
+// Fixed set of worker threads for data-parallel loops over files and records.
+// The calling thread always takes part in parallelFor, so a loop started from
+// inside another loop's body still makes progress when every worker is busy.
+class WorkerPool {
+public:
+    using IndexFn = std::function<void(size_t index)>;
+
+    explicit WorkerPool(size_t threadCount = defaultThreadCount()) {
+        threads_.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            threads_.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Process-wide pool shared by the mod, backup and format code.
+    static WorkerPool& shared() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    // One worker per hardware thread, minus the caller that joins each loop.
+    static size_t defaultThreadCount() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n > 1 ? n - 1 : 1;
+    }
+
+    size_t threadCount() const { return threads_.size(); }
+
+    // Calls fn(i) for every i in [0, count) and blocks until all calls return.
+    // Indices are claimed dynamically, so uneven work items balance themselves.
+    // The first exception thrown by fn is rethrown here after the loop drains.
+    void parallelFor(size_t count, const IndexFn& fn) {
+        if (count == 0) return;
+        if (count == 1 || threads_.empty()) {
+            for (size_t i = 0; i < count; ++i) fn(i);
+            return;
+        }
+
+        auto job = std::make_shared<Job>();
+        job->fn = &fn;
+        job->count = count;
+
+        size_t helpers = std::min(threads_.size(), count - 1);
+        {
+            std::lock_guard lock(mutex_);
+            for (size_t i = 0; i < helpers; ++i) {
+                queue_.emplace_back([job]() { runJob(*job); });
+            }
+        }
+        if (helpers == 1) {
+            wake_.notify_one();
+        } else {
+            wake_.notify_all();
+        }
+
+        runJob(*job);
+
+        std::unique_lock lock(job->mutex);
+        job->finished.wait(lock, [&]() { return job->completed == job->count; });
+        if (job->error) {
+            std::rethrow_exception(job->error);
+        }
+    }
+
+private:
+    struct Job {
+        const IndexFn* fn = nullptr;
+        size_t count = 0;
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t completed = 0;
+        std::exception_ptr error;
+    };
+
+    // Helpers that start after every index has been claimed return without
+    // touching fn, which may already be out of scope by then.
+    static void runJob(Job& job) {
+        for (;;) {
+            size_t i = job.next.fetch_add(1);
+            if (i >= job.count) return;
+
+            std::exception_ptr error;
+            try {
+                (*job.fn)(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard lock(job.mutex);
+            if (error && !job.error) {
+                job.error = error;
+            }
+            if (++job.completed == job.count) {
+                job.finished.notify_all();
+            }
+        }
+    }
+
+    void workerLoop() {
+        KUF_PROFILE_THREAD("worker");
+        for (;;) {
+            std::function<void()> work;
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                if (stopping_ && queue_.empty()) return;
+                work = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            work();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+} // namespace kuf
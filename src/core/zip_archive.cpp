@@ -1,17 +1,110 @@
 #include "core/zip_archive.h"
+#include "core/worker_pool.h"
 
 #include <miniz.h>
 
+#include <algorithm>
+#include <chrono>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace kuf {
 
+namespace {
+
+// Reserves disk space for a file about to be written. Creates or truncates the file.
+void preallocateFile(const std::string& path, uint64_t size) {
+#if defined(__linux__)
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return;
+    if (size > 0) {
+        posix_fallocate(fd, 0, static_cast<off_t>(size));
+    }
+    ::close(fd);
+#else
+    { std::ofstream create(std::filesystem::path(path), std::ios::binary | std::ios::trunc); }
+    std::error_code ec;
+    std::filesystem::resize_file(path, size, ec);
+#endif
+}
+
+size_t readFromStream(void* opaque, mz_uint64 fileOffset, void* buf, size_t n) {
+    auto* in = static_cast<std::ifstream*>(opaque);
+    if (static_cast<mz_uint64>(in->tellg()) != fileOffset) {
+        in->seekg(static_cast<std::streamoff>(fileOffset));
+    }
+    in->read(static_cast<char*>(buf), static_cast<std::streamsize>(n));
+    return static_cast<size_t>(in->gcount());
+}
+
+MZ_TIME_T fileTime(const std::string& path) {
+    std::error_code ec;
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec) return std::time(nullptr);
+    auto sys = std::chrono::file_clock::to_sys(time);
+    return static_cast<MZ_TIME_T>(std::chrono::system_clock::to_time_t(
+        std::chrono::time_point_cast<std::chrono::system_clock::duration>(sys)));
+}
+
+// Deflates a few slices of a file at the fastest level. If even those barely
+// shrink, the file is already compressed and deflating all of it would only
+// burn time. Smaller files are cheap enough to deflate outright.
+bool looksIncompressible(std::span<const std::byte> data) {
+    constexpr size_t kSampleSize = 16 * 1024;
+    constexpr size_t kSampleCount = 4;
+    if (data.size() < kSampleSize * kSampleCount) return false;
+
+    static const int kFlags = static_cast<int>(
+        tdefl_create_comp_flags_from_zip_params(MZ_BEST_SPEED, -MZ_DEFAULT_WINDOW_BITS,
+                                                MZ_DEFAULT_STRATEGY));
+    std::vector<std::byte> out(kSampleSize);
+    size_t compressed = 0;
+    for (size_t i = 0; i < kSampleCount; ++i) {
+        size_t offset = (data.size() - kSampleSize) / (kSampleCount - 1) * i;
+        size_t n = tdefl_compress_mem_to_mem(out.data(), out.size(), data.data() + offset,
+                                             kSampleSize, kFlags);
+        compressed += n == 0 ? kSampleSize : n; // 0 means it did not fit.
+    }
+    return compressed * 100 > kSampleSize * kSampleCount * 97;
+}
+
+struct HeapFree {
+    void operator()(void* p) const { mz_free(p); }
+};
+
+// One file made ready for appending: either its raw deflate stream or, when
+// storing, the mapping it is copied from.
+struct PreparedEntry {
+    MappedFile source;
+    std::unique_ptr<void, HeapFree> deflated;
+    size_t deflatedSize = 0;
+    mz_uint32 crc = 0;
+    MZ_TIME_T modified = 0;
+    bool stream = false; // Too large to hold compressed in memory; use addFile.
+    bool ok = false;
+};
+
+size_t writeToStream(void* opaque, mz_uint64 /*fileOffset*/, const void* buf, size_t n) {
+    auto* out = static_cast<std::ofstream*>(opaque);
+    out->write(static_cast<const char*>(buf), static_cast<std::streamsize>(n));
+    return out->good() ? n : 0;
+}
+
+} // namespace
+
 // --- ZipReader ---
 
 ZipReader::~ZipReader() { close(); }
 
-ZipReader::ZipReader(ZipReader&& other) noexcept : archive_(other.archive_) {
+ZipReader::ZipReader(ZipReader&& other) noexcept
+    : archive_(other.archive_), mapping_(std::move(other.mapping_)) {
     other.archive_ = nullptr;
 }
 
@@ -19,6 +112,7 @@ ZipReader& ZipReader::operator=(ZipReader&& other) noexcept {
     if (this != &other) {
         close();
         archive_ = other.archive_;
+        mapping_ = std::move(other.mapping_);
         other.archive_ = nullptr;
     }
     return *this;
@@ -27,6 +121,16 @@ ZipReader& ZipReader::operator=(ZipReader&& other) noexcept {
 bool ZipReader::open(const std::string& path) {
     close();
     auto* zip = new mz_zip_archive{};
+
+    if (mapping_.open(path) && mapping_.size() > 0) {
+        auto data = mapping_.data();
+        if (mz_zip_reader_init_mem(zip, data.data(), data.size(), 0)) {
+            archive_ = zip;
+            return true;
+        }
+    }
+    mapping_.close();
+
     if (!mz_zip_reader_init_file(zip, path.c_str(), 0)) {
         delete zip;
         return false;
@@ -42,6 +146,7 @@ void ZipReader::close() {
         delete zip;
         archive_ = nullptr;
     }
+    mapping_.close();
 }
 
 std::vector<std::string> ZipReader::entries() const {
@@ -59,6 +164,27 @@ std::vector<std::string> ZipReader::entries() const {
     return result;
 }
 
+std::vector<ZipEntryInfo> ZipReader::entryInfos() const {
+    std::vector<ZipEntryInfo> result;
+    if (!archive_) return result;
+    auto* zip = static_cast<mz_zip_archive*>(archive_);
+    mz_uint count = mz_zip_reader_get_num_files(zip);
+    result.reserve(count);
+    for (mz_uint i = 0; i < count; ++i) {
+        mz_zip_archive_file_stat stat;
+        if (!mz_zip_reader_file_stat(zip, i, &stat) || stat.m_is_directory) continue;
+
+        ZipEntryInfo info;
+        info.index = i;
+        info.name = stat.m_filename;
+        info.compressedSize = stat.m_comp_size;
+        info.uncompressedSize = stat.m_uncomp_size;
+        info.stored = stat.m_method == 0;
+        result.push_back(std::move(info));
+    }
+    return result;
+}
+
 std::optional<std::vector<std::byte>> ZipReader::readEntry(const std::string& name) const {
     if (!archive_) return std::nullopt;
     auto* zip = static_cast<mz_zip_archive*>(archive_);
@@ -68,6 +194,10 @@ std::optional<std::vector<std::byte>> ZipReader::readEntry(const std::string& na
     mz_zip_archive_file_stat stat;
     if (!mz_zip_reader_file_stat(zip, static_cast<mz_uint>(index), &stat)) return std::nullopt;
 
+    if (auto view = viewAt(static_cast<mz_uint>(index))) {
+        return std::vector<std::byte>(view->begin(), view->end());
+    }
+
     std::vector<std::byte> data(stat.m_uncomp_size);
     if (!mz_zip_reader_extract_to_mem(zip, static_cast<mz_uint>(index), data.data(), data.size(), 0)) {
         return std::nullopt;
@@ -75,6 +205,90 @@ std::optional<std::vector<std::byte>> ZipReader::readEntry(const std::string& na
     return data;
 }
 
+std::optional<size_t> ZipReader::readEntryInto(const std::string& name,
+                                               std::span<std::byte> out) const {
+    if (!archive_) return std::nullopt;
+    auto* zip = static_cast<mz_zip_archive*>(archive_);
+    int index = mz_zip_reader_locate_file(zip, name.c_str(), nullptr, 0);
+    if (index < 0) return std::nullopt;
+
+    mz_zip_archive_file_stat stat;
+    if (!mz_zip_reader_file_stat(zip, static_cast<mz_uint>(index), &stat)) return std::nullopt;
+    if (stat.m_uncomp_size > out.size()) return std::nullopt;
+
+    if (!mz_zip_reader_extract_to_mem_no_alloc(zip, static_cast<mz_uint>(index), out.data(),
+                                               out.size(), 0, nullptr, 0)) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(stat.m_uncomp_size);
+}
+
+std::optional<std::span<const std::byte>> ZipReader::entryView(const std::string& name) const {
+    if (!archive_ || !mapping_.isOpen()) return std::nullopt;
+    auto* zip = static_cast<mz_zip_archive*>(archive_);
+    int index = mz_zip_reader_locate_file(zip, name.c_str(), nullptr, 0);
+    if (index < 0) return std::nullopt;
+    return viewAt(static_cast<mz_uint>(index));
+}
+
+std::optional<std::span<const std::byte>> ZipReader::entryBytes(
+    const std::string& name, std::vector<std::byte>& scratch) const {
+    if (!archive_) return std::nullopt;
+    auto* zip = static_cast<mz_zip_archive*>(archive_);
+    int index = mz_zip_reader_locate_file(zip, name.c_str(), nullptr, 0);
+    if (index < 0) return std::nullopt;
+
+    if (auto view = viewAt(static_cast<mz_uint>(index))) {
+        return view;
+    }
+
+    mz_zip_archive_file_stat stat;
+    if (!mz_zip_reader_file_stat(zip, static_cast<mz_uint>(index), &stat)) return std::nullopt;
+    scratch.resize(stat.m_uncomp_size);
+    if (!mz_zip_reader_extract_to_mem_no_alloc(zip, static_cast<mz_uint>(index), scratch.data(),
+                                               scratch.size(), 0, nullptr, 0)) {
+        return std::nullopt;
+    }
+    return std::span<const std::byte>(scratch);
+}
+
+std::optional<std::span<const std::byte>> ZipReader::viewAt(unsigned index) const {
+    if (!mapping_.isOpen()) return std::nullopt;
+    auto* zip = static_cast<mz_zip_archive*>(archive_);
+
+    mz_zip_archive_file_stat stat;
+    if (!mz_zip_reader_file_stat(zip, index, &stat)) return std::nullopt;
+    // Method 0 and no encryption bit: the entry's bytes are the file's bytes.
+    if (stat.m_method != 0 || (stat.m_bit_flag & 1) || stat.m_comp_size != stat.m_uncomp_size) {
+        return std::nullopt;
+    }
+
+    // The local header repeats the name and may carry a different extra field,
+    // so its own lengths decide where the data starts.
+    auto archive = mapping_.data();
+    constexpr size_t kLocalHeaderSize = 30;
+    constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+    uint64_t headerOffset = stat.m_local_header_ofs;
+    if (headerOffset + kLocalHeaderSize > archive.size()) return std::nullopt;
+
+    const auto* header = reinterpret_cast<const unsigned char*>(archive.data() + headerOffset);
+    uint32_t signature = header[0] | (header[1] << 8) | (header[2] << 16) |
+                         (static_cast<uint32_t>(header[3]) << 24);
+    if (signature != kLocalHeaderSignature) return std::nullopt;
+    uint16_t nameLength = static_cast<uint16_t>(header[26] | (header[27] << 8));
+    uint16_t extraLength = static_cast<uint16_t>(header[28] | (header[29] << 8));
+
+    uint64_t dataOffset = headerOffset + kLocalHeaderSize + nameLength + extraLength;
+    if (dataOffset + stat.m_uncomp_size > archive.size()) return std::nullopt;
+
+    auto view = archive.subspan(static_cast<size_t>(dataOffset), static_cast<size_t>(stat.m_uncomp_size));
+    if (mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(view.data()), view.size()) !=
+        stat.m_crc32) {
+        return std::nullopt;
+    }
+    return view;
+}
+
 bool ZipReader::extractEntry(const std::string& name, const std::string& destPath) const {
     if (!archive_) return false;
     auto* zip = static_cast<mz_zip_archive*>(archive_);
@@ -85,6 +299,29 @@ bool ZipReader::extractEntry(const std::string& name, const std::string& destPat
     return mz_zip_reader_extract_to_file(zip, static_cast<mz_uint>(index), destPath.c_str(), 0);
 }
 
+bool ZipReader::extractEntryAt(unsigned index, const std::string& destPath, uint64_t sizeHint) const {
+    if (!archive_) return false;
+    auto* zip = static_cast<mz_zip_archive*>(archive_);
+
+    preallocateFile(destPath, sizeHint);
+
+    // Open without truncating so the preallocated extent is kept.
+    std::ofstream out(std::filesystem::path(destPath), std::ios::binary | std::ios::in | std::ios::out);
+    if (!out) return false;
+    if (!mz_zip_reader_extract_to_callback(zip, index, writeToStream, &out, 0)) return false;
+
+    auto written = static_cast<uint64_t>(out.tellp());
+    out.close();
+    if (!out) return false;
+
+    // Trim if the central directory size was wrong and fewer bytes arrived.
+    if (written != sizeHint) {
+        std::error_code ec;
+        std::filesystem::resize_file(destPath, written, ec);
+    }
+    return true;
+}
+
 bool ZipReader::extractAll(const std::string& destDir) const {
     if (!archive_) return false;
     for (const auto& entry : entries()) {
@@ -145,16 +382,35 @@ bool ZipWriter::addFile(const std::string& diskPath, const std::string& archiveN
     if (!archive_ || finalized_) return false;
     auto* zip = static_cast<mz_zip_archive*>(archive_);
 
-    std::ifstream file(diskPath, std::ios::binary | std::ios::ate);
+    std::ifstream file(std::filesystem::path(diskPath), std::ios::binary);
     if (!file) return false;
-    auto size = file.tellg();
-    file.seekg(0);
 
-    std::vector<char> data(static_cast<size_t>(size));
-    file.read(data.data(), size);
+    std::error_code ec;
+    auto size = std::filesystem::file_size(diskPath, ec);
+    if (ec) return false;
+    MZ_TIME_T modified = fileTime(diskPath);
+
+    // miniz pulls the file through its own fixed-size I/O buffer, so memory use
+    // does not grow with the file.
+    return mz_zip_writer_add_read_buf_callback(zip, archiveName.c_str(), readFromStream, &file,
+                                               size, &modified, nullptr, 0,
+                                               MZ_DEFAULT_COMPRESSION, nullptr, 0, nullptr, 0);
+}
+
+bool ZipWriter::addFileStored(const std::string& diskPath, const std::string& archiveName) {
+    if (!archive_ || finalized_) return false;
+    auto* zip = static_cast<mz_zip_archive*>(archive_);
 
-    return mz_zip_writer_add_mem(zip, archiveName.c_str(), data.data(),
-                                  data.size(), MZ_DEFAULT_COMPRESSION);
+    MappedFile mapped;
+    if (!mapped.open(diskPath)) return false;
+    MZ_TIME_T modified = fileTime(diskPath);
+
+    // Stored entries are written straight from the mapping: one CRC pass and
+    // one write, with no staging copy.
+    auto data = mapped.data();
+    return mz_zip_writer_add_mem_ex_v2(zip, archiveName.c_str(), data.data(), data.size(),
+                                       nullptr, 0, MZ_NO_COMPRESSION, 0, 0, &modified,
+                                       nullptr, 0, nullptr, 0);
 }
 
 bool ZipWriter::addMemory(const std::string& archiveName, const void* data, size_t size) {
@@ -163,6 +419,111 @@ bool ZipWriter::addMemory(const std::string& archiveName, const void* data, size
     return mz_zip_writer_add_mem(zip, archiveName.c_str(), data, size, MZ_DEFAULT_COMPRESSION);
 }
 
+bool ZipWriter::addFiles(const std::vector<ZipFileSource>& files, const ProgressFn& onProgress,
+                         size_t* failedIndex) {
+    if (!archive_ || finalized_) return false;
+    auto* zip = static_cast<mz_zip_archive*>(archive_);
+
+    // Entries larger than this are deflated by the streaming path instead.
+    constexpr size_t kMaxInMemorySize = 256ull * 1024 * 1024;
+    // Deflated output held at once across a window; a window is closed before
+    // its files' combined size passes this, so memory does not grow with the
+    // worker count.
+    constexpr uint64_t kMaxBufferedBytes = 256ull * 1024 * 1024;
+
+    static const int kDeflateFlags = static_cast<int>(
+        tdefl_create_comp_flags_from_zip_params(MZ_DEFAULT_LEVEL, -MZ_DEFAULT_WINDOW_BITS,
+                                                MZ_DEFAULT_STRATEGY));
+
+    auto prepare = [&](const ZipFileSource& file, PreparedEntry& entry) {
+        if (!entry.source.open(file.diskPath)) return;
+        entry.modified = fileTime(file.diskPath);
+        auto data = entry.source.data();
+
+        bool store = file.compression == ZipCompression::Store ||
+                     (file.compression == ZipCompression::Auto && looksIncompressible(data));
+        if (!store && data.size() > kMaxInMemorySize) {
+            entry.source.close();
+            entry.stream = true;
+            entry.ok = true;
+            return;
+        }
+
+        entry.crc = static_cast<mz_uint32>(
+            mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(data.data()), data.size()));
+        if (!store && !data.empty()) {
+            size_t outSize = 0;
+            entry.deflated.reset(
+                tdefl_compress_mem_to_heap(data.data(), data.size(), &outSize, kDeflateFlags));
+            if (!entry.deflated) return;
+            entry.deflatedSize = outSize;
+
+            // Auto never lets an entry grow; it is stored instead.
+            if (file.compression == ZipCompression::Auto && outSize >= data.size()) {
+                entry.deflated.reset();
+                entry.deflatedSize = 0;
+            }
+        }
+        entry.ok = true;
+    };
+
+    auto append = [&](const ZipFileSource& file, PreparedEntry& entry) -> bool {
+        if (!entry.ok) return false;
+        if (entry.stream) return addFile(file.diskPath, file.archiveName);
+
+        auto data = entry.source.data();
+        if (entry.deflated) {
+            return mz_zip_writer_add_mem_ex_v2(
+                zip, file.archiveName.c_str(), entry.deflated.get(), entry.deflatedSize, nullptr, 0,
+                MZ_DEFAULT_LEVEL | MZ_ZIP_FLAG_COMPRESSED_DATA, data.size(), entry.crc,
+                &entry.modified, nullptr, 0, nullptr, 0);
+        }
+        return mz_zip_writer_add_mem_ex_v2(zip, file.archiveName.c_str(), data.data(), data.size(),
+                                           nullptr, 0, MZ_NO_COMPRESSION, 0, 0, &entry.modified,
+                                           nullptr, 0, nullptr, 0);
+    };
+
+    // Bytes a file will hold in memory while its window is open. Streamed and
+    // stored files hold none beyond their mapping.
+    auto bufferedBytes = [&](const ZipFileSource& file) -> uint64_t {
+        if (file.compression == ZipCompression::Store) return 0;
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(file.diskPath, ec);
+        return ec || size > kMaxInMemorySize ? 0 : size;
+    };
+
+    // Windows also stop at a fixed number of files, which bounds open mappings.
+    auto& pool = WorkerPool::shared();
+    size_t maxWindow = std::max<size_t>(4 * (pool.threadCount() + 1), 8);
+
+    for (size_t start = 0; start < files.size();) {
+        size_t count = 0;
+        uint64_t buffered = 0;
+        while (start + count < files.size() && count < maxWindow) {
+            uint64_t bytes = bufferedBytes(files[start + count]);
+            if (count > 0 && buffered + bytes > kMaxBufferedBytes) break;
+            buffered += bytes;
+            ++count;
+        }
+
+        std::vector<PreparedEntry> prepared(count);
+        pool.parallelFor(count, [&](size_t i) {
+            prepare(files[start + i], prepared[i]);
+        });
+
+        for (size_t i = 0; i < count; ++i) {
+            if (!append(files[start + i], prepared[i])) {
+                if (failedIndex) *failedIndex = start + i;
+                return false;
+            }
+            prepared[i] = PreparedEntry{};
+            if (onProgress) onProgress(start + i);
+        }
+        start += count;
+    }
+    return true;
+}
+
 bool ZipWriter::finalize() {
     if (!archive_ || finalized_) return false;
     auto* zip = static_cast<mz_zip_archive*>(archive_);
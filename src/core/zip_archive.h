@@ -1,12 +1,26 @@
 #pragma once
 
+#include "core/mapped_file.h"
+
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace kuf {
 
+// Central directory record for one file entry in an archive.
+struct ZipEntryInfo {
+    unsigned index = 0;
+    std::string name;
+    uint64_t compressedSize = 0;
+    uint64_t uncompressedSize = 0;
+    bool stored = false; // Entry data is not compressed.
+};
+
 class ZipReader {
 public:
     ZipReader() = default;
@@ -17,16 +31,55 @@ public:
     ZipReader(ZipReader&& other) noexcept;
     ZipReader& operator=(ZipReader&& other) noexcept;
 
+    // Maps the archive into memory when possible so stored entries can be
+    // viewed in place; falls back to buffered file reads otherwise.
     bool open(const std::string& path);
     void close();
 
     std::vector<std::string> entries() const;
+    std::vector<ZipEntryInfo> entryInfos() const;
     std::optional<std::vector<std::byte>> readEntry(const std::string& name) const;
+
+    // Inflates an entry into caller-owned memory. Returns the entry size, or
+    // nullopt if the entry is missing, corrupt or larger than out.
+    std::optional<size_t> readEntryInto(const std::string& name, std::span<std::byte> out) const;
+
+    // Bytes of a stored (uncompressed) entry inside the mapped archive, CRC
+    // checked. Valid until the reader is closed. nullopt for deflated entries
+    // or when the archive is not mapped.
+    std::optional<std::span<const std::byte>> entryView(const std::string& name) const;
+
+    // Entry contents without a copy where possible: a view for stored entries,
+    // otherwise inflated into scratch, which is resized but keeps its capacity
+    // so one buffer can serve many reads.
+    std::optional<std::span<const std::byte>> entryBytes(const std::string& name,
+                                                         std::vector<std::byte>& scratch) const;
     bool extractEntry(const std::string& name, const std::string& destPath) const;
     bool extractAll(const std::string& destDir) const;
 
+    // Extracts the entry at a central directory index. The destination's parent
+    // directory must already exist; the file is preallocated to sizeHint bytes
+    // before inflating so large outputs are laid out in one extent.
+    bool extractEntryAt(unsigned index, const std::string& destPath, uint64_t sizeHint) const;
+
 private:
+    std::optional<std::span<const std::byte>> viewAt(unsigned index) const;
+
     void* archive_ = nullptr; // mz_zip_archive*
+    MappedFile mapping_; // Backs archive_ when the archive is memory mapped.
+};
+
+// How ZipWriter::addFiles writes one entry.
+enum class ZipCompression {
+    Auto,    // Deflate unless sampled slices do not shrink; store if deflating does not shrink.
+    Deflate, // Deflate even when it does not shrink the file.
+    Store
+};
+
+struct ZipFileSource {
+    std::string diskPath;
+    std::string archiveName;
+    ZipCompression compression = ZipCompression::Auto;
 };
 
 class ZipWriter {
@@ -40,8 +93,20 @@ public:
     ZipWriter& operator=(ZipWriter&& other) noexcept;
 
     bool create(const std::string& path);
+    // Deflates a file from disk, streaming it through a fixed-size buffer.
     bool addFile(const std::string& diskPath, const std::string& archiveName);
+    // Adds a file uncompressed, reading it through a memory mapping.
+    bool addFileStored(const std::string& diskPath, const std::string& archiveName);
     bool addMemory(const std::string& archiveName, const void* data, size_t size);
+
+    // Adds many files at once. Files are compressed into memory in parallel on
+    // the shared worker pool, a window of at most 256 MiB of input at a time,
+    // and appended in order.
+    // onProgress(i) is called after file i is written. On failure, failedIndex
+    // (if given) receives the index of the file that could not be added.
+    using ProgressFn = std::function<void(size_t index)>;
+    bool addFiles(const std::vector<ZipFileSource>& files, const ProgressFn& onProgress = {},
+                  size_t* failedIndex = nullptr);
     bool finalize();
 
 private:
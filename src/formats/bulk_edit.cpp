@@ -0,0 +1,841 @@
+#include "formats/bulk_edit.h"
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+namespace kuf {
+
+namespace {
+
+enum class FieldType : uint8_t {
+    Float,
+    Int32,
+    UInt32,
+    UInt8,
+    Enum8 // One-byte enum class; read-only.
+};
+
+using AddressFn = void* (*)(void* record, size_t arg);
+
+struct FieldDef {
+    FieldType type;
+    AddressFn address;
+    size_t arg = 0;
+};
+
+template<typename T> struct MemberTraits;
+template<typename R, typename T> struct MemberTraits<T R::*> {
+    using Record = R;
+    using Type = T;
+};
+
+template<auto Member>
+void* memberAddress(void* record, size_t) {
+    using Record = typename MemberTraits<decltype(Member)>::Record;
+    return &(static_cast<Record*>(record)->*Member);
+}
+
+template<auto Member>
+void* elementAddress(void* record, size_t index) {
+    using Record = typename MemberTraits<decltype(Member)>::Record;
+    return &(static_cast<Record*>(record)->*Member)[index];
+}
+
+template<typename T>
+constexpr FieldType fieldTypeOf() {
+    if constexpr (std::is_same_v<T, float>) return FieldType::Float;
+    else if constexpr (std::is_same_v<T, int32_t>) return FieldType::Int32;
+    else if constexpr (std::is_same_v<T, uint32_t>) return FieldType::UInt32;
+    else if constexpr (std::is_same_v<T, uint8_t>) return FieldType::UInt8;
+    else {
+        static_assert(std::is_enum_v<T> && sizeof(T) == 1, "unsupported bulk edit field type");
+        return FieldType::Enum8;
+    }
+}
+
+// Field names and accessors for one target. Names are built once and never
+// move, so the string_views in infos stay valid.
+struct FieldTable {
+    std::vector<std::string> names;
+    std::vector<BulkEditFieldInfo> infos;
+    std::vector<FieldDef> defs;
+
+    template<auto Member>
+    void add(std::string name, bool writable = true) {
+        using T = typename MemberTraits<decltype(Member)>::Type;
+        addRaw(std::move(name), fieldTypeOf<T>(), &memberAddress<Member>, 0, writable);
+    }
+
+    template<auto Member>
+    void addArray(const std::string& name) {
+        using T = typename MemberTraits<decltype(Member)>::Type;
+        using Element = typename T::value_type;
+        for (size_t i = 0; i < std::tuple_size_v<T>; ++i) {
+            addRaw(name + "[" + std::to_string(i) + "]", fieldTypeOf<Element>(), &elementAddress<Member>, i, true);
+        }
+    }
+
+    void addRaw(std::string name, FieldType type, AddressFn address, size_t arg, bool writable) {
+        names.push_back(std::move(name));
+        defs.push_back({type, address, arg});
+        // Enum fields only take their named values, so they are filter-only.
+        infos.push_back({{}, writable && type != FieldType::Enum8});
+    }
+
+    void finish() {
+        for (size_t i = 0; i < names.size(); ++i) infos[i].name = names[i];
+    }
+
+    std::optional<uint32_t> find(std::string_view name) const {
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) return static_cast<uint32_t>(i);
+        }
+        return std::nullopt;
+    }
+};
+
+const FieldTable& troopFields() {
+    static const FieldTable table = [] {
+        FieldTable t;
+        t.add<&TroopInfo::job>("job");
+        t.add<&TroopInfo::typeId>("typeId");
+        t.add<&TroopInfo::moveSpeed>("moveSpeed");
+        t.add<&TroopInfo::rotateRate>("rotateRate");
+        t.add<&TroopInfo::moveAcceleration>("moveAcceleration");
+        t.add<&TroopInfo::moveDeceleration>("moveDeceleration");
+        t.add<&TroopInfo::sightRange>("sightRange");
+        t.add<&TroopInfo::attackRangeMax>("attackRangeMax");
+        t.add<&TroopInfo::attackRangeMin>("attackRangeMin");
+        t.add<&TroopInfo::attackFrontRange>("attackFrontRange");
+        t.add<&TroopInfo::directAttack>("directAttack");
+        t.add<&TroopInfo::indirectAttack>("indirectAttack");
+        t.add<&TroopInfo::defense>("defense");
+        t.add<&TroopInfo::baseWidth>("baseWidth");
+        t.add<&TroopInfo::resistMelee>("resistMelee");
+        t.add<&TroopInfo::resistRanged>("resistRanged");
+        t.add<&TroopInfo::resistFrontal>("resistFrontal");
+        t.add<&TroopInfo::resistExplosion>("resistExplosion");
+        t.add<&TroopInfo::resistFire>("resistFire");
+        t.add<&TroopInfo::resistIce>("resistIce");
+        t.add<&TroopInfo::resistLightning>("resistLightning");
+        t.add<&TroopInfo::resistHoly>("resistHoly");
+        t.add<&TroopInfo::resistCurse>("resistCurse");
+        t.add<&TroopInfo::resistEarth>("resistEarth");
+        t.add<&TroopInfo::maxUnitSpeedMultiplier>("maxUnitSpeedMultiplier");
+        t.add<&TroopInfo::defaultUnitHp>("defaultUnitHp");
+        t.add<&TroopInfo::formationRandom>("formationRandom");
+        t.add<&TroopInfo::defaultUnitNumX>("defaultUnitNumX");
+        t.add<&TroopInfo::defaultUnitNumY>("defaultUnitNumY");
+        t.add<&TroopInfo::unitHpLevelUp>("unitHpLevelUp");
+        for (size_t i = 0; i < 3; ++i) {
+            std::string prefix = "levelUpData[" + std::to_string(i) + "].";
+            t.addRaw(prefix + "skillId", FieldType::Int32, [](void* r, size_t k) -> void* {
+                return &static_cast<TroopInfo*>(r)->levelUpData[k].skillId;
+            }, i, true);
+            t.addRaw(prefix + "bonusPerLevel", FieldType::Float, [](void* r, size_t k) -> void* {
+                return &static_cast<TroopInfo*>(r)->levelUpData[k].bonusPerLevel;
+            }, i, true);
+        }
+        t.add<&TroopInfo::damageDistribution>("damageDistribution");
+        t.finish();
+        return t;
+    }();
+    return table;
+}
+
+const FieldTable& unitFields() {
+    static const FieldTable table = [] {
+        FieldTable t;
+        // IDs are referenced from event scripts; change them with renumber.
+        t.add<&StgUnit::uniqueId>("uniqueId", false);
+        t.add<&StgUnit::ucd>("ucd");
+        t.add<&StgUnit::isHero>("isHero");
+        t.add<&StgUnit::isEnabled>("isEnabled");
+        t.add<&StgUnit::leaderHpOverride>("leaderHpOverride");
+        t.add<&StgUnit::unitHpOverride>("unitHpOverride");
+        t.add<&StgUnit::positionX>("positionX");
+        t.add<&StgUnit::positionY>("positionY");
+        t.add<&StgUnit::direction>("direction");
+        t.add<&StgUnit::leaderJobType>("leaderJobType");
+        t.add<&StgUnit::leaderModelId>("leaderModelId");
+        t.add<&StgUnit::leaderWorldmapId>("leaderWorldmapId");
+        t.add<&StgUnit::leaderLevel>("leaderLevel");
+        // Decides how many officer blocks the unit carries.
+        t.add<&StgUnit::officerCount>("officerCount", false);
+        t.addRaw("officer1.level", FieldType::UInt8, [](void* r, size_t) -> void* {
+            return &static_cast<StgUnit*>(r)->officer1.level;
+        }, 0, true);
+        t.addRaw("officer2.level", FieldType::UInt8, [](void* r, size_t) -> void* {
+            return &static_cast<StgUnit*>(r)->officer2.level;
+        }, 0, true);
+        t.add<&StgUnit::troopInfoIndex>("troopInfoIndex");
+        t.add<&StgUnit::formationType>("formationType");
+        t.add<&StgUnit::unitAnimConfig>("unitAnimConfig");
+        t.add<&StgUnit::gridX>("gridX");
+        t.add<&StgUnit::gridY>("gridY");
+        t.addArray<&StgUnit::statOverrides>("statOverrides");
+        t.finish();
+        return t;
+    }();
+    return table;
+}
+
+const FieldTable& fieldTable(BulkEditTarget target) {
+    return target == BulkEditTarget::Troops ? troopFields() : unitFields();
+}
+
+enum class OpCode : uint8_t {
+    Const, Load, Index,
+    Neg, Not, Abs, Round, Floor, Ceil,
+    Add, Sub, Mul, Div, Min, Max,
+    Lt, Le, Gt, Ge, Eq, Ne, And, Or,
+    Clamp
+};
+
+struct Op {
+    OpCode code;
+    uint32_t slot = 0; // Column for Load.
+    double value = 0;  // Constant for Const.
+};
+
+// Postfix program; depth is the largest number of blocks live at once.
+struct Expr {
+    std::vector<Op> ops;
+    size_t depth = 0;
+};
+
+struct Assignment {
+    uint32_t field = 0;
+    uint32_t slot = 0; // Column holding the field's current value.
+    Expr expr;
+};
+
+// ---- Lexer ----
+
+enum class TokenKind : uint8_t { End, Number, Name, Pattern, Symbol };
+
+struct Token {
+    TokenKind kind = TokenKind::End;
+    std::string text; // Name, pattern prefix or symbol.
+    double number = 0;
+    size_t column = 0;
+};
+
+bool isNameStart(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isNameChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '[' || c == ']';
+}
+
+std::variant<std::vector<Token>, std::string> tokenize(std::string_view src) {
+    static constexpr std::string_view kTwoCharSymbols[] = {
+        "+=", "-=", "*=", "/=", "==", "!=", "<=", ">=", "&&", "||"};
+
+    std::vector<Token> tokens;
+    size_t i = 0;
+    while (i < src.size()) {
+        char c = src[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+            continue;
+        }
+        Token tok;
+        tok.column = i + 1;
+
+        if (std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && i + 1 < src.size() &&
+                                                            std::isdigit(static_cast<unsigned char>(src[i + 1])))) {
+            auto [end, ec] = std::from_chars(src.data() + i, src.data() + src.size(), tok.number);
+            if (ec != std::errc()) {
+                return "Invalid number at column " + std::to_string(tok.column);
+            }
+            i = static_cast<size_t>(end - src.data());
+            if (i < src.size() && src[i] == '%') {
+                tok.number /= 100.0;
+                ++i;
+            }
+            tok.kind = TokenKind::Number;
+        } else if (isNameStart(c)) {
+            size_t start = i;
+            while (i < src.size() && isNameChar(src[i])) ++i;
+            tok.text = std::string(src.substr(start, i - start));
+            tok.kind = TokenKind::Name;
+            // A * glued to a name makes a field pattern, unless an operand
+            // follows ("resist*2") or it starts "*=" ("defense*=2").
+            if (i < src.size() && src[i] == '*') {
+                size_t next = i + 1;
+                while (next < src.size() && std::isspace(static_cast<unsigned char>(src[next]))) ++next;
+                bool operand = next < src.size() && (isNameChar(src[next]) || src[next] == '(');
+                bool compound = i + 1 < src.size() && src[i + 1] == '=';
+                if (!operand && !compound) {
+                    tok.kind = TokenKind::Pattern;
+                    ++i;
+                }
+            }
+        } else {
+            tok.kind = TokenKind::Symbol;
+            std::string_view rest = src.substr(i);
+            for (auto sym : kTwoCharSymbols) {
+                if (rest.substr(0, 2) == sym) {
+                    tok.text = std::string(sym);
+                    break;
+                }
+            }
+            if (tok.text.empty()) {
+                if (std::string_view("+-*/<>=!(),;").find(c) == std::string_view::npos) {
+                    return std::string("Unexpected '") + c + "' at column " + std::to_string(tok.column);
+                }
+                tok.text = std::string(1, c);
+            }
+            i += tok.text.size();
+        }
+        tokens.push_back(std::move(tok));
+    }
+    Token end;
+    end.column = src.size() + 1;
+    tokens.push_back(end);
+    return tokens;
+}
+
+
+// ---- Parser ----
+
+struct CompiledEdit {
+    BulkEditTarget target = BulkEditTarget::Troops;
+    std::vector<Assignment> assignments;
+    bool hasWhere = false;
+    Expr where;
+    std::vector<uint32_t> slotFields; // Field gathered into each column.
+    size_t depth = 1;
+};
+
+struct ParseError {
+    std::string message;
+};
+
+class Parser {
+public:
+    Parser(std::vector<Token> tokens, BulkEditTarget target)
+        : tokens_(std::move(tokens)), target_(target), fields_(fieldTable(target)) {}
+
+    CompiledEdit parse() {
+        edit_.target = target_;
+        std::vector<uint32_t> assigned;
+        do {
+            parseAssignment(assigned);
+        } while (acceptSymbol(",") || acceptSymbol(";"));
+
+        if (acceptKeyword("where")) {
+            edit_.hasWhere = true;
+            parseExpr(edit_.where, std::nullopt);
+        }
+        if (peek().kind != TokenKind::End) fail("Unexpected input");
+        return std::move(edit_);
+    }
+
+private:
+    const Token& peek() const { return tokens_[pos_]; }
+
+    bool atKeyword(std::string_view word) const {
+        return peek().kind == TokenKind::Name && peek().text == word;
+    }
+
+    bool acceptSymbol(std::string_view sym) {
+        if (peek().kind != TokenKind::Symbol || peek().text != sym) return false;
+        ++pos_;
+        return true;
+    }
+
+    bool acceptKeyword(std::string_view word) {
+        if (!atKeyword(word)) return false;
+        ++pos_;
+        return true;
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw ParseError{message + " at column " + std::to_string(peek().column)};
+    }
+
+    void expectSymbol(std::string_view sym) {
+        if (!acceptSymbol(sym)) fail("Expected '" + std::string(sym) + "'");
+    }
+
+    // Column holding field, added on first use.
+    uint32_t slotFor(uint32_t field) {
+        auto& slots = edit_.slotFields;
+        auto it = std::find(slots.begin(), slots.end(), field);
+        if (it != slots.end()) return static_cast<uint32_t>(it - slots.begin());
+        slots.push_back(field);
+        return static_cast<uint32_t>(slots.size() - 1);
+    }
+
+    void parseAssignment(std::vector<uint32_t>& assigned) {
+        const Token& lhs = peek();
+        std::vector<uint32_t> targets;
+        if (lhs.kind == TokenKind::Pattern) {
+            for (size_t i = 0; i < fields_.names.size(); ++i) {
+                if (fields_.infos[i].writable && fields_.names[i].starts_with(lhs.text)) {
+                    targets.push_back(static_cast<uint32_t>(i));
+                }
+            }
+            if (targets.empty()) fail("No writable field matches '" + lhs.text + "*'");
+        } else if (lhs.kind == TokenKind::Name) {
+            auto field = fields_.find(lhs.text);
+            if (!field) fail("Unknown field '" + lhs.text + "'");
+            if (!fields_.infos[*field].writable) fail("Field '" + lhs.text + "' is read-only");
+            targets.push_back(*field);
+        } else {
+            fail("Expected a field to assign");
+        }
+        for (uint32_t field : targets) {
+            if (std::find(assigned.begin(), assigned.end(), field) != assigned.end()) {
+                fail("Field '" + fields_.names[field] + "' is assigned twice");
+            }
+            assigned.push_back(field);
+        }
+        std::optional<std::string> pattern;
+        if (lhs.kind == TokenKind::Pattern) pattern = lhs.text;
+        ++pos_;
+
+        std::optional<OpCode> compound;
+        if (acceptSymbol("+=")) compound = OpCode::Add;
+        else if (acceptSymbol("-=")) compound = OpCode::Sub;
+        else if (acceptSymbol("*=")) compound = OpCode::Mul;
+        else if (acceptSymbol("/=")) compound = OpCode::Div;
+        else if (!acceptSymbol("=")) fail("Expected an assignment operator");
+
+        // A pattern re-parses the right-hand side once per matching field.
+        size_t rhs = pos_;
+        size_t end = rhs;
+        for (uint32_t field : targets) {
+            pos_ = rhs;
+            Assignment a;
+            a.field = field;
+            a.slot = slotFor(field);
+            if (pattern) {
+                patternPrefix_ = *pattern;
+                patternField_ = field;
+            }
+            parseExpr(a.expr, compound ? std::optional<uint32_t>(a.slot) : std::nullopt);
+            if (compound) emit(*compound);
+            edit_.depth = std::max(edit_.depth, a.expr.depth);
+            edit_.assignments.push_back(std::move(a));
+            end = pos_;
+        }
+        pos_ = end;
+        patternField_.reset();
+    }
+
+    // Parses an expression into out. With lhsSlot the column is pushed first,
+    // for compound assignments.
+    void parseExpr(Expr& out, std::optional<uint32_t> lhsSlot) {
+        expr_ = &out;
+        depth_ = 0;
+        maxDepth_ = 0;
+        if (lhsSlot) emit(OpCode::Load, *lhsSlot);
+        parseOr();
+        out.depth = maxDepth_;
+        edit_.depth = std::max(edit_.depth, maxDepth_);
+    }
+
+    void emit(OpCode code, uint32_t slot = 0, double value = 0) {
+        expr_->ops.push_back({code, slot, value});
+        switch (code) {
+        case OpCode::Const:
+        case OpCode::Load:
+        case OpCode::Index:
+            ++depth_;
+            break;
+        case OpCode::Neg:
+        case OpCode::Not:
+        case OpCode::Abs:
+        case OpCode::Round:
+        case OpCode::Floor:
+        case OpCode::Ceil:
+            break;
+        case OpCode::Clamp:
+            depth_ -= 2;
+            break;
+        default:
+            --depth_;
+            break;
+        }
+        maxDepth_ = std::max(maxDepth_, depth_);
+    }
+
+    void parseOr() {
+        parseAnd();
+        while (acceptKeyword("or") || acceptSymbol("||")) {
+            parseAnd();
+            emit(OpCode::Or);
+        }
+    }
+
+    void parseAnd() {
+        parseNot();
+        while (acceptKeyword("and") || acceptSymbol("&&")) {
+            parseNot();
+            emit(OpCode::And);
+        }
+    }
+
+    void parseNot() {
+        if (acceptKeyword("not") || acceptSymbol("!")) {
+            parseNot();
+            emit(OpCode::Not);
+            return;
+        }
+        parseComparison();
+    }
+
+    void parseComparison() {
+        static constexpr std::pair<std::string_view, OpCode> kComparisons[] = {
+            {"<", OpCode::Lt}, {"<=", OpCode::Le}, {">", OpCode::Gt},
+            {">=", OpCode::Ge}, {"==", OpCode::Eq}, {"!=", OpCode::Ne}};
+
+        parseSum();
+        for (auto [sym, code] : kComparisons) {
+            if (acceptSymbol(sym)) {
+                parseSum();
+                emit(code);
+                return;
+            }
+        }
+    }
+
+    void parseSum() {
+        parseProduct();
+        for (;;) {
+            if (acceptSymbol("+")) {
+                parseProduct();
+                emit(OpCode::Add);
+            } else if (acceptSymbol("-")) {
+                parseProduct();
+                emit(OpCode::Sub);
+            } else {
+                return;
+            }
+        }
+    }
+
+    void parseProduct() {
+        parseUnary();
+        for (;;) {
+            if (acceptSymbol("*")) {
+                parseUnary();
+                emit(OpCode::Mul);
+            } else if (acceptSymbol("/")) {
+                parseUnary();
+                emit(OpCode::Div);
+            } else {
+                return;
+            }
+        }
+    }
+
+    void parseUnary() {
+        if (acceptSymbol("-")) {
+            parseUnary();
+            emit(OpCode::Neg);
+        } else if (acceptSymbol("+")) {
+            parseUnary();
+        } else {
+            parsePrimary();
+        }
+    }
+
+    void parsePrimary() {
+        static constexpr std::pair<std::string_view, UCD> kUcdNames[] = {
+            {"player", UCD::Player}, {"enemy", UCD::Enemy}, {"ally", UCD::Ally}, {"neutral", UCD::Neutral}};
+
+        const Token& tok = peek();
+        if (tok.kind == TokenKind::Number) {
+            ++pos_;
+            emit(OpCode::Const, 0, tok.number);
+            return;
+        }
+        if (acceptSymbol("(")) {
+            parseOr();
+            expectSymbol(")");
+            return;
+        }
+        if (tok.kind == TokenKind::Pattern) {
+            if (!patternField_ || tok.text != patternPrefix_) {
+                fail("Pattern '" + tok.text + "*' can only be read when assigning to it");
+            }
+            ++pos_;
+            emit(OpCode::Load, slotFor(*patternField_));
+            return;
+        }
+        if (tok.kind != TokenKind::Name) fail("Expected a value");
+
+        if (tokens_[pos_ + 1].kind == TokenKind::Symbol && tokens_[pos_ + 1].text == "(") {
+            parseCall();
+            return;
+        }
+        if (tok.text == "index") {
+            ++pos_;
+            emit(OpCode::Index);
+            return;
+        }
+        if (target_ == BulkEditTarget::Units) {
+            for (auto [name, ucd] : kUcdNames) {
+                if (tok.text == name) {
+                    ++pos_;
+                    emit(OpCode::Const, 0, static_cast<double>(ucd));
+                    return;
+                }
+            }
+        }
+        auto field = fields_.find(tok.text);
+        if (!field) fail("Unknown field '" + tok.text + "'");
+        ++pos_;
+        emit(OpCode::Load, slotFor(*field));
+    }
+
+    void parseCall() {
+        struct Function {
+            std::string_view name;
+            size_t args;
+            OpCode code;
+        };
+        static constexpr Function kFunctions[] = {
+            {"min", 2, OpCode::Min}, {"max", 2, OpCode::Max}, {"clamp", 3, OpCode::Clamp},
+            {"abs", 1, OpCode::Abs}, {"round", 1, OpCode::Round}, {"floor", 1, OpCode::Floor},
+            {"ceil", 1, OpCode::Ceil}};
+
+        auto fn = std::find_if(std::begin(kFunctions), std::end(kFunctions),
+                               [&](const Function& f) { return f.name == peek().text; });
+        if (fn == std::end(kFunctions)) fail("Unknown function '" + peek().text + "'");
+        pos_ += 2;
+        for (size_t i = 0; i < fn->args; ++i) {
+            if (i > 0) expectSymbol(",");
+            parseOr();
+        }
+        expectSymbol(")");
+        emit(fn->code);
+    }
+
+    std::vector<Token> tokens_;
+    size_t pos_ = 0;
+    BulkEditTarget target_;
+    const FieldTable& fields_;
+    CompiledEdit edit_;
+
+    Expr* expr_ = nullptr;
+    size_t depth_ = 0;
+    size_t maxDepth_ = 0;
+    std::string patternPrefix_;
+    std::optional<uint32_t> patternField_;
+};
+
+// ---- Evaluation ----
+
+// Records per block. Small enough that every live column stays in L1.
+constexpr size_t kBlock = 256;
+using Column = std::array<double, kBlock>;
+
+void gather(const FieldDef& def, std::byte* records, size_t stride, size_t first, size_t count, Column& out) {
+    for (size_t i = 0; i < count; ++i) {
+        void* field = def.address(records + (first + i) * stride, def.arg);
+        switch (def.type) {
+        case FieldType::Float:  out[i] = *static_cast<const float*>(field); break;
+        case FieldType::Int32:  out[i] = *static_cast<const int32_t*>(field); break;
+        case FieldType::UInt32: out[i] = *static_cast<const uint32_t*>(field); break;
+        case FieldType::UInt8:
+        case FieldType::Enum8:  out[i] = *static_cast<const uint8_t*>(field); break;
+        }
+    }
+}
+
+// Operators always run over the whole block. The fixed trip count lets the
+// compiler vectorize without a scalar tail; lanes past the last record hold
+// stale values and are never read back.
+template<typename F>
+void unary(Column& a, F f) {
+    for (size_t i = 0; i < kBlock; ++i) a[i] = f(a[i]);
+}
+
+template<typename F>
+void binary(Column& a, const Column& b, F f) {
+    for (size_t i = 0; i < kBlock; ++i) a[i] = f(a[i], b[i]);
+}
+
+// Runs expr over the block starting at record first; the result is left in
+// stack[0].
+void run(const Expr& expr, const std::vector<Column>& columns, std::vector<Column>& stack, size_t first) {
+    size_t top = 0;
+    for (const auto& op : expr.ops) {
+        switch (op.code) {
+        case OpCode::Const:
+            stack[top++].fill(op.value);
+            continue;
+        case OpCode::Load:
+            stack[top++] = columns[op.slot];
+            continue;
+        case OpCode::Index: {
+            auto& a = stack[top++];
+            for (size_t i = 0; i < kBlock; ++i) a[i] = static_cast<double>(first + i);
+            continue;
+        }
+        default:
+            break;
+        }
+
+        Column& a = stack[top - 1];
+        switch (op.code) {
+        case OpCode::Neg:   unary(a, [](double x) { return -x; }); continue;
+        case OpCode::Not:   unary(a, [](double x) { return x == 0.0 ? 1.0 : 0.0; }); continue;
+        case OpCode::Abs:   unary(a, [](double x) { return std::fabs(x); }); continue;
+        case OpCode::Round: unary(a, [](double x) { return std::round(x); }); continue;
+        case OpCode::Floor: unary(a, [](double x) { return std::floor(x); }); continue;
+        case OpCode::Ceil:  unary(a, [](double x) { return std::ceil(x); }); continue;
+        default:
+            break;
+        }
+
+        if (op.code == OpCode::Clamp) {
+            Column& x = stack[top - 3];
+            const Column& lo = stack[top - 2];
+            const Column& hi = a;
+            for (size_t i = 0; i < kBlock; ++i) x[i] = std::min(std::max(x[i], lo[i]), hi[i]);
+            top -= 2;
+            continue;
+        }
+
+        Column& l = stack[top - 2];
+        const Column& r = a;
+        switch (op.code) {
+        case OpCode::Add: binary(l, r, [](double x, double y) { return x + y; }); break;
+        case OpCode::Sub: binary(l, r, [](double x, double y) { return x - y; }); break;
+        case OpCode::Mul: binary(l, r, [](double x, double y) { return x * y; }); break;
+        case OpCode::Div: binary(l, r, [](double x, double y) { return x / y; }); break;
+        case OpCode::Min: binary(l, r, [](double x, double y) { return std::min(x, y); }); break;
+        case OpCode::Max: binary(l, r, [](double x, double y) { return std::max(x, y); }); break;
+        case OpCode::Lt:  binary(l, r, [](double x, double y) { return x < y ? 1.0 : 0.0; }); break;
+        case OpCode::Le:  binary(l, r, [](double x, double y) { return x <= y ? 1.0 : 0.0; }); break;
+        case OpCode::Gt:  binary(l, r, [](double x, double y) { return x > y ? 1.0 : 0.0; }); break;
+        case OpCode::Ge:  binary(l, r, [](double x, double y) { return x >= y ? 1.0 : 0.0; }); break;
+        case OpCode::Eq:  binary(l, r, [](double x, double y) { return x == y ? 1.0 : 0.0; }); break;
+        case OpCode::Ne:  binary(l, r, [](double x, double y) { return x != y ? 1.0 : 0.0; }); break;
+        case OpCode::And: binary(l, r, [](double x, double y) { return (x != 0.0 && y != 0.0) ? 1.0 : 0.0; }); break;
+        case OpCode::Or:  binary(l, r, [](double x, double y) { return (x != 0.0 || y != 0.0) ? 1.0 : 0.0; }); break;
+        default:
+            break;
+        }
+        --top;
+    }
+}
+
+template<typename T>
+void writeInteger(std::vector<std::pair<T*, T>>& out, void* field, double value, double old) {
+    double clamped = std::clamp(std::round(value), static_cast<double>(std::numeric_limits<T>::min()),
+                                static_cast<double>(std::numeric_limits<T>::max()));
+    if (clamped != old) out.emplace_back(static_cast<T*>(field), static_cast<T>(clamped));
+}
+
+} // namespace
+
+struct BulkEdit::Program : CompiledEdit {
+    explicit Program(CompiledEdit edit) : CompiledEdit(std::move(edit)) {}
+
+    BulkEditPlan evaluate(std::byte* records, size_t stride, size_t count) const;
+};
+
+BulkEditPlan BulkEdit::Program::evaluate(std::byte* records, size_t stride, size_t count) const {
+    KUF_PROFILE_ZONE("BulkEdit::plan");
+    const auto& table = fieldTable(target);
+    BulkEditPlan plan;
+    plan.records = count;
+
+    std::vector<Column> columns(slotFields.size());
+    std::vector<Column> stack(depth);
+    std::array<bool, kBlock> selected;
+
+    for (size_t first = 0; first < count; first += kBlock) {
+        size_t n = std::min(kBlock, count - first);
+        for (size_t slot = 0; slot < slotFields.size(); ++slot) {
+            gather(table.defs[slotFields[slot]], records, stride, first, n, columns[slot]);
+        }
+
+        if (hasWhere) {
+            run(where, columns, stack, first);
+            for (size_t i = 0; i < n; ++i) selected[i] = stack[0][i] != 0.0;
+        } else {
+            std::fill_n(selected.begin(), n, true);
+        }
+        plan.matched += static_cast<size_t>(std::count(selected.begin(), selected.begin() + n, true));
+
+        for (const auto& assignment : assignments) {
+            run(assignment.expr, columns, stack, first);
+            const Column& result = stack[0];
+            const Column& old = columns[assignment.slot];
+            const FieldDef& def = table.defs[assignment.field];
+            for (size_t i = 0; i < n; ++i) {
+                if (!selected[i]) continue;
+                if (!std::isfinite(result[i])) {
+                    ++plan.nonFinite;
+                    continue;
+                }
+                void* field = def.address(records + (first + i) * stride, def.arg);
+                switch (def.type) {
+                case FieldType::Float: {
+                    float value = static_cast<float>(result[i]);
+                    if (static_cast<double>(value) != old[i]) {
+                        plan.floats.emplace_back(static_cast<float*>(field), value);
+                    }
+                    break;
+                }
+                case FieldType::Int32:  writeInteger(plan.ints, field, result[i], old[i]); break;
+                case FieldType::UInt32: writeInteger(plan.uints, field, result[i], old[i]); break;
+                case FieldType::UInt8:  writeInteger(plan.bytes, field, result[i], old[i]); break;
+                case FieldType::Enum8:  break;
+                }
+            }
+        }
+    }
+    return plan;
+}
+
+BulkEdit::BulkEdit(std::unique_ptr<Program> program) : program_(std::move(program)) {}
+BulkEdit::~BulkEdit() = default;
+BulkEdit::BulkEdit(BulkEdit&&) noexcept = default;
+BulkEdit& BulkEdit::operator=(BulkEdit&&) noexcept = default;
+
+std::variant<BulkEdit, std::string> BulkEdit::compile(std::string_view source, BulkEditTarget target) {
+    auto tokens = tokenize(source);
+    if (auto* error = std::get_if<std::string>(&tokens)) return *error;
+    try {
+        Parser parser(std::move(std::get<std::vector<Token>>(tokens)), target);
+        return BulkEdit(std::make_unique<Program>(parser.parse()));
+    } catch (const ParseError& e) {
+        return e.message;
+    }
+}
+
+BulkEditTarget BulkEdit::target() const {
+    return program_->target;
+}
+
+BulkEditPlan BulkEdit::plan(std::span<TroopInfo> troops) const {
+    if (program_->target != BulkEditTarget::Troops) return {};
+    return program_->evaluate(reinterpret_cast<std::byte*>(troops.data()), sizeof(TroopInfo), troops.size());
+}
+
+BulkEditPlan BulkEdit::plan(std::span<StgUnit> units) const {
+    if (program_->target != BulkEditTarget::Units) return {};
+    return program_->evaluate(reinterpret_cast<std::byte*>(units.data()), sizeof(StgUnit), units.size());
+}
+
+std::span<const BulkEditFieldInfo> BulkEdit::fields(BulkEditTarget target) {
+    return fieldTable(target).infos;
+}
+
+} // namespace kuf
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "formats/sox_binary.h"
+#include "formats/stg_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace kuf {
+
+// Record arrays a bulk edit can run over.
+enum class BulkEditTarget : uint8_t {
+    Troops, // SoxBinary::troops()
+    Units   // StgFormat::units()
+};
+
+// A field a bulk edit can read, and write unless it is read-only.
+struct BulkEditFieldInfo {
+    std::string_view name;
+    bool writable = true;
+};
+
+// Every field write a bulk edit makes, grouped by storage type. Only fields
+// whose value actually changes are listed. Nothing has been written yet;
+// callers apply the plan themselves, e.g. as undoable bulk commands.
+struct BulkEditPlan {
+    size_t records = 0;   // Records examined.
+    size_t matched = 0;   // Records the where clause selected.
+    size_t nonFinite = 0; // Results left unapplied because they were NaN or infinite.
+    std::vector<std::pair<float*, float>> floats;
+    std::vector<std::pair<int32_t*, int32_t>> ints;
+    std::vector<std::pair<uint32_t*, uint32_t>> uints;
+    std::vector<std::pair<uint8_t*, uint8_t>> bytes;
+
+    size_t changeCount() const { return floats.size() + ints.size() + uints.size() + bytes.size(); }
+    bool empty() const { return changeCount() == 0; }
+};
+
+// A compiled bulk edit: one or more assignments, optionally filtered by a
+// where clause, for example
+//
+//   unitHpOverride *= 1 + 20% where ucd == enemy and unitHpOverride > 0
+//   resist* = min(resist*, 300)
+//
+// Assignments use =, +=, -=, *= or /= and are separated by commas; all of
+// them read the values from before the edit. Expressions support + - * /,
+// comparisons, and/or/not, min, max, clamp, abs, round, floor and ceil,
+// number literals with an optional % suffix, the UCD names player, enemy,
+// ally and neutral, and index (the record's position). A field name ending in
+// * assigns every field with that prefix; the same pattern on the right-hand
+// side stands for the field being assigned.
+//
+// Evaluation is column-wise: each field is gathered into a contiguous block
+// of doubles and every operator runs as one tight loop over the block, which
+// the compiler vectorizes. Integer fields are rounded and clamped to their
+// range on write.
+class BulkEdit {
+public:
+    ~BulkEdit();
+    BulkEdit(BulkEdit&&) noexcept;
+    BulkEdit& operator=(BulkEdit&&) noexcept;
+
+    // Parses source for target. Returns the error message on failure.
+    static std::variant<BulkEdit, std::string> compile(std::string_view source, BulkEditTarget target);
+
+    BulkEditTarget target() const;
+
+    // Evaluates the edit. The records must match target(); the other overload
+    // returns an empty plan.
+    BulkEditPlan plan(std::span<TroopInfo> troops) const;
+    BulkEditPlan plan(std::span<StgUnit> units) const;
+
+    static std::span<const BulkEditFieldInfo> fields(BulkEditTarget target);
+
+private:
+    struct Program;
+    explicit BulkEdit(std::unique_ptr<Program> program);
+
+    std::unique_ptr<Program> program_;
+};
+
+} // namespace kuf
@@ -0,0 +1,245 @@
+#include "formats/record_digest.h"
+#include "core/file_io.h"
+#include "core/hash.h"
+#include "formats/sox_binary.h"
+#include "formats/sox_encoding.h"
+#include "formats/sox_skill_info.h"
+#include "formats/sox_text.h"
+#include "formats/stg_format.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace kuf {
+
+namespace {
+
+constexpr size_t kSoxHeaderSize = 8;
+constexpr size_t kTroopRecordSize = 148;
+
+// Makes keys unique when a file repeats an id.
+class KeyDeduper {
+public:
+    std::string operator()(std::string key) {
+        size_t seen = seen_[key]++;
+        if (seen > 0) key += "#" + std::to_string(seen);
+        return key;
+    }
+
+private:
+    std::unordered_map<std::string, size_t> seen_;
+};
+
+// Collects digests with unique keys.
+class DigestList {
+public:
+    void add(std::string key, uint64_t hash) {
+        digests_.push_back({dedupe_(std::move(key)), hash});
+    }
+
+    std::vector<RecordDigest> take() { return std::move(digests_); }
+
+private:
+    std::vector<RecordDigest> digests_;
+    KeyDeduper dedupe_;
+};
+
+// Collects spans with unique keys, tracking the running file offset.
+class SpanList {
+public:
+    explicit SpanList(size_t offset) : offset_(offset) {}
+
+    void skip(size_t size) { offset_ += size; }
+
+    void add(std::string key, size_t size) {
+        spans_.push_back({dedupe_(std::move(key)), offset_, size});
+        offset_ += size;
+    }
+
+    size_t offset() const { return offset_; }
+    std::vector<RecordSpan> take() { return std::move(spans_); }
+
+private:
+    std::vector<RecordSpan> spans_;
+    KeyDeduper dedupe_;
+    size_t offset_;
+};
+
+std::optional<std::vector<RecordSpan>> layoutStg(const StgFormat& stg, size_t fileSize) {
+    SpanList spans(0);
+    spans.add("header", kStgHeaderSize);
+    for (const auto& unit : stg.units()) {
+        spans.add("unit:" + std::to_string(unit.uniqueId), kStgUnitSize);
+    }
+
+    // An unparsed tail is opaque; treat it as one record.
+    if (!stg.tailParsed()) {
+        if (spans.offset() < fileSize) spans.add("tail", fileSize - spans.offset());
+        return spans.take();
+    }
+
+    // Section sizes mirror StgFormat's parse*/serialize* routines.
+    spans.skip(4);
+    for (const auto& area : stg.areas()) {
+        spans.add("area:" + std::to_string(area.areaId), kStgAreaIdEntrySize);
+    }
+
+    spans.skip(4);
+    for (const auto& var : stg.variables()) {
+        spans.add("variable:" + std::to_string(var.variableId),
+                  kStgVariableNameSize + 4 + var.initialValue.serializedSize());
+    }
+
+    spans.skip(4);
+    for (const auto& block : stg.eventBlocks()) {
+        spans.skip(8);
+        for (const auto& event : block.events) {
+            spans.add("event:" + std::to_string(event.eventId), event.rawData.size());
+        }
+    }
+
+    spans.add("footer", 4 + stg.footerEntries().size() * 8);
+    if (spans.offset() != fileSize) return std::nullopt;
+    return spans.take();
+}
+
+std::optional<std::vector<RecordSpan>> layoutStg(std::span<const std::byte> data) {
+    StgFormat stg;
+    if (!stg.load(data)) return std::nullopt;
+    return layoutStg(stg, data.size());
+}
+
+std::vector<RecordSpan> layoutTroopSox(const SoxBinary& binary, size_t fileSize) {
+    SpanList spans(kSoxHeaderSize);
+    for (size_t i = 0; i < binary.recordCount(); ++i) {
+        spans.add("troop:" + std::to_string(i), kTroopRecordSize);
+    }
+    spans.add("footer", fileSize - spans.offset());
+    return spans.take();
+}
+
+std::optional<std::vector<RecordSpan>> layoutTroopSox(std::span<const std::byte> data) {
+    SoxBinary binary;
+    if (!binary.load(data)) return std::nullopt;
+    return layoutTroopSox(binary, data.size());
+}
+
+std::vector<RecordDigest> digestSpans(const std::vector<RecordSpan>& spans,
+                                      std::span<const std::byte> data) {
+    std::vector<RecordDigest> digests;
+    digests.reserve(spans.size());
+    for (const auto& span : spans) {
+        digests.push_back({span.key, hash64(data.subspan(span.offset, span.size))});
+    }
+    return digests;
+}
+
+std::optional<std::vector<RecordDigest>> digestSox(std::span<const std::byte> data) {
+    SoxBinary binary;
+    if (binary.load(data)) return digestTroopSox(binary, data);
+
+    SoxSkillInfo skills;
+    if (skills.load(data)) return digestSkillSox(skills);
+
+    SoxText text;
+    if (text.load(data)) return digestTextSox(text);
+
+    return std::nullopt;
+}
+
+} // namespace
+
+std::optional<std::vector<RecordSpan>> recordLayout(std::string_view fileName,
+                                                    std::span<const std::byte> data) {
+    std::string ext = lowerExtension(fileName);
+    if (ext == ".stg") return layoutStg(data);
+    if (ext == ".sox") return layoutTroopSox(data);
+    return std::nullopt;
+}
+
+std::optional<std::vector<RecordSpan>> stgRecordLayout(const StgFormat& stg, size_t fileSize) {
+    return layoutStg(stg, fileSize);
+}
+
+std::vector<RecordDigest> digestTroopSox(const SoxBinary& troops, std::span<const std::byte> data) {
+    // Troop records are fixed size; hash the file bytes directly so fields the
+    // parser does not model still count as changes.
+    return digestSpans(layoutTroopSox(troops, data.size()), data);
+}
+
+std::vector<RecordDigest> digestSkillSox(const SoxSkillInfo& skills) {
+    DigestList list;
+    for (const auto& skill : skills.skills()) {
+        Hash64 hasher;
+        hasher.update(skill.locKey.data(), skill.locKey.size());
+        hasher.update(skill.iconPath.data(), skill.iconPath.size());
+        hasher.update(&skill.skillType, sizeof(skill.skillType));
+        hasher.update(&skill.maxLevel, sizeof(skill.maxLevel));
+        list.add("skill:" + std::to_string(skill.id), hasher.digest());
+    }
+    return list.take();
+}
+
+std::vector<RecordDigest> digestTextSox(const SoxText& text) {
+    DigestList list;
+    for (size_t i = 0; i < text.entryCount(); ++i) {
+        uint16_t maxLength = text.maxLength(i);
+        std::string_view entryText = text.text(i);
+        Hash64 hasher;
+        hasher.update(&maxLength, sizeof(maxLength));
+        hasher.update(entryText.data(), entryText.size());
+        list.add("text:" + std::to_string(i), hasher.digest());
+    }
+    return list.take();
+}
+
+std::optional<std::vector<RecordDigest>> digestStg(const StgFormat& stg, std::span<const std::byte> data) {
+    auto spans = layoutStg(stg, data.size());
+    if (!spans) return std::nullopt;
+    return digestSpans(*spans, data);
+}
+
+std::optional<std::vector<RecordDigest>> digestRecords(std::string_view fileName,
+                                                       std::span<const std::byte> data) {
+    std::string ext = lowerExtension(fileName);
+    if (ext == ".stg") {
+        StgFormat stg;
+        if (!stg.load(data)) return std::nullopt;
+        return digestStg(stg, data);
+    }
+    if (ext == ".sox") {
+        if (isSoxEncoded(data)) {
+            auto decoded = soxDecode(data);
+            if (!decoded) return std::nullopt;
+            return digestSox(*decoded);
+        }
+        return digestSox(data);
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> changedRecords(const std::vector<RecordDigest>& base,
+                                        const std::vector<RecordDigest>& modified) {
+    std::unordered_map<std::string_view, uint64_t> baseHashes;
+    baseHashes.reserve(base.size());
+    for (const auto& d : base) {
+        baseHashes.emplace(d.key, d.hash);
+    }
+
+    std::vector<std::string> changed;
+    for (const auto& d : modified) {
+        auto it = baseHashes.find(d.key);
+        if (it == baseHashes.end() || it->second != d.hash) {
+            changed.push_back(d.key);
+        }
+        if (it != baseHashes.end()) baseHashes.erase(it);
+    }
+    for (const auto& [key, hash] : baseHashes) {
+        changed.emplace_back(key);
+    }
+
+    std::sort(changed.begin(), changed.end());
+    return changed;
+}
+
+} // namespace kuf
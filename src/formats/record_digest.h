@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kuf {
+
+class SoxBinary;
+class SoxSkillInfo;
+class SoxText;
+class StgFormat;
+
+// Hash of one record inside a game data file. Keys are stable across edits of
+// the same file (troop index, unit uniqueId, eventId, ...) so two versions of a
+// file can be compared record by record.
+struct RecordDigest {
+    std::string key;
+    uint64_t hash = 0;
+};
+
+// Byte range of one record inside a file with a fixed record layout.
+struct RecordSpan {
+    std::string key;
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+// Locates every record of a troop SOX or STG file, in file order, using the
+// format parsers. Bytes between spans are section counts and block headers.
+// Returns nullopt for other files, including encoded SOX.
+std::optional<std::vector<RecordSpan>> recordLayout(std::string_view fileName,
+                                                    std::span<const std::byte> data);
+
+// recordLayout for a mission the caller has already loaded from fileSize bytes.
+std::optional<std::vector<RecordSpan>> stgRecordLayout(const StgFormat& stg, size_t fileSize);
+
+// Splits a SOX or STG file into records and hashes each one. Returns nullopt
+// for files without a known record structure.
+std::optional<std::vector<RecordDigest>> digestRecords(std::string_view fileName,
+                                                       std::span<const std::byte> data);
+
+// digestRecords for a file the caller has already parsed, with the same keys
+// and hashes in file order. data is the (decoded) bytes the file was loaded
+// from. digestStg returns nullopt when the layout does not cover the file.
+std::vector<RecordDigest> digestTroopSox(const SoxBinary& troops, std::span<const std::byte> data);
+std::vector<RecordDigest> digestSkillSox(const SoxSkillInfo& skills);
+std::vector<RecordDigest> digestTextSox(const SoxText& text);
+std::optional<std::vector<RecordDigest>> digestStg(const StgFormat& stg, std::span<const std::byte> data);
+
+// Keys of records that were added, removed or changed going from base to modified.
+std::vector<std::string> changedRecords(const std::vector<RecordDigest>& base,
+                                        const std::vector<RecordDigest>& modified);
+
+} // namespace kuf
@@ -0,0 +1,333 @@
+#include "formats/record_patch.h"
+#include "core/file_io.h"
+#include "core/hash.h"
+#include "formats/record_digest.h"
+#include "formats/sox_binary.h"
+#include "formats/stg_format.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace kuf {
+
+namespace {
+
+constexpr char kPatchMagic[4] = {'K', 'U', 'F', 'P'};
+constexpr uint32_t kPatchVersion = 1;
+
+// Equal bytes shorter than this between two changes are folded into one run;
+// each run costs 8 bytes of framing.
+constexpr size_t kRunMergeGap = 8;
+
+std::vector<RecordPatchRun> diffRuns(std::span<const std::byte> base,
+                                     std::span<const std::byte> modified) {
+    std::vector<RecordPatchRun> runs;
+    size_t i = 0;
+    while (i < base.size()) {
+        if (base[i] == modified[i]) {
+            ++i;
+            continue;
+        }
+
+        size_t start = i;
+        size_t end = i + 1;
+        size_t equal = 0;
+        for (size_t j = end; j < base.size() && equal < kRunMergeGap; ++j) {
+            if (base[j] == modified[j]) {
+                ++equal;
+            } else {
+                equal = 0;
+                end = j + 1;
+            }
+        }
+
+        RecordPatchRun run;
+        run.offset = static_cast<uint32_t>(start);
+        run.oldBytes.assign(base.begin() + start, base.begin() + end);
+        run.newBytes.assign(modified.begin() + start, modified.begin() + end);
+        runs.push_back(std::move(run));
+        i = end;
+    }
+    return runs;
+}
+
+// Round-trips the spliced bytes through the parser so the result is a file the
+// editor itself would have written.
+std::optional<std::vector<std::byte>> resave(std::string_view fileName,
+                                             std::span<const std::byte> data) {
+    std::string ext = lowerExtension(fileName);
+    if (ext == ".stg") {
+        StgFormat stg;
+        if (!stg.load(data)) return std::nullopt;
+        return stg.save();
+    }
+    if (ext == ".sox") {
+        SoxBinary sox;
+        if (!sox.load(data)) return std::nullopt;
+        return sox.save();
+    }
+    return std::nullopt;
+}
+
+class PatchWriter {
+public:
+    void u8(uint8_t v) { out_.push_back(static_cast<std::byte>(v)); }
+
+    void u32(uint32_t v) {
+        size_t pos = out_.size();
+        out_.resize(pos + 4);
+        std::memcpy(out_.data() + pos, &v, 4);
+    }
+
+    void u64(uint64_t v) {
+        size_t pos = out_.size();
+        out_.resize(pos + 8);
+        std::memcpy(out_.data() + pos, &v, 8);
+    }
+
+    void bytes(const void* data, size_t size) {
+        const auto* p = static_cast<const std::byte*>(data);
+        out_.insert(out_.end(), p, p + size);
+    }
+
+    void blob(const std::vector<std::byte>& data) {
+        u32(static_cast<uint32_t>(data.size()));
+        bytes(data.data(), data.size());
+    }
+
+    std::vector<std::byte> take() { return std::move(out_); }
+
+private:
+    std::vector<std::byte> out_;
+};
+
+class PatchReader {
+public:
+    explicit PatchReader(std::span<const std::byte> data) : data_(data) {}
+
+    bool u8(uint8_t& v) { return read(&v, 1); }
+    bool u32(uint32_t& v) { return read(&v, 4); }
+    bool u64(uint64_t& v) { return read(&v, 8); }
+
+    bool bytes(std::vector<std::byte>& out, size_t size) {
+        if (data_.size() - pos_ < size) return false;
+        out.assign(data_.begin() + pos_, data_.begin() + pos_ + size);
+        pos_ += size;
+        return true;
+    }
+
+    bool blob(std::vector<std::byte>& out) {
+        uint32_t size = 0;
+        return u32(size) && bytes(out, size);
+    }
+
+    bool string(std::string& out) {
+        uint32_t size = 0;
+        if (!u32(size) || data_.size() - pos_ < size) return false;
+        out.assign(reinterpret_cast<const char*>(data_.data() + pos_), size);
+        pos_ += size;
+        return true;
+    }
+
+    bool atEnd() const { return pos_ == data_.size(); }
+
+private:
+    bool read(void* out, size_t size) {
+        if (data_.size() - pos_ < size) return false;
+        std::memcpy(out, data_.data() + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    std::span<const std::byte> data_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
+std::optional<RecordPatch> diffRecordPatch(std::string_view fileName,
+                                           std::span<const std::byte> base,
+                                           std::span<const std::byte> modified) {
+    auto baseSpans = recordLayout(fileName, base);
+    auto modifiedSpans = recordLayout(fileName, modified);
+    if (!baseSpans || !modifiedSpans || baseSpans->size() != modifiedSpans->size()) {
+        return std::nullopt;
+    }
+
+    RecordPatch patch;
+    for (size_t i = 0; i < baseSpans->size(); ++i) {
+        const auto& b = (*baseSpans)[i];
+        const auto& m = (*modifiedSpans)[i];
+        if (b.key != m.key) return std::nullopt;
+
+        auto baseBytes = base.subspan(b.offset, b.size);
+        auto modifiedBytes = modified.subspan(m.offset, m.size);
+        if (b.size == m.size &&
+            std::equal(baseBytes.begin(), baseBytes.end(), modifiedBytes.begin())) {
+            continue;
+        }
+
+        RecordPatchEdit edit;
+        edit.key = b.key;
+        edit.baseHash = hash64(baseBytes);
+        if (b.size == m.size) {
+            edit.runs = diffRuns(baseBytes, modifiedBytes);
+        } else {
+            edit.replace = true;
+            edit.replacement.assign(modifiedBytes.begin(), modifiedBytes.end());
+        }
+        patch.edits.push_back(std::move(edit));
+    }
+
+    // Section counts and block headers sit between records; if those changed
+    // the patch cannot reproduce the file, so prove it does.
+    auto check = applyRecordPatch(fileName, base, patch);
+    auto* rebuilt = std::get_if<std::vector<std::byte>>(&check);
+    if (!rebuilt || rebuilt->size() != modified.size() ||
+        !std::equal(rebuilt->begin(), rebuilt->end(), modified.begin())) {
+        return std::nullopt;
+    }
+    return patch;
+}
+
+std::variant<std::vector<std::byte>, std::string> applyRecordPatch(
+    std::string_view fileName, std::span<const std::byte> current, const RecordPatch& patch) {
+    auto spans = recordLayout(fileName, current);
+    if (!spans) return std::string("File is not a troop SOX or STG file");
+
+    std::unordered_map<std::string_view, const RecordSpan*> byKey;
+    for (const auto& span : *spans) {
+        byKey.emplace(span.key, &span);
+    }
+
+    // Validate every edit before changing anything, and order them by offset
+    // so the file can be rebuilt in one pass.
+    std::vector<std::pair<const RecordSpan*, const RecordPatchEdit*>> ordered;
+    ordered.reserve(patch.edits.size());
+    for (const auto& edit : patch.edits) {
+        auto it = byKey.find(edit.key);
+        if (it == byKey.end()) return "Record " + edit.key + " not found";
+
+        const RecordSpan& span = *it->second;
+        auto record = current.subspan(span.offset, span.size);
+        if (hash64(record) != edit.baseHash) {
+            // The record differs from the patch's base; accept it only if it
+            // already holds the patched bytes (patch applied twice).
+            bool alreadyApplied = edit.replace
+                ? std::equal(record.begin(), record.end(), edit.replacement.begin(),
+                             edit.replacement.end())
+                : !edit.runs.empty();
+            for (const auto& run : edit.runs) {
+                if (run.offset + run.newBytes.size() > record.size() ||
+                    !std::equal(run.newBytes.begin(), run.newBytes.end(),
+                                record.begin() + run.offset)) {
+                    alreadyApplied = false;
+                    break;
+                }
+            }
+            if (alreadyApplied) continue;
+            return "Record " + edit.key + " was changed by something else";
+        }
+        for (const auto& run : edit.runs) {
+            if (run.offset + run.oldBytes.size() > record.size() ||
+                run.oldBytes.size() != run.newBytes.size()) {
+                return "Patch for " + edit.key + " does not fit the record";
+            }
+        }
+        ordered.emplace_back(&span, &edit);
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const auto& a, const auto& b) { return a.first->offset < b.first->offset; });
+
+    std::vector<std::byte> out;
+    out.reserve(current.size());
+    size_t pos = 0;
+    for (const auto& [span, edit] : ordered) {
+        out.insert(out.end(), current.begin() + pos, current.begin() + span->offset);
+        if (edit->replace) {
+            out.insert(out.end(), edit->replacement.begin(), edit->replacement.end());
+        } else {
+            size_t recordStart = out.size();
+            out.insert(out.end(), current.begin() + span->offset,
+                       current.begin() + span->offset + span->size);
+            for (const auto& run : edit->runs) {
+                std::copy(run.newBytes.begin(), run.newBytes.end(),
+                          out.begin() + recordStart + run.offset);
+            }
+        }
+        pos = span->offset + span->size;
+    }
+    out.insert(out.end(), current.begin() + pos, current.end());
+
+    auto saved = resave(fileName, out);
+    if (!saved) return std::string("Patched file failed to load");
+    return std::move(*saved);
+}
+
+std::vector<std::byte> serializeRecordPatch(const RecordPatch& patch) {
+    PatchWriter w;
+    w.bytes(kPatchMagic, sizeof(kPatchMagic));
+    w.u32(kPatchVersion);
+    w.u32(static_cast<uint32_t>(patch.edits.size()));
+    for (const auto& edit : patch.edits) {
+        w.u32(static_cast<uint32_t>(edit.key.size()));
+        w.bytes(edit.key.data(), edit.key.size());
+        w.u64(edit.baseHash);
+        w.u8(edit.replace ? 1 : 0);
+        if (edit.replace) {
+            w.blob(edit.replacement);
+            continue;
+        }
+        w.u32(static_cast<uint32_t>(edit.runs.size()));
+        for (const auto& run : edit.runs) {
+            w.u32(run.offset);
+            w.u32(static_cast<uint32_t>(run.newBytes.size()));
+            w.bytes(run.oldBytes.data(), run.oldBytes.size());
+            w.bytes(run.newBytes.data(), run.newBytes.size());
+        }
+    }
+    return w.take();
+}
+
+std::optional<RecordPatch> parseRecordPatch(std::span<const std::byte> data) {
+    if (data.size() < sizeof(kPatchMagic) ||
+        std::memcmp(data.data(), kPatchMagic, sizeof(kPatchMagic)) != 0) {
+        return std::nullopt;
+    }
+
+    PatchReader r(data.subspan(sizeof(kPatchMagic)));
+    uint32_t version = 0;
+    uint32_t editCount = 0;
+    if (!r.u32(version) || version != kPatchVersion || !r.u32(editCount)) return std::nullopt;
+
+    RecordPatch patch;
+    for (uint32_t e = 0; e < editCount; ++e) {
+        RecordPatchEdit edit;
+        uint8_t replace = 0;
+        if (!r.string(edit.key) || !r.u64(edit.baseHash) || !r.u8(replace)) return std::nullopt;
+        edit.replace = replace != 0;
+
+        if (edit.replace) {
+            if (!r.blob(edit.replacement)) return std::nullopt;
+        } else {
+            uint32_t runCount = 0;
+            if (!r.u32(runCount)) return std::nullopt;
+            for (uint32_t i = 0; i < runCount; ++i) {
+                RecordPatchRun run;
+                uint32_t size = 0;
+                if (!r.u32(run.offset) || !r.u32(size) || !r.bytes(run.oldBytes, size) ||
+                    !r.bytes(run.newBytes, size)) {
+                    return std::nullopt;
+                }
+                edit.runs.push_back(std::move(run));
+            }
+        }
+        patch.edits.push_back(std::move(edit));
+    }
+
+    if (!r.atEnd()) return std::nullopt;
+    return patch;
+}
+
+} // namespace kuf
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace kuf {
+
+// Changed bytes inside one record, with the bytes they replace. Offsets are
+// relative to the start of the record.
+struct RecordPatchRun {
+    uint32_t offset = 0;
+    std::vector<std::byte> oldBytes;
+    std::vector<std::byte> newBytes;
+};
+
+// Edit to one record, located by key (see recordLayout). A record that kept its
+// size is patched in place by runs; one that grew or shrank (STG variables and
+// events) is replaced whole.
+struct RecordPatchEdit {
+    std::string key;
+    uint64_t baseHash = 0; // Hash of the record in the file the patch was made from.
+    bool replace = false;
+    std::vector<RecordPatchRun> runs;
+    std::vector<std::byte> replacement;
+};
+
+// Record-level delta between two versions of a troop SOX or STG file.
+struct RecordPatch {
+    std::vector<RecordPatchEdit> edits;
+};
+
+// Computes a patch turning base into modified. Returns nullopt when the files
+// cannot be patched record by record: unsupported format, records added or
+// removed, or changes outside any record.
+std::optional<RecordPatch> diffRecordPatch(std::string_view fileName,
+                                           std::span<const std::byte> base,
+                                           std::span<const std::byte> modified);
+
+// Applies a patch to the current file contents. Each edited record must still
+// match the version the patch was made from; records the patch does not touch
+// may differ, so patches editing different records of one file compose. The
+// result is reloaded and re-saved through the format parser.
+std::variant<std::vector<std::byte>, std::string> applyRecordPatch(
+    std::string_view fileName, std::span<const std::byte> current, const RecordPatch& patch);
+
+std::vector<std::byte> serializeRecordPatch(const RecordPatch& patch);
+std::optional<RecordPatch> parseRecordPatch(std::span<const std::byte> data);
+
+} // namespace kuf
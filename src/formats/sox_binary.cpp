@@ -1,4 +1,5 @@
 #include "formats/sox_binary.h"
+#include "core/profiler.h"
 
 #include <cstring>
 
@@ -35,6 +36,7 @@ constexpr size_t FOOTER_SIZE = 64;
 } // namespace
 
 bool SoxBinary::load(std::span<const std::byte> data) {
+    KUF_PROFILE_ZONE("SoxBinary::load");
     if (data.size() < HEADER_SIZE) {
         return false;
     }
@@ -106,6 +108,7 @@ bool SoxBinary::load(std::span<const std::byte> data) {
 }
 
 std::vector<std::byte> SoxBinary::save() const {
+    KUF_PROFILE_ZONE("SoxBinary::save");
     std::vector<std::byte> data;
     data.resize(HEADER_SIZE + troops_.size() * TROOP_RECORD_SIZE + FOOTER_SIZE);
 
@@ -161,6 +164,7 @@ std::vector<std::byte> SoxBinary::save() const {
 }
 
 std::vector<ValidationIssue> SoxBinary::validate() const {
+    KUF_PROFILE_ZONE("SoxBinary::validate");
     std::vector<ValidationIssue> issues;
 
     for (size_t i = 0; i < troops_.size(); ++i) {
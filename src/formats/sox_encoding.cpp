@@ -1,4 +1,5 @@
 #include "formats/sox_encoding.h"
+#include "core/profiler.h"
 
 #include <cctype>
 #include <cstdint>
@@ -22,6 +23,7 @@ char intToHexChar(int v) {
 } // namespace
 
 std::optional<std::vector<std::byte>> soxDecode(std::span<const std::byte> encoded) {
+    KUF_PROFILE_ZONE("soxDecode");
     if (encoded.size() % 2 != 0) {
         return std::nullopt;
     }
@@ -44,6 +46,7 @@ std::optional<std::vector<std::byte>> soxDecode(std::span<const std::byte> encod
 }
 
 std::vector<std::byte> soxEncode(std::span<const std::byte> decoded) {
+    KUF_PROFILE_ZONE("soxEncode");
     std::vector<std::byte> encoded;
     encoded.reserve(decoded.size() * 2);
 
@@ -1,4 +1,5 @@
 #include "formats/sox_skill_info.h"
+#include "core/profiler.h"
 
 #include <cstring>
 
@@ -24,6 +25,7 @@ constexpr size_t FOOTER_SIZE = 64;
 } // namespace
 
 bool SoxSkillInfo::load(std::span<const std::byte> data) {
+    KUF_PROFILE_ZONE("SoxSkillInfo::load");
     if (data.size() < HEADER_SIZE + FOOTER_SIZE) {
         return false;
     }
@@ -86,6 +88,7 @@ bool SoxSkillInfo::load(std::span<const std::byte> data) {
 }
 
 std::vector<std::byte> SoxSkillInfo::save() const {
+    KUF_PROFILE_ZONE("SoxSkillInfo::save");
     // Calculate total size.
     size_t dataSize = HEADER_SIZE;
     for (const auto& skill : skills_) {
@@ -130,6 +133,7 @@ std::vector<std::byte> SoxSkillInfo::save() const {
 }
 
 std::vector<ValidationIssue> SoxSkillInfo::validate() const {
+    KUF_PROFILE_ZONE("SoxSkillInfo::validate");
     std::vector<ValidationIssue> issues;
 
     for (size_t i = 0; i < skills_.size(); ++i) {
@@ -14,6 +14,8 @@ struct SkillInfo {
     std::string iconPath;
     uint32_t skillType;
     uint32_t maxLevel;
+
+    bool operator==(const SkillInfo&) const = default;
 };
 
 class SoxSkillInfo : public IFileFormat {
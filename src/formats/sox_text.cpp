@@ -1,4 +1,5 @@
 #include "formats/sox_text.h"
+#include "core/profiler.h"
 
 #include <algorithm>
 #include <cstdint>
@@ -15,12 +16,49 @@ T readLE(const std::byte* data) {
     return value;
 }
 
+template<typename T>
+void writeLE(std::byte* data, T value) {
+    std::memcpy(data, &value, sizeof(T));
+}
+
 constexpr size_t HEADER_SIZE = 8;
+constexpr size_t ENTRY_HEADER_SIZE = 6; // 4-byte index + 2-byte length.
+
+// True when reject(c) is false for every byte. Works in fixed-size blocks
+// so the inner loop has a constant trip count and vectorizes even at -O2.
+template<typename Reject>
+bool noneOf(std::string_view text, Reject reject) {
+    constexpr size_t kBlock = 64;
+    const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+    size_t i = 0;
+    for (; i + kBlock <= text.size(); i += kBlock) {
+        unsigned char bad = 0;
+        for (size_t j = 0; j < kBlock; ++j) bad |= reject(p[i + j]);
+        if (bad) return false;
+    }
+    unsigned char bad = 0;
+    for (; i < text.size(); ++i) bad |= reject(p[i]);
+    return bad == 0;
+}
+
+// Printable ASCII plus tab, newline and carriage return.
+unsigned char notLoadableText(unsigned char c) {
+    unsigned char printable = static_cast<unsigned char>(c - 32) < 95;
+    unsigned char space = (c == '\t') | (c == '\n') | (c == '\r');
+    return static_cast<unsigned char>((printable | space) ^ 1);
+}
+
+// Control characters other than NUL, and anything outside 7-bit ASCII.
+unsigned char nonPrintable(unsigned char c) {
+    unsigned char printable = static_cast<unsigned char>(c - 32) < 95;
+    return static_cast<unsigned char>((printable | (c == 0)) ^ 1);
+}
 
 } // namespace
 
 bool SoxText::load(std::span<const std::byte> data) {
-    if (data.size() < HEADER_SIZE) {
+    KUF_PROFILE_ZONE("SoxText::load");
+    if (data.size() < HEADER_SIZE || data.size() > UINT32_MAX) {
         return false;
     }
 
@@ -30,26 +68,34 @@ bool SoxText::load(std::span<const std::byte> data) {
         return false;
     }
 
+    // No upper bound on the count: merged localization tables run to
+    // hundreds of thousands of entries. A corrupt count costs nothing, since
+    // the loop stops at the end of the data.
     int32_t count = readLE<int32_t>(data.data() + 4);
-    if (count < 0 || count > 10000) {
+    if (count < 0) {
         return false;
     }
 
+    // Every entry takes at least 7 bytes, which bounds the index without
+    // trusting the header.
+    size_t expected = std::min(static_cast<size_t>(count), (data.size() - HEADER_SIZE) / (ENTRY_HEADER_SIZE + 1));
     entries_.clear();
+    pool_.clear();
+    poolGarbage_ = 0;
+    entries_.reserve(expected);
+    pool_.reserve(data.size() - HEADER_SIZE - expected * ENTRY_HEADER_SIZE);
     size_t offset = HEADER_SIZE;
 
     // Each entry: 4-byte index + 2-byte length (LE) + text bytes.
-    while (offset + 6 <= data.size() && entries_.size() < static_cast<size_t>(count)) {
+    while (offset + ENTRY_HEADER_SIZE <= data.size() && entries_.size() < static_cast<size_t>(count)) {
         // Skip 4-byte index.
-        offset += 4;
-
-        // Read 2-byte length.
-        uint16_t textLen = readLE<uint16_t>(data.data() + offset);
-        offset += 2;
+        uint16_t textLen = readLE<uint16_t>(data.data() + offset + 4);
+        offset += ENTRY_HEADER_SIZE;
 
         // Reject entries with zero length.
         if (textLen == 0) {
             entries_.clear();
+            pool_.clear();
             return false;
         }
 
@@ -57,69 +103,96 @@ bool SoxText::load(std::span<const std::byte> data) {
             break;
         }
 
-        TextEntry entry;
-        entry.maxLength = textLen;
-
-        const char* textStart = reinterpret_cast<const char*>(data.data() + offset);
-        entry.text = std::string(textStart, textLen);
-
-        // Validate text is printable ASCII (plus common whitespace).
-        for (char c : entry.text) {
-            if (c != '\t' && c != '\n' && c != '\r' && (c < 32 || c > 126)) {
-                entries_.clear();
-                return false;
-            }
-        }
-
-        entries_.push_back(std::move(entry));
+        entries_.push_back({static_cast<uint32_t>(pool_.size()), textLen, textLen});
+        pool_.append(reinterpret_cast<const char*>(data.data() + offset), textLen);
         offset += textLen;
     }
 
+    // Validate text is printable ASCII (plus common whitespace), in one pass
+    // over the whole pool.
+    if (!noneOf(pool_, notLoadableText)) {
+        entries_.clear();
+        pool_.clear();
+        return false;
+    }
+
     version_ = GameVersion::Crusaders;
     return !entries_.empty();
 }
 
 std::vector<std::byte> SoxText::save() const {
-    std::vector<std::byte> data;
+    KUF_PROFILE_ZONE("SoxText::save");
+    size_t size = HEADER_SIZE + entries_.size() * ENTRY_HEADER_SIZE;
+    for (const auto& entry : entries_) size += entry.length;
 
-    // Write header.
-    int32_t version = 100;
-    int32_t count = static_cast<int32_t>(entries_.size());
-    data.resize(HEADER_SIZE);
-    std::memcpy(data.data(), &version, sizeof(version));
-    std::memcpy(data.data() + 4, &count, sizeof(count));
+    std::vector<std::byte> data(size);
+    std::byte* out = data.data();
+    writeLE<int32_t>(out, 100);
+    writeLE<int32_t>(out + 4, static_cast<int32_t>(entries_.size()));
+    out += HEADER_SIZE;
 
     for (size_t i = 0; i < entries_.size(); ++i) {
         const auto& entry = entries_[i];
+        writeLE<int32_t>(out, static_cast<int32_t>(i));
+        writeLE<uint16_t>(out + 4, entry.length);
+        std::memcpy(out + ENTRY_HEADER_SIZE, pool_.data() + entry.offset, entry.length);
+        out += ENTRY_HEADER_SIZE + entry.length;
+    }
+
+    return data;
+}
 
-        // Write 4-byte index.
-        int32_t index = static_cast<int32_t>(i);
-        size_t pos = data.size();
-        data.resize(pos + 4);
-        std::memcpy(data.data() + pos, &index, sizeof(index));
-
-        // Write 2-byte length.
-        uint16_t textLen = static_cast<uint16_t>(entry.text.size());
-        pos = data.size();
-        data.resize(pos + 2);
-        std::memcpy(data.data() + pos, &textLen, sizeof(textLen));
-
-        // Write text bytes.
-        for (char c : entry.text) {
-            data.push_back(static_cast<std::byte>(c));
+void SoxText::setText(size_t index, std::string_view text) {
+    text = text.substr(0, UINT16_MAX);
+    auto& entry = entries_[index];
+
+    if (text.size() <= entry.length) {
+        // memmove: text may be a view of this very entry.
+        std::memmove(pool_.data() + entry.offset, text.data(), text.size());
+        poolGarbage_ += entry.length - text.size();
+    } else {
+        // Appending may reallocate the pool, so copy a view into it first.
+        std::string copy;
+        if (text.data() >= pool_.data() && text.data() < pool_.data() + pool_.size()) {
+            copy = std::string(text);
+            text = copy;
         }
+        poolGarbage_ += entry.length;
+        entry.offset = static_cast<uint32_t>(pool_.size());
+        pool_.append(text);
     }
+    entry.length = static_cast<uint16_t>(text.size());
 
-    return data;
+    if (poolGarbage_ > 4096 && poolGarbage_ > pool_.size() / 2) {
+        compactPool();
+    }
+}
+
+void SoxText::compactPool() {
+    std::string compacted;
+    compacted.reserve(pool_.size() - poolGarbage_);
+    for (auto& entry : entries_) {
+        uint32_t offset = static_cast<uint32_t>(compacted.size());
+        compacted.append(pool_, entry.offset, entry.length);
+        entry.offset = offset;
+    }
+    pool_ = std::move(compacted);
+    poolGarbage_ = 0;
 }
 
 std::vector<ValidationIssue> SoxText::validate() const {
+    KUF_PROFILE_ZONE("SoxText::validate");
     std::vector<ValidationIssue> issues;
 
+    // One pass over the pool usually rules out every entry at once. Only when
+    // it finds something (possibly in bytes no entry uses any more) is each
+    // entry checked on its own.
+    bool poolPrintable = noneOf(pool_, nonPrintable);
+
     for (size_t i = 0; i < entries_.size(); ++i) {
         const auto& entry = entries_[i];
 
-        if (entry.text.size() > entry.maxLength) {
+        if (entry.length > entry.maxLength) {
             issues.push_back({
                 Severity::Error,
                 "text",
@@ -129,16 +202,13 @@ std::vector<ValidationIssue> SoxText::validate() const {
         }
 
         // Check for non-printable characters.
-        for (char c : entry.text) {
-            if (c != '\0' && (c < 32 || c > 126)) {
-                issues.push_back({
-                    Severity::Warning,
-                    "text",
-                    "Contains non-printable characters",
-                    i
-                });
-                break;
-            }
+        if (!poolPrintable && !noneOf(text(i), nonPrintable)) {
+            issues.push_back({
+                Severity::Warning,
+                "text",
+                "Contains non-printable characters",
+                i
+            });
         }
     }
 
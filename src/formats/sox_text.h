@@ -3,16 +3,25 @@
 #include "formats/file_format.h"
 
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace kuf {
 
+// Where one entry's text lives in the string pool.
 struct TextEntry {
-    uint16_t maxLength;
-    std::string text;
+    uint32_t offset = 0;
+    uint16_t length = 0;
+    uint16_t maxLength = 0;
 };
 
+// Text SOX tables, of any entry count. load copies every entry's text into one
+// pool and checks it up front rather than decoding on access: the printable
+// check is what tells text SOX files from binary ones during detection, and
+// the format does not own the loaded bytes. Memory is the file's size plus 8
+// bytes per entry; views clip the UI's cost to the visible rows instead.
 class SoxText : public IFileFormat {
 public:
     bool load(std::span<const std::byte> data) override;
@@ -22,10 +31,26 @@ public:
     std::vector<ValidationIssue> validate() const override;
 
     size_t entryCount() const { return entries_.size(); }
-    const std::vector<TextEntry>& entries() const { return entries_; }
-    std::vector<TextEntry>& entries() { return entries_; }
+    std::span<const TextEntry> entries() const { return entries_; }
+
+    // Views into the pool stay valid until the next setText.
+    std::string_view text(size_t index) const {
+        const auto& entry = entries_[index];
+        return std::string_view(pool_.data() + entry.offset, entry.length);
+    }
+    uint16_t maxLength(size_t index) const { return entries_[index].maxLength; }
+
+    // Replaces an entry's text. Texts longer than the 16-bit length field
+    // allows are truncated.
+    void setText(size_t index, std::string_view text);
 
 private:
+    void compactPool();
+
+    // Every entry's text back to back; edited texts are appended and the old
+    // bytes left behind until compactPool.
+    std::string pool_;
+    size_t poolGarbage_ = 0;
     std::vector<TextEntry> entries_;
     GameVersion version_ = GameVersion::Unknown;
 };
@@ -0,0 +1,212 @@
+#include "formats/stg_corpus.h"
+#include "core/file_io.h"
+#include "core/mapped_file.h"
+#include "core/worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+namespace kuf {
+
+namespace {
+
+// Outcome of parsing one file, filled in on a worker thread.
+struct ParseSlot {
+    StgFormat stg;
+    std::string error;
+    bool ok = false;
+};
+
+} // namespace
+
+int32_t effectiveTroopInfoIndex(const StgUnit& unit) {
+    if (unit.troopInfoIndex >= 0) return unit.troopInfoIndex;
+    switch (unit.formationType) {
+        case 1: return 0;
+        case 2: return 3;
+        case 3: return 7;
+        case 4: return 9;
+        case 5: return 16;
+        case 6: return 26;
+        case 7: return 12;
+        case 8: return 35;
+        case 9: return 13;
+        case 10: return 19;
+        case 11: return 10;
+        case 12: return 37;
+        case 13: return 18;
+        case 14: return 6;
+        case 15: return 29;
+        case 0x20: return 17;
+        case 0x21: return 14;
+        case 0x23: return 30;
+        case 0x24: return 40;
+        case 0x25: return 41;
+        case 0x26: return 42;
+        case 0x27: return 42;
+        default: return 2;
+    }
+}
+
+size_t StgCorpus::load(const std::string& dir, const ProgressFn& onProgress) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    fs::path root(dir);
+    for (auto it = fs::recursive_directory_iterator(root, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file(ec) && lowerExtension(it->path().string()) == ".stg") {
+            paths.push_back(it->path().lexically_relative(root).generic_string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    // Missions are a few hundred KiB at most; mapping them avoids a copy and
+    // lets the parser read straight from the page cache.
+    parseAll(paths, [&](size_t i, StgFormat& out, std::string& error) {
+        MappedFile file;
+        if (!file.open((root / paths[i]).string())) {
+            error = "Failed to read file";
+            return false;
+        }
+        if (!out.load(file.data())) {
+            error = "Not a valid STG file";
+            return false;
+        }
+        return true;
+    }, onProgress);
+    return missions_.size();
+}
+
+size_t StgCorpus::loadFromMemory(const std::vector<std::pair<std::string, std::vector<std::byte>>>& files) {
+    std::vector<std::string> paths;
+    paths.reserve(files.size());
+    for (const auto& f : files) paths.push_back(f.first);
+
+    parseAll(paths, [&](size_t i, StgFormat& out, std::string& error) {
+        if (!out.load(files[i].second)) {
+            error = "Not a valid STG file";
+            return false;
+        }
+        return true;
+    }, {});
+    return missions_.size();
+}
+
+void StgCorpus::clear() {
+    missions_.clear();
+    failures_.clear();
+    troopIndex_.clear();
+    variableIndex_.clear();
+    heroes_.clear();
+    totalUnits_ = 0;
+    totalEvents_ = 0;
+}
+
+void StgCorpus::parseAll(std::vector<std::string> paths,
+                         const std::function<bool(size_t, StgFormat&, std::string&)>& parse,
+                         const ProgressFn& onProgress) {
+    clear();
+
+    std::vector<ParseSlot> slots(paths.size());
+    std::atomic<size_t> done{0};
+    WorkerPool::shared().parallelFor(paths.size(), [&](size_t i) {
+        slots[i].ok = parse(i, slots[i].stg, slots[i].error);
+        size_t finished = done.fetch_add(1) + 1;
+        if (onProgress) onProgress(finished, paths.size());
+    });
+
+    missions_.reserve(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!slots[i].ok) {
+            failures_.push_back({std::move(paths[i]), std::move(slots[i].error)});
+            continue;
+        }
+        StgCorpusMission mission;
+        mission.path = std::move(paths[i]);
+        mission.stg = std::move(slots[i].stg);
+        mission.eventCount = mission.stg.totalEventCount();
+        missions_.push_back(std::move(mission));
+    }
+
+    // findMission() searches by path.
+    std::sort(missions_.begin(), missions_.end(),
+              [](const StgCorpusMission& a, const StgCorpusMission& b) { return a.path < b.path; });
+    buildIndex();
+}
+
+void StgCorpus::buildIndex() {
+    std::map<std::pair<uint8_t, uint8_t>, std::vector<StgUnitRef>> heroes;
+
+    for (uint32_t m = 0; m < missions_.size(); ++m) {
+        const auto& stg = missions_[m].stg;
+        const auto& units = stg.units();
+        for (uint32_t u = 0; u < units.size(); ++u) {
+            StgUnitRef ref{m, u};
+            troopIndex_[effectiveTroopInfoIndex(units[u])].push_back(ref);
+            if (units[u].isHero) {
+                heroes[{units[u].leaderJobType, units[u].leaderModelId}].push_back(ref);
+            }
+        }
+        totalUnits_ += units.size();
+        totalEvents_ += missions_[m].eventCount;
+
+        // A mission lists each variable once, but guard against repeats so the
+        // mission lists stay unique.
+        for (const auto& var : stg.variables()) {
+            auto& list = variableIndex_[var.name];
+            if (list.empty() || list.back() != m) list.push_back(m);
+        }
+    }
+
+    heroes_.reserve(heroes.size());
+    for (auto& [key, refs] : heroes) {
+        heroes_.push_back({key.first, key.second, std::move(refs)});
+    }
+}
+
+const StgCorpusMission* StgCorpus::findMission(std::string_view path) const {
+    auto it = std::lower_bound(missions_.begin(), missions_.end(), path,
+                               [](const StgCorpusMission& m, std::string_view p) { return m.path < p; });
+    if (it == missions_.end() || it->path != path) return nullptr;
+    return &*it;
+}
+
+std::span<const StgUnitRef> StgCorpus::unitsWithTroop(int32_t troopInfoIndex) const {
+    auto it = troopIndex_.find(troopInfoIndex);
+    if (it == troopIndex_.end()) return {};
+    return it->second;
+}
+
+std::vector<int32_t> StgCorpus::troopTypes() const {
+    std::vector<int32_t> types;
+    types.reserve(troopIndex_.size());
+    for (const auto& [index, refs] : troopIndex_) types.push_back(index);
+    return types;
+}
+
+std::vector<uint32_t> StgCorpus::missionsWithTroop(int32_t troopInfoIndex) const {
+    std::vector<uint32_t> result;
+    for (const auto& ref : unitsWithTroop(troopInfoIndex)) {
+        if (result.empty() || result.back() != ref.mission) result.push_back(ref.mission);
+    }
+    return result;
+}
+
+std::span<const uint32_t> StgCorpus::missionsWithVariable(std::string_view name) const {
+    auto it = variableIndex_.find(name);
+    if (it == variableIndex_.end()) return {};
+    return it->second;
+}
+
+std::vector<std::string> StgCorpus::variableNames() const {
+    std::vector<std::string> names;
+    names.reserve(variableIndex_.size());
+    for (const auto& [name, missions] : variableIndex_) names.push_back(name);
+    return names;
+}
+
+} // namespace kuf
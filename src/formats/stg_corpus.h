@@ -0,0 +1,108 @@
+#pragma once
+
+#include "formats/stg_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace kuf {
+
+// One parsed mission. path is relative to the directory the corpus was loaded
+// from, with forward slashes.
+struct StgCorpusMission {
+    std::string path;
+    StgFormat stg;
+    size_t eventCount = 0;
+};
+
+struct StgCorpusFailure {
+    std::string path;
+    std::string error;
+};
+
+// A unit in one mission of the corpus.
+struct StgUnitRef {
+    uint32_t mission = 0; // Index into StgCorpus::missions().
+    uint32_t unit = 0;    // Index into that mission's units().
+};
+
+// Every placement of one hero. Heroes are told apart by leader job type and
+// model id, the pair the game uses to pick the character.
+struct StgHeroAppearances {
+    uint8_t jobType = 0;
+    uint8_t modelId = 0;
+    std::vector<StgUnitRef> units;
+};
+
+// TroopInfo index the game uses for a unit. A negative troopInfoIndex falls
+// back to a per-formation default (GetDefaultTroopInfoIndex at 0x004b4520).
+int32_t effectiveTroopInfoIndex(const StgUnit& unit);
+
+// All STG missions under a game directory, parsed once and kept resident with
+// a cross-mission index of troop types, heroes and variable names. Loading
+// parses files on the shared worker pool; queries are lookups in prebuilt maps.
+class StgCorpus {
+public:
+    // Called with (files done, file count) from whichever thread finished a file.
+    using ProgressFn = std::function<void(size_t done, size_t total)>;
+
+    // Finds every .stg file below dir and parses them in parallel, replacing
+    // anything loaded before. Returns the number of missions loaded.
+    size_t load(const std::string& dir, const ProgressFn& onProgress = {});
+
+    // Same as load() for files already in memory, as (relative path, bytes).
+    size_t loadFromMemory(const std::vector<std::pair<std::string, std::vector<std::byte>>>& files);
+
+    void clear();
+
+    const std::vector<StgCorpusMission>& missions() const { return missions_; }
+    const std::vector<StgCorpusFailure>& failures() const { return failures_; }
+    const StgCorpusMission* findMission(std::string_view path) const;
+    size_t totalUnitCount() const { return totalUnits_; }
+    size_t totalEventCount() const { return totalEvents_; }
+
+    // Units whose effective TroopInfo index is troopInfoIndex.
+    std::span<const StgUnitRef> unitsWithTroop(int32_t troopInfoIndex) const;
+
+    // Distinct effective TroopInfo indices in use, ascending.
+    std::vector<int32_t> troopTypes() const;
+
+    // Missions (ascending indices) that use the troop type at least once.
+    std::vector<uint32_t> missionsWithTroop(int32_t troopInfoIndex) const;
+
+    // Hero units grouped by identity, ordered by job type then model id.
+    const std::vector<StgHeroAppearances>& heroes() const { return heroes_; }
+
+    // Missions (ascending indices) that declare a variable with this name.
+    std::span<const uint32_t> missionsWithVariable(std::string_view name) const;
+
+    // Distinct variable names across the corpus, sorted.
+    std::vector<std::string> variableNames() const;
+
+    const StgUnit& unit(const StgUnitRef& ref) const { return missions_[ref.mission].stg.units()[ref.unit]; }
+
+private:
+    // Runs parse(i, ...) for every path in parallel and keeps the successes in
+    // path order.
+    void parseAll(std::vector<std::string> paths,
+                  const std::function<bool(size_t index, StgFormat& out, std::string& error)>& parse,
+                  const ProgressFn& onProgress);
+    void buildIndex();
+
+    std::vector<StgCorpusMission> missions_;
+    std::vector<StgCorpusFailure> failures_;
+    std::map<int32_t, std::vector<StgUnitRef>> troopIndex_;
+    std::map<std::string, std::vector<uint32_t>, std::less<>> variableIndex_;
+    std::vector<StgHeroAppearances> heroes_;
+    size_t totalUnits_ = 0;
+    size_t totalEvents_ = 0;
+};
+
+} // namespace kuf
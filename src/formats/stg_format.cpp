@@ -1,5 +1,6 @@
 #include "formats/stg_format.h"
 
+#include "core/profiler.h"
 #include "core/text_encoding.h"
 
 #include <algorithm>
@@ -238,6 +239,7 @@ void StgFormat::patchUnit(StgUnit& unit) const {
 }
 
 bool StgFormat::load(std::span<const std::byte> data) {
+    KUF_PROFILE_ZONE("StgFormat::load");
     if (data.size() < kStgHeaderSize) {
         return false;
     }
@@ -275,6 +277,7 @@ bool StgFormat::load(std::span<const std::byte> data) {
 }
 
 std::vector<std::byte> StgFormat::save() const {
+    KUF_PROFILE_ZONE("StgFormat::save");
     patchHeader();
     for (auto& unit : const_cast<std::vector<StgUnit>&>(units_)) {
         patchUnit(unit);
@@ -656,6 +659,7 @@ size_t StgFormat::totalEventCount() const {
 }
 
 std::vector<ValidationIssue> StgFormat::validate() const {
+    KUF_PROFILE_ZONE("StgFormat::validate");
     std::vector<ValidationIssue> issues;
 
     for (size_t i = 0; i < units_.size(); ++i) {
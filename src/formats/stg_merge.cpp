@@ -0,0 +1,467 @@
+#include "formats/stg_merge.h"
+#include "core/profiler.h"
+#include "core/worker_pool.h"
+#include "formats/record_digest.h"
+#include "formats/stg_format.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace kuf {
+
+namespace {
+
+constexpr size_t kUnitCountOffset = 0x270;
+
+enum class Section {
+    Header,
+    Unit,
+    Area,
+    Variable,
+    Event,
+    Footer,
+    Tail,
+    Count
+};
+
+constexpr size_t kSectionCount = static_cast<size_t>(Section::Count);
+
+Section sectionOf(std::string_view key) {
+    std::string_view kind = key.substr(0, key.find_first_of(":#"));
+    if (kind == "header") return Section::Header;
+    if (kind == "unit") return Section::Unit;
+    if (kind == "area") return Section::Area;
+    if (kind == "variable") return Section::Variable;
+    if (kind == "event") return Section::Event;
+    if (kind == "footer") return Section::Footer;
+    return Section::Tail;
+}
+
+struct Item {
+    std::string_view key;
+    std::span<const std::byte> bytes;
+    size_t block = 0; // Event block, for events.
+};
+
+// One version of the mission split into records by section, in file order.
+// Items point into the caller's buffer and the spans held here.
+struct Side {
+    Side() = default;
+    Side(const Side&) = delete;
+    Side& operator=(const Side&) = delete;
+
+    StgFormat stg;
+    std::vector<RecordSpan> spans;
+    std::array<std::vector<Item>, kSectionCount> sections;
+    std::vector<uint32_t> blockHeaders;
+};
+
+std::string loadSide(std::span<const std::byte> data, Side& side, const char* name) {
+    auto layout = side.stg.load(data) ? stgRecordLayout(side.stg, data.size()) : std::nullopt;
+    if (!layout) return std::string(name) + " is not a valid STG mission";
+    side.spans = std::move(*layout);
+
+    std::vector<size_t> blockOfEvent;
+    for (size_t b = 0; b < side.stg.eventBlocks().size(); ++b) {
+        side.blockHeaders.push_back(side.stg.eventBlocks()[b].blockHeader);
+        blockOfEvent.insert(blockOfEvent.end(), side.stg.eventBlocks()[b].events.size(), b);
+    }
+
+    size_t eventIndex = 0;
+    for (const auto& span : side.spans) {
+        Section section = sectionOf(span.key);
+        Item item{span.key, data.subspan(span.offset, span.size)};
+        if (section == Section::Event) item.block = blockOfEvent[eventIndex++];
+        side.sections[static_cast<size_t>(section)].push_back(item);
+    }
+    return {};
+}
+
+bool sameBytes(std::span<const std::byte> a, std::span<const std::byte> b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+// --- field layouts ----------------------------------------------------------
+
+// A field of a fixed-size record. Derived fields are rewritten after the
+// merge and never conflict.
+struct Segment {
+    std::string name;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    bool derived = false;
+};
+
+void addArray(std::vector<Segment>& fields, const std::string& name, uint32_t offset, uint32_t stride,
+              uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        fields.push_back({name + "[" + std::to_string(i) + "]", offset + i * stride, stride});
+    }
+}
+
+// Sorts the named fields and covers the bytes between them with aligned
+// words, so unmodelled data still merges at a fine grain.
+std::vector<Segment> withGaps(std::vector<Segment> fields, uint32_t recordSize) {
+    std::sort(fields.begin(), fields.end(), [](const auto& a, const auto& b) { return a.offset < b.offset; });
+    std::vector<Segment> segments;
+    uint32_t pos = 0;
+    auto fill = [&](uint32_t end) {
+        while (pos < end) {
+            uint32_t wordEnd = std::min(end, (pos / 4 + 1) * 4);
+            char name[32];
+            std::snprintf(name, sizeof(name), "bytes[0x%x]", pos);
+            segments.push_back({name, pos, wordEnd - pos});
+            pos = wordEnd;
+        }
+    };
+    for (auto& field : fields) {
+        fill(field.offset);
+        pos = field.offset + field.size;
+        segments.push_back(std::move(field));
+    }
+    fill(recordSize);
+    return segments;
+}
+
+const std::vector<Segment>& headerSegments() {
+    static const std::vector<Segment> segments = withGaps(
+        {
+            {"formatMagic", 0x000, 4},
+            {"mapFile", 0x048, 64},
+            {"bitmapFile", 0x088, 64},
+            {"defaultCameraFile", 0x0C8, 64},
+            {"userCameraFile", 0x108, 64},
+            {"settingsFile", 0x148, 64},
+            {"skyCloudEffects", 0x188, 64},
+            {"aiScriptFile", 0x1C8, 64},
+            {"cubemapTexture", 0x20C, 64},
+            {"unitCount", kUnitCountOffset, 4, true},
+        },
+        kStgHeaderSize);
+    return segments;
+}
+
+void addOfficer(std::vector<Segment>& fields, const std::string& name, uint32_t base, uint32_t abilities) {
+    fields.push_back({name + ".jobType", base, 1});
+    fields.push_back({name + ".modelId", base + 1, 1});
+    fields.push_back({name + ".worldmapId", base + 2, 1});
+    fields.push_back({name + ".level", base + 3, 1});
+    addArray(fields, name + ".skills", base + 4, 2, 4);
+    addArray(fields, name + ".abilities", base + 12, 4, abilities);
+}
+
+const std::vector<Segment>& unitSegments() {
+    static const std::vector<Segment> segments = [] {
+        std::vector<Segment> fields = {
+            {"unitName", 0x00, 32},
+            {"uniqueId", 0x20, 4},
+            {"ucd", 0x24, 1},
+            {"isHero", 0x25, 1},
+            {"isEnabled", 0x26, 1},
+            {"leaderHpOverride", 0x28, 4},
+            {"unitHpOverride", 0x2C, 4},
+            {"positionX", 0x44, 4},
+            {"positionY", 0x48, 4},
+            {"direction", 0x4C, 1},
+            {"leaderJobType", 0x54, 1},
+            {"leaderModelId", 0x55, 1},
+            {"leaderWorldmapId", 0x56, 1},
+            {"leaderLevel", 0x57, 1},
+            {"officerCount", 0xBC, 4},
+            {"unitAnimConfig", 0x18C, 4},
+            {"gridX", 0x190, 4},
+            {"gridY", 0x194, 4},
+            {"troopInfoIndex", 0x1C0, 4},
+            {"formationType", 0x1C4, 4},
+        };
+        addArray(fields, "leaderSkills", 0x58, 2, 4);
+        addArray(fields, "leaderAbilities", 0x60, 4, 23);
+        addOfficer(fields, "officer1", 0xC0, 23);
+        addOfficer(fields, "officer2", 0x128, 19);
+        addArray(fields, "statOverrides", 0x1C8, 4, 22);
+        return withGaps(std::move(fields), kStgUnitSize);
+    }();
+    return segments;
+}
+
+const std::vector<Segment>& areaSegments() {
+    static const std::vector<Segment> segments = withGaps(
+        {
+            {"description", 0x00, 32},
+            {"areaId", 0x40, 4},
+            {"boundX1", 0x44, 4},
+            {"boundY1", 0x48, 4},
+            {"boundX2", 0x4C, 4},
+            {"boundY2", 0x50, 4},
+        },
+        kStgAreaIdEntrySize);
+    return segments;
+}
+
+// Records of these sections have a fixed layout and merge field by field;
+// the others (variables, events, footer) are replaced whole.
+const std::vector<Segment>* segmentsFor(Section section) {
+    switch (section) {
+    case Section::Header: return &headerSegments();
+    case Section::Unit: return &unitSegments();
+    case Section::Area: return &areaSegments();
+    default: return nullptr;
+    }
+}
+
+// --- merging ----------------------------------------------------------------
+
+class Merger {
+public:
+    Merger(StgMergePrefer prefer, StgMergeResult& result) : prefer_(prefer), result_(result) {}
+
+    std::vector<Item> mergeSection(Section section, const Side& base, const Side& ours, const Side& theirs);
+    std::vector<uint32_t> mergeBlockHeaders(const Side& base, const Side& ours, const Side& theirs) const;
+
+private:
+    std::span<const std::byte> mergeRecord(Section section, std::string_view key, std::span<const std::byte> base,
+                                           std::span<const std::byte> ours, std::span<const std::byte> theirs);
+
+    void conflict(std::string_view key, std::string reason, std::vector<std::string> fields = {}) {
+        result_.conflicts.push_back({std::string(key), std::move(reason), std::move(fields)});
+    }
+
+    bool preferOurs() const { return prefer_ == StgMergePrefer::Ours; }
+
+    StgMergePrefer prefer_;
+    StgMergeResult& result_;
+    // Records combined from both sides; a deque keeps earlier ones in place.
+    std::deque<std::vector<std::byte>> combined_;
+};
+
+std::span<const std::byte> Merger::mergeRecord(Section section, std::string_view key,
+                                               std::span<const std::byte> base,
+                                               std::span<const std::byte> ours,
+                                               std::span<const std::byte> theirs) {
+    if (sameBytes(theirs, base) || sameBytes(ours, theirs)) return ours;
+    if (sameBytes(ours, base)) {
+        ++result_.takenFromTheirs;
+        return theirs;
+    }
+
+    const auto* segments = segmentsFor(section);
+    if (!segments || ours.size() != base.size() || theirs.size() != base.size()) {
+        conflict(key, "changed on both sides");
+        return preferOurs() ? ours : theirs;
+    }
+
+    auto& merged = combined_.emplace_back(ours.begin(), ours.end());
+    std::vector<std::string> clashes;
+    for (const auto& segment : *segments) {
+        if (segment.derived) continue;
+        auto b = base.subspan(segment.offset, segment.size);
+        auto o = ours.subspan(segment.offset, segment.size);
+        auto t = theirs.subspan(segment.offset, segment.size);
+        if (sameBytes(t, b) || sameBytes(o, t)) continue;
+        if (!sameBytes(o, b)) {
+            clashes.push_back(segment.name);
+            if (preferOurs()) continue;
+        }
+        std::memcpy(merged.data() + segment.offset, t.data(), t.size());
+    }
+    if (clashes.empty()) {
+        ++result_.fieldMerged;
+    } else {
+        conflict(key, "changed on both sides", std::move(clashes));
+    }
+    return merged;
+}
+
+std::vector<Item> Merger::mergeSection(Section section, const Side& base, const Side& ours, const Side& theirs) {
+    const auto& b = base.sections[static_cast<size_t>(section)];
+    const auto& o = ours.sections[static_cast<size_t>(section)];
+    const auto& t = theirs.sections[static_cast<size_t>(section)];
+
+    auto indexOf = [](const std::vector<Item>& items) {
+        std::unordered_map<std::string_view, size_t> index;
+        index.reserve(items.size());
+        for (size_t i = 0; i < items.size(); ++i) index.emplace(items[i].key, i);
+        return index;
+    };
+    auto baseIndex = indexOf(b);
+    auto theirsIndex = indexOf(t);
+
+    // Ours' records in ours' order.
+    std::vector<Item> merged;
+    merged.reserve(o.size() + t.size());
+    std::unordered_set<std::string_view> kept;
+    kept.reserve(o.size() + t.size());
+    for (const auto& item : o) {
+        auto bi = baseIndex.find(item.key);
+        auto ti = theirsIndex.find(item.key);
+        if (ti != theirsIndex.end()) {
+            const auto& theirsItem = t[ti->second];
+            std::span<const std::byte> bytes = item.bytes;
+            if (bi != baseIndex.end()) {
+                bytes = mergeRecord(section, item.key, b[bi->second].bytes, item.bytes, theirsItem.bytes);
+            } else if (!sameBytes(item.bytes, theirsItem.bytes)) {
+                conflict(item.key, "added on both sides with different contents");
+                if (!preferOurs()) bytes = theirsItem.bytes;
+            }
+            merged.push_back({item.key, bytes, item.block});
+        } else if (bi == baseIndex.end()) {
+            merged.push_back(item);
+        } else if (!sameBytes(item.bytes, b[bi->second].bytes)) {
+            conflict(item.key, "changed in ours, removed in theirs");
+            if (!preferOurs()) continue;
+            merged.push_back(item);
+        } else {
+            continue; // Removed in theirs.
+        }
+        kept.insert(item.key);
+    }
+
+    // Records only theirs has, placed after the record they follow in theirs.
+    std::unordered_map<std::string_view, std::vector<Item>> followers;
+    std::vector<Item> leading;
+    std::string_view previous;
+    for (const auto& item : t) {
+        if (kept.count(item.key)) {
+            previous = item.key;
+            continue;
+        }
+        auto bi = baseIndex.find(item.key);
+        if (bi != baseIndex.end()) {
+            // Present in base but not in ours: ours removed it.
+            if (sameBytes(item.bytes, b[bi->second].bytes)) continue;
+            conflict(item.key, "removed in ours, changed in theirs");
+            if (preferOurs()) continue;
+        } else {
+            ++result_.takenFromTheirs;
+        }
+        (previous.empty() ? leading : followers[previous]).push_back(item);
+        previous = item.key;
+    }
+    if (leading.empty() && followers.empty()) return merged;
+
+    std::vector<Item> ordered;
+    ordered.reserve(merged.size() + t.size());
+    // Each item is followed by its followers, depth first. Chains of added
+    // records can be as long as the section, so the walk keeps its own stack
+    // rather than recursing.
+    std::vector<const Item*> pending;
+    auto emit = [&](const Item& root) {
+        pending.push_back(&root);
+        while (!pending.empty()) {
+            const Item* item = pending.back();
+            pending.pop_back();
+            ordered.push_back(*item);
+            auto it = followers.find(item->key);
+            if (it == followers.end()) continue;
+            for (auto f = it->second.rbegin(); f != it->second.rend(); ++f) pending.push_back(&*f);
+        }
+    };
+    for (const auto& item : leading) emit(item);
+    for (const auto& item : merged) emit(item);
+    return ordered;
+}
+
+std::vector<uint32_t> Merger::mergeBlockHeaders(const Side& base, const Side& ours, const Side& theirs) const {
+    if (ours.blockHeaders.empty()) return theirs.blockHeaders;
+    std::vector<uint32_t> headers = ours.blockHeaders;
+    if (base.blockHeaders.size() != headers.size() || theirs.blockHeaders.size() != headers.size()) {
+        return headers;
+    }
+    for (size_t i = 0; i < headers.size(); ++i) {
+        if (headers[i] == base.blockHeaders[i]) headers[i] = theirs.blockHeaders[i];
+    }
+    return headers;
+}
+
+void appendU32(std::vector<std::byte>& out, uint32_t value) {
+    size_t pos = out.size();
+    out.resize(pos + 4);
+    std::memcpy(out.data() + pos, &value, 4);
+}
+
+void appendItems(std::vector<std::byte>& out, const std::vector<Item>& items) {
+    for (const auto& item : items) out.insert(out.end(), item.bytes.begin(), item.bytes.end());
+}
+
+} // namespace
+
+std::variant<StgMergeResult, std::string> mergeStg(std::span<const std::byte> base,
+                                                   std::span<const std::byte> ours,
+                                                   std::span<const std::byte> theirs,
+                                                   StgMergePrefer prefer) {
+    KUF_PROFILE_ZONE("mergeStg");
+    Side baseSide, oursSide, theirsSide;
+    const std::array<std::span<const std::byte>, 3> inputs = {base, ours, theirs};
+    const std::array<Side*, 3> sides = {&baseSide, &oursSide, &theirsSide};
+    const std::array<const char*, 3> names = {"base", "ours", "theirs"};
+    std::array<std::string, 3> errors;
+    WorkerPool::shared().parallelFor(3, [&](size_t i) { errors[i] = loadSide(inputs[i], *sides[i], names[i]); });
+    for (const auto& error : errors) {
+        if (!error.empty()) return error;
+    }
+    bool tailParsed = oursSide.stg.tailParsed();
+    if (baseSide.stg.tailParsed() != tailParsed || theirsSide.stg.tailParsed() != tailParsed) {
+        return std::string("versions disagree on whether the event tail can be parsed");
+    }
+
+    StgMergeResult result;
+    Merger merger(prefer, result);
+    std::array<std::vector<Item>, kSectionCount> sections;
+    for (size_t s = 0; s < kSectionCount; ++s) {
+        sections[s] = merger.mergeSection(static_cast<Section>(s), baseSide, oursSide, theirsSide);
+    }
+    const auto& header = sections[static_cast<size_t>(Section::Header)];
+    const auto& units = sections[static_cast<size_t>(Section::Unit)];
+    if (header.size() != 1) return std::string("merged mission has no header");
+
+    // Sections are reassembled with the counts and block headers that
+    // recordLayout leaves between records.
+    auto& out = result.merged;
+    out.reserve(std::max({base.size(), ours.size(), theirs.size()}) * 2);
+    appendItems(out, header);
+    uint32_t unitCount = static_cast<uint32_t>(units.size());
+    std::memcpy(out.data() + kUnitCountOffset, &unitCount, 4);
+    appendItems(out, units);
+
+    if (tailParsed) {
+        const auto& areas = sections[static_cast<size_t>(Section::Area)];
+        const auto& variables = sections[static_cast<size_t>(Section::Variable)];
+        const auto& events = sections[static_cast<size_t>(Section::Event)];
+        appendU32(out, static_cast<uint32_t>(areas.size()));
+        appendItems(out, areas);
+        appendU32(out, static_cast<uint32_t>(variables.size()));
+        appendItems(out, variables);
+
+        // Events keep the block they are in on the side they came from,
+        // clamped to the blocks the merged file has.
+        auto blockHeaders = merger.mergeBlockHeaders(baseSide, oursSide, theirsSide);
+        if (blockHeaders.empty() && !events.empty()) blockHeaders.push_back(0);
+        std::vector<std::vector<Item>> blocks(blockHeaders.size());
+        for (const auto& event : events) {
+            blocks[std::min(event.block, blocks.size() - 1)].push_back(event);
+        }
+        appendU32(out, static_cast<uint32_t>(blocks.size()));
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            appendU32(out, blockHeaders[i]);
+            appendU32(out, static_cast<uint32_t>(blocks[i].size()));
+            appendItems(out, blocks[i]);
+        }
+        appendItems(out, sections[static_cast<size_t>(Section::Footer)]);
+    } else {
+        appendItems(out, sections[static_cast<size_t>(Section::Tail)]);
+    }
+
+    StgFormat check;
+    if (!check.load(out) || check.tailParsed() != tailParsed || check.unitCount() != units.size()) {
+        return std::string("merged mission failed to parse");
+    }
+    return result;
+}
+
+} // namespace kuf
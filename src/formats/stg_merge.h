@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace kuf {
+
+// Side whose version a conflicting record keeps in the merged file.
+enum class StgMergePrefer {
+    Ours,
+    Theirs
+};
+
+// A record both sides changed in incompatible ways. Keys match recordLayout
+// ("unit:1001", "event:12", ...). When both sides edited the same fixed-size
+// record (header, unit, area), only the fields they both changed are listed.
+struct StgMergeConflict {
+    std::string key;
+    std::string reason;
+    std::vector<std::string> fields;
+};
+
+struct StgMergeResult {
+    std::vector<std::byte> merged;
+    std::vector<StgMergeConflict> conflicts;
+    size_t takenFromTheirs = 0; // Records where only theirs changed.
+    size_t fieldMerged = 0;     // Records both sides edited in different fields.
+
+    bool clean() const { return conflicts.empty(); }
+};
+
+// Three-way merge of an STG mission. Units, areas, variables and events are
+// matched by uniqueId, areaId, variableId and eventId; a record changed on one
+// side takes that side's version, and one changed on both is combined field by
+// field where it has a fixed layout. Conflicting records keep the preferred
+// side. The merged file keeps ours' record order, with records theirs added
+// placed after the record they follow there. Unmodelled bytes are carried
+// through. Returns an error when a version cannot be parsed.
+std::variant<StgMergeResult, std::string> mergeStg(std::span<const std::byte> base,
+                                                   std::span<const std::byte> ours,
+                                                   std::span<const std::byte> theirs,
+                                                   StgMergePrefer prefer = StgMergePrefer::Ours);
+
+} // namespace kuf
@@ -0,0 +1,300 @@
+#include "formats/stg_reference_index.h"
+#include "core/profiler.h"
+#include "formats/stg_script_catalog.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+
+namespace kuf {
+
+namespace {
+
+constexpr int8_t kNoRef = -1;
+constexpr size_t kMaxCatalogId = 256;
+constexpr size_t kCatalogParams = 3;
+
+using KindTable = std::array<std::array<int8_t, kCatalogParams>, kMaxCatalogId>;
+
+// Per-type parameter kinds, so indexing a mission does not search the catalog
+// by name for every parameter.
+KindTable buildKindTable(const ScriptEntryInfo* catalog, size_t count) {
+    KindTable table;
+    for (auto& params : table) params.fill(kNoRef);
+    for (size_t i = 0; i < count; ++i) {
+        if (catalog[i].id >= kMaxCatalogId) continue;
+        for (size_t p = 0; p < kCatalogParams; ++p) {
+            if (auto kind = referenceKindForParam(catalog[i].paramNames[p])) {
+                table[catalog[i].id][p] = static_cast<int8_t>(*kind);
+            }
+        }
+    }
+    return table;
+}
+
+bool holdsId(const StgParamValue& param) {
+    return param.type == StgParamType::Int || param.type == StgParamType::Enum;
+}
+
+StgParamValue* paramAt(StgFormat& stg, const StgRefSite& site) {
+    auto& event = stg.eventBlocks()[site.block].events[site.event];
+    auto& entries = site.action ? event.actions : event.conditions;
+    return &entries[site.entry].params[site.param];
+}
+
+} // namespace
+
+std::optional<StgRefKind> referenceKindForParam(const char* paramName) {
+    if (!paramName || !paramName[0]) return std::nullopt;
+
+    // Troop parameters name the unit's uniqueId under several roles.
+    static constexpr const char* kTroopParams[] = {"TroopID", "TroopID1", "TroopID2", "AttackerID", "TargetID"};
+    for (const char* name : kTroopParams) {
+        if (std::strcmp(paramName, name) == 0) return StgRefKind::Troop;
+    }
+    if (std::strcmp(paramName, "AreaID") == 0) return StgRefKind::Area;
+    if (std::strcmp(paramName, "VariableID") == 0) return StgRefKind::Variable;
+    if (std::strcmp(paramName, "EventID") == 0) return StgRefKind::Event;
+    return std::nullopt;
+}
+
+std::optional<StgRefKind> referenceKind(bool isAction, uint32_t typeId, size_t paramIndex) {
+    static const KindTable conditions = buildKindTable(kConditions, kConditionCount);
+    static const KindTable actions = buildKindTable(kActions, kActionCount);
+
+    if (typeId >= kMaxCatalogId || paramIndex >= kCatalogParams) return std::nullopt;
+    int8_t kind = (isAction ? actions : conditions)[typeId][paramIndex];
+    if (kind == kNoRef) return std::nullopt;
+    return static_cast<StgRefKind>(kind);
+}
+
+std::vector<StgReferenceIndex::Ref> StgReferenceIndex::collectEvent(const StgEvent& event, uint32_t block,
+                                                                    uint32_t eventIndex) {
+    std::vector<Ref> refs;
+    auto collect = [&](const std::vector<StgScriptEntry>& entries, bool isAction) {
+        for (uint32_t e = 0; e < entries.size(); ++e) {
+            const auto& params = entries[e].params;
+            size_t n = std::min(params.size(), kCatalogParams);
+            for (uint32_t p = 0; p < n; ++p) {
+                if (!holdsId(params[p])) continue;
+                if (auto kind = referenceKind(isAction, entries[e].typeId, p)) {
+                    refs.push_back({*kind, params[p].intValue, {block, eventIndex, isAction, e, p}});
+                }
+            }
+        }
+    };
+    collect(event.conditions, false);
+    collect(event.actions, true);
+    return refs;
+}
+
+void StgReferenceIndex::insertRefs(const std::vector<Ref>& refs) {
+    for (const auto& ref : refs) {
+        auto& list = sites_[key(ref.kind, ref.id)];
+        list.insert(std::lower_bound(list.begin(), list.end(), ref.site), ref.site);
+    }
+}
+
+void StgReferenceIndex::eraseRefs(const std::vector<Ref>& refs) {
+    for (const auto& ref : refs) {
+        auto it = sites_.find(key(ref.kind, ref.id));
+        if (it == sites_.end()) continue;
+        auto& list = it->second;
+        auto pos = std::lower_bound(list.begin(), list.end(), ref.site);
+        if (pos != list.end() && *pos == ref.site) list.erase(pos);
+        if (list.empty()) sites_.erase(it);
+    }
+}
+
+void StgReferenceIndex::build(const StgFormat& stg) {
+    KUF_PROFILE_ZONE("StgReferenceIndex::build");
+    clear();
+    for (size_t b = 0; b < stg.eventBlocks().size(); ++b) {
+        reindexBlock(stg, b);
+    }
+}
+
+void StgReferenceIndex::clear() {
+    sites_.clear();
+    eventRefs_.clear();
+}
+
+bool StgReferenceIndex::reindexEvent(const StgFormat& stg, size_t block, size_t event) {
+    const auto& blocks = stg.eventBlocks();
+    if (block >= blocks.size() || event >= blocks[block].events.size()) return false;
+    if (eventRefs_.size() <= block) eventRefs_.resize(block + 1);
+    auto& blockRefs = eventRefs_[block];
+    if (blockRefs.size() <= event) blockRefs.resize(event + 1);
+
+    auto refs = collectEvent(blocks[block].events[event], static_cast<uint32_t>(block),
+                             static_cast<uint32_t>(event));
+    if (refs == blockRefs[event]) return false;
+
+    eraseRefs(blockRefs[event]);
+    insertRefs(refs);
+    blockRefs[event] = std::move(refs);
+    return true;
+}
+
+void StgReferenceIndex::reindexBlock(const StgFormat& stg, size_t block) {
+    if (block < eventRefs_.size()) {
+        for (const auto& refs : eventRefs_[block]) eraseRefs(refs);
+        eventRefs_[block].clear();
+    }
+
+    const auto& blocks = stg.eventBlocks();
+    if (block >= blocks.size()) {
+        // The block is gone; drop trailing empty slots.
+        while (!eventRefs_.empty() && eventRefs_.back().empty()) eventRefs_.pop_back();
+        return;
+    }
+
+    if (eventRefs_.size() <= block) eventRefs_.resize(block + 1);
+    const auto& events = blocks[block].events;
+    auto& blockRefs = eventRefs_[block];
+    blockRefs.resize(events.size());
+    for (size_t e = 0; e < events.size(); ++e) {
+        blockRefs[e] = collectEvent(events[e], static_cast<uint32_t>(block), static_cast<uint32_t>(e));
+        insertRefs(blockRefs[e]);
+    }
+}
+
+std::span<const StgRefSite> StgReferenceIndex::find(StgRefKind kind, int32_t id) const {
+    auto it = sites_.find(key(kind, id));
+    if (it == sites_.end()) return {};
+    return it->second;
+}
+
+bool StgReferenceIndex::sitesMatch(const StgFormat& stg, StgRefKind kind, int32_t id) const {
+    const auto& blocks = stg.eventBlocks();
+    for (const auto& site : find(kind, id)) {
+        if (site.block >= blocks.size() || site.event >= blocks[site.block].events.size()) return false;
+        const auto& event = blocks[site.block].events[site.event];
+        const auto& entries = site.action ? event.actions : event.conditions;
+        if (site.entry >= entries.size() || site.param >= entries[site.entry].params.size()) return false;
+        const auto& param = entries[site.entry].params[site.param];
+        if (!holdsId(param) || param.intValue != id) return false;
+        if (referenceKind(site.action, entries[site.entry].typeId, site.param) != kind) return false;
+    }
+    return true;
+}
+
+bool StgReferenceIndex::isDefined(const StgFormat& stg, StgRefKind kind, int32_t id) {
+    auto matches = [id](uint32_t value) { return static_cast<int32_t>(value) == id; };
+    switch (kind) {
+        case StgRefKind::Troop:
+            return std::any_of(stg.units().begin(), stg.units().end(),
+                               [&](const StgUnit& u) { return matches(u.uniqueId); });
+        case StgRefKind::Area:
+            return std::any_of(stg.areas().begin(), stg.areas().end(),
+                               [&](const StgArea& a) { return matches(a.areaId); });
+        case StgRefKind::Variable:
+            return std::any_of(stg.variables().begin(), stg.variables().end(),
+                               [&](const StgVariable& v) { return matches(v.variableId); });
+        case StgRefKind::Event:
+            for (const auto& block : stg.eventBlocks()) {
+                for (const auto& event : block.events) {
+                    if (matches(event.eventId)) return true;
+                }
+            }
+            return false;
+    }
+    return false;
+}
+
+std::optional<StgRenumberPlan> StgReferenceIndex::planRenumber(const StgFormat& stg, StgRefKind kind, int32_t from,
+                                                              int32_t to) const {
+    if (from == to || to < 0 || !isDefined(stg, kind, from) || isDefined(stg, kind, to)) return std::nullopt;
+
+    StgRenumberPlan plan;
+    plan.kind = kind;
+    plan.from = from;
+    plan.to = to;
+    auto isFrom = [from](uint32_t value) { return static_cast<int32_t>(value) == from; };
+    auto collect = [&](const auto& records, auto id) {
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (isFrom(records[i].*id)) plan.definitions.push_back(static_cast<uint32_t>(i));
+        }
+    };
+    switch (kind) {
+        case StgRefKind::Troop:
+            collect(stg.units(), &StgUnit::uniqueId);
+            break;
+        case StgRefKind::Area:
+            collect(stg.areas(), &StgArea::areaId);
+            break;
+        case StgRefKind::Variable:
+            collect(stg.variables(), &StgVariable::variableId);
+            break;
+        case StgRefKind::Event: {
+            const auto& blocks = stg.eventBlocks();
+            for (uint32_t b = 0; b < blocks.size(); ++b) {
+                for (uint32_t e = 0; e < blocks[b].events.size(); ++e) {
+                    if (!isFrom(blocks[b].events[e].eventId)) continue;
+                    plan.eventDefinitions.push_back({b, e});
+                    plan.modifiedEvents.push_back({b, e});
+                }
+            }
+            break;
+        }
+    }
+
+    auto sites = find(kind, from);
+    plan.params.assign(sites.begin(), sites.end());
+    for (const auto& site : sites) {
+        StgEventSlot slot{site.block, site.event};
+        // Sites are in file order, so one event's sites are adjacent.
+        if (plan.modifiedEvents.empty() || plan.modifiedEvents.back() != slot) {
+            plan.modifiedEvents.push_back(slot);
+        }
+    }
+    return plan;
+}
+
+void applyRenumberPlan(StgFormat& stg, const StgRenumberPlan& plan, int32_t id) {
+    auto value = static_cast<uint32_t>(id);
+    for (uint32_t i : plan.definitions) {
+        switch (plan.kind) {
+            case StgRefKind::Troop: stg.units()[i].uniqueId = value; break;
+            case StgRefKind::Area: stg.areas()[i].areaId = value; break;
+            case StgRefKind::Variable: stg.variables()[i].variableId = value; break;
+            case StgRefKind::Event: break;
+        }
+    }
+    for (const auto& slot : plan.eventDefinitions) {
+        stg.eventBlocks()[slot.block].events[slot.event].eventId = value;
+    }
+    for (const auto& site : plan.params) paramAt(stg, site)->intValue = id;
+}
+
+bool StgReferenceIndex::renumber(StgFormat& stg, StgRefKind kind, int32_t from, int32_t to) {
+    auto plan = planRenumber(stg, kind, from, to);
+    if (!plan) return false;
+
+    applyRenumberPlan(stg, *plan, to);
+    for (const auto& slot : plan->modifiedEvents) {
+        stg.eventBlocks()[slot.block].events[slot.event].modified = true;
+    }
+
+    auto it = sites_.find(key(kind, from));
+    if (it == sites_.end()) return true;
+    std::vector<StgRefSite> moved = std::move(it->second);
+    sites_.erase(it);
+
+    for (const auto& site : moved) {
+        for (auto& ref : eventRefs_[site.block][site.event]) {
+            if (ref.site == site) ref.id = to;
+        }
+    }
+
+    // References to an ID nobody defines may already exist; merge in order.
+    auto& target = sites_[key(kind, to)];
+    std::vector<StgRefSite> merged;
+    merged.reserve(target.size() + moved.size());
+    std::merge(target.begin(), target.end(), moved.begin(), moved.end(), std::back_inserter(merged));
+    target = std::move(merged);
+    return true;
+}
+
+} // namespace kuf
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "formats/stg_format.h"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace kuf {
+
+// Kinds of mission objects that event scripts refer to by ID.
+enum class StgRefKind : uint8_t {
+    Troop,    // StgUnit::uniqueId
+    Area,     // StgArea::areaId
+    Variable, // StgVariable::variableId
+    Event     // StgEvent::eventId
+};
+
+// What a script parameter refers to, judged by its name in the script catalog.
+// Returns nullopt for plain values (counts, percentages, message IDs, ...).
+std::optional<StgRefKind> referenceKindForParam(const char* paramName);
+
+// Same lookup for parameter paramIndex of a condition or action type.
+std::optional<StgRefKind> referenceKind(bool isAction, uint32_t typeId, size_t paramIndex);
+
+// One parameter that holds a reference.
+struct StgRefSite {
+    uint32_t block = 0;
+    uint32_t event = 0;
+    bool action = false; // Otherwise a condition.
+    uint32_t entry = 0;
+    uint32_t param = 0;
+
+    auto operator<=>(const StgRefSite&) const = default;
+};
+
+// One event, by block and position in the block.
+struct StgEventSlot {
+    uint32_t block = 0;
+    uint32_t event = 0;
+
+    auto operator<=>(const StgEventSlot&) const = default;
+};
+
+// Every field a renumber writes, so callers can apply it themselves, e.g. as
+// an undoable command. Fields are addressed by index rather than pointer, so a
+// plan kept in the undo history survives event vectors reallocating; it stays
+// valid as long as the mission's structure is the same when it is applied.
+struct StgRenumberPlan {
+    StgRefKind kind = StgRefKind::Troop;
+    int32_t from = 0;
+    int32_t to = 0;
+    std::vector<uint32_t> definitions;          // Units, areas or variables whose ID is from.
+    std::vector<StgEventSlot> eventDefinitions; // Events whose ID is from.
+    std::vector<StgRefSite> params;             // Parameters referencing from.
+    std::vector<StgEventSlot> modifiedEvents;   // Set modified so they are re-serialized.
+};
+
+// Writes id into every definition and parameter the plan lists: plan.to to
+// apply it, plan.from to revert it. Modified flags are left to the caller.
+void applyRenumberPlan(StgFormat& stg, const StgRenumberPlan& plan, int32_t id);
+
+// Inverted index from (kind, ID) to every script parameter that references it.
+// The index mirrors one StgFormat; callers keep it in step after edits with
+// reindexEvent (an event's scripts changed) or reindexBlock (events were added,
+// removed or reordered), each of which only touches the IDs involved.
+class StgReferenceIndex {
+public:
+    void build(const StgFormat& stg);
+    void clear();
+
+    // Re-reads one event. Returns false when its references were unchanged, in
+    // which case the index was not touched.
+    bool reindexEvent(const StgFormat& stg, size_t block, size_t event);
+
+    // Re-reads every event of one block after structural changes.
+    void reindexBlock(const StgFormat& stg, size_t block);
+
+    // Sites referencing the ID, in file order. Empty when there are none.
+    std::span<const StgRefSite> find(StgRefKind kind, int32_t id) const;
+    size_t count(StgRefKind kind, int32_t id) const { return find(kind, id).size(); }
+
+    // True when every site listed for the ID still holds that reference. Edits
+    // that bypassed reindexEvent/reindexBlock make this false. O(results).
+    bool sitesMatch(const StgFormat& stg, StgRefKind kind, int32_t id) const;
+
+    // True when a unit, area, variable or event with this ID exists.
+    static bool isDefined(const StgFormat& stg, StgRefKind kind, int32_t id);
+
+    // Changes the ID of the object with ID from, and every reference to it, to
+    // to. Fails without changing anything when to is already defined or from
+    // is not. Edited events are marked modified.
+    bool renumber(StgFormat& stg, StgRefKind kind, int32_t from, int32_t to);
+
+    // The fields renumber would write, without writing them. nullopt when
+    // renumber would fail. Applying the plan leaves this index stale.
+    std::optional<StgRenumberPlan> planRenumber(const StgFormat& stg, StgRefKind kind, int32_t from, int32_t to) const;
+
+private:
+    struct Ref {
+        StgRefKind kind;
+        int32_t id;
+        StgRefSite site;
+
+        bool operator==(const Ref&) const = default;
+    };
+
+    static uint64_t key(StgRefKind kind, int32_t id) {
+        return (static_cast<uint64_t>(kind) << 32) | static_cast<uint32_t>(id);
+    }
+
+    static std::vector<Ref> collectEvent(const StgEvent& event, uint32_t block, uint32_t eventIndex);
+    void insertRefs(const std::vector<Ref>& refs);
+    void eraseRefs(const std::vector<Ref>& refs);
+
+    std::unordered_map<uint64_t, std::vector<StgRefSite>> sites_;
+    // References held by each event, [block][event]; the source for erasing.
+    std::vector<std::vector<std::vector<Ref>>> eventRefs_;
+};
+
+} // namespace kuf
@@ -0,0 +1,637 @@
+#include "formats/structural_diff.h"
+#include "core/file_io.h"
+#include "core/mapped_file.h"
+#include "core/profiler.h"
+#include "core/worker_pool.h"
+#include "formats/record_digest.h"
+#include "formats/sox_binary.h"
+#include "formats/sox_encoding.h"
+#include "formats/sox_skill_info.h"
+#include "formats/sox_text.h"
+#include "formats/stg_format.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace kuf {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr size_t kSoxHeaderSize = 8;
+constexpr size_t kTroopRecordSize = 148;
+
+// Raw byte ranges listed for a record whose modelled fields are all equal.
+constexpr size_t kMaxRawRanges = 8;
+constexpr size_t kMaxRawRangeBytes = 16;
+
+enum class RecordType {
+    Troop,
+    Skill,
+    Text,
+    Header,
+    Unit,
+    Area,
+    Variable,
+    Event,
+    Footer,
+    Tail,
+    TroopFooter
+};
+
+// A digest from digestRecords, tagged with the parsed record it covers.
+struct Record {
+    std::string key;
+    uint64_t hash = 0;
+    RecordType type = RecordType::Tail;
+    size_t index = 0;
+};
+
+// One side of a diff: the parsed file and its records in file order. Spans
+// and event pointers point into the document itself, so it is not copyable.
+struct Document {
+    Document() = default;
+    Document(const Document&) = delete;
+    Document& operator=(const Document&) = delete;
+
+    std::string format;
+    std::vector<std::byte> decoded;
+    std::span<const std::byte> data;
+    std::optional<SoxBinary> troops;
+    std::optional<SoxSkillInfo> skills;
+    std::optional<SoxText> text;
+    std::optional<StgFormat> stg;
+    std::vector<const StgEvent*> events;
+    size_t tailOffset = 0;
+    std::vector<Record> records;
+};
+
+// Hands out digests, which are in file order, to the parsed records they
+// cover, section by section.
+class RecordTagger {
+public:
+    RecordTagger(std::vector<RecordDigest> digests, std::vector<Record>& records)
+        : digests_(std::move(digests)), records_(records) {
+        records_.reserve(digests_.size());
+    }
+
+    void take(RecordType type, size_t count) {
+        for (size_t i = 0; i < count && next_ < digests_.size(); ++i, ++next_) {
+            records_.push_back({std::move(digests_[next_].key), digests_[next_].hash, type, i});
+        }
+    }
+
+    size_t remaining() const { return digests_.size() - next_; }
+
+private:
+    std::vector<RecordDigest> digests_;
+    std::vector<Record>& records_;
+    size_t next_ = 0;
+};
+
+bool loadSox(Document& doc) {
+    auto& binary = doc.troops.emplace();
+    if (binary.load(doc.data)) {
+        RecordTagger tagger(digestTroopSox(binary, doc.data), doc.records);
+        tagger.take(RecordType::Troop, binary.recordCount());
+        tagger.take(RecordType::TroopFooter, 1);
+        doc.tailOffset = kSoxHeaderSize + binary.recordCount() * kTroopRecordSize;
+        doc.format = std::string(binary.formatName());
+        return true;
+    }
+    doc.troops.reset();
+
+    auto& skills = doc.skills.emplace();
+    if (skills.load(doc.data)) {
+        RecordTagger tagger(digestSkillSox(skills), doc.records);
+        tagger.take(RecordType::Skill, skills.skills().size());
+        doc.format = std::string(skills.formatName());
+        return true;
+    }
+    doc.skills.reset();
+
+    auto& text = doc.text.emplace();
+    if (text.load(doc.data)) {
+        RecordTagger tagger(digestTextSox(text), doc.records);
+        tagger.take(RecordType::Text, text.entryCount());
+        doc.format = std::string(text.formatName());
+        return true;
+    }
+    doc.text.reset();
+    return false;
+}
+
+bool loadStg(Document& doc) {
+    auto& stg = doc.stg.emplace();
+    if (!stg.load(doc.data)) {
+        doc.stg.reset();
+        return false;
+    }
+    auto digests = digestStg(stg, doc.data);
+    if (!digests) return false;
+
+    RecordTagger tagger(std::move(*digests), doc.records);
+    tagger.take(RecordType::Header, 1);
+    tagger.take(RecordType::Unit, stg.units().size());
+    // An unparsed tail is opaque; digestRecords treats it as one record.
+    if (!stg.tailParsed()) {
+        doc.tailOffset = std::min(doc.data.size(), kStgHeaderSize + stg.units().size() * kStgUnitSize);
+        tagger.take(RecordType::Tail, tagger.remaining());
+    } else {
+        tagger.take(RecordType::Area, stg.areas().size());
+        tagger.take(RecordType::Variable, stg.variables().size());
+        for (const auto& block : stg.eventBlocks()) {
+            for (const auto& event : block.events) doc.events.push_back(&event);
+        }
+        tagger.take(RecordType::Event, doc.events.size());
+        tagger.take(RecordType::Footer, 1);
+    }
+
+    doc.format = std::string(stg.formatName());
+    return true;
+}
+
+bool loadDocument(std::string_view fileName, std::span<const std::byte> data, Document& doc) {
+    std::string ext = lowerExtension(fileName);
+    doc.data = data;
+    if (ext == ".stg") return loadStg(doc);
+    if (ext != ".sox") return false;
+    if (isSoxEncoded(data)) {
+        auto decoded = soxDecode(data);
+        if (!decoded) return false;
+        doc.decoded = std::move(*decoded);
+        doc.data = doc.decoded;
+    }
+    return loadSox(doc);
+}
+
+// --- field listing ----------------------------------------------------------
+
+using FieldList = std::vector<std::pair<std::string, std::string>>;
+
+std::string formatValue(float value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    return std::string(buf, result.ptr);
+}
+
+template <typename T>
+    requires std::is_integral_v<T>
+std::string formatValue(T value) {
+    // Promote uint8_t so it prints as a number rather than a character.
+    return std::to_string(+value);
+}
+
+std::string formatValue(const std::string& value) { return value; }
+
+std::string formatValue(const StgParamValue& value) {
+    switch (value.type) {
+    case StgParamType::Int: return formatValue(value.intValue);
+    case StgParamType::Float: return formatValue(value.floatValue);
+    case StgParamType::String: return "\"" + value.stringValue + "\"";
+    case StgParamType::Enum: return "enum " + formatValue(value.intValue);
+    }
+    return formatValue(value.intValue);
+}
+
+template <typename T>
+void put(FieldList& out, std::string name, const T& value) {
+    out.emplace_back(std::move(name), formatValue(value));
+}
+
+template <typename T, size_t N>
+void putArray(FieldList& out, const std::string& name, const std::array<T, N>& values) {
+    for (size_t i = 0; i < N; ++i) put(out, name + "[" + std::to_string(i) + "]", values[i]);
+}
+
+void putSkills(FieldList& out, const std::string& name, const std::array<SkillSlot, 4>& skills) {
+    for (size_t i = 0; i < skills.size(); ++i) {
+        std::string slot = name + "[" + std::to_string(i) + "].";
+        put(out, slot + "skillId", skills[i].skillId);
+        put(out, slot + "level", skills[i].level);
+    }
+}
+
+void putScript(FieldList& out, const std::string& name, const std::vector<StgScriptEntry>& script) {
+    put(out, name + ".count", script.size());
+    for (size_t i = 0; i < script.size(); ++i) {
+        std::string entry = name + "[" + std::to_string(i) + "]";
+        put(out, entry + ".typeId", script[i].typeId);
+        for (size_t p = 0; p < script[i].params.size(); ++p) {
+            put(out, entry + ".params[" + std::to_string(p) + "]", script[i].params[p]);
+        }
+    }
+}
+
+void listTroop(FieldList& out, const TroopInfo& t) {
+    put(out, "job", t.job);
+    put(out, "typeId", t.typeId);
+    put(out, "moveSpeed", t.moveSpeed);
+    put(out, "rotateRate", t.rotateRate);
+    put(out, "moveAcceleration", t.moveAcceleration);
+    put(out, "moveDeceleration", t.moveDeceleration);
+    put(out, "sightRange", t.sightRange);
+    put(out, "attackRangeMax", t.attackRangeMax);
+    put(out, "attackRangeMin", t.attackRangeMin);
+    put(out, "attackFrontRange", t.attackFrontRange);
+    put(out, "directAttack", t.directAttack);
+    put(out, "indirectAttack", t.indirectAttack);
+    put(out, "defense", t.defense);
+    put(out, "baseWidth", t.baseWidth);
+    put(out, "resistMelee", t.resistMelee);
+    put(out, "resistRanged", t.resistRanged);
+    put(out, "resistFrontal", t.resistFrontal);
+    put(out, "resistExplosion", t.resistExplosion);
+    put(out, "resistFire", t.resistFire);
+    put(out, "resistIce", t.resistIce);
+    put(out, "resistLightning", t.resistLightning);
+    put(out, "resistHoly", t.resistHoly);
+    put(out, "resistCurse", t.resistCurse);
+    put(out, "resistEarth", t.resistEarth);
+    put(out, "maxUnitSpeedMultiplier", t.maxUnitSpeedMultiplier);
+    put(out, "defaultUnitHp", t.defaultUnitHp);
+    put(out, "formationRandom", t.formationRandom);
+    put(out, "defaultUnitNumX", t.defaultUnitNumX);
+    put(out, "defaultUnitNumY", t.defaultUnitNumY);
+    put(out, "unitHpLevelUp", t.unitHpLevelUp);
+    for (size_t i = 0; i < t.levelUpData.size(); ++i) {
+        std::string level = "levelUpData[" + std::to_string(i) + "].";
+        put(out, level + "skillId", t.levelUpData[i].skillId);
+        put(out, level + "bonusPerLevel", t.levelUpData[i].bonusPerLevel);
+    }
+    put(out, "damageDistribution", t.damageDistribution);
+}
+
+void listOfficer(FieldList& out, const std::string& name, const OfficerData& officer) {
+    put(out, name + ".jobType", officer.jobType);
+    put(out, name + ".modelId", officer.modelId);
+    put(out, name + ".worldmapId", officer.worldmapId);
+    put(out, name + ".level", officer.level);
+    putSkills(out, name + ".skills", officer.skills);
+    putArray(out, name + ".abilities", officer.abilities);
+}
+
+void listUnit(FieldList& out, const StgUnit& u) {
+    put(out, "unitName", u.unitName);
+    put(out, "uniqueId", u.uniqueId);
+    put(out, "ucd", static_cast<int>(u.ucd));
+    put(out, "isHero", u.isHero);
+    put(out, "isEnabled", u.isEnabled);
+    put(out, "leaderHpOverride", u.leaderHpOverride);
+    put(out, "unitHpOverride", u.unitHpOverride);
+    put(out, "positionX", u.positionX);
+    put(out, "positionY", u.positionY);
+    put(out, "direction", static_cast<int>(u.direction));
+    put(out, "leaderJobType", u.leaderJobType);
+    put(out, "leaderModelId", u.leaderModelId);
+    put(out, "leaderWorldmapId", u.leaderWorldmapId);
+    put(out, "leaderLevel", u.leaderLevel);
+    putSkills(out, "leaderSkills", u.leaderSkills);
+    putArray(out, "leaderAbilities", u.leaderAbilities);
+    put(out, "officerCount", u.officerCount);
+    listOfficer(out, "officer1", u.officer1);
+    listOfficer(out, "officer2", u.officer2);
+    put(out, "troopInfoIndex", u.troopInfoIndex);
+    put(out, "formationType", u.formationType);
+    put(out, "unitAnimConfig", u.unitAnimConfig);
+    put(out, "gridX", u.gridX);
+    put(out, "gridY", u.gridY);
+    putArray(out, "statOverrides", u.statOverrides);
+}
+
+void listHeader(FieldList& out, const StgHeader& h) {
+    put(out, "formatMagic", h.formatMagic);
+    put(out, "mapFile", h.mapFile);
+    put(out, "bitmapFile", h.bitmapFile);
+    put(out, "defaultCameraFile", h.defaultCameraFile);
+    put(out, "userCameraFile", h.userCameraFile);
+    put(out, "settingsFile", h.settingsFile);
+    put(out, "skyCloudEffects", h.skyCloudEffects);
+    put(out, "aiScriptFile", h.aiScriptFile);
+    put(out, "cubemapTexture", h.cubemapTexture);
+    put(out, "unitCount", h.unitCount);
+}
+
+void listFields(FieldList& out, const Document& doc, const Record& record) {
+    switch (record.type) {
+    case RecordType::Troop:
+        listTroop(out, doc.troops->troops()[record.index]);
+        break;
+    case RecordType::Skill: {
+        const auto& skill = doc.skills->skills()[record.index];
+        put(out, "locKey", skill.locKey);
+        put(out, "iconPath", skill.iconPath);
+        put(out, "skillType", skill.skillType);
+        put(out, "maxLevel", skill.maxLevel);
+        break;
+    }
+    case RecordType::Text:
+        put(out, "text", std::string(doc.text->text(record.index)));
+        put(out, "maxLength", doc.text->maxLength(record.index));
+        break;
+    case RecordType::Header:
+        listHeader(out, doc.stg->header());
+        break;
+    case RecordType::Unit:
+        listUnit(out, doc.stg->units()[record.index]);
+        break;
+    case RecordType::Area: {
+        const auto& area = doc.stg->areas()[record.index];
+        put(out, "description", area.description);
+        put(out, "boundX1", area.boundX1);
+        put(out, "boundY1", area.boundY1);
+        put(out, "boundX2", area.boundX2);
+        put(out, "boundY2", area.boundY2);
+        break;
+    }
+    case RecordType::Variable: {
+        const auto& var = doc.stg->variables()[record.index];
+        put(out, "name", var.name);
+        put(out, "initialValue", var.initialValue);
+        break;
+    }
+    case RecordType::Event: {
+        const auto& event = *doc.events[record.index];
+        put(out, "description", event.description);
+        putScript(out, "conditions", event.conditions);
+        putScript(out, "actions", event.actions);
+        break;
+    }
+    case RecordType::Footer: {
+        const auto& footer = doc.stg->footerEntries();
+        put(out, "entries.count", footer.size());
+        for (size_t i = 0; i < footer.size(); ++i) {
+            std::string entry = "entries[" + std::to_string(i) + "].";
+            put(out, entry + "field1", footer[i].field1);
+            put(out, entry + "field2", footer[i].field2);
+        }
+        break;
+    }
+    case RecordType::Tail:
+    case RecordType::TroopFooter:
+        put(out, "size", doc.data.size() - doc.tailOffset);
+        break;
+    }
+}
+
+// The record's bytes as read from the file, for records that keep them.
+std::span<const std::byte> rawBytes(const Document& doc, const Record& record) {
+    switch (record.type) {
+    case RecordType::Troop:
+        return doc.data.subspan(kSoxHeaderSize + record.index * kTroopRecordSize, kTroopRecordSize);
+    case RecordType::Header:
+        return doc.stg->header().rawData;
+    case RecordType::Unit:
+        return doc.stg->units()[record.index].rawData;
+    case RecordType::Area:
+        return doc.stg->areas()[record.index].rawData;
+    case RecordType::Event:
+        return doc.events[record.index]->rawData;
+    case RecordType::Tail:
+    case RecordType::TroopFooter:
+        return doc.data.subspan(doc.tailOffset);
+    default:
+        return {};
+    }
+}
+
+std::string hexBytes(std::span<const std::byte> bytes) {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string hex;
+    size_t shown = std::min(bytes.size(), kMaxRawRangeBytes);
+    hex.reserve(shown * 3 + 3);
+    for (size_t i = 0; i < shown; ++i) {
+        if (i > 0) hex += ' ';
+        auto b = static_cast<unsigned>(bytes[i]);
+        hex += kDigits[b >> 4];
+        hex += kDigits[b & 0xF];
+    }
+    if (shown < bytes.size()) hex += " ...";
+    return hex;
+}
+
+std::string hexOffset(size_t offset) {
+    char buf[24];
+    buf[0] = '0';
+    buf[1] = 'x';
+    auto result = std::to_chars(buf + 2, buf + sizeof(buf), offset, 16);
+    return std::string(buf, result.ptr);
+}
+
+// Lists differing byte ranges, merging ranges separated by fewer than four
+// equal bytes so one changed value shows as one range.
+void compareRaw(std::vector<FieldChange>& out, std::span<const std::byte> before,
+                std::span<const std::byte> after) {
+    if (before.size() != after.size()) {
+        out.push_back({"bytes", std::to_string(before.size()), std::to_string(after.size())});
+        return;
+    }
+    size_t i = 0;
+    while (i < before.size() && out.size() < kMaxRawRanges) {
+        if (before[i] == after[i]) {
+            ++i;
+            continue;
+        }
+        size_t start = i;
+        size_t end = i + 1;
+        for (size_t j = end; j < before.size() && j < end + 4; ++j) {
+            if (before[j] != after[j]) end = j + 1;
+        }
+        while (end < before.size() && before[end] != after[end]) ++end;
+        out.push_back({"bytes[" + hexOffset(start) + ".." + hexOffset(end) + ")",
+                       hexBytes(before.subspan(start, end - start)), hexBytes(after.subspan(start, end - start))});
+        i = end;
+    }
+}
+
+std::vector<FieldChange> compareRecords(const Document& baseDoc, const Record& base, const Document& modifiedDoc,
+                                        const Record& modified) {
+    FieldList before, after;
+    listFields(before, baseDoc, base);
+    listFields(after, modifiedDoc, modified);
+
+    std::vector<FieldChange> changes;
+    std::unordered_map<std::string_view, const std::string*> baseValues;
+    baseValues.reserve(before.size());
+    for (const auto& [name, value] : before) baseValues.emplace(name, &value);
+    for (auto& [name, value] : after) {
+        auto it = baseValues.find(name);
+        if (it == baseValues.end()) {
+            changes.push_back({name, {}, std::move(value)});
+            continue;
+        }
+        if (*it->second != value) changes.push_back({name, *it->second, std::move(value)});
+        baseValues.erase(it);
+    }
+    // Fields only the base has, such as script entries that were removed.
+    for (const auto& [name, value] : before) {
+        if (baseValues.count(name)) changes.push_back({name, value, {}});
+    }
+
+    if (changes.empty()) compareRaw(changes, rawBytes(baseDoc, base), rawBytes(modifiedDoc, modified));
+    return changes;
+}
+
+struct FilePair {
+    std::string relative;
+    fs::path base;     // Empty when the file was added.
+    fs::path modified; // Empty when the file was removed.
+};
+
+bool isGameDataFile(const fs::path& path) {
+    std::string ext = lowerExtension(path.filename().string());
+    return ext == ".sox" || ext == ".stg";
+}
+
+void collectFiles(const fs::path& root, std::map<std::string, FilePair>& byPath, bool isBase) {
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(root, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code statEc;
+        if (!it->is_regular_file(statEc) || !isGameDataFile(it->path())) continue;
+        std::string relative = it->path().lexically_relative(root).generic_string();
+        auto& pair = byPath[relative];
+        pair.relative = relative;
+        (isBase ? pair.base : pair.modified) = it->path();
+    }
+}
+
+std::vector<FilePair> pairFiles(const std::string& base, const std::string& modified) {
+    std::error_code ec;
+    if (!fs::is_directory(base, ec) || !fs::is_directory(modified, ec)) {
+        return {{fs::path(modified).filename().string(), base, modified}};
+    }
+    std::map<std::string, FilePair> byPath;
+    collectFiles(base, byPath, true);
+    collectFiles(modified, byPath, false);
+
+    std::vector<FilePair> pairs;
+    pairs.reserve(byPath.size());
+    for (auto& [path, pair] : byPath) pairs.push_back(std::move(pair));
+    return pairs;
+}
+
+FileDiff diffPair(const FilePair& pair) {
+    FileDiff result;
+    result.path = pair.relative;
+    if (pair.base.empty() || pair.modified.empty()) {
+        result.status = pair.base.empty() ? FileDiffStatus::Added : FileDiffStatus::Removed;
+        return result;
+    }
+
+    MappedFile base, modified;
+    if (!base.open(pair.base.string()) || !modified.open(pair.modified.string())) {
+        result.status = FileDiffStatus::Unreadable;
+        return result;
+    }
+    if (base.size() == modified.size() &&
+        (base.size() == 0 || std::memcmp(base.data().data(), modified.data().data(), base.size()) == 0)) {
+        result.status = FileDiffStatus::Identical;
+        return result;
+    }
+    result.status = FileDiffStatus::Changed;
+    result.diff = diffStructure(pair.relative, base.data(), modified.data());
+    return result;
+}
+
+} // namespace
+
+std::optional<StructuralDiff> diffStructure(std::string_view fileName,
+                                            std::span<const std::byte> base,
+                                            std::span<const std::byte> modified) {
+    KUF_PROFILE_ZONE("diffStructure");
+    // Both sides are parsed at once; inside a corpus diff this nests in the
+    // per-file loop, which the pool supports.
+    Document before, after;
+    bool loaded[2] = {false, false};
+    WorkerPool::shared().parallelFor(2, [&](size_t i) {
+        loaded[i] = i == 0 ? loadDocument(fileName, base, before) : loadDocument(fileName, modified, after);
+    });
+    if (!loaded[0] || !loaded[1] || before.format != after.format) return std::nullopt;
+
+    StructuralDiff diff;
+    diff.format = after.format;
+    auto compare = [&](const Record& baseRecord, const Record& record) {
+        if (baseRecord.hash == record.hash) {
+            ++diff.unchanged;
+        } else {
+            diff.records.push_back({RecordChangeKind::Changed, record.key,
+                                    compareRecords(before, baseRecord, after, record)});
+        }
+    };
+
+    // Records usually keep their order between versions, so the common
+    // prefix is matched in lockstep and only the rest goes through a map.
+    size_t common = 0;
+    size_t shorter = std::min(before.records.size(), after.records.size());
+    while (common < shorter && before.records[common].key == after.records[common].key) {
+        compare(before.records[common], after.records[common]);
+        ++common;
+    }
+
+    std::unordered_map<std::string_view, size_t> baseIndex;
+    baseIndex.reserve(before.records.size() - common);
+    for (size_t i = common; i < before.records.size(); ++i) {
+        baseIndex.emplace(before.records[i].key, i);
+    }
+
+    std::vector<bool> matched(before.records.size(), false);
+    for (size_t i = common; i < after.records.size(); ++i) {
+        const auto& record = after.records[i];
+        auto it = baseIndex.find(record.key);
+        if (it == baseIndex.end()) {
+            diff.records.push_back({RecordChangeKind::Added, record.key, {}});
+            continue;
+        }
+        matched[it->second] = true;
+        compare(before.records[it->second], record);
+    }
+    for (size_t i = common; i < before.records.size(); ++i) {
+        if (!matched[i]) diff.records.push_back({RecordChangeKind::Removed, before.records[i].key, {}});
+    }
+    return diff;
+}
+
+std::vector<FileDiff> diffPaths(const std::string& base, const std::string& modified,
+                                const DiffProgressFn& onProgress) {
+    KUF_PROFILE_ZONE("diffPaths");
+    auto pairs = pairFiles(base, modified);
+    std::vector<FileDiff> results(pairs.size());
+    std::atomic<size_t> done{0};
+    WorkerPool::shared().parallelFor(pairs.size(), [&](size_t i) {
+        results[i] = diffPair(pairs[i]);
+        size_t finished = done.fetch_add(1) + 1;
+        if (onProgress) onProgress(finished, pairs.size());
+    });
+    return results;
+}
+
+std::string_view recordChangeKindName(RecordChangeKind kind) {
+    switch (kind) {
+    case RecordChangeKind::Added: return "added";
+    case RecordChangeKind::Removed: return "removed";
+    case RecordChangeKind::Changed: return "changed";
+    }
+    return "changed";
+}
+
+std::string_view fileDiffStatusName(FileDiffStatus status) {
+    switch (status) {
+    case FileDiffStatus::Identical: return "identical";
+    case FileDiffStatus::Added: return "added";
+    case FileDiffStatus::Removed: return "removed";
+    case FileDiffStatus::Changed: return "changed";
+    case FileDiffStatus::Unreadable: return "unreadable";
+    }
+    return "unreadable";
+}
+
+} // namespace kuf
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kuf {
+
+enum class RecordChangeKind {
+    Added,
+    Removed,
+    Changed
+};
+
+// One field that differs between two versions of a record. Values are
+// formatted for display; a field missing on one side has an empty value there.
+struct FieldChange {
+    std::string field;
+    std::string before;
+    std::string after;
+};
+
+// A record that was added, removed or changed. Keys match digestRecords
+// ("troop:3", "unit:1001", "event:12", ...). Fields are listed for changed
+// records only; bytes the parsers do not model are reported as raw ranges.
+struct RecordChange {
+    RecordChangeKind kind = RecordChangeKind::Changed;
+    std::string key;
+    std::vector<FieldChange> fields;
+};
+
+struct StructuralDiff {
+    std::string format;
+    size_t unchanged = 0;
+    std::vector<RecordChange> records;
+
+    bool identical() const { return records.empty(); }
+};
+
+// Compares two versions of a SOX or STG file record by record. Records are
+// matched by key and compared by hash, so unchanged regions cost one pass;
+// only changed records are broken down into fields. Returns nullopt when
+// either side has no known record structure or the formats differ.
+std::optional<StructuralDiff> diffStructure(std::string_view fileName,
+                                            std::span<const std::byte> base,
+                                            std::span<const std::byte> modified);
+
+enum class FileDiffStatus {
+    Identical,
+    Added,
+    Removed,
+    Changed,
+    Unreadable
+};
+
+// Result for one file of a corpus comparison. A changed file without a
+// record structure has no diff and can only be reported as a whole.
+struct FileDiff {
+    std::string path;
+    FileDiffStatus status = FileDiffStatus::Identical;
+    std::optional<StructuralDiff> diff;
+};
+
+// Compares every SOX and STG file under two directories, paired by relative
+// path and sorted by it, diffing files in parallel. Two plain files are
+// compared directly. onProgress is called from worker threads.
+using DiffProgressFn = std::function<void(size_t done, size_t total)>;
+std::vector<FileDiff> diffPaths(const std::string& base, const std::string& modified,
+                                const DiffProgressFn& onProgress = {});
+
+std::string_view recordChangeKindName(RecordChangeKind kind);
+std::string_view fileDiffStatusName(FileDiffStatus status);
+
+} // namespace kuf
@@ -0,0 +1,455 @@
+#include "formats/text_search_index.h"
+#include "core/file_io.h"
+#include "core/mapped_file.h"
+#include "core/profiler.h"
+#include "core/worker_pool.h"
+#include "formats/sox_encoding.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace kuf {
+
+namespace {
+
+unsigned char lowerAscii(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+uint32_t trigramAt(const char* p) {
+    return (uint32_t{lowerAscii(static_cast<unsigned char>(p[0]))} << 16) |
+           (uint32_t{lowerAscii(static_cast<unsigned char>(p[1]))} << 8) |
+           uint32_t{lowerAscii(static_cast<unsigned char>(p[2]))};
+}
+
+void appendTrigrams(std::string_view text, std::vector<uint32_t>& out) {
+    for (size_t i = 0; i + 3 <= text.size(); ++i) out.push_back(trigramAt(text.data() + i));
+}
+
+void sortUnique(std::vector<uint32_t>& v) {
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+}
+
+// Literal runs that every match of an ECMAScript pattern must contain. Kept
+// conservative: any alternation gives up, and groups, classes and escapes
+// such as \d only end a run. A quantifier that allows zero repeats takes the
+// character before it out of the run.
+std::vector<std::string> requiredLiterals(std::string_view p) {
+    std::vector<std::string> runs;
+    if (p.find('|') != std::string_view::npos) return runs;
+
+    std::string run;
+    auto flush = [&]() {
+        if (run.size() >= 3) runs.push_back(run);
+        run.clear();
+    };
+
+    int depth = 0;
+    for (size_t i = 0; i < p.size(); ++i) {
+        char c = p[i];
+        switch (c) {
+        case '*':
+        case '?':
+        case '{':
+            if (!run.empty()) run.pop_back();
+            flush();
+            if (c == '{') {
+                while (i < p.size() && p[i] != '}') ++i;
+            }
+            break;
+        case '+':
+            flush();
+            break;
+        case '\\': {
+            if (i + 1 >= p.size()) break;
+            char next = p[++i];
+            if (std::isalnum(static_cast<unsigned char>(next))) {
+                // Character classes, back-references and numeric escapes.
+                flush();
+                if (next == 'x') i += 2;
+                else if (next == 'u') i += 4;
+                else if (next == 'c') i += 1;
+            } else if (depth == 0) {
+                run += next;
+            }
+            break;
+        }
+        case '[':
+            flush();
+            for (++i; i < p.size() && p[i] != ']'; ++i) {
+                if (p[i] == '\\') ++i;
+            }
+            break;
+        case '(':
+            flush();
+            ++depth;
+            break;
+        case ')':
+            flush();
+            if (depth > 0) --depth;
+            break;
+        case '.':
+        case '^':
+        case '$':
+            flush();
+            break;
+        default:
+            if (depth == 0) run += c;
+            break;
+        }
+    }
+    flush();
+    return runs;
+}
+
+size_t findNoCase(std::string_view text, std::string_view pattern, size_t from) {
+    auto it = std::search(text.begin() + from, text.end(), pattern.begin(), pattern.end(), [](char a, char b) {
+        return lowerAscii(static_cast<unsigned char>(a)) == lowerAscii(static_cast<unsigned char>(b));
+    });
+    return it == text.end() ? std::string_view::npos : static_cast<size_t>(it - text.begin());
+}
+
+// Entries per shard. Each shard sorts its own (trigram, entry) pairs, which
+// keeps the sort inside the cache and lets large tables index in parallel.
+constexpr size_t kShardEntries = 4096;
+
+// Trigram posting lists for a run of entries in CSR form: the entries
+// containing keys[k] are postings[starts[k], starts[k + 1]), ascending.
+struct TrigramShard {
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> starts;
+    std::vector<uint32_t> postings;
+
+    // The posting list of every trigram, or false when one of them is absent.
+    bool postingsFor(const std::vector<uint32_t>& trigrams, std::vector<std::span<const uint32_t>>& lists) const {
+        lists.clear();
+        for (uint32_t key : trigrams) {
+            auto it = std::lower_bound(keys.begin(), keys.end(), key);
+            if (it == keys.end() || *it != key) return false;
+            size_t k = static_cast<size_t>(it - keys.begin());
+            lists.emplace_back(postings.data() + starts[k], starts[k + 1] - starts[k]);
+        }
+        return true;
+    }
+};
+
+void buildShard(const SoxText& text, size_t first, size_t last, TrigramShard& shard) {
+    // Every (trigram, entry) occurrence, packed as trigram << 32 | entry and
+    // generated in entry order.
+    std::vector<uint64_t> pairs;
+    for (size_t e = first; e < last; ++e) {
+        std::string_view entry = text.text(e);
+        for (size_t i = 0; i + 3 <= entry.size(); ++i) {
+            pairs.push_back((uint64_t{trigramAt(entry.data() + i)} << 32) | e);
+        }
+    }
+
+    // Trigrams are 24-bit, so three stable byte-wise counting passes group the
+    // pairs by trigram and keep entries ascending within each group.
+    std::vector<uint64_t> sorted(pairs.size());
+    for (int shift = 32; shift < 56; shift += 8) {
+        size_t counts[257] = {};
+        for (uint64_t pair : pairs) ++counts[((pair >> shift) & 0xFF) + 1];
+        for (size_t b = 1; b < 257; ++b) counts[b] += counts[b - 1];
+        for (uint64_t pair : pairs) sorted[counts[(pair >> shift) & 0xFF]++] = pair;
+        pairs.swap(sorted);
+    }
+
+    // A trigram repeated within one entry shows up as adjacent duplicates.
+    shard.postings.reserve(pairs.size());
+    uint64_t previous = UINT64_MAX;
+    for (uint64_t pair : pairs) {
+        if (pair == previous) continue;
+        previous = pair;
+        uint32_t key = static_cast<uint32_t>(pair >> 32);
+        if (shard.keys.empty() || shard.keys.back() != key) {
+            shard.keys.push_back(key);
+            shard.starts.push_back(static_cast<uint32_t>(shard.postings.size()));
+        }
+        shard.postings.push_back(static_cast<uint32_t>(pair));
+    }
+    shard.starts.push_back(static_cast<uint32_t>(shard.postings.size()));
+}
+
+struct FileStamp {
+    std::string path;
+    std::pair<uint64_t, int64_t> stamp;
+};
+
+} // namespace
+
+std::variant<TextQuery, std::string> TextQuery::compile(std::string_view pattern, const TextSearchOptions& options) {
+    if (pattern.empty()) return std::string("Empty search pattern");
+
+    TextQuery query;
+    query.pattern_ = std::string(pattern);
+    query.options_ = options;
+
+    std::vector<std::string> literals;
+    if (options.regex) {
+        auto flags = std::regex::ECMAScript | std::regex::optimize;
+        if (!options.matchCase) flags |= std::regex::icase;
+        try {
+            query.regex_ = std::make_shared<const std::regex>(query.pattern_, flags);
+        } catch (const std::regex_error& e) {
+            return std::string("Invalid regex: ") + e.what();
+        }
+        literals = requiredLiterals(pattern);
+    } else {
+        literals.push_back(query.pattern_);
+    }
+
+    for (const auto& literal : literals) appendTrigrams(literal, query.trigrams_);
+    sortUnique(query.trigrams_);
+    return query;
+}
+
+std::optional<std::pair<size_t, size_t>> TextQuery::find(std::string_view text) const {
+    if (regex_) {
+        std::cmatch match;
+        if (!std::regex_search(text.data(), text.data() + text.size(), match, *regex_)) return std::nullopt;
+        return std::make_pair(static_cast<size_t>(match.position(0)), static_cast<size_t>(match.length(0)));
+    }
+    size_t pos = options_.matchCase ? text.find(pattern_) : findNoCase(text, pattern_, 0);
+    if (pos == std::string_view::npos) return std::nullopt;
+    return std::make_pair(pos, pattern_.size());
+}
+
+std::optional<std::string> TextQuery::replace(std::string_view text, std::string_view replacement) const {
+    if (!find(text)) return std::nullopt;
+
+    std::string out;
+    if (regex_) {
+        std::regex_replace(std::back_inserter(out), text.data(), text.data() + text.size(), *regex_,
+                           std::string(replacement));
+        return out;
+    }
+
+    size_t from = 0;
+    while (true) {
+        size_t pos = options_.matchCase ? text.find(pattern_, from) : findNoCase(text, pattern_, from);
+        if (pos == std::string_view::npos) break;
+        out.append(text, from, pos - from);
+        out.append(replacement);
+        from = pos + pattern_.size();
+    }
+    out.append(text, from);
+    return out;
+}
+
+// One file's entries, with trigram posting lists per shard of entries.
+struct TextSearchIndex::IndexedFile {
+    SoxText text;
+    std::vector<TrigramShard> shards;
+};
+
+std::shared_ptr<const TextSearchIndex::IndexedFile> TextSearchIndex::indexFile(std::span<const std::byte> data) {
+    KUF_PROFILE_ZONE("TextSearchIndex::indexFile");
+    auto file = std::make_shared<IndexedFile>();
+
+    std::optional<std::vector<std::byte>> decoded;
+    if (isSoxEncoded(data)) {
+        decoded = soxDecode(data);
+        if (decoded) data = *decoded;
+    }
+    if (!file->text.load(data)) return nullptr;
+
+    size_t count = file->text.entryCount();
+    file->shards.resize((count + kShardEntries - 1) / kShardEntries);
+    WorkerPool::shared().parallelFor(file->shards.size(), [&](size_t i) {
+        size_t first = i * kShardEntries;
+        buildShard(file->text, first, std::min(count, first + kShardEntries), file->shards[i]);
+    });
+    return file;
+}
+
+template<typename Fn>
+void TextSearchIndex::forEachCandidate(const IndexedFile& file, const TextQuery& query, Fn&& fn) {
+    const auto& trigrams = query.trigrams();
+    if (trigrams.empty()) {
+        for (uint32_t e = 0; e < file.text.entryCount(); ++e) {
+            if (!fn(e)) return;
+        }
+        return;
+    }
+
+    std::vector<std::span<const uint32_t>> lists;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> next;
+    for (const auto& shard : file.shards) {
+        if (!shard.postingsFor(trigrams, lists)) continue;
+
+        // Intersect starting from the rarest trigram so the working set only
+        // shrinks.
+        std::sort(lists.begin(), lists.end(), [](auto a, auto b) { return a.size() < b.size(); });
+        candidates.assign(lists[0].begin(), lists[0].end());
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+            next.clear();
+            std::set_intersection(candidates.begin(), candidates.end(), lists[i].begin(), lists[i].end(),
+                                  std::back_inserter(next));
+            candidates.swap(next);
+        }
+        for (uint32_t e : candidates) {
+            if (!fn(e)) return;
+        }
+    }
+}
+
+size_t TextSearchIndex::refresh(const std::string& dir, const ProgressFn& onProgress) {
+    KUF_PROFILE_ZONE("TextSearchIndex::refresh");
+    std::vector<FileStamp> found;
+    std::error_code ec;
+    fs::path root(dir);
+    for (auto it = fs::recursive_directory_iterator(root, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code statEc;
+        if (!it->is_regular_file(statEc) || lowerExtension(it->path().string()) != ".sox") continue;
+        uint64_t size = it->file_size(statEc);
+        int64_t mtime = it->last_write_time(statEc).time_since_epoch().count();
+        if (statEc) continue;
+        found.push_back({it->path().lexically_relative(root).generic_string(), {size, mtime}});
+    }
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.path < b.path; });
+
+    std::vector<const FileStamp*> changed;
+    {
+        std::lock_guard lock(mutex_);
+        if (directory_ != dir) {
+            files_.clear();
+            stamps_.clear();
+            directory_ = dir;
+        }
+        // Drop files that are gone.
+        for (auto it = stamps_.begin(); it != stamps_.end();) {
+            auto pos = std::lower_bound(found.begin(), found.end(), it->first,
+                                        [](const FileStamp& f, const std::string& path) { return f.path < path; });
+            bool present = pos != found.end() && pos->path == it->first;
+            if (!present) {
+                files_.erase(it->first);
+                it = stamps_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (const auto& f : found) {
+            auto it = stamps_.find(f.path);
+            if (it == stamps_.end() || it->second != f.stamp) changed.push_back(&f);
+        }
+    }
+
+    // Reading and indexing happen outside the lock, so searches keep working
+    // on the previous version of each file until its new one is swapped in.
+    std::vector<std::shared_ptr<const IndexedFile>> indexed(changed.size());
+    std::atomic<size_t> done{0};
+    WorkerPool::shared().parallelFor(changed.size(), [&](size_t i) {
+        MappedFile file;
+        if (file.open((root / changed[i]->path).string())) {
+            indexed[i] = indexFile(file.data());
+        }
+        size_t finished = done.fetch_add(1) + 1;
+        if (onProgress) onProgress(finished, changed.size());
+    });
+
+    std::lock_guard lock(mutex_);
+    for (size_t i = 0; i < changed.size(); ++i) {
+        stamps_[changed[i]->path] = changed[i]->stamp;
+        if (indexed[i]) {
+            files_[changed[i]->path] = std::move(indexed[i]);
+        } else {
+            files_.erase(changed[i]->path);
+        }
+    }
+    return changed.size();
+}
+
+bool TextSearchIndex::addFile(const std::string& path, std::span<const std::byte> data) {
+    auto file = indexFile(data);
+    std::lock_guard lock(mutex_);
+    if (!file) {
+        files_.erase(path);
+        return false;
+    }
+    files_[path] = std::move(file);
+    return true;
+}
+
+void TextSearchIndex::removeFile(const std::string& path) {
+    std::lock_guard lock(mutex_);
+    files_.erase(path);
+    stamps_.erase(path);
+}
+
+void TextSearchIndex::clear() {
+    std::lock_guard lock(mutex_);
+    files_.clear();
+    stamps_.clear();
+    directory_.clear();
+}
+
+size_t TextSearchIndex::fileCount() const {
+    std::lock_guard lock(mutex_);
+    return files_.size();
+}
+
+size_t TextSearchIndex::entryCount() const {
+    std::lock_guard lock(mutex_);
+    size_t count = 0;
+    for (const auto& [path, file] : files_) count += file->text.entryCount();
+    return count;
+}
+
+std::vector<std::string> TextSearchIndex::files() const {
+    std::lock_guard lock(mutex_);
+    std::vector<std::string> paths;
+    paths.reserve(files_.size());
+    for (const auto& [path, file] : files_) paths.push_back(path);
+    return paths;
+}
+
+TextSearchIndex::FileList TextSearchIndex::snapshot() const {
+    std::lock_guard lock(mutex_);
+    return FileList(files_.begin(), files_.end());
+}
+
+TextSearchResult TextSearchIndex::search(const TextQuery& query, size_t maxHits) const {
+    KUF_PROFILE_ZONE("TextSearchIndex::search");
+    TextSearchResult result;
+    for (const auto& [path, file] : snapshot()) {
+        forEachCandidate(*file, query, [&](uint32_t e) {
+            ++result.candidates;
+            std::string_view text = file->text.text(e);
+            auto match = query.find(text);
+            if (!match) return true;
+            if (result.hits.size() == maxHits) {
+                result.truncated = true;
+                return false;
+            }
+            result.hits.push_back({path, e, static_cast<uint32_t>(match->first),
+                                   static_cast<uint32_t>(match->second), std::string(text)});
+            return true;
+        });
+        if (result.truncated) break;
+    }
+    return result;
+}
+
+std::vector<std::string> TextSearchIndex::filesMatching(const TextQuery& query) const {
+    std::vector<std::string> paths;
+    for (const auto& [path, file] : snapshot()) {
+        bool matched = false;
+        forEachCandidate(*file, query, [&](uint32_t e) {
+            matched = query.find(file->text.text(e)).has_value();
+            return !matched;
+        });
+        if (matched) paths.push_back(path);
+    }
+    return paths;
+}
+
+} // namespace kuf
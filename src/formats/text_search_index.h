@@ -0,0 +1,134 @@
+#pragma once
+
+#include "formats/sox_text.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <regex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace kuf {
+
+struct TextSearchOptions {
+    bool regex = false;
+    bool matchCase = false;
+};
+
+// A compiled search pattern, shared by index lookups and replacement. Besides
+// the matcher it keeps the trigrams every match must contain, which is what
+// lets the index skip entries without running the matcher on them.
+class TextQuery {
+public:
+    // Fails with a message when the regex does not compile.
+    static std::variant<TextQuery, std::string> compile(std::string_view pattern, const TextSearchOptions& options);
+
+    // First match in text as (offset, length).
+    std::optional<std::pair<size_t, size_t>> find(std::string_view text) const;
+
+    // text with every match replaced, or nullopt when nothing matches. Regex
+    // replacements may refer to groups as $1, $2 and so on.
+    std::optional<std::string> replace(std::string_view text, std::string_view replacement) const;
+
+    // Lowercase trigrams that occur in every match, sorted and unique. Empty
+    // when the pattern has no literal run of three characters, in which case
+    // every entry is a candidate.
+    const std::vector<uint32_t>& trigrams() const { return trigrams_; }
+
+private:
+    TextQuery() = default;
+
+    std::string pattern_;
+    TextSearchOptions options_;
+    std::shared_ptr<const std::regex> regex_;
+    std::vector<uint32_t> trigrams_;
+};
+
+// One matching entry. path is relative to the indexed directory, with forward
+// slashes; offset and length give the first match in text.
+struct TextSearchHit {
+    std::string path;
+    uint32_t entry = 0;
+    uint32_t offset = 0;
+    uint32_t length = 0;
+    std::string text;
+};
+
+struct TextSearchResult {
+    std::vector<TextSearchHit> hits;
+    size_t candidates = 0; // Entries the matcher ran on.
+    bool truncated = false;
+};
+
+// Outcome of replacing a query's matches in one file.
+struct TextReplaceResult {
+    size_t changed = 0;   // Entries replaced.
+    size_t skipped = 0;   // Matches whose replacement was empty or too long.
+    bool blocked = false; // Validation failed, so the file was not saved.
+    bool unsaved = false; // The file already had unsaved edits, so it was left for the user to save.
+};
+
+// Trigram index over the text SOX files below a game directory. Each file
+// keeps its own posting lists, so refreshing after an edit re-reads and
+// re-indexes only the files whose size or modification time changed. Files
+// are swapped in whole under a lock and searches work on a snapshot, so a
+// refresh may run on a task thread while the UI searches.
+class TextSearchIndex {
+public:
+    // Called with (files done, file count) from whichever thread finished a file.
+    using ProgressFn = std::function<void(size_t done, size_t total)>;
+
+    // Finds every .sox file below dir and indexes the text ones that are new or
+    // changed since the last refresh; files that disappeared are dropped.
+    // Switching to another directory starts over. Returns the number of files
+    // read.
+    size_t refresh(const std::string& dir, const ProgressFn& onProgress = {});
+
+    // Indexes a file already in memory under a relative path. Returns false and
+    // drops any earlier version when data is not a text SOX.
+    bool addFile(const std::string& path, std::span<const std::byte> data);
+    void removeFile(const std::string& path);
+    void clear();
+
+    size_t fileCount() const;
+    size_t entryCount() const;
+    std::vector<std::string> files() const;
+
+    // Entries matching query in path order, then entry order; stops after
+    // maxHits and sets truncated.
+    TextSearchResult search(const TextQuery& query, size_t maxHits = 10000) const;
+
+    // Relative paths of the files with at least one match.
+    std::vector<std::string> filesMatching(const TextQuery& query) const;
+
+private:
+    struct IndexedFile;
+    using FileList = std::vector<std::pair<std::string, std::shared_ptr<const IndexedFile>>>;
+
+    static std::shared_ptr<const IndexedFile> indexFile(std::span<const std::byte> data);
+
+    // Calls fn(entry) for every entry of file that may match, in entry order,
+    // until fn returns false.
+    template<typename Fn>
+    static void forEachCandidate(const IndexedFile& file, const TextQuery& query, Fn&& fn);
+
+    // The current files, so searches run without holding the lock.
+    FileList snapshot() const;
+
+    mutable std::mutex mutex_;
+    std::string directory_;
+    std::map<std::string, std::shared_ptr<const IndexedFile>, std::less<>> files_;
+    // Size and modification time of every .sox seen by refresh, text or not,
+    // so unchanged non-text files are not read again either.
+    std::map<std::string, std::pair<uint64_t, int64_t>, std::less<>> stamps_;
+};
+
+} // namespace kuf
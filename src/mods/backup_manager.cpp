@@ -1,10 +1,17 @@
 #include "mods/backup_manager.h"
 #include "core/config.h"
+#include "core/hash.h"
+#include "core/worker_pool.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
 #include <sstream>
 
 namespace kuf {
@@ -37,9 +44,59 @@ std::string formatTimestamp(const std::string& dirName) {
     return result;
 }
 
+// Copies a file and carries over its modification time, so later delta restores
+// can skip identical files on the size + mtime check alone.
 void copyFileWithDirs(const fs::path& src, const fs::path& dest) {
     fs::create_directories(dest.parent_path());
     fs::copy_file(src, dest, fs::copy_options::overwrite_existing);
+
+    std::error_code ec;
+    auto mtime = fs::last_write_time(src, ec);
+    if (!ec) {
+        fs::last_write_time(dest, mtime, ec);
+    }
+}
+
+// Compares two files byte-for-byte in fixed-size chunks, stopping at the first difference.
+bool sameContents(const fs::path& a, const fs::path& b) {
+    std::ifstream fa(a, std::ios::binary);
+    std::ifstream fb(b, std::ios::binary);
+    if (!fa || !fb) return false;
+
+    constexpr size_t kChunkSize = 64 * 1024;
+    std::array<char, kChunkSize> bufA;
+    std::array<char, kChunkSize> bufB;
+
+    while (fa && fb) {
+        fa.read(bufA.data(), kChunkSize);
+        fb.read(bufB.data(), kChunkSize);
+        auto readA = fa.gcount();
+        auto readB = fb.gcount();
+        if (readA != readB) return false;
+        if (std::memcmp(bufA.data(), bufB.data(), static_cast<size_t>(readA)) != 0) return false;
+    }
+    return fa.eof() && fb.eof();
+}
+
+// Returns true if dest already holds the same data as src. Size and mtime are
+// checked first; contents are only read when the metadata is inconclusive.
+bool fileUpToDate(const fs::path& src, const fs::path& dest) {
+    std::error_code ec;
+    auto destStatus = fs::status(dest, ec);
+    if (ec || !fs::is_regular_file(destStatus)) return false;
+
+    auto srcSize = fs::file_size(src, ec);
+    if (ec) return false;
+    auto destSize = fs::file_size(dest, ec);
+    if (ec || srcSize != destSize) return false;
+
+    auto srcTime = fs::last_write_time(src, ec);
+    if (!ec) {
+        auto destTime = fs::last_write_time(dest, ec);
+        if (!ec && srcTime == destTime) return true;
+    }
+
+    return sameContents(src, dest);
 }
 
 std::vector<fs::path> enumerateFiles(const std::string& dir) {
@@ -53,6 +110,45 @@ std::vector<fs::path> enumerateFiles(const std::string& dir) {
     return files;
 }
 
+// Hashes a file through a caller-owned buffer so concurrent hashing stays within
+// a fixed amount of memory per worker.
+std::optional<uint64_t> hashFile(const fs::path& path, std::vector<char>& buffer) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return std::nullopt;
+
+    Hash64 hasher;
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        auto got = file.gcount();
+        if (got > 0) hasher.update(buffer.data(), static_cast<size_t>(got));
+    }
+    if (!file.eof()) return std::nullopt;
+    return hasher.digest();
+}
+
+// Relative paths (generic separators) of every regular file under dir, sorted.
+std::vector<std::string> relativeFileList(const std::string& dir, bool skipBackupMeta) {
+    std::vector<std::string> result;
+    fs::path root(dir);
+    for (const auto& f : enumerateFiles(dir)) {
+        if (skipBackupMeta && f.filename() == "backup.json") continue;
+        result.push_back(fs::relative(f, root).generic_string());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// Lists the game files stored in a backup, excluding its backup.json metadata.
+std::vector<fs::path> enumerateBackupFiles(const std::string& backupPath) {
+    std::vector<fs::path> gameFiles;
+    for (auto& f : enumerateFiles(backupPath)) {
+        if (f.filename() != "backup.json") {
+            gameFiles.push_back(std::move(f));
+        }
+    }
+    return gameFiles;
+}
+
 } // namespace
 
 std::string BackupManager::backupDirectory() {
@@ -110,24 +206,29 @@ bool BackupManager::createBackup(const std::string& gameDir, AsyncTask& task) {
     return true;
 }
 
-bool BackupManager::restoreBackup(const BackupInfo& backup, const std::string& gameDir, AsyncTask& task) {
-    auto files = enumerateFiles(backup.path);
-
-    // Filter out backup.json from the file list.
+bool BackupManager::restoreBackup(const BackupInfo& backup, const std::string& gameDir, AsyncTask& task,
+                                  RestoreMode mode) {
+    fs::path backupRoot(backup.path);
     std::vector<fs::path> gameFiles;
-    for (const auto& f : files) {
-        if (f.filename() != "backup.json") {
-            gameFiles.push_back(f);
-        }
-    }
 
-    if (gameFiles.empty()) {
-        task.setError("Backup contains no game files");
-        return false;
+    if (mode == RestoreMode::Delta) {
+        auto plan = planRestore(backup, gameDir, task);
+        if (!plan) return false;
+        for (const auto& rel : plan->changedFiles) {
+            gameFiles.push_back(backupRoot / fs::path(rel));
+        }
+        if (gameFiles.empty()) {
+            task.setProgress(1.0f, "Game directory already matches backup");
+            return true;
+        }
+    } else {
+        gameFiles = enumerateBackupFiles(backup.path);
+        if (gameFiles.empty()) {
+            task.setError("Backup contains no game files");
+            return false;
+        }
     }
 
-    fs::path backupRoot(backup.path);
-
     for (size_t i = 0; i < gameFiles.size(); ++i) {
         auto relativePath = fs::relative(gameFiles[i], backupRoot);
         auto destPath = fs::path(gameDir) / relativePath;
@@ -147,6 +248,114 @@ bool BackupManager::restoreBackup(const BackupInfo& backup, const std::string& g
     return true;
 }
 
+std::optional<RestorePlan> BackupManager::planRestore(const BackupInfo& backup, const std::string& gameDir,
+                                                      AsyncTask& task) {
+    auto gameFiles = enumerateBackupFiles(backup.path);
+    if (gameFiles.empty()) {
+        task.setError("Backup contains no game files");
+        return std::nullopt;
+    }
+
+    fs::path backupRoot(backup.path);
+    RestorePlan plan;
+
+    for (size_t i = 0; i < gameFiles.size(); ++i) {
+        auto relativePath = fs::relative(gameFiles[i], backupRoot);
+        auto destPath = fs::path(gameDir) / relativePath;
+
+        task.setProgress(static_cast<float>(i) / static_cast<float>(gameFiles.size()),
+                         "Comparing " + relativePath.string());
+
+        if (fileUpToDate(gameFiles[i], destPath)) {
+            ++plan.unchangedCount;
+            continue;
+        }
+
+        plan.changedFiles.push_back(relativePath.generic_string());
+        std::error_code ec;
+        auto size = fs::file_size(gameFiles[i], ec);
+        if (!ec) plan.bytesToCopy += size;
+    }
+
+    task.setProgress(1.0f, "Comparison complete");
+    return plan;
+}
+
+std::optional<VerifyReport> BackupManager::verifyBackup(const BackupInfo& backup, const std::string& gameDir,
+                                                       AsyncTask& task) {
+    task.setProgress(0.0f, "Scanning files");
+    auto backupFiles = relativeFileList(backup.path, true);
+    auto gameFiles = relativeFileList(gameDir, false);
+    if (backupFiles.empty()) {
+        task.setError("Backup contains no game files");
+        return std::nullopt;
+    }
+
+    VerifyReport report;
+    std::set_difference(backupFiles.begin(), backupFiles.end(), gameFiles.begin(), gameFiles.end(),
+                        std::back_inserter(report.missingFiles));
+    std::set_difference(gameFiles.begin(), gameFiles.end(), backupFiles.begin(), backupFiles.end(),
+                        std::back_inserter(report.extraFiles));
+
+    std::vector<std::string> common;
+    std::set_intersection(backupFiles.begin(), backupFiles.end(), gameFiles.begin(), gameFiles.end(),
+                          std::back_inserter(common));
+
+    // Files whose sizes differ are modified without reading them. The rest are
+    // hashed on both sides; each side of each pair is an independent work item so
+    // the backup and game directory are read concurrently.
+    std::vector<std::string> candidates;
+    size_t totalBytes = 0;
+    for (const auto& rel : common) {
+        std::error_code ecA, ecB;
+        auto sizeA = fs::file_size(fs::path(backup.path) / fs::path(rel), ecA);
+        auto sizeB = fs::file_size(fs::path(gameDir) / fs::path(rel), ecB);
+        if (ecA || ecB || sizeA != sizeB) {
+            report.modifiedFiles.push_back(rel);
+        } else {
+            candidates.push_back(rel);
+            totalBytes += sizeA * 2;
+        }
+    }
+
+    std::vector<std::optional<uint64_t>> hashes(candidates.size() * 2);
+    std::atomic<size_t> bytesDone{0};
+    std::atomic<size_t> itemsDone{0};
+    constexpr size_t kHashBufferSize = 1024 * 1024;
+
+    WorkerPool::shared().parallelFor(hashes.size(), [&](size_t i) {
+        thread_local std::vector<char> buffer(kHashBufferSize);
+        const std::string& rel = candidates[i / 2];
+        fs::path path = (i % 2 == 0 ? fs::path(backup.path) : fs::path(gameDir)) / fs::path(rel);
+
+        hashes[i] = hashFile(path, buffer);
+
+        std::error_code ec;
+        auto size = fs::file_size(path, ec);
+        size_t done = bytesDone.fetch_add(ec ? 0 : size) + (ec ? 0 : size);
+        size_t items = itemsDone.fetch_add(1) + 1;
+        if (items % 16 == 0 || items == hashes.size()) {
+            float fraction = totalBytes > 0 ? static_cast<float>(done) / static_cast<float>(totalBytes) : 1.0f;
+            task.setProgress(fraction, "Hashing " + rel);
+        }
+    });
+
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const auto& hashBackup = hashes[i * 2];
+        const auto& hashGame = hashes[i * 2 + 1];
+        if (hashBackup && hashGame && *hashBackup == *hashGame) {
+            ++report.matchedCount;
+        } else {
+            report.modifiedFiles.push_back(candidates[i]);
+        }
+    }
+    std::sort(report.modifiedFiles.begin(), report.modifiedFiles.end());
+    report.bytesHashed = bytesDone.load();
+
+    task.setProgress(1.0f, "Verification complete");
+    return report;
+}
+
 bool BackupManager::deleteBackup(const BackupInfo& backup) {
     if (backup.path.empty() || !fs::exists(backup.path)) return false;
 
@@ -16,11 +16,39 @@ struct BackupInfo {
     size_t totalBytes = 0;
 };
 
+enum class RestoreMode {
+    Full,  // Copy every file in the backup over the game directory.
+    Delta  // Copy only files that differ from the game directory.
+};
+
+// Result of comparing a backup against the game directory without touching it.
+struct RestorePlan {
+    std::vector<std::string> changedFiles; // Relative paths a delta restore would rewrite.
+    size_t unchangedCount = 0;
+    size_t bytesToCopy = 0;
+};
+
+// Result of comparing a backup against the game directory by content hash.
+struct VerifyReport {
+    std::vector<std::string> missingFiles;  // In the backup, absent from the game directory.
+    std::vector<std::string> extraFiles;    // In the game directory, absent from the backup.
+    std::vector<std::string> modifiedFiles; // In both, with different contents.
+    size_t matchedCount = 0;
+    size_t bytesHashed = 0;
+
+    bool clean() const { return missingFiles.empty() && extraFiles.empty() && modifiedFiles.empty(); }
+};
+
 class BackupManager {
 public:
     static std::string backupDirectory();
     static bool createBackup(const std::string& gameDir, AsyncTask& task);
-    static bool restoreBackup(const BackupInfo& backup, const std::string& gameDir, AsyncTask& task);
+    static bool restoreBackup(const BackupInfo& backup, const std::string& gameDir, AsyncTask& task,
+                              RestoreMode mode = RestoreMode::Full);
+    static std::optional<RestorePlan> planRestore(const BackupInfo& backup, const std::string& gameDir,
+                                                  AsyncTask& task);
+    static std::optional<VerifyReport> verifyBackup(const BackupInfo& backup, const std::string& gameDir,
+                                                    AsyncTask& task);
     static bool deleteBackup(const BackupInfo& backup);
     static std::vector<BackupInfo> listBackups();
     static std::optional<BackupInfo> latestBackup();
@@ -0,0 +1,292 @@
+#include "mods/mod_conflict_index.h"
+#include "core/file_io.h"
+#include "core/worker_pool.h"
+#include "core/zip_archive.h"
+#include "formats/record_digest.h"
+#include "formats/record_patch.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <unordered_set>
+
+namespace kuf {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// The game runs on case-insensitive filesystems and mod authors mix separators.
+std::string normalizePath(const std::string& path) {
+    std::string result;
+    result.reserve(path.size());
+    for (char c : path) {
+        result += c == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    size_t start = 0;
+    while (start < result.size() && (result[start] == '/' || result.compare(start, 2, "./") == 0)) {
+        start += result[start] == '/' ? 1 : 2;
+    }
+    return result.substr(start);
+}
+
+// Reads the game's copy of a normalized path. Mods may spell a path in any
+// case, so when the exact spelling is missing each component is matched
+// case-insensitively against the directory listing.
+std::optional<std::vector<std::byte>> readGameFile(const std::string& gameDir,
+                                                   const std::string& displayPath,
+                                                   const std::string& normalizedPath) {
+    if (auto data = readFileBytes(gameDir + "/" + displayPath)) return data;
+
+    fs::path current = gameDir;
+    size_t start = 0;
+    while (true) {
+        size_t slash = normalizedPath.find('/', start);
+        std::string part = normalizedPath.substr(start, slash - start);
+
+        std::optional<fs::path> match;
+        std::error_code ec;
+        for (fs::directory_iterator it(current, ec), end; !ec && it != end; it.increment(ec)) {
+            if (normalizePath(it->path().filename().string()) == part) {
+                match = it->path();
+                break;
+            }
+        }
+        if (!match) return std::nullopt;
+        current = *match;
+        if (slash == std::string::npos) return readFileBytes(current);
+        start = slash + 1;
+    }
+}
+
+bool hasRecordStructure(const std::string& normalizedPath) {
+    auto endsWith = [&](const char* ext) {
+        size_t n = std::char_traits<char>::length(ext);
+        return normalizedPath.size() >= n &&
+               normalizedPath.compare(normalizedPath.size() - n, n, ext) == 0;
+    };
+    return endsWith(".sox") || endsWith(".stg");
+}
+
+} // namespace
+
+ModConflictIndex::Entry ModConflictIndex::readEntry(const ModInfo& mod) {
+    Entry entry;
+    entry.name = mod.metadata.name;
+    entry.fileSize = mod.fileSize;
+
+    ZipReader reader;
+    if (reader.open(mod.zipPath)) {
+        for (auto& name : reader.entries()) {
+            if (name == "mod.json") continue;
+            entry.files[normalizePath(ModManager::gamePathForEntry(name))] = std::move(name);
+        }
+    }
+    for (const auto& declared : mod.metadata.files) {
+        entry.files.try_emplace(normalizePath(declared));
+    }
+    return entry;
+}
+
+void ModConflictIndex::insertLocked(const std::string& zipPath, Entry entry) {
+    eraseLocked(zipPath);
+    for (const auto& [path, archiveName] : entry.files) {
+        auto& pathMods = modsByPath_[path];
+        if (pathMods.displayPath.empty()) {
+            pathMods.displayPath =
+                archiveName.empty() ? path : ModManager::gamePathForEntry(archiveName);
+        }
+        pathMods.zipPaths.push_back(zipPath);
+    }
+    mods_[zipPath] = std::move(entry);
+}
+
+void ModConflictIndex::eraseLocked(const std::string& zipPath) {
+    auto it = mods_.find(zipPath);
+    if (it == mods_.end()) return;
+
+    for (const auto& [path, archiveName] : it->second.files) {
+        auto pm = modsByPath_.find(path);
+        if (pm == modsByPath_.end()) continue;
+        auto& zips = pm->second.zipPaths;
+        zips.erase(std::remove(zips.begin(), zips.end(), zipPath), zips.end());
+        if (zips.empty()) modsByPath_.erase(pm);
+    }
+    mods_.erase(it);
+}
+
+void ModConflictIndex::addMod(const ModInfo& mod) {
+    Entry entry = readEntry(mod);
+    std::lock_guard lock(mutex_);
+    insertLocked(mod.zipPath, std::move(entry));
+}
+
+void ModConflictIndex::removeMod(const std::string& zipPath) {
+    std::lock_guard lock(mutex_);
+    eraseLocked(zipPath);
+}
+
+void ModConflictIndex::sync(const std::vector<ModInfo>& mods) {
+    std::vector<const ModInfo*> stale;
+    {
+        std::lock_guard lock(mutex_);
+        std::unordered_set<std::string> listed;
+        for (const auto& mod : mods) {
+            listed.insert(mod.zipPath);
+            auto it = mods_.find(mod.zipPath);
+            if (it == mods_.end() || it->second.fileSize != mod.fileSize ||
+                it->second.name != mod.metadata.name) {
+                stale.push_back(&mod);
+            }
+        }
+
+        std::vector<std::string> gone;
+        for (const auto& [zipPath, entry] : mods_) {
+            if (!listed.count(zipPath)) gone.push_back(zipPath);
+        }
+        for (const auto& zipPath : gone) {
+            eraseLocked(zipPath);
+        }
+    }
+
+    // Central directories are read outside the lock; a first sync over a large
+    // library opens every archive, so spread that across the pool.
+    std::vector<Entry> entries(stale.size());
+    WorkerPool::shared().parallelFor(stale.size(), [&](size_t i) {
+        entries[i] = readEntry(*stale[i]);
+    });
+
+    std::lock_guard lock(mutex_);
+    for (size_t i = 0; i < stale.size(); ++i) {
+        insertLocked(stale[i]->zipPath, std::move(entries[i]));
+    }
+}
+
+size_t ModConflictIndex::modCount() const {
+    std::lock_guard lock(mutex_);
+    return mods_.size();
+}
+
+std::vector<std::string> ModConflictIndex::modsTouching(const std::string& path) const {
+    std::lock_guard lock(mutex_);
+    auto it = modsByPath_.find(normalizePath(path));
+    if (it == modsByPath_.end()) return {};
+    return it->second.zipPaths;
+}
+
+std::vector<ModConflict> ModConflictIndex::conflictsFor(const std::string& zipPath) const {
+    std::lock_guard lock(mutex_);
+    auto self = mods_.find(zipPath);
+    if (self == mods_.end()) return {};
+
+    std::map<std::string, std::vector<std::string>> filesByOther;
+    for (const auto& [path, archiveName] : self->second.files) {
+        const auto& pathMods = modsByPath_.at(path);
+        for (const auto& other : pathMods.zipPaths) {
+            if (other != zipPath) {
+                filesByOther[other].push_back(pathMods.displayPath);
+            }
+        }
+    }
+
+    std::vector<ModConflict> result;
+    result.reserve(filesByOther.size());
+    for (auto& [other, files] : filesByOther) {
+        std::sort(files.begin(), files.end());
+        result.push_back({mods_.at(other).name, other, std::move(files)});
+    }
+    std::sort(result.begin(), result.end(), [](const ModConflict& a, const ModConflict& b) {
+        return a.otherMod < b.otherMod;
+    });
+    return result;
+}
+
+std::vector<RecordConflict> ModConflictIndex::recordConflictsFor(const std::string& zipPath,
+                                                                 const std::string& gameDir) const {
+    struct WorkItem {
+        std::string otherMod;
+        std::string otherZipPath;
+        std::string path;
+        std::string displayPath;
+        std::string selfEntry;
+        std::string otherEntry;
+    };
+
+    std::vector<WorkItem> items;
+    {
+        std::lock_guard lock(mutex_);
+        auto self = mods_.find(zipPath);
+        if (self == mods_.end()) return {};
+
+        for (const auto& [path, selfEntry] : self->second.files) {
+            const auto& pathMods = modsByPath_.at(path);
+            for (const auto& other : pathMods.zipPaths) {
+                if (other == zipPath) continue;
+                const auto& otherEntry = mods_.at(other);
+                items.push_back({otherEntry.name, other, path, pathMods.displayPath, selfEntry,
+                                 otherEntry.files.at(path)});
+            }
+        }
+    }
+
+    std::vector<RecordConflict> result(items.size());
+    WorkerPool::shared().parallelFor(items.size(), [&](size_t i) {
+        const auto& item = items[i];
+        auto& conflict = result[i];
+        conflict.otherMod = item.otherMod;
+        conflict.file = item.displayPath;
+        conflict.wholeFile = true;
+
+        if (!hasRecordStructure(item.path) || item.selfEntry.empty() || item.otherEntry.empty()) {
+            return;
+        }
+
+        // Records can only be told apart against the game's copy; without one
+        // the overlap stays a single whole-file conflict.
+        auto baseData = readGameFile(gameDir, item.displayPath, item.path);
+        auto baseRecords = baseData ? digestRecords(item.displayPath, *baseData) : std::nullopt;
+        if (!baseRecords) return;
+
+        auto changedBy = [&](const std::string& archive, const std::string& entryName)
+            -> std::optional<std::vector<std::string>> {
+            ZipReader reader;
+            if (!reader.open(archive)) return std::nullopt;
+            std::vector<std::byte> scratch;
+            auto data = reader.entryBytes(entryName, scratch);
+            if (!data) return std::nullopt;
+
+            // A patch lists the records it edits.
+            if (ModManager::isPatchEntry(entryName)) {
+                auto patch = parseRecordPatch(*data);
+                if (!patch) return std::nullopt;
+                std::vector<std::string> keys;
+                for (const auto& edit : patch->edits) keys.push_back(edit.key);
+                std::sort(keys.begin(), keys.end());
+                return keys;
+            }
+
+            auto records = digestRecords(item.displayPath, *data);
+            if (!records) return std::nullopt;
+            return changedRecords(*baseRecords, *records);
+        };
+
+        auto selfChanged = changedBy(zipPath, item.selfEntry);
+        auto otherChanged = selfChanged ? changedBy(item.otherZipPath, item.otherEntry)
+                                        : std::nullopt;
+        if (!selfChanged || !otherChanged) return;
+
+        std::set_intersection(selfChanged->begin(), selfChanged->end(), otherChanged->begin(),
+                              otherChanged->end(), std::back_inserter(conflict.records));
+        conflict.wholeFile = false;
+    });
+
+    std::sort(result.begin(), result.end(), [](const RecordConflict& a, const RecordConflict& b) {
+        return a.otherMod != b.otherMod ? a.otherMod < b.otherMod : a.file < b.file;
+    });
+    return result;
+}
+
+} // namespace kuf
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "mods/mod_manager.h"
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kuf {
+
+// Files one other mod shares with the mod being inspected.
+struct ModConflict {
+    std::string otherMod;
+    std::string otherZipPath;
+    std::vector<std::string> files;
+};
+
+// Record-level view of one shared SOX or STG file.
+struct RecordConflict {
+    std::string otherMod;
+    std::string file;
+    std::vector<std::string> records; // Records both mods change relative to the game.
+    bool wholeFile = false;           // No record structure; any overlap is a conflict.
+};
+
+// Inverted index of game file path -> library mods that write it, built from
+// each mod's declared file list and its archive's central directory. Mods are
+// identified by archive path, since names need not be unique in the library.
+// All methods are safe to call from task threads.
+class ModConflictIndex {
+public:
+    void addMod(const ModInfo& mod);
+    void removeMod(const std::string& zipPath);
+
+    // Adds archives that are new or changed size and drops ones that are gone.
+    void sync(const std::vector<ModInfo>& mods);
+
+    size_t modCount() const;
+    std::vector<std::string> modsTouching(const std::string& path) const;
+
+    // File-level overlaps, answered from the index alone.
+    std::vector<ModConflict> conflictsFor(const std::string& zipPath) const;
+
+    // Reads every shared SOX/STG file from both archives and the game directory
+    // and reports which records both mods change. A file missing from the game
+    // directory is reported as one whole-file conflict. Files are compared in
+    // parallel.
+    std::vector<RecordConflict> recordConflictsFor(const std::string& zipPath,
+                                                   const std::string& gameDir) const;
+
+private:
+    struct Entry {
+        std::string name;
+        size_t fileSize = 0;
+        // Normalized game path -> entry name inside the archive (empty when the
+        // path is only declared in mod.json).
+        std::unordered_map<std::string, std::string> files;
+    };
+
+    struct PathMods {
+        std::string displayPath;
+        std::vector<std::string> zipPaths;
+    };
+
+    static Entry readEntry(const ModInfo& mod);
+    void insertLocked(const std::string& zipPath, Entry entry);
+    void eraseLocked(const std::string& zipPath);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> mods_;
+    std::unordered_map<std::string, PathMods> modsByPath_;
+};
+
+} // namespace kuf
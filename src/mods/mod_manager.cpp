@@ -1,25 +1,356 @@
 #include "mods/mod_manager.h"
 #include "core/config.h"
+#include "core/file_io.h"
+#include "core/hash.h"
 #include "core/json.h"
+#include "core/worker_pool.h"
 #include "core/zip_archive.h"
+#include "formats/record_patch.h"
+#include "mods/mod_conflict_index.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace kuf {
 
 namespace fs = std::filesystem;
 
+namespace {
+
+// Reads and validates mod.json from a library archive.
+std::optional<ModMetadata> readArchiveMetadata(const std::string& zipPath) {
+    ZipReader reader;
+    if (!reader.open(zipPath)) return std::nullopt;
+
+    // Called for every new archive in the library; reuse one inflate buffer
+    // per thread and view stored mod.json entries in place.
+    thread_local std::vector<std::byte> scratch;
+    auto jsonData = reader.entryBytes("mod.json", scratch);
+    if (!jsonData) return std::nullopt;
+
+    std::string jsonStr(reinterpret_cast<const char*>(jsonData->data()), jsonData->size());
+    return parseModJson(jsonStr);
+}
+
+int64_t fileModifiedTime(const fs::directory_entry& entry) {
+    std::error_code ec;
+    auto time = entry.last_write_time(ec);
+    if (ec) return 0;
+    return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+std::vector<ModIndexEntry> loadLibraryIndex(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return {};
+
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    return parseModIndexJson(content);
+}
+
+// Writes through a temporary file so an interrupted save never leaves a
+// truncated index behind.
+void saveLibraryIndex(const std::string& path, const std::vector<ModIndexEntry>& entries) {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath);
+        if (!file) return;
+        file << serializeModIndexJson(entries);
+        if (!file.good()) return;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+}
+
+// Same temporary-file dance as the library index; installed.json is what
+// crash recovery consults to tell a finished install from an interrupted one.
+bool saveInstalledMods(const std::string& path, const std::vector<InstalledModInfo>& mods) {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath);
+        if (!file) return false;
+        file << serializeInstalledModsJson(mods);
+        if (!file.good()) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+constexpr const char* kPatchEntryPrefix = "patches/";
+
+bool writeDiskFileAtomic(const std::string& path, const std::vector<std::byte>& data) {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary);
+        if (!file) return false;
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        if (!file.good()) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+// Applies a patch entry from the mod archive to the game file it targets.
+std::string applyPatchEntry(const ZipReader& reader, const std::string& entryName,
+                            const std::string& gamePath, const std::string& destPath) {
+    std::vector<std::byte> scratch;
+    auto patchData = reader.entryBytes(entryName, scratch);
+    if (!patchData) return "Failed to read patch: " + entryName;
+    auto patch = parseRecordPatch(*patchData);
+    if (!patch) return "Invalid patch: " + entryName;
+
+    auto current = readFileBytes(destPath);
+    if (!current) return "Patch target missing: " + gamePath;
+
+    auto result = applyRecordPatch(gamePath, *current, *patch);
+    if (auto* error = std::get_if<std::string>(&result)) {
+        return gamePath + ": " + *error;
+    }
+    if (!writeDiskFileAtomic(destPath, std::get<std::vector<std::byte>>(result))) {
+        return "Failed to write: " + gamePath;
+    }
+    return {};
+}
+
+// Pre-image archive layout: the original bytes of every file a mod overwrote
+// under files/, plus a newline separated list of the files it created.
+constexpr const char* kPreimageFilesPrefix = "files/";
+constexpr const char* kPreimageCreatedList = "created.txt";
+
+// Written once the pre-image is complete and removed once installed.json lists
+// the mod. Finding it on startup means game files may be half-applied.
+struct InstallJournal {
+    std::string name;
+    std::string gameDir;
+    std::string preimagePath;
+};
+
+bool writeInstallJournal(const std::string& path, const InstallJournal& journal) {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath);
+        if (!file) return false;
+        file << journal.name << "\n" << journal.gameDir << "\n" << journal.preimagePath << "\n";
+        if (!file.good()) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+std::optional<InstallJournal> readInstallJournal(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return std::nullopt;
+
+    InstallJournal journal;
+    if (!std::getline(file, journal.name) || !std::getline(file, journal.gameDir) ||
+        !std::getline(file, journal.preimagePath)) {
+        return std::nullopt;
+    }
+    return journal;
+}
+
+// Mod names are free text; keep the file name portable and unique per name.
+std::string preimageFileName(const std::string& modName) {
+    std::string safe;
+    for (char c : modName) {
+        bool keep = std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+        safe += keep ? c : '_';
+    }
+    std::ostringstream ss;
+    ss << safe << "-" << std::hex << std::setw(8) << std::setfill('0')
+       << static_cast<uint32_t>(hash64(modName.data(), modName.size()));
+    return ss.str() + ".zip";
+}
+
+// Next to each pre-image: the hash of every file the mod left in the game
+// directory, one "<hash> <path>" line each. Uninstall only reverts files that
+// still match, so changes made after the install, such as by a later mod, stay.
+using WrittenHashes = std::unordered_map<std::string, uint64_t>;
+
+std::string writtenHashesPath(const std::string& preimagePath) {
+    return preimagePath + ".written";
+}
+
+std::optional<uint64_t> hashDiskFile(const std::string& path) {
+    auto data = readFileBytes(path);
+    if (!data) return std::nullopt;
+    return hash64(*data);
+}
+
+bool saveWrittenHashes(const std::string& path, const std::vector<std::string>& relativePaths,
+                       const std::string& gameDir) {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath);
+        if (!file) return false;
+        for (const auto& rel : relativePaths) {
+            auto hash = hashDiskFile(gameDir + "/" + rel);
+            if (!hash) continue;
+            file << std::hex << std::setw(16) << std::setfill('0') << *hash << " " << rel << "\n";
+        }
+        if (!file.good()) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+std::optional<WrittenHashes> loadWrittenHashes(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return std::nullopt;
+
+    WrittenHashes hashes;
+    std::string line;
+    while (std::getline(file, line)) {
+        auto space = line.find(' ');
+        if (space == std::string::npos) continue;
+        hashes[line.substr(space + 1)] = std::stoull(line.substr(0, space), nullptr, 16);
+    }
+    return hashes;
+}
+
+// Copies the current version of each path the mod touches into the pre-image.
+// Only the mod's own file list is read, so the cost follows the mod's size.
+bool capturePreimage(const std::vector<std::string>& relativePaths, const std::string& gameDir,
+                     const std::string& preimagePath, AsyncTask& task) {
+    std::string tmpPath = preimagePath + ".tmp";
+    std::string created;
+    {
+        ZipWriter writer;
+        if (!writer.create(tmpPath)) return false;
+
+        std::vector<ZipFileSource> existing;
+        for (const auto& rel : relativePaths) {
+            std::string fullPath = gameDir + "/" + rel;
+            if (fs::is_regular_file(fullPath)) {
+                existing.push_back({fullPath, kPreimageFilesPrefix + rel});
+            } else {
+                created += rel + "\n";
+            }
+        }
+
+        bool added = writer.addFiles(existing, [&](size_t i) {
+            task.setProgress(static_cast<float>(i + 1) / static_cast<float>(existing.size()),
+                             "Saved " + fs::path(existing[i].diskPath).filename().string());
+        });
+        if (!added) return false;
+
+        if (!writer.addMemory(kPreimageCreatedList, created.data(), created.size())) return false;
+        if (!writer.finalize()) return false;
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, preimagePath, ec);
+    return !ec;
+}
+
+// Puts the game directory back the way capturePreimage found it. With written
+// hashes, files that no longer match what the mod wrote are left alone and
+// listed in conflicts instead.
+bool restorePreimage(const std::string& preimagePath, const std::string& gameDir, AsyncTask& task,
+                     const WrittenHashes* written = nullptr,
+                     std::vector<std::string>* conflicts = nullptr) {
+    ZipReader reader;
+    if (!reader.open(preimagePath)) {
+        task.setError("Failed to open pre-image: " + preimagePath);
+        return false;
+    }
+
+    auto changedSinceInstall = [&](const std::string& rel) {
+        if (!written) return false;
+        // Files missing after the install have no recorded hash.
+        auto it = written->find(rel);
+        auto hash = hashDiskFile(gameDir + "/" + rel);
+        bool unchanged = hash ? it != written->end() && it->second == *hash : it == written->end();
+        if (unchanged) return false;
+        if (conflicts) conflicts->push_back(rel);
+        return true;
+    };
+
+    auto entries = reader.entryInfos();
+    const std::string prefix = kPreimageFilesPrefix;
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto& entry = entries[i];
+        if (entry.name.compare(0, prefix.size(), prefix) != 0) continue;
+
+        std::string rel = entry.name.substr(prefix.size());
+        task.setProgress(static_cast<float>(i) / static_cast<float>(entries.size()),
+                         "Restoring " + rel);
+        if (changedSinceInstall(rel)) continue;
+
+        std::string destPath = gameDir + "/" + rel;
+        std::error_code ec;
+        fs::create_directories(fs::path(destPath).parent_path(), ec);
+        if (!reader.extractEntryAt(entry.index, destPath, entry.uncompressedSize)) {
+            task.setError("Failed to restore: " + rel);
+            return false;
+        }
+    }
+
+    auto created = reader.readEntry(kPreimageCreatedList);
+    if (!created) {
+        task.setError("Pre-image is missing its created file list");
+        return false;
+    }
+
+    std::istringstream lines(std::string(reinterpret_cast<const char*>(created->data()),
+                                         created->size()));
+    std::string rel;
+    fs::path root = fs::path(gameDir).lexically_normal();
+    while (std::getline(lines, rel)) {
+        if (rel.empty() || changedSinceInstall(rel)) continue;
+        fs::path path = fs::path(gameDir + "/" + rel).lexically_normal();
+        std::error_code ec;
+        fs::remove(path, ec);
+
+        // Drop directories the mod created, stopping at the first non-empty one.
+        for (auto dir = path.parent_path(); dir != root && dir.has_relative_path();
+             dir = dir.parent_path()) {
+            if (!fs::is_empty(dir, ec) || ec) break;
+            fs::remove(dir, ec);
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
 std::string ModManager::modsDirectory() {
     return getConfigDir() + "/mods";
 }
 
+std::string ModManager::libraryIndexPath() {
+    return modsDirectory() + "/library_index.json";
+}
+
+std::string ModManager::preimageDirectory() {
+    return modsDirectory() + "/preimages";
+}
+
+std::string ModManager::installJournalPath() {
+    return modsDirectory() + "/install.journal";
+}
+
 bool ModManager::createMod(const ModMetadata& meta, const std::string& gameDir,
                            const std::vector<std::string>& relativePaths,
-                           const std::string& outputZipPath, AsyncTask& task) {
+                           const std::string& outputZipPath, AsyncTask& task,
+                           const std::string& baseDir) {
     ZipWriter writer;
     if (!writer.create(outputZipPath)) {
         task.setError("Failed to create zip file");
@@ -33,17 +364,40 @@ bool ModManager::createMod(const ModMetadata& meta, const std::string& gameDir,
         return false;
     }
 
-    // Add game files.
+    // Record patches are small and written directly; whole files are collected
+    // and compressed as one parallel batch.
+    std::vector<ZipFileSource> wholeFiles;
     for (size_t i = 0; i < relativePaths.size(); ++i) {
         std::string diskPath = gameDir + "/" + relativePaths[i];
 
-        task.setProgress(static_cast<float>(i) / static_cast<float>(relativePaths.size()),
-                         relativePaths[i]);
-
-        if (!writer.addFile(diskPath, relativePaths[i])) {
-            task.setError("Failed to add file: " + relativePaths[i]);
-            return false;
+        if (!baseDir.empty()) {
+            task.setProgress(0.0f, "Diffing " + relativePaths[i]);
+            auto base = readFileBytes(baseDir + "/" + relativePaths[i]);
+            auto modified = base ? readFileBytes(diskPath) : std::nullopt;
+            auto patch = modified ? diffRecordPatch(relativePaths[i], *base, *modified)
+                                  : std::nullopt;
+            if (patch) {
+                auto bytes = serializeRecordPatch(*patch);
+                if (!writer.addMemory(kPatchEntryPrefix + relativePaths[i], bytes.data(),
+                                      bytes.size())) {
+                    task.setError("Failed to add patch: " + relativePaths[i]);
+                    return false;
+                }
+                continue;
+            }
         }
+
+        wholeFiles.push_back({diskPath, relativePaths[i]});
+    }
+
+    size_t failed = 0;
+    bool added = writer.addFiles(wholeFiles, [&](size_t i) {
+        task.setProgress(static_cast<float>(i + 1) / static_cast<float>(wholeFiles.size()),
+                         wholeFiles[i].archiveName);
+    }, &failed);
+    if (!added) {
+        task.setError("Failed to add file: " + wholeFiles[failed].archiveName);
+        return false;
     }
 
     if (!writer.finalize()) {
@@ -55,7 +409,15 @@ bool ModManager::createMod(const ModMetadata& meta, const std::string& gameDir,
     return true;
 }
 
-std::variant<ModInfo, std::string> ModManager::importMod(const std::string& zipPath) {
+bool ModManager::isPatchEntry(const std::string& entryName) {
+    return entryName.compare(0, std::strlen(kPatchEntryPrefix), kPatchEntryPrefix) == 0;
+}
+
+std::string ModManager::gamePathForEntry(const std::string& entryName) {
+    return isPatchEntry(entryName) ? entryName.substr(std::strlen(kPatchEntryPrefix)) : entryName;
+}
+
+std::variant<ModInfo, std::string> ModManager::readMod(const std::string& zipPath) {
     ZipReader reader;
     if (!reader.open(zipPath)) {
         return std::string("Failed to open zip file");
@@ -73,6 +435,18 @@ std::variant<ModInfo, std::string> ModManager::importMod(const std::string& zipP
         return std::string("Invalid or incomplete mod.json (requires name, version, game, files)");
     }
 
+    ModInfo info;
+    info.metadata = std::move(*meta);
+    info.zipPath = zipPath;
+    info.fileSize = fs::file_size(zipPath);
+    return info;
+}
+
+std::variant<ModInfo, std::string> ModManager::importMod(const std::string& zipPath) {
+    auto read = readMod(zipPath);
+    if (std::holds_alternative<std::string>(read)) return read;
+    ModInfo info = std::move(std::get<ModInfo>(read));
+
     // Copy to mods directory.
     fs::create_directories(modsDirectory());
     std::string destPath = modsDirectory() + "/" + fs::path(zipPath).filename().string();
@@ -97,10 +471,9 @@ std::variant<ModInfo, std::string> ModManager::importMod(const std::string& zipP
         }
     }
 
-    ModInfo info;
-    info.metadata = *meta;
     info.zipPath = destPath;
     info.fileSize = fs::file_size(destPath);
+    conflictIndex().addMod(info);
     return info;
 }
 
@@ -111,28 +484,229 @@ bool ModManager::applyMod(const ModInfo& mod, const std::string& gameDir, AsyncT
         return false;
     }
 
-    auto allEntries = reader.entries();
-
     // Filter out mod.json.
+    std::vector<ZipEntryInfo> gameEntries;
+    uint64_t totalBytes = 0;
+    for (auto& entry : reader.entryInfos()) {
+        if (entry.name == "mod.json") continue;
+        totalBytes += entry.uncompressedSize;
+        gameEntries.push_back(std::move(entry));
+    }
+    reader.close();
+
+    // Create every destination directory before the workers start so they
+    // never race each other on create_directories.
+    std::unordered_set<std::string> directories;
+    for (const auto& entry : gameEntries) {
+        auto parent = fs::path(gameDir + "/" + gamePathForEntry(entry.name)).parent_path().string();
+        if (directories.insert(parent).second) {
+            std::error_code ec;
+            fs::create_directories(parent, ec);
+            if (ec) {
+                task.setError("Failed to create directory: " + parent);
+                return false;
+            }
+        }
+    }
+
+    // Largest entries first so one big texture does not finish last on its own.
+    std::sort(gameEntries.begin(), gameEntries.end(), [](const auto& a, const auto& b) {
+        return a.uncompressedSize > b.uncompressedSize;
+    });
+
+    // A mz_zip_archive is not safe to share, so each worker opens its own reader
+    // over the archive and claims entries from a shared cursor.
+    auto& pool = WorkerPool::shared();
+    size_t workerCount = std::min(pool.threadCount() + 1, gameEntries.size());
+
+    std::atomic<size_t> nextEntry{0};
+    std::atomic<size_t> entriesDone{0};
+    std::atomic<uint64_t> bytesDone{0};
+    std::atomic<bool> failed{false};
+    std::mutex errorMutex;
+    std::string error;
+
+    auto fail = [&](const std::string& message) {
+        std::lock_guard lock(errorMutex);
+        if (!failed.exchange(true)) {
+            error = message;
+        }
+    };
+
+    pool.parallelFor(workerCount, [&](size_t) {
+        ZipReader local;
+        if (!local.open(mod.zipPath)) {
+            fail("Failed to open mod archive");
+            return;
+        }
+
+        while (!failed) {
+            size_t i = nextEntry.fetch_add(1);
+            if (i >= gameEntries.size()) return;
+            const auto& entry = gameEntries[i];
+
+            std::string gamePath = gamePathForEntry(entry.name);
+            std::string destPath = gameDir + "/" + gamePath;
+            if (isPatchEntry(entry.name)) {
+                auto error = applyPatchEntry(local, entry.name, gamePath, destPath);
+                if (!error.empty()) {
+                    fail(error);
+                    return;
+                }
+            } else if (!local.extractEntryAt(entry.index, destPath, entry.uncompressedSize)) {
+                fail("Failed to extract: " + entry.name);
+                return;
+            }
+
+            uint64_t bytes = bytesDone.fetch_add(entry.uncompressedSize) + entry.uncompressedSize;
+            size_t done = entriesDone.fetch_add(1) + 1;
+            float progress = totalBytes > 0
+                ? static_cast<float>(static_cast<double>(bytes) / static_cast<double>(totalBytes))
+                : static_cast<float>(done) / static_cast<float>(gameEntries.size());
+            task.setProgress(progress, gamePath);
+        }
+    });
+
+    if (failed) {
+        task.setError(error);
+        return false;
+    }
+
+    task.setProgress(1.0f, "Mod applied");
+    return true;
+}
+
+bool ModManager::installMod(const ModInfo& mod, const std::string& gameDir, AsyncTask& task) {
+    // Reinstalling over an earlier version: put the original files back first so
+    // the new pre-image holds the game's files rather than the old mod's.
+    for (const auto& installed : listInstalledMods()) {
+        if (installed.name == mod.metadata.name && !installed.preimagePath.empty()) {
+            if (!uninstallMod(installed.name, task)) return false;
+            break;
+        }
+    }
+
     std::vector<std::string> gameEntries;
-    for (const auto& entry : allEntries) {
-        if (entry != "mod.json") {
-            gameEntries.push_back(entry);
+    {
+        ZipReader reader;
+        if (!reader.open(mod.zipPath)) {
+            task.setError("Failed to open mod archive");
+            return false;
+        }
+        for (const auto& entry : reader.entries()) {
+            if (entry != "mod.json") {
+                gameEntries.push_back(gamePathForEntry(entry));
+            }
         }
     }
 
-    for (size_t i = 0; i < gameEntries.size(); ++i) {
-        task.setProgress(static_cast<float>(i) / static_cast<float>(gameEntries.size()),
-                         gameEntries[i]);
+    std::error_code ec;
+    fs::create_directories(preimageDirectory(), ec);
+    std::string preimagePath = preimageDirectory() + "/" + preimageFileName(mod.metadata.name);
+    std::string journalPath = installJournalPath();
+
+    if (!capturePreimage(gameEntries, gameDir, preimagePath, task)) {
+        fs::remove(preimagePath + ".tmp", ec);
+        task.setError("Failed to save files the mod would overwrite");
+        return false;
+    }
 
-        std::string destPath = gameDir + "/" + gameEntries[i];
-        if (!reader.extractEntry(gameEntries[i], destPath)) {
-            task.setError("Failed to extract: " + gameEntries[i]);
+    if (!writeInstallJournal(journalPath, {mod.metadata.name, gameDir, preimagePath})) {
+        fs::remove(preimagePath, ec);
+        task.setError("Failed to write install journal");
+        return false;
+    }
+
+    bool ok = applyMod(mod, gameDir, task);
+    std::string error = ok ? std::string() : task.error();
+    if (ok && !saveWrittenHashes(writtenHashesPath(preimagePath), gameEntries, gameDir)) {
+        ok = false;
+        error = "Failed to record installed files";
+    }
+    if (ok && !markInstalled(mod, gameDir, preimagePath)) {
+        ok = false;
+        error = "Failed to record installed mod";
+    }
+
+    if (!ok) {
+        restorePreimage(preimagePath, gameDir, task);
+        fs::remove(preimagePath, ec);
+        fs::remove(writtenHashesPath(preimagePath), ec);
+        fs::remove(journalPath, ec);
+        task.setError(error + " (changes were rolled back)");
+        return false;
+    }
+
+    fs::remove(journalPath, ec);
+    task.setProgress(1.0f, "Mod installed");
+    return true;
+}
+
+bool ModManager::uninstallMod(const std::string& name, AsyncTask& task,
+                              std::vector<std::string>* conflicts) {
+    auto mods = listInstalledMods();
+    auto it = std::find_if(mods.begin(), mods.end(),
+                           [&name](const InstalledModInfo& m) { return m.name == name; });
+    if (it == mods.end()) {
+        task.setError("Mod is not installed: " + name);
+        return false;
+    }
+
+    // Mods recorded before pre-images existed can only be forgotten.
+    if (!it->preimagePath.empty()) {
+        // Mods installed before written hashes were kept are reverted whole.
+        std::string hashesPath = writtenHashesPath(it->preimagePath);
+        auto written = loadWrittenHashes(hashesPath);
+        if (!restorePreimage(it->preimagePath, it->gameDir, task, written ? &*written : nullptr,
+                             conflicts)) {
             return false;
         }
+        std::error_code ec;
+        fs::remove(it->preimagePath, ec);
+        fs::remove(hashesPath, ec);
     }
 
-    task.setProgress(1.0f, "Mod applied");
+    if (!markUninstalled(name)) {
+        task.setError("Failed to update installed mods");
+        return false;
+    }
+
+    task.setProgress(1.0f, "Mod uninstalled");
+    return true;
+}
+
+bool ModManager::hasInterruptedInstall() {
+    return fs::exists(installJournalPath());
+}
+
+bool ModManager::recoverInterruptedInstall(AsyncTask& task) {
+    std::string journalPath = installJournalPath();
+    auto journal = readInstallJournal(journalPath);
+    std::error_code ec;
+    if (!journal) {
+        fs::remove(journalPath, ec);
+        return true;
+    }
+
+    // installed.json is written before the journal is removed, so a matching
+    // entry means the install finished and only the cleanup was lost.
+    bool recorded = false;
+    for (const auto& installed : listInstalledMods()) {
+        if (installed.preimagePath == journal->preimagePath) {
+            recorded = true;
+            break;
+        }
+    }
+
+    if (!recorded && fs::exists(journal->preimagePath)) {
+        task.setProgress(0.0f, "Rolling back interrupted install of " + journal->name);
+        if (!restorePreimage(journal->preimagePath, journal->gameDir, task)) return false;
+        fs::remove(journal->preimagePath, ec);
+        fs::remove(writtenHashesPath(journal->preimagePath), ec);
+    }
+
+    fs::remove(journalPath, ec);
+    task.setProgress(1.0f, "Recovered interrupted install");
     return true;
 }
 
@@ -140,6 +714,7 @@ bool ModManager::removeMod(const ModInfo& mod) {
     if (mod.zipPath.empty() || !fs::exists(mod.zipPath)) return false;
     std::error_code ec;
     fs::remove(mod.zipPath, ec);
+    if (!ec) conflictIndex().removeMod(mod.zipPath);
     return !ec;
 }
 
@@ -149,25 +724,58 @@ std::vector<ModInfo> ModManager::listMods() {
 
     if (!fs::exists(dir)) return mods;
 
+    std::unordered_map<std::string, ModIndexEntry> cached;
+    auto cachedEntries = loadLibraryIndex(libraryIndexPath());
+    for (auto& e : cachedEntries) {
+        std::string key = e.mod.zipPath;
+        cached.emplace(std::move(key), std::move(e));
+    }
+
+    // Reuse cached metadata for archives whose size and mtime still match; only
+    // new or changed archives are opened. Archives without a valid mod.json are
+    // cached too, so a broken archive is not reopened on every listing.
+    std::vector<ModIndexEntry> index;
+    std::vector<ModIndexEntry> stale;
     for (const auto& entry : fs::directory_iterator(dir)) {
         if (!entry.is_regular_file()) continue;
         if (entry.path().extension() != ".zip") continue;
 
-        ZipReader reader;
-        if (!reader.open(entry.path().string())) continue;
+        ModIndexEntry current;
+        current.mod.zipPath = entry.path().string();
+        current.mod.fileSize = entry.file_size();
+        current.modifiedTime = fileModifiedTime(entry);
+
+        auto it = cached.find(current.mod.zipPath);
+        if (it != cached.end() && it->second.mod.fileSize == current.mod.fileSize &&
+            it->second.modifiedTime == current.modifiedTime) {
+            index.push_back(std::move(it->second));
+        } else {
+            stale.push_back(std::move(current));
+        }
+    }
 
-        auto jsonData = reader.readEntry("mod.json");
-        if (!jsonData) continue;
+    std::vector<char> valid(stale.size(), 0);
+    WorkerPool::shared().parallelFor(stale.size(), [&](size_t i) {
+        if (auto meta = readArchiveMetadata(stale[i].mod.zipPath)) {
+            stale[i].mod.metadata = std::move(*meta);
+            valid[i] = 1;
+        }
+    });
+
+    for (size_t i = 0; i < stale.size(); ++i) {
+        stale[i].invalid = !valid[i];
+        index.push_back(std::move(stale[i]));
+    }
 
-        std::string jsonStr(reinterpret_cast<const char*>(jsonData->data()), jsonData->size());
-        auto meta = parseModJson(jsonStr);
-        if (!meta) continue;
+    // Rewrite the index only when something was added, changed or removed.
+    bool indexChanged = !stale.empty() || index.size() != cachedEntries.size();
+    if (indexChanged) {
+        saveLibraryIndex(libraryIndexPath(), index);
+    }
 
-        ModInfo info;
-        info.metadata = *meta;
-        info.zipPath = entry.path().string();
-        info.fileSize = entry.file_size();
-        mods.push_back(std::move(info));
+    mods.reserve(index.size());
+    for (auto& e : index) {
+        if (!e.invalid) mods.push_back(std::move(e.mod));
     }
 
     // Sort by name.
@@ -175,9 +783,15 @@ std::vector<ModInfo> ModManager::listMods() {
         return a.metadata.name < b.metadata.name;
     });
 
+    conflictIndex().sync(mods);
     return mods;
 }
 
+ModConflictIndex& ModManager::conflictIndex() {
+    static ModConflictIndex index;
+    return index;
+}
+
 std::vector<InstalledModInfo> ModManager::listInstalledMods() {
     std::string path = modsDirectory() + "/installed.json";
     if (!fs::exists(path)) return {};
@@ -190,7 +804,8 @@ std::vector<InstalledModInfo> ModManager::listInstalledMods() {
     return parseInstalledModsJson(content);
 }
 
-bool ModManager::markInstalled(const ModInfo& mod) {
+bool ModManager::markInstalled(const ModInfo& mod, const std::string& gameDir,
+                               const std::string& preimagePath) {
     auto mods = listInstalledMods();
 
     // Replace existing entry with the same name.
@@ -201,6 +816,8 @@ bool ModManager::markInstalled(const ModInfo& mod) {
             m.author = mod.metadata.author;
             m.game = mod.metadata.game;
             m.zipPath = mod.zipPath;
+            m.gameDir = gameDir;
+            m.preimagePath = preimagePath;
 
             auto now = std::chrono::system_clock::now();
             auto time = std::chrono::system_clock::to_time_t(now);
@@ -226,6 +843,8 @@ bool ModManager::markInstalled(const ModInfo& mod) {
         info.author = mod.metadata.author;
         info.game = mod.metadata.game;
         info.zipPath = mod.zipPath;
+        info.gameDir = gameDir;
+        info.preimagePath = preimagePath;
 
         auto now = std::chrono::system_clock::now();
         auto time = std::chrono::system_clock::to_time_t(now);
@@ -243,12 +862,7 @@ bool ModManager::markInstalled(const ModInfo& mod) {
     }
 
     fs::create_directories(modsDirectory());
-    std::string path = modsDirectory() + "/installed.json";
-    std::ofstream file(path);
-    if (!file) return false;
-
-    file << serializeInstalledModsJson(mods);
-    return file.good();
+    return saveInstalledMods(modsDirectory() + "/installed.json", mods);
 }
 
 bool ModManager::markUninstalled(const std::string& name) {
@@ -259,12 +873,7 @@ bool ModManager::markUninstalled(const std::string& name) {
     if (it == mods.end()) return false;
     mods.erase(it, mods.end());
 
-    std::string path = modsDirectory() + "/installed.json";
-    std::ofstream file(path);
-    if (!file) return false;
-
-    file << serializeInstalledModsJson(mods);
-    return file.good();
+    return saveInstalledMods(modsDirectory() + "/installed.json", mods);
 }
 
 } // namespace kuf
@@ -3,6 +3,7 @@
 #include "core/async_task.h"
 #include "core/mod_metadata.h"
 
+#include <cstdint>
 #include <string>
 #include <variant>
 #include <vector>
@@ -15,6 +16,16 @@ struct ModInfo {
     size_t fileSize = 0;
 };
 
+// Cached listing of one library archive. Reused by listMods() for as long as the
+// archive's size and modification time are unchanged.
+struct ModIndexEntry {
+    ModInfo mod;
+    int64_t modifiedTime = 0;
+    // The archive has no valid mod.json. Kept so it is not reopened until it
+    // changes; listMods() leaves it out.
+    bool invalid = false;
+};
+
 struct InstalledModInfo {
     std::string name;
     std::string version;
@@ -22,21 +33,60 @@ struct InstalledModInfo {
     std::string game;
     std::string installedAt;
     std::string zipPath;
+    std::string gameDir;      // Empty for mods recorded before pre-images existed.
+    std::string preimagePath; // Archive of the files the mod overwrote.
 };
 
+class ModConflictIndex;
+
 class ModManager {
 public:
     static std::string modsDirectory();
+    static std::string libraryIndexPath();
+    static std::string preimageDirectory();
+    static std::string installJournalPath();
+    // Packs the given game files into a mod archive. With a baseDir (an unmodded
+    // copy of the game, e.g. a backup), troop SOX and STG files whose records
+    // can be diffed against the base are stored as record patches instead of
+    // whole files.
     static bool createMod(const ModMetadata& meta, const std::string& gameDir,
                           const std::vector<std::string>& relativePaths,
-                          const std::string& outputZipPath, AsyncTask& task);
+                          const std::string& outputZipPath, AsyncTask& task,
+                          const std::string& baseDir = {});
+
+    // Archive entries under patches/ hold a record patch for the game file at
+    // the rest of the path.
+    static bool isPatchEntry(const std::string& entryName);
+    static std::string gamePathForEntry(const std::string& entryName);
+    // Reads and validates an archive's mod.json without adding it to the library.
+    static std::variant<ModInfo, std::string> readMod(const std::string& zipPath);
     static std::variant<ModInfo, std::string> importMod(const std::string& zipPath);
     static bool applyMod(const ModInfo& mod, const std::string& gameDir, AsyncTask& task);
     static bool removeMod(const ModInfo& mod);
     static std::vector<ModInfo> listMods();
 
+    // Which library mods write which game files. Kept current by importMod,
+    // removeMod and listMods.
+    static ModConflictIndex& conflictIndex();
+
+    // Saves the game files the mod is about to overwrite into a pre-image archive,
+    // applies the mod and records it in installed.json. A failed apply is rolled
+    // back from the pre-image before returning.
+    static bool installMod(const ModInfo& mod, const std::string& gameDir, AsyncTask& task);
+
+    // Restores the files captured when the mod was installed, deletes the files it
+    // added, and removes it from installed.json. Files changed since the install,
+    // e.g. by a mod installed later, are left as they are and listed in conflicts.
+    static bool uninstallMod(const std::string& name, AsyncTask& task,
+                             std::vector<std::string>* conflicts = nullptr);
+
+    // An install journal left on disk means the app stopped mid-install.
+    static bool hasInterruptedInstall();
+    static bool recoverInterruptedInstall(AsyncTask& task);
+
     static std::vector<InstalledModInfo> listInstalledMods();
-    static bool markInstalled(const ModInfo& mod);
+    static bool markInstalled(const ModInfo& mod, const std::string& gameDir = {},
+                              const std::string& preimagePath = {});
     static bool markUninstalled(const std::string& name);
 };
 
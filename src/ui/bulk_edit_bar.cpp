@@ -0,0 +1,99 @@
+#include "ui/bulk_edit_bar.h"
+#include "undo/bulk_edit_command.h"
+
+#include <imgui.h>
+
+#include <variant>
+
+namespace kuf {
+
+void BulkEditBar::draw(UndoStack& undo, std::span<TroopInfo> troops) {
+    drawBar(undo, troops);
+}
+
+void BulkEditBar::draw(UndoStack& undo, std::span<StgUnit> units) {
+    drawBar(undo, units);
+}
+
+template<typename Record>
+void BulkEditBar::drawBar(UndoStack& undo, std::span<Record> records) {
+    const char* hint = target_ == BulkEditTarget::Troops ? "resist* = min(resist*, 300) where job == 2"
+                                                         : "unitHpOverride *= 1 + 20% where ucd == enemy";
+    ImGui::SetNextItemWidth(-140.0f);
+    bool enter = ImGui::InputTextWithHint("##bulkEdit", hint, source_, sizeof(source_),
+                                          ImGuiInputTextFlags_EnterReturnsTrue);
+    ImGui::SameLine();
+    drawFieldHelp();
+
+    if (compiledSource_ != source_) {
+        compiledSource_ = source_;
+        edit_.reset();
+        error_.clear();
+        previewValid_ = false;
+        if (!compiledSource_.empty()) {
+            auto result = BulkEdit::compile(compiledSource_, target_);
+            if (auto* error = std::get_if<std::string>(&result)) {
+                error_ = std::move(*error);
+            } else {
+                edit_.emplace(std::move(std::get<BulkEdit>(result)));
+            }
+        }
+    }
+
+    if (edit_ && (!previewValid_ || previewRevision_ != undo.revision() || previewRecords_ != records.size())) {
+        auto plan = edit_->plan(records);
+        previewValid_ = true;
+        previewRevision_ = undo.revision();
+        previewRecords_ = records.size();
+        previewMatched_ = plan.matched;
+        previewChanges_ = plan.changeCount();
+        previewNonFinite_ = plan.nonFinite;
+    }
+
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!edit_ || previewChanges_ == 0);
+    bool apply = ImGui::Button("Apply") || enter;
+    ImGui::EndDisabled();
+    if (apply && edit_ && previewChanges_ > 0) {
+        executeBulkEdit(undo, edit_->plan(records), "Bulk edit: " + compiledSource_);
+    }
+
+    if (!error_.empty()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", error_.c_str());
+    } else if (edit_) {
+        ImGui::TextDisabled("%zu of %zu records match, %zu fields change", previewMatched_, records.size(),
+                            previewChanges_);
+        if (previewNonFinite_ > 0) {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "| %zu results not finite, left unchanged",
+                               previewNonFinite_);
+        }
+    }
+}
+
+void BulkEditBar::drawFieldHelp() const {
+    ImGui::TextDisabled("(?)");
+    if (!ImGui::IsItemHovered()) return;
+
+    ImGui::BeginTooltip();
+    ImGui::PushTextWrapPos(ImGui::GetFontSize() * 40.0f);
+    ImGui::TextUnformatted("Assign with = += -= *= /=, separate assignments with commas and filter with "
+                           "'where'. Operators: + - * / < <= > >= == != and or not. Functions: min max "
+                           "clamp abs round floor ceil. 20% is 0.2. 'resist*' assigns every field starting "
+                           "with resist. 'index' is the record's position.");
+    ImGui::Separator();
+    std::string names;
+    for (const auto& field : BulkEdit::fields(target_)) {
+        if (!names.empty()) names += ", ";
+        names += field.name;
+        if (!field.writable) names += " (read-only)";
+    }
+    ImGui::TextUnformatted(names.c_str());
+    if (target_ == BulkEditTarget::Units) {
+        ImGui::TextUnformatted("UCD values: player, enemy, ally, neutral.");
+    }
+    ImGui::PopTextWrapPos();
+    ImGui::EndTooltip();
+}
+
+} // namespace kuf
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "formats/bulk_edit.h"
+#include "undo/undo_stack.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace kuf {
+
+// One-line bulk edit over every troop of a SOX file or every unit of a
+// mission. Shows how many records match while the expression is typed and
+// applies it as a single undo step.
+class BulkEditBar {
+public:
+    explicit BulkEditBar(BulkEditTarget target) : target_(target) {}
+
+    void draw(UndoStack& undo, std::span<TroopInfo> troops);
+    void draw(UndoStack& undo, std::span<StgUnit> units);
+
+private:
+    template<typename Record>
+    void drawBar(UndoStack& undo, std::span<Record> records);
+    void drawFieldHelp() const;
+
+    BulkEditTarget target_;
+    char source_[512] = {};
+    std::string compiledSource_;
+    std::optional<BulkEdit> edit_;
+    std::string error_;
+
+    // Counts from the last preview, refreshed when the expression or the
+    // document changes.
+    bool previewValid_ = false;
+    uint64_t previewRevision_ = 0;
+    size_t previewRecords_ = 0;
+    size_t previewMatched_ = 0;
+    size_t previewChanges_ = 0;
+    size_t previewNonFinite_ = 0;
+};
+
+} // namespace kuf
@@ -42,6 +42,14 @@ bool SettingsDialog::draw() {
         // General tab.
         if (ImGui::BeginTabItem("General")) {
             ImGui::SliderInt("Max Recent Files", &pendingConfig_.maxRecentFiles, 5, 20);
+            ImGui::Checkbox("Redraw only when something changes", &pendingConfig_.idleRendering);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Wait for input instead of redrawing every frame while idle.");
+            }
+            ImGui::SliderInt("Undo History (MB)", &pendingConfig_.undoHistoryMB, 8, 1024);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Memory kept for undo per open file. Oldest steps are dropped first.");
+            }
 
             ImGui::EndTabItem();
         }
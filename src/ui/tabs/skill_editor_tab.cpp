@@ -1,4 +1,5 @@
 #include "ui/tabs/skill_editor_tab.h"
+#include "core/profiler.h"
 
 #include <algorithm>
 #include <cstring>
@@ -19,6 +20,7 @@ void SkillEditorTab::selectSkill(size_t index) {
 }
 
 void SkillEditorTab::drawContent() {
+    KUF_PROFILE_ZONE("SkillEditorTab::drawContent");
     if (!document_ || !document_->skillData) {
         ImGui::TextDisabled("No skill data loaded");
         return;
@@ -1,4 +1,5 @@
 #include "ui/tabs/stg_editor_tab.h"
+#include "core/profiler.h"
 
 #include <imgui.h>
 
@@ -8,7 +9,8 @@
 
 #include "formats/stg_script_catalog.h"
 #include "ui/imgui_helpers.h"
-#include "undo/reorder_vector_command.h"
+#include "undo/stg_event_command.h"
+#include "undo/stg_renumber_command.h"
 
 namespace kuf {
 
@@ -21,6 +23,12 @@ const char* directionNames[] = {
     "West", "SouthWest", "South", "SouthEast"
 };
 
+void moveEntry(std::vector<StgScriptEntry>& entries, int from, int to) {
+    auto item = std::move(entries[from]);
+    entries.erase(entries.begin() + from);
+    entries.insert(entries.begin() + to, std::move(item));
+}
+
 // CharInfo job types that use CharInfo names (from GetUnitDisplayName at 0x005597a0).
 constexpr uint8_t kCharInfoJobTypes[] = {32, 33, 34, 35, 36, 37, 38, 43, 44, 46, 47};
 
@@ -194,10 +202,14 @@ void StgEditorTab::selectUnit(size_t index) {
 }
 
 void StgEditorTab::drawContent() {
+    KUF_PROFILE_ZONE("StgEditorTab::drawContent");
     if (!document_ || !document_->stgData) {
         ImGui::TextDisabled("No STG data loaded");
         return;
     }
+    if (refIndexBuilt_ && document_->undoStack->revision() != refIndexRevision_) {
+        refIndexBuilt_ = false;
+    }
 
     float totalHeight = ImGui::GetContentRegionAvail().y;
 
@@ -278,13 +290,19 @@ void StgEditorTab::drawContent() {
             ImGui::EndChild();
         }
     } else {
-        ImGui::BeginChild("StgUnitList", ImVec2(230, totalHeight), ImGuiChildFlags_Borders);
+        ImGui::BeginGroup();
+        if (ImGui::CollapsingHeader("Bulk Edit")) {
+            unitBulkEdit_.draw(*document_->undoStack, document_->stgData->units());
+        }
+        float unitsHeight = ImGui::GetContentRegionAvail().y;
+
+        ImGui::BeginChild("StgUnitList", ImVec2(230, unitsHeight), ImGuiChildFlags_Borders);
         drawUnitList();
         ImGui::EndChild();
 
         ImGui::SameLine();
 
-        ImGui::BeginChild("StgUnitDetails", ImVec2(0, totalHeight), ImGuiChildFlags_Borders);
+        ImGui::BeginChild("StgUnitDetails", ImVec2(0, unitsHeight), ImGuiChildFlags_Borders);
         if (selectedUnit_ >= 0 &&
             selectedUnit_ < static_cast<int>(document_->stgData->unitCount())) {
             drawUnitDetails(selectedUnit_);
@@ -292,6 +310,7 @@ void StgEditorTab::drawContent() {
             ImGui::TextDisabled("Select a unit to edit");
         }
         ImGui::EndChild();
+        ImGui::EndGroup();
     }
 }
 
@@ -630,6 +649,8 @@ void StgEditorTab::drawUnitDetails(size_t index) {
             ImGui::PopID();
         }
     }
+
+    drawReferences(StgRefKind::Troop, static_cast<int32_t>(unit.uniqueId));
 }
 
 void StgEditorTab::drawOfficerSection(const char* label, OfficerData& officer, bool active) {
@@ -754,6 +775,8 @@ void StgEditorTab::drawAreaDetails(size_t index) {
         float h = std::abs(area.boundY2 - area.boundY1);
         ImGui::Text("Size: %.0f x %.0f", w, h);
     }
+
+    drawReferences(StgRefKind::Area, static_cast<int32_t>(area.areaId));
 }
 
 void StgEditorTab::drawVariableList() {
@@ -842,6 +865,8 @@ void StgEditorTab::drawVariableDetails(size_t index) {
             break;
         }
     }
+
+    drawReferences(StgRefKind::Variable, static_cast<int32_t>(var.variableId));
 }
 
 void StgEditorTab::drawEventList() {
@@ -849,16 +874,17 @@ void StgEditorTab::drawEventList() {
 
     // Add event to current/first block.
     if (ImGui::SmallButton("+ Add Event")) {
-        if (blocks.empty()) {
-            blocks.push_back({});
-        }
         StgEvent newEvent;
         newEvent.description = "New Event";
         newEvent.modified = true;
-        blocks[selectedBlock_ >= 0 ? selectedBlock_ : 0].events.push_back(newEvent);
-        selectedBlock_ = selectedBlock_ >= 0 ? selectedBlock_ : 0;
-        selectedEvent_ = static_cast<int>(blocks[selectedBlock_].events.size() - 1);
-        document_->dirty = true;
+        selectedBlock_ = blocks.empty() ? 0 : std::clamp(selectedBlock_, 0, static_cast<int>(blocks.size()) - 1);
+        size_t index = blocks.empty() ? 0 : blocks[selectedBlock_].events.size();
+        document_->undoStack->execute(std::make_unique<StgEventCommand>(
+            document_->stgData.get(), selectedBlock_, index, std::nullopt, std::move(newEvent), "Add event"));
+        selectedEvent_ = static_cast<int>(index);
+        if (refIndexBuilt_) {
+            refIndex_.reindexBlock(*document_->stgData, selectedBlock_);
+        }
     }
 
     ImGui::Separator();
@@ -903,12 +929,17 @@ void StgEditorTab::drawEventList() {
             }
 
             if (deleteIndex >= 0) {
-                block.events.erase(block.events.begin() + deleteIndex);
+                document_->undoStack->execute(std::make_unique<StgEventCommand>(
+                    document_->stgData.get(), b, deleteIndex, block.events[deleteIndex], std::nullopt,
+                    "Delete event"));
                 if (selectedBlock_ == static_cast<int>(b) &&
                     selectedEvent_ >= static_cast<int>(block.events.size())) {
                     selectedEvent_ = static_cast<int>(block.events.size()) - 1;
                 }
                 document_->dirty = true;
+                if (refIndexBuilt_) {
+                    refIndex_.reindexBlock(*document_->stgData, b);
+                }
             }
 
             ImGui::TreePop();
@@ -946,14 +977,21 @@ void StgEditorTab::drawEventDetails(size_t blockIdx, size_t eventIdx) {
         int condDelete = -1;
         int condDragSrc = -1;
         int condDragDst = -1;
+        int condParamEntry = -1;
+        int condParamDelta = 0;
         for (size_t i = 0; i < event.conditions.size(); ++i) {
             ImGui::PushID(static_cast<int>(i));
 
             char entryLabel[32];
             snprintf(entryLabel, sizeof(entryLabel), "Condition %zu", i);
+            int paramDelta = 0;
             drawScriptEntry(entryLabel, event.conditions[i], true, event,
                             "COND_REORDER", static_cast<int>(i),
-                            &condDragSrc, &condDragDst);
+                            &condDragSrc, &condDragDst, &paramDelta);
+            if (paramDelta != 0) {
+                condParamEntry = static_cast<int>(i);
+                condParamDelta = paramDelta;
+            }
 
             ImGui::SameLine();
             if (ImGui::SmallButton("X")) {
@@ -963,23 +1001,32 @@ void StgEditorTab::drawEventDetails(size_t blockIdx, size_t eventIdx) {
             ImGui::PopID();
         }
 
+        // Structural edits replace the whole event through the undo stack.
         if (condDragSrc >= 0 && condDragDst >= 0 && condDragSrc != condDragDst) {
-            document_->undoStack->execute(
-                std::make_unique<ReorderVectorCommand<StgScriptEntry>>(
-                    &event.conditions, condDragSrc, condDragDst,
-                    "Reorder condition"));
-            event.modified = true;
+            StgEvent updated = event;
+            moveEntry(updated.conditions, condDragSrc, condDragDst);
+            replaceEvent(blockIdx, eventIdx, std::move(updated), "Reorder condition");
+        }
+        if (condParamEntry >= 0) {
+            StgEvent updated = event;
+            auto& params = updated.conditions[condParamEntry].params;
+            if (condParamDelta > 0) {
+                params.push_back({});
+            } else {
+                params.pop_back();
+            }
+            replaceEvent(blockIdx, eventIdx, std::move(updated), condParamDelta > 0 ? "Add param" : "Remove param");
         }
         if (condDelete >= 0) {
-            event.conditions.erase(event.conditions.begin() + condDelete);
-            event.modified = true;
-            document_->dirty = true;
+            StgEvent updated = event;
+            updated.conditions.erase(updated.conditions.begin() + condDelete);
+            replaceEvent(blockIdx, eventIdx, std::move(updated), "Delete condition");
         }
 
         if (ImGui::SmallButton("+ Add Condition")) {
-            event.conditions.push_back({});
-            event.modified = true;
-            document_->dirty = true;
+            StgEvent updated = event;
+            updated.conditions.push_back({});
+            replaceEvent(blockIdx, eventIdx, std::move(updated), "Add condition");
         }
     }
 
@@ -989,14 +1036,21 @@ void StgEditorTab::drawEventDetails(size_t blockIdx, size_t eventIdx) {
         int actDelete = -1;
         int actDragSrc = -1;
         int actDragDst = -1;
+        int actParamEntry = -1;
+        int actParamDelta = 0;
         for (size_t i = 0; i < event.actions.size(); ++i) {
             ImGui::PushID(static_cast<int>(i + 1000));
 
             char entryLabel[32];
             snprintf(entryLabel, sizeof(entryLabel), "Action %zu", i);
+            int paramDelta = 0;
             drawScriptEntry(entryLabel, event.actions[i], false, event,
                             "ACT_REORDER", static_cast<int>(i),
-                            &actDragSrc, &actDragDst);
+                            &actDragSrc, &actDragDst, &paramDelta);
+            if (paramDelta != 0) {
+                actParamEntry = static_cast<int>(i);
+                actParamDelta = paramDelta;
+            }
 
             ImGui::SameLine();
             if (ImGui::SmallButton("X")) {
@@ -1006,31 +1060,47 @@ void StgEditorTab::drawEventDetails(size_t blockIdx, size_t eventIdx) {
             ImGui::PopID();
         }
 
+        // Structural edits replace the whole event through the undo stack.
         if (actDragSrc >= 0 && actDragDst >= 0 && actDragSrc != actDragDst) {
-            document_->undoStack->execute(
-                std::make_unique<ReorderVectorCommand<StgScriptEntry>>(
-                    &event.actions, actDragSrc, actDragDst,
-                    "Reorder action"));
-            event.modified = true;
+            StgEvent updated = event;
+            moveEntry(updated.actions, actDragSrc, actDragDst);
+            replaceEvent(blockIdx, eventIdx, std::move(updated), "Reorder action");
+        }
+        if (actParamEntry >= 0) {
+            StgEvent updated = event;
+            auto& params = updated.actions[actParamEntry].params;
+            if (actParamDelta > 0) {
+                params.push_back({});
+            } else {
+                params.pop_back();
+            }
+            replaceEvent(blockIdx, eventIdx, std::move(updated), actParamDelta > 0 ? "Add param" : "Remove param");
         }
         if (actDelete >= 0) {
-            event.actions.erase(event.actions.begin() + actDelete);
-            event.modified = true;
-            document_->dirty = true;
+            StgEvent updated = event;
+            updated.actions.erase(updated.actions.begin() + actDelete);
+            replaceEvent(blockIdx, eventIdx, std::move(updated), "Delete action");
         }
 
         if (ImGui::SmallButton("+ Add Action")) {
-            event.actions.push_back({});
-            event.modified = true;
-            document_->dirty = true;
+            StgEvent updated = event;
+            updated.actions.push_back({});
+            replaceEvent(blockIdx, eventIdx, std::move(updated), "Add action");
         }
     }
+
+    drawReferences(StgRefKind::Event, static_cast<int32_t>(event.eventId));
+
+    // Picks up whatever the panels above changed in this event's scripts.
+    if (refIndexBuilt_) {
+        refIndex_.reindexEvent(*document_->stgData, blockIdx, eventIdx);
+    }
 }
 
 void StgEditorTab::drawScriptEntry(const char* entryLabel, StgScriptEntry& entry,
                                     bool isCondition, StgEvent& event,
                                     const char* dragPayloadType, int dragIndex,
-                                    int* dragSrc, int* dragDst) {
+                                    int* dragSrc, int* dragDst, int* paramDelta) {
     const ScriptEntryInfo* info = isCondition
         ? findConditionInfo(entry.typeId)
         : findActionInfo(entry.typeId);
@@ -1109,18 +1179,14 @@ void StgEditorTab::drawScriptEntry(const char* entryLabel, StgScriptEntry& entry
             ImGui::PopID();
         }
 
-        // Add/remove param buttons.
-        if (ImGui::SmallButton("+ Param")) {
-            entry.params.push_back({});
-            event.modified = true;
-            document_->dirty = true;
+        // Add/remove param buttons; the caller applies them as undoable edits.
+        if (paramDelta && ImGui::SmallButton("+ Param")) {
+            *paramDelta = 1;
         }
-        if (!entry.params.empty()) {
+        if (paramDelta && !entry.params.empty()) {
             ImGui::SameLine();
             if (ImGui::SmallButton("- Param")) {
-                entry.params.pop_back();
-                event.modified = true;
-                document_->dirty = true;
+                *paramDelta = -1;
             }
         }
 
@@ -1223,4 +1289,85 @@ void StgEditorTab::drawParamValue(const char* label, StgParamValue& param, StgEv
     ImGui::PopID();
 }
 
+void StgEditorTab::replaceEvent(size_t blockIdx, size_t eventIdx, StgEvent updated, const char* description) {
+    updated.modified = true;
+    const auto& current = document_->stgData->eventBlocks()[blockIdx].events[eventIdx];
+    document_->undoStack->execute(std::make_unique<StgEventCommand>(
+        document_->stgData.get(), blockIdx, eventIdx, current, std::move(updated), description));
+}
+
+void StgEditorTab::ensureReferenceIndex() {
+    if (refIndexBuilt_) return;
+    refIndex_.build(*document_->stgData);
+    refIndexBuilt_ = true;
+    refIndexRevision_ = document_->undoStack->revision();
+}
+
+void StgEditorTab::renumber(StgRefKind kind, int32_t from, int32_t to) {
+    auto plan = refIndex_.planRenumber(*document_->stgData, kind, from, to);
+    if (!plan) return;
+
+    static constexpr const char* kKindNames[] = {"troop", "area", "variable", "event"};
+    char desc[96];
+    snprintf(desc, sizeof(desc), "Renumber %s %d to %d", kKindNames[static_cast<int>(kind)], from, to);
+
+    document_->undoStack->execute(
+        std::make_unique<StgRenumberCommand>(document_->stgData.get(), std::move(*plan), desc));
+}
+
+void StgEditorTab::drawReferences(StgRefKind kind, int32_t id) {
+    if (!ImGui::CollapsingHeader("References")) return;
+
+    auto& stg = *document_->stgData;
+    if (!stg.tailParsed()) {
+        ImGui::TextDisabled("Event section could not be parsed.");
+        return;
+    }
+
+    ensureReferenceIndex();
+    // Undoing a reorder in another event bypasses the incremental updates;
+    // rebuild if any listed site no longer holds this ID.
+    if (!refIndex_.sitesMatch(stg, kind, id)) {
+        refIndex_.build(stg);
+    }
+
+    auto sites = refIndex_.find(kind, id);
+    ImGui::Text("%zu script references", sites.size());
+
+    for (size_t i = 0; i < sites.size(); ++i) {
+        const auto& site = sites[i];
+        const auto& event = stg.eventBlocks()[site.block].events[site.event];
+        const auto& entries = site.action ? event.actions : event.conditions;
+        const ScriptEntryInfo* info = site.action ? findActionInfo(entries[site.entry].typeId)
+                                                  : findConditionInfo(entries[site.entry].typeId);
+
+        char label[192];
+        snprintf(label, sizeof(label), "[%u] %s / %s %u: %s", event.eventId, event.description.c_str(),
+                 site.action ? "Action" : "Condition", site.entry, info ? info->name : "Unknown");
+
+        ImGui::PushID(static_cast<int>(i));
+        if (ImGui::Selectable(label)) {
+            currentSection_ = Section::Events;
+            selectedBlock_ = static_cast<int>(site.block);
+            selectedEvent_ = static_cast<int>(site.event);
+        }
+        ImGui::PopID();
+    }
+
+    ImGui::Separator();
+    ImGui::SetNextItemWidth(120.0f);
+    ImGui::InputInt("##renumberTo", &renumberTarget_);
+    ImGui::SameLine();
+    bool taken = StgReferenceIndex::isDefined(stg, kind, renumberTarget_);
+    ImGui::BeginDisabled(taken || renumberTarget_ == id || renumberTarget_ < 0);
+    if (ImGui::SmallButton("Renumber")) {
+        renumber(kind, id, renumberTarget_);
+    }
+    ImGui::EndDisabled();
+    if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+        ImGui::SetTooltip(taken ? "ID %d is already in use" : "Change this ID to %d here and in every reference",
+                          renumberTarget_);
+    }
+}
+
 } // namespace kuf
@@ -3,6 +3,8 @@
 #include "ui/tabs/editor_tab.h"
 #include "core/name_dictionary.h"
 #include "formats/stg_format.h"
+#include "formats/stg_reference_index.h"
+#include "ui/bulk_edit_bar.h"
 
 #include <memory>
 
@@ -42,9 +44,15 @@ private:
     void drawScriptEntry(const char* entryLabel, StgScriptEntry& entry, bool isCondition,
                          StgEvent& event, const char* dragPayloadType = nullptr,
                          int dragIndex = -1, int* dragSrc = nullptr,
-                         int* dragDst = nullptr);
+                         int* dragDst = nullptr, int* paramDelta = nullptr);
     void drawParamValue(const char* label, StgParamValue& param, StgEvent& event,
                         const char* paramHint = nullptr);
+    // Swaps in an edited copy of an event as one undo step, for edits that
+    // add, remove or move its entries or parameters.
+    void replaceEvent(size_t blockIdx, size_t eventIdx, StgEvent updated, const char* description);
+    void drawReferences(StgRefKind kind, int32_t id);
+    void ensureReferenceIndex();
+    void renumber(StgRefKind kind, int32_t from, int32_t to);
 
     Section currentSection_ = Section::Units;
     int selectedUnit_ = -1;
@@ -53,6 +61,16 @@ private:
     int selectedBlock_ = 0;
     int selectedEvent_ = -1;
     NameDictionary nameDictionary_;
+
+    // Where-used index over event scripts, built on first use and kept in step
+    // as events are edited. Anything done through the undo stack, including
+    // undo itself, marks it for a rebuild.
+    StgReferenceIndex refIndex_;
+    bool refIndexBuilt_ = false;
+    uint64_t refIndexRevision_ = 0;
+    int renumberTarget_ = 0;
+
+    BulkEditBar unitBulkEdit_{BulkEditTarget::Units};
 };
 
 } // namespace kuf
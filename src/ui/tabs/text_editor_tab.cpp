@@ -1,4 +1,6 @@
 #include "ui/tabs/text_editor_tab.h"
+#include "core/profiler.h"
+#include "undo/set_text_command.h"
 
 #include <imgui.h>
 #include <algorithm>
@@ -11,7 +13,23 @@ TextEditorTab::TextEditorTab(std::shared_ptr<OpenDocument> doc)
     editBuffer_[0] = '\0';
 }
 
+void TextEditorTab::selectEntry(size_t index) {
+    if (document_ && document_->textData && index < document_->textData->entryCount()) {
+        selectedEntry_ = static_cast<int>(index);
+        scrollToSelected_ = true;
+        loadEditBuffer(index);
+    }
+}
+
+void TextEditorTab::loadEditBuffer(size_t index) {
+    std::string_view text = document_->textData->text(index);
+    size_t n = std::min(text.size(), sizeof(editBuffer_) - 1);
+    std::memcpy(editBuffer_, text.data(), n);
+    editBuffer_[n] = '\0';
+}
+
 void TextEditorTab::drawContent() {
+    KUF_PROFILE_ZONE("TextEditorTab::drawContent");
     if (!document_ || !document_->textData) {
         ImGui::TextDisabled("No text file loaded");
         return;
@@ -31,36 +49,16 @@ void TextEditorTab::drawContent() {
         ImGui::TableSetupColumn("Text", ImGuiTableColumnFlags_WidthStretch);
         ImGui::TableHeadersRow();
 
-        for (size_t i = 0; i < textData->entries().size(); ++i) {
-            auto& entry = textData->entries()[i];
-            ImGui::TableNextRow();
-
-            // Index.
-            ImGui::TableNextColumn();
-            char label[32];
-            snprintf(label, sizeof(label), "%zu", i);
-            bool selected = (selectedEntry_ == static_cast<int>(i));
-            if (ImGui::Selectable(label, selected, ImGuiSelectableFlags_SpanAllColumns)) {
-                selectedEntry_ = static_cast<int>(i);
-                strncpy(editBuffer_, entry.text.c_str(), sizeof(editBuffer_) - 1);
-                editBuffer_[sizeof(editBuffer_) - 1] = '\0';
-            }
-
-            // Max length.
-            ImGui::TableNextColumn();
-            ImGui::Text("%d", entry.maxLength);
-
-            // Text content.
-            ImGui::TableNextColumn();
-            if (selected) {
-                ImGui::SetNextItemWidth(-1);
-                if (ImGui::InputText("##edit", editBuffer_, entry.maxLength + 1,
-                        ImGuiInputTextFlags_EnterReturnsTrue)) {
-                    entry.text = editBuffer_;
-                    document_->dirty = true;
-                }
-            } else {
-                ImGui::Text("%s", entry.text.c_str());
+        // Only the visible rows are laid out, so tables with hundreds of
+        // thousands of entries scroll as fast as small ones.
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(textData->entryCount()));
+        if (scrollToSelected_ && selectedEntry_ >= 0) {
+            clipper.IncludeItemByIndex(selectedEntry_);
+        }
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                drawRow(static_cast<size_t>(row));
             }
         }
 
@@ -70,4 +68,44 @@ void TextEditorTab::drawContent() {
     ImGui::EndChild();
 }
 
+void TextEditorTab::drawRow(size_t i) {
+    auto& textData = *document_->textData;
+    std::string_view text = textData.text(i);
+    uint16_t maxLength = textData.maxLength(i);
+    ImGui::TableNextRow();
+
+    // Index.
+    ImGui::TableNextColumn();
+    char label[32];
+    snprintf(label, sizeof(label), "%zu", i);
+    bool selected = (selectedEntry_ == static_cast<int>(i));
+    if (ImGui::Selectable(label, selected, ImGuiSelectableFlags_SpanAllColumns)) {
+        selectedEntry_ = static_cast<int>(i);
+        loadEditBuffer(i);
+    }
+    if (selected && scrollToSelected_) {
+        ImGui::SetScrollHereY(0.5f);
+        scrollToSelected_ = false;
+    }
+
+    // Max length.
+    ImGui::TableNextColumn();
+    ImGui::Text("%d", maxLength);
+
+    // Text content.
+    ImGui::TableNextColumn();
+    if (selected) {
+        ImGui::SetNextItemWidth(-1);
+        size_t bufSize = std::min<size_t>(maxLength + 1, sizeof(editBuffer_));
+        if (ImGui::InputText("##edit", editBuffer_, bufSize,
+                ImGuiInputTextFlags_EnterReturnsTrue)) {
+            auto command = std::make_unique<SetTextCommand>(&textData, "Edit text " + std::to_string(i));
+            command->add(i, editBuffer_);
+            document_->undoStack->execute(std::move(command));
+        }
+    } else {
+        ImGui::TextUnformatted(text.data(), text.data() + text.size());
+    }
+}
+
 } // namespace kuf
@@ -13,8 +13,15 @@ public:
 
     void drawContent() override;
 
+    // Selects an entry for editing and scrolls it into view.
+    void selectEntry(size_t index);
+
 private:
+    void drawRow(size_t index);
+    void loadEditBuffer(size_t index);
+
     int selectedEntry_ = -1;
+    bool scrollToSelected_ = false;
     char editBuffer_[256] = {};
 };
 
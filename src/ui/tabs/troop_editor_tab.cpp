@@ -1,10 +1,44 @@
 #include "ui/tabs/troop_editor_tab.h"
+#include "core/profiler.h"
+#include "undo/set_field_command.h"
 
 #include <cfloat>
 #include <imgui.h>
+#include <string>
 
 namespace kuf {
 
+namespace {
+
+// Records a widget edit as a SetFieldCommand. Every frame of a drag edits the
+// same field, so the frames merge into one undo step until the widget is
+// released.
+template<typename T>
+void commitEdit(UndoStack& undo, T* field, T value, bool changed, const char* label) {
+    if (changed && value != *field) {
+        undo.beginMerge();
+        undo.execute(makeSetFieldCommand(field, value, std::string("Edit ") + label));
+    }
+    if (ImGui::IsItemDeactivatedAfterEdit()) {
+        undo.sealMerge();
+    }
+}
+
+void dragFloat(UndoStack& undo, const char* label, float* field, float speed, float min, float max,
+               const char* format) {
+    float value = *field;
+    bool changed = ImGui::DragFloat(label, &value, speed, min, max, format);
+    commitEdit(undo, field, value, changed, label);
+}
+
+void dragInt(UndoStack& undo, const char* label, int32_t* field, float speed, int min, int max) {
+    int value = *field;
+    bool changed = ImGui::DragInt(label, &value, speed, min, max);
+    commitEdit(undo, field, static_cast<int32_t>(value), changed, label);
+}
+
+} // namespace
+
 TroopEditorTab::TroopEditorTab(std::shared_ptr<OpenDocument> doc)
     : EditorTab(std::move(doc)) {}
 
@@ -16,11 +50,16 @@ void TroopEditorTab::selectTroop(size_t index) {
 }
 
 void TroopEditorTab::drawContent() {
+    KUF_PROFILE_ZONE("TroopEditorTab::drawContent");
     if (!document_ || !document_->binaryData) {
         ImGui::TextDisabled("No troop data loaded");
         return;
     }
 
+    if (ImGui::CollapsingHeader("Bulk Edit")) {
+        bulkEdit_.draw(*document_->undoStack, document_->binaryData->troops());
+    }
+
     float listHeight = ImGui::GetContentRegionAvail().y;
     ImGui::BeginChild("TroopList", ImVec2(250, listHeight), ImGuiChildFlags_Borders);
     drawTroopTable();
@@ -57,31 +96,32 @@ void TroopEditorTab::drawTroopDetails(size_t index) {
     ImGui::Text("%s", name);
     ImGui::Separator();
 
+    auto& undo = *document_->undoStack;
+
     if (ImGui::CollapsingHeader("Movement", ImGuiTreeNodeFlags_DefaultOpen)) {
-        ImGui::DragFloat("Move Speed", &troop.moveSpeed, 1.0f, 0.0f, 10000.0f, "%.0f");
-        ImGui::DragFloat("Rotate Rate", &troop.rotateRate, 1.0f, 0.0f, 1000.0f, "%.0f");
-        ImGui::DragFloat("Acceleration", &troop.moveAcceleration, 1.0f, 0.0f, 1000.0f, "%.0f");
-        ImGui::DragFloat("Deceleration", &troop.moveDeceleration, 1.0f, 0.0f, 1000.0f, "%.0f");
+        dragFloat(undo, "Move Speed", &troop.moveSpeed, 1.0f, 0.0f, 10000.0f, "%.0f");
+        dragFloat(undo, "Rotate Rate", &troop.rotateRate, 1.0f, 0.0f, 1000.0f, "%.0f");
+        dragFloat(undo, "Acceleration", &troop.moveAcceleration, 1.0f, 0.0f, 1000.0f, "%.0f");
+        dragFloat(undo, "Deceleration", &troop.moveDeceleration, 1.0f, 0.0f, 1000.0f, "%.0f");
     }
 
     if (ImGui::CollapsingHeader("Combat", ImGuiTreeNodeFlags_DefaultOpen)) {
-        ImGui::DragFloat("Sight Range", &troop.sightRange, 10.0f, 0.0f, 50000.0f, "%.0f");
-        ImGui::DragFloat("Attack Range Max", &troop.attackRangeMax, 10.0f, 0.0f, 50000.0f, "%.0f");
-        ImGui::DragFloat("Attack Range Min", &troop.attackRangeMin, 10.0f, 0.0f, 50000.0f, "%.0f");
-        ImGui::DragFloat("Direct Attack", &troop.directAttack, 1.0f, 0.0f, 1000.0f, "%.0f");
-        ImGui::DragFloat("Indirect Attack", &troop.indirectAttack, 1.0f, 0.0f, 1000.0f, "%.0f");
-        ImGui::DragFloat("Defense", &troop.defense, 1.0f, 0.0f, 1000.0f, "%.0f");
+        dragFloat(undo, "Sight Range", &troop.sightRange, 10.0f, 0.0f, 50000.0f, "%.0f");
+        dragFloat(undo, "Attack Range Max", &troop.attackRangeMax, 10.0f, 0.0f, 50000.0f, "%.0f");
+        dragFloat(undo, "Attack Range Min", &troop.attackRangeMin, 10.0f, 0.0f, 50000.0f, "%.0f");
+        dragFloat(undo, "Direct Attack", &troop.directAttack, 1.0f, 0.0f, 1000.0f, "%.0f");
+        dragFloat(undo, "Indirect Attack", &troop.indirectAttack, 1.0f, 0.0f, 1000.0f, "%.0f");
+        dragFloat(undo, "Defense", &troop.defense, 1.0f, 0.0f, 1000.0f, "%.0f");
     }
 
     if (ImGui::CollapsingHeader("Resistances", ImGuiTreeNodeFlags_DefaultOpen)) {
         // File stores damage percentage as int32: 0=immune, 100=normal, 200=very vulnerable.
         // Game divides by 100.0 to get damage multiplier (0.0×, 1.0×, 2.0×).
         ImGui::TextDisabled("Damage %% (0=immune, 100=normal, 200+=vulnerable)");
-        auto resistInput = [](const char* label, float* value) {
+        auto resistInput = [&undo](const char* label, float* value) {
             int fileVal = static_cast<int>(*value);
-            if (ImGui::DragInt(label, &fileVal, 1, 0, 10000, "%d%%")) {
-                *value = static_cast<float>(fileVal);
-            }
+            bool changed = ImGui::DragInt(label, &fileVal, 1, 0, 10000, "%d%%");
+            commitEdit(undo, value, static_cast<float>(fileVal), changed, label);
         };
 
         resistInput("Melee", &troop.resistMelee);
@@ -97,9 +137,9 @@ void TroopEditorTab::drawTroopDetails(size_t index) {
     }
 
     if (ImGui::CollapsingHeader("Unit Configuration", ImGuiTreeNodeFlags_DefaultOpen)) {
-        ImGui::DragFloat("Default HP", &troop.defaultUnitHp, 1.0f, 1.0f, 10000.0f, "%.0f");
-        ImGui::DragInt("Units X", &troop.defaultUnitNumX, 1, 1, 20);
-        ImGui::DragInt("Units Y", &troop.defaultUnitNumY, 1, 1, 20);
+        dragFloat(undo, "Default HP", &troop.defaultUnitHp, 1.0f, 1.0f, 10000.0f, "%.0f");
+        dragInt(undo, "Units X", &troop.defaultUnitNumX, 1, 1, 20);
+        dragInt(undo, "Units Y", &troop.defaultUnitNumY, 1, 1, 20);
         ImGui::Text("Total Units: %d", troop.defaultUnitNumX * troop.defaultUnitNumY);
     }
 }
@@ -2,6 +2,7 @@
 
 #include "ui/tabs/editor_tab.h"
 #include "formats/sox_binary.h"
+#include "ui/bulk_edit_bar.h"
 
 #include <memory>
 
@@ -21,6 +22,7 @@ private:
     void drawTroopDetails(size_t index);
 
     int selectedTroop_ = -1;
+    BulkEditBar bulkEdit_{BulkEditTarget::Troops};
 
     static constexpr const char* TROOP_NAMES[] = {
         "Archer", "Longbows", "Infantry", "Spearman", "Heavy Infantry",
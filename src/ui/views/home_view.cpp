@@ -1,5 +1,6 @@
 #include "ui/views/home_view.h"
 #include "ui/dialogs/file_dialog.h"
+#include "core/profiler.h"
 
 #include <imgui.h>
 #include <filesystem>
@@ -9,6 +10,7 @@ namespace kuf {
 HomeView::HomeView() : View("Home") {}
 
 void HomeView::drawContent() {
+    KUF_PROFILE_ZONE("HomeView::drawContent");
     if (!gamesDetected_) {
         detectGames();
         gamesDetected_ = true;
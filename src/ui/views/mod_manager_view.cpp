@@ -1,5 +1,6 @@
 #include "ui/views/mod_manager_view.h"
 #include "ui/dialogs/file_dialog.h"
+#include "core/profiler.h"
 
 #include <imgui.h>
 
@@ -38,9 +39,17 @@ std::string currentIso8601() {
 ModManagerView::ModManagerView() : View("Mod Manager") {}
 
 void ModManagerView::drawContent() {
+    KUF_PROFILE_ZONE("ModManagerView::drawContent");
     if (!installedModsLoaded_) {
         refreshInstalledMods();
         installedModsLoaded_ = true;
+
+        // Roll back an install that was cut short by a crash or kill.
+        if (ModManager::hasInterruptedInstall() && task_.state() == AsyncTaskState::Idle) {
+            task_.start([](AsyncTask& t) {
+                return ModManager::recoverInterruptedInstall(t);
+            });
+        }
     }
 
     float height = ImGui::GetContentRegionAvail().y;
@@ -89,9 +98,11 @@ void ModManagerView::drawInstalledSidebar() {
         }
 
         ImGui::Spacing();
+        ImGui::BeginDisabled(task_.state() == AsyncTaskState::Running);
         if (ImGui::Button("Uninstall", ImVec2(-1, 0))) {
             showUninstallConfirm_ = true;
         }
+        ImGui::EndDisabled();
     }
 
     if (showUninstallConfirm_) {
@@ -99,15 +110,27 @@ void ModManagerView::drawInstalledSidebar() {
         showUninstallConfirm_ = false;
     }
     if (ImGui::BeginPopupModal("Confirm Uninstall", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-        ImGui::Text("Remove this mod from the installed list?");
-        ImGui::TextDisabled("(Files in the game directory are not reverted.)");
+        bool validSelection = selectedInstalledMod_ >= 0 &&
+                              selectedInstalledMod_ < static_cast<int>(installedMods_.size());
+        bool canRevert = validSelection &&
+                         !installedMods_[selectedInstalledMod_].preimagePath.empty();
+
+        ImGui::Text("Uninstall this mod?");
+        if (canRevert) {
+            ImGui::TextDisabled("(Files the mod replaced will be restored.)");
+        } else {
+            ImGui::TextDisabled("(Files in the game directory are not reverted.)");
+        }
         ImGui::Separator();
         if (ImGui::Button("Uninstall", ImVec2(120, 0))) {
-            if (selectedInstalledMod_ >= 0 &&
-                selectedInstalledMod_ < static_cast<int>(installedMods_.size())) {
-                ModManager::markUninstalled(installedMods_[selectedInstalledMod_].name);
+            if (validSelection) {
+                std::string name = installedMods_[selectedInstalledMod_].name;
                 selectedInstalledMod_ = -1;
-                refreshInstalledMods();
+                auto conflicts = std::make_shared<std::vector<std::string>>();
+                pendingUninstallConflicts_ = conflicts;
+                task_.start([name, conflicts](AsyncTask& t) {
+                    return ModManager::uninstallMod(name, t, conflicts.get());
+                });
             }
             ImGui::CloseCurrentPopup();
         }
@@ -117,6 +140,8 @@ void ModManagerView::drawInstalledSidebar() {
         }
         ImGui::EndPopup();
     }
+
+    drawUninstallConflictsPopup();
 }
 
 void ModManagerView::drawMainContent() {
@@ -136,11 +161,33 @@ void ModManagerView::drawMainContent() {
 
     // Handle async task completion.
     if (task_.state() == AsyncTaskState::Completed) {
+        if (pendingRestorePlan_) {
+            restorePreview_ = std::move(*pendingRestorePlan_);
+            pendingRestorePlan_.reset();
+            showRestorePreview_ = true;
+        }
+        if (pendingVerifyReport_) {
+            verifyReport_ = std::move(*pendingVerifyReport_);
+            pendingVerifyReport_.reset();
+            showVerifyReport_ = true;
+        }
+        if (pendingRecordConflicts_) {
+            recordConflicts_ = std::move(*pendingRecordConflicts_);
+            pendingRecordConflicts_.reset();
+        }
+        if (pendingUninstallConflicts_) {
+            uninstallConflicts_ = std::move(*pendingUninstallConflicts_);
+            pendingUninstallConflicts_.reset();
+        }
         refreshBackups();
         refreshMods();
         refreshInstalledMods();
         task_.reset();
     } else if (task_.state() == AsyncTaskState::Failed) {
+        pendingRestorePlan_.reset();
+        pendingVerifyReport_.reset();
+        pendingRecordConflicts_.reset();
+        pendingUninstallConflicts_.reset();
         if (onError_) {
             onError_(task_.error());
         }
@@ -174,10 +221,11 @@ void ModManagerView::drawBackupsSection() {
         if (!backups_.empty()) {
             ImGui::Spacing();
 
-            if (ImGui::BeginTable("BackupsTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            if (ImGui::BeginTable("BackupsTable", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
                 ImGui::TableSetupColumn("Timestamp", ImGuiTableColumnFlags_WidthStretch);
                 ImGui::TableSetupColumn("Files", ImGuiTableColumnFlags_WidthFixed, 60.0f);
                 ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+                ImGui::TableSetupColumn("##Verify", ImGuiTableColumnFlags_WidthFixed, 50.0f);
                 ImGui::TableSetupColumn("##Restore", ImGuiTableColumnFlags_WidthFixed, 60.0f);
                 ImGui::TableSetupColumn("##Delete", ImGuiTableColumnFlags_WidthFixed, 60.0f);
                 ImGui::TableHeadersRow();
@@ -198,6 +246,21 @@ void ModManagerView::drawBackupsSection() {
                     ImGui::TableNextColumn();
                     ImGui::PushID(i);
                     ImGui::BeginDisabled(!hasGameDir);
+                    if (ImGui::SmallButton("Verify")) {
+                        std::string dir = gameDirectory_;
+                        auto result = std::make_shared<VerifyReport>();
+                        pendingVerifyReport_ = result;
+                        task_.start([backup, dir, result](AsyncTask& t) {
+                            auto report = BackupManager::verifyBackup(backup, dir, t);
+                            if (!report) return false;
+                            *result = std::move(*report);
+                            return true;
+                        });
+                    }
+                    ImGui::EndDisabled();
+
+                    ImGui::TableNextColumn();
+                    ImGui::BeginDisabled(!hasGameDir);
                     if (ImGui::SmallButton("Restore")) {
                         pendingBackupIndex_ = i;
                         showRestoreConfirm_ = true;
@@ -226,13 +289,33 @@ void ModManagerView::drawBackupsSection() {
     }
     if (ImGui::BeginPopupModal("Confirm Restore", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
         ImGui::Text("Restore this backup? This will overwrite files in the game directory.");
+        ImGui::Checkbox("Only copy files that differ", &deltaRestore_);
         ImGui::Separator();
+        bool validBackup = pendingBackupIndex_ >= 0 &&
+                           pendingBackupIndex_ < static_cast<int>(backups_.size());
         if (ImGui::Button("Restore", ImVec2(120, 0))) {
-            if (pendingBackupIndex_ >= 0 && pendingBackupIndex_ < static_cast<int>(backups_.size())) {
+            if (validBackup) {
+                auto backup = backups_[pendingBackupIndex_];
+                std::string dir = gameDirectory_;
+                auto mode = deltaRestore_ ? RestoreMode::Delta : RestoreMode::Full;
+                task_.start([backup, dir, mode](AsyncTask& t) {
+                    return BackupManager::restoreBackup(backup, dir, t, mode);
+                });
+            }
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Preview", ImVec2(120, 0))) {
+            if (validBackup) {
                 auto backup = backups_[pendingBackupIndex_];
                 std::string dir = gameDirectory_;
-                task_.start([backup, dir](AsyncTask& t) {
-                    return BackupManager::restoreBackup(backup, dir, t);
+                auto result = std::make_shared<RestorePlan>();
+                pendingRestorePlan_ = result;
+                task_.start([backup, dir, result](AsyncTask& t) {
+                    auto plan = BackupManager::planRestore(backup, dir, t);
+                    if (!plan) return false;
+                    *result = std::move(*plan);
+                    return true;
                 });
             }
             ImGui::CloseCurrentPopup();
@@ -265,6 +348,98 @@ void ModManagerView::drawBackupsSection() {
         }
         ImGui::EndPopup();
     }
+
+    drawRestorePreviewPopup();
+    drawVerifyReportPopup();
+}
+
+void ModManagerView::drawRestorePreviewPopup() {
+    if (showRestorePreview_) {
+        ImGui::OpenPopup("Restore Preview");
+        showRestorePreview_ = false;
+    }
+    if (ImGui::BeginPopupModal("Restore Preview", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        if (restorePreview_) {
+            const auto& plan = *restorePreview_;
+            if (plan.changedFiles.empty()) {
+                ImGui::Text("The game directory already matches this backup.");
+            } else {
+                ImGui::Text("%zu files would be restored (%s), %zu unchanged.",
+                            plan.changedFiles.size(), formatBytes(plan.bytesToCopy).c_str(),
+                            plan.unchangedCount);
+                ImGui::BeginChild("RestorePreviewFiles", ImVec2(480, 240), ImGuiChildFlags_Borders);
+                for (const auto& f : plan.changedFiles) {
+                    ImGui::BulletText("%s", f.c_str());
+                }
+                ImGui::EndChild();
+            }
+        }
+        ImGui::Separator();
+        if (ImGui::Button("Close", ImVec2(120, 0))) {
+            restorePreview_.reset();
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndPopup();
+    }
+}
+
+void ModManagerView::drawVerifyReportPopup() {
+    if (showVerifyReport_) {
+        ImGui::OpenPopup("Verification Result");
+        showVerifyReport_ = false;
+    }
+    if (ImGui::BeginPopupModal("Verification Result", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        if (verifyReport_) {
+            const auto& report = *verifyReport_;
+            ImGui::Text("%zu files match (%s hashed).", report.matchedCount,
+                        formatBytes(report.bytesHashed).c_str());
+            if (report.clean()) {
+                ImGui::Text("The game directory matches this backup.");
+            } else {
+                auto fileList = [](const char* label, const std::vector<std::string>& files) {
+                    if (files.empty()) return;
+                    if (ImGui::TreeNodeEx(label, ImGuiTreeNodeFlags_DefaultOpen, "%s (%zu)", label,
+                                          files.size())) {
+                        for (const auto& f : files) {
+                            ImGui::BulletText("%s", f.c_str());
+                        }
+                        ImGui::TreePop();
+                    }
+                };
+                ImGui::BeginChild("VerifyReportFiles", ImVec2(480, 240), ImGuiChildFlags_Borders);
+                fileList("Modified", report.modifiedFiles);
+                fileList("Missing", report.missingFiles);
+                fileList("Extra", report.extraFiles);
+                ImGui::EndChild();
+            }
+        }
+        ImGui::Separator();
+        if (ImGui::Button("Close", ImVec2(120, 0))) {
+            verifyReport_.reset();
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndPopup();
+    }
+}
+
+void ModManagerView::drawUninstallConflictsPopup() {
+    if (!uninstallConflicts_.empty() && !ImGui::IsPopupOpen("Files Kept")) {
+        ImGui::OpenPopup("Files Kept");
+    }
+    if (ImGui::BeginPopupModal("Files Kept", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::Text("These files changed after the mod was installed and were not reverted:");
+        ImGui::BeginChild("UninstallConflictFiles", ImVec2(480, 200), ImGuiChildFlags_Borders);
+        for (const auto& f : uninstallConflicts_) {
+            ImGui::BulletText("%s", f.c_str());
+        }
+        ImGui::EndChild();
+        ImGui::Separator();
+        if (ImGui::Button("Close", ImVec2(120, 0))) {
+            uninstallConflicts_.clear();
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndPopup();
+    }
 }
 
 void ModManagerView::drawModLibrarySection() {
@@ -357,6 +532,7 @@ void ModManagerView::drawModLibrarySection() {
                         ImGui::BulletText("%s", f.c_str());
                     }
                 }
+                drawModConflicts(mod);
             }
         } else {
             ImGui::TextDisabled("No mods imported.");
@@ -370,17 +546,14 @@ void ModManagerView::drawModLibrarySection() {
     }
     if (ImGui::BeginPopupModal("Confirm Apply Mod", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
         ImGui::Text("Apply this mod? Files in the game directory will be overwritten.");
+        ImGui::TextDisabled("(Replaced files are saved so the mod can be uninstalled.)");
         ImGui::Separator();
         if (ImGui::Button("Apply", ImVec2(120, 0))) {
             if (pendingModIndex_ >= 0 && pendingModIndex_ < static_cast<int>(mods_.size())) {
                 auto mod = mods_[pendingModIndex_];
                 std::string dir = gameDirectory_;
                 task_.start([mod, dir](AsyncTask& t) {
-                    bool ok = ModManager::applyMod(mod, dir, t);
-                    if (ok) {
-                        ModManager::markInstalled(mod);
-                    }
-                    return ok;
+                    return ModManager::installMod(mod, dir, t);
                 });
             }
             ImGui::CloseCurrentPopup();
@@ -393,6 +566,75 @@ void ModManagerView::drawModLibrarySection() {
     }
 }
 
+void ModManagerView::drawModConflicts(const ModInfo& mod) {
+    auto conflicts = ModManager::conflictIndex().conflictsFor(mod.zipPath);
+
+    ImGui::Spacing();
+    if (conflicts.empty()) {
+        ImGui::TextDisabled("No other library mod writes these files.");
+        return;
+    }
+
+    ImGui::Text("Conflicts (%zu mods):", conflicts.size());
+    for (const auto& c : conflicts) {
+        if (ImGui::TreeNode(c.otherZipPath.c_str(), "%s (%zu files)", c.otherMod.c_str(),
+                            c.files.size())) {
+            for (const auto& f : c.files) {
+                ImGui::BulletText("%s", f.c_str());
+            }
+            ImGui::TreePop();
+        }
+    }
+
+    // Record-level analysis reads the shared SOX/STG files, so it runs on demand.
+    ImGui::BeginDisabled(gameDirectory_.empty());
+    if (ImGui::Button("Compare Records")) {
+        auto result = std::make_shared<std::vector<RecordConflict>>();
+        pendingRecordConflicts_ = result;
+        recordConflicts_.reset();
+        recordConflictsZip_ = mod.zipPath;
+        std::string zipPath = mod.zipPath;
+        std::string dir = gameDirectory_;
+        task_.start([result, zipPath, dir](AsyncTask& t) {
+            t.setProgress(0.0f, "Comparing records");
+            *result = ModManager::conflictIndex().recordConflictsFor(zipPath, dir);
+            return true;
+        });
+    }
+    ImGui::EndDisabled();
+
+    if (!recordConflicts_ || recordConflictsZip_ != mod.zipPath) return;
+
+    if (ImGui::BeginTable("RecordConflictsTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Mod", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+        ImGui::TableSetupColumn("File", ImGuiTableColumnFlags_WidthFixed, 160.0f);
+        ImGui::TableSetupColumn("Overlapping Records", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        for (const auto& rc : *recordConflicts_) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", rc.otherMod.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", rc.file.c_str());
+            ImGui::TableNextColumn();
+            if (rc.wholeFile) {
+                ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Whole file");
+            } else if (rc.records.empty()) {
+                ImGui::TextDisabled("None (changes are disjoint)");
+            } else {
+                std::string joined;
+                for (const auto& r : rc.records) {
+                    if (!joined.empty()) joined += ", ";
+                    joined += r;
+                }
+                ImGui::TextWrapped("%s", joined.c_str());
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
 void ModManagerView::drawCreateModSection() {
     if (ImGui::CollapsingHeader("Create Mod")) {
         ImGui::InputText("Name", modName_, sizeof(modName_));
@@ -451,6 +693,21 @@ void ModManagerView::drawCreateModSection() {
             modFiles_.erase(modFiles_.begin() + removeIndex);
         }
 
+        // Record patches need an unmodded copy of each file to diff against;
+        // backups_ is newest first, like BackupManager::latestBackup().
+        const BackupInfo* baseBackup = backups_.empty() ? nullptr : &backups_.front();
+        ImGui::Spacing();
+        ImGui::BeginDisabled(!baseBackup);
+        ImGui::Checkbox("Store SOX/STG edits as record patches", &exportAsPatches_);
+        ImGui::EndDisabled();
+        if (baseBackup) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(against backup %s)", baseBackup->timestamp.c_str());
+        } else {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(create a backup first)");
+        }
+
         ImGui::Spacing();
         bool canExport = modName_[0] != '\0' && modVersion_[0] != '\0' &&
                          !modFiles_.empty() && hasGameDir;
@@ -470,8 +727,9 @@ void ModManagerView::drawCreateModSection() {
                 std::string dir = gameDirectory_;
                 auto files = modFiles_;
                 std::string outPath = *savePath;
-                task_.start([meta, dir, files, outPath](AsyncTask& t) {
-                    return ModManager::createMod(meta, dir, files, outPath, t);
+                std::string baseDir = exportAsPatches_ && baseBackup ? baseBackup->path : "";
+                task_.start([meta, dir, files, outPath, baseDir](AsyncTask& t) {
+                    return ModManager::createMod(meta, dir, files, outPath, t, baseDir);
                 });
             }
         }
@@ -513,8 +771,9 @@ void ModManagerView::restoreLatestBackup() {
 
     auto backup = *latest;
     std::string dir = gameDirectory_;
-    task_.start([backup, dir](AsyncTask& t) {
-        return BackupManager::restoreBackup(backup, dir, t);
+    auto mode = deltaRestore_ ? RestoreMode::Delta : RestoreMode::Full;
+    task_.start([backup, dir, mode](AsyncTask& t) {
+        return BackupManager::restoreBackup(backup, dir, t, mode);
     });
 }
 
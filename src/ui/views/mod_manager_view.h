@@ -3,9 +3,12 @@
 #include "ui/views/view.h"
 #include "core/async_task.h"
 #include "mods/backup_manager.h"
+#include "mods/mod_conflict_index.h"
 #include "mods/mod_manager.h"
 
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -22,13 +25,20 @@ public:
 
     void restoreLatestBackup();
 
+    // True while a backup, restore or install task is running.
+    bool busy() const { return task_.state() == AsyncTaskState::Running; }
+
 private:
     void drawInstalledSidebar();
     void drawMainContent();
     void drawBackupsSection();
     void drawModLibrarySection();
     void drawCreateModSection();
+    void drawModConflicts(const ModInfo& mod);
     void drawProgressOverlay();
+    void drawRestorePreviewPopup();
+    void drawVerifyReportPopup();
+    void drawUninstallConflictsPopup();
     void refreshBackups();
     void refreshMods();
     void refreshInstalledMods();
@@ -39,12 +49,29 @@ private:
     // Backups.
     std::vector<BackupInfo> backups_;
     bool backupsLoaded_ = false;
+    bool deltaRestore_ = true;
+
+    // Restore preview (dry run). The task fills pendingRestorePlan_ on the
+    // worker thread; it is moved into restorePreview_ once the task completes.
+    std::shared_ptr<RestorePlan> pendingRestorePlan_;
+    std::optional<RestorePlan> restorePreview_;
+    bool showRestorePreview_ = false;
+
+    // Backup verification, handed over from the task the same way.
+    std::shared_ptr<VerifyReport> pendingVerifyReport_;
+    std::optional<VerifyReport> verifyReport_;
+    bool showVerifyReport_ = false;
 
     // Mod library.
     std::vector<ModInfo> mods_;
     bool modsLoaded_ = false;
     int selectedMod_ = -1;
 
+    // Record-level conflicts for recordConflictsZip_, handed over from the task.
+    std::shared_ptr<std::vector<RecordConflict>> pendingRecordConflicts_;
+    std::optional<std::vector<RecordConflict>> recordConflicts_;
+    std::string recordConflictsZip_;
+
     // Create mod form.
     char modName_[128] = {};
     char modVersion_[32] = "1.0.0";
@@ -52,6 +79,7 @@ private:
     char modDescription_[256] = {};
     int modGame_ = 0; // 0 = crusaders, 1 = heroes
     std::vector<std::string> modFiles_;
+    bool exportAsPatches_ = true; // Diff SOX/STG files against the latest backup.
 
     // Installed mods.
     std::vector<InstalledModInfo> installedMods_;
@@ -59,6 +87,10 @@ private:
     int selectedInstalledMod_ = -1;
     bool showUninstallConfirm_ = false;
 
+    // Files an uninstall left alone because they changed after the install.
+    std::shared_ptr<std::vector<std::string>> pendingUninstallConflicts_;
+    std::vector<std::string> uninstallConflicts_;
+
     // Confirmation popups.
     bool showRestoreConfirm_ = false;
     bool showDeleteConfirm_ = false;
@@ -0,0 +1,79 @@
+#include "ui/views/profiler_view.h"
+
+#if KUF_ENABLE_PROFILER
+
+#include "ui/dialogs/file_dialog.h"
+
+#include <imgui.h>
+
+namespace kuf {
+
+ProfilerView::ProfilerView() : View("Profiler") {
+    open_ = false;
+}
+
+void ProfilerView::drawContent() {
+    double meanMs = profiler::meanFrameMs();
+    ImGui::Text("Frame: %.2f ms mean, %.2f ms worst (%.0f fps) over %zu frames", meanMs,
+                profiler::maxFrameMs(), meanMs > 0 ? 1000.0 / meanMs : 0.0, profiler::kHistoryFrames);
+    if (uint64_t dropped = profiler::droppedEvents()) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "| %llu events dropped",
+                           static_cast<unsigned long long>(dropped));
+    }
+
+    if (profiler::capturing()) {
+        if (ImGui::Button("Stop Capture")) profiler::stopCapture();
+        ImGui::SameLine();
+        ImGui::Text("Capturing... %zu events", profiler::capturedEvents());
+    } else {
+        if (ImGui::Button("Start Capture")) {
+            profiler::startCapture();
+            status_.clear();
+        }
+        ImGui::SameLine();
+        ImGui::BeginDisabled(profiler::capturedEvents() == 0);
+        if (ImGui::Button("Export Trace...")) {
+            if (auto path = FileDialog::saveFile("*.json", "kufeditor_trace.json")) {
+                status_ = profiler::writeChromeTrace(*path) ? "Saved " + *path : "Cannot write " + *path;
+            }
+        }
+        ImGui::EndDisabled();
+        if (!status_.empty()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", status_.c_str());
+        }
+    }
+    ImGui::Separator();
+
+    auto zones = profiler::summaries();
+    if (ImGui::BeginTable("ProfilerZones", 5,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Calls/frame", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+        ImGui::TableSetupColumn("Mean ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Max ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Last ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableHeadersRow();
+
+        for (const auto& zone : zones) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(zone.name.data(), zone.name.data() + zone.name.size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", zone.callsPerFrame);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", zone.meanMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", zone.maxMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", zone.lastMs);
+        }
+        ImGui::EndTable();
+    }
+}
+
+} // namespace kuf
+
+#endif
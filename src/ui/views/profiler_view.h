@@ -0,0 +1,26 @@
+#pragma once
+
+#include "core/profiler.h"
+
+#if KUF_ENABLE_PROFILER
+
+#include "ui/views/view.h"
+
+#include <string>
+
+namespace kuf {
+
+// Rolling per-zone frame timings and Chrome trace capture.
+class ProfilerView : public View {
+public:
+    ProfilerView();
+
+    void drawContent() override;
+
+private:
+    std::string status_;
+};
+
+} // namespace kuf
+
+#endif
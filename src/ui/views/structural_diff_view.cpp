@@ -0,0 +1,250 @@
+#include "ui/views/structural_diff_view.h"
+#include "core/profiler.h"
+#include "ui/dialogs/file_dialog.h"
+
+#include <imgui.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+namespace kuf {
+
+namespace {
+
+ImVec4 statusColor(FileDiffStatus status) {
+    switch (status) {
+    case FileDiffStatus::Added: return ImVec4(0.4f, 0.9f, 0.4f, 1.0f);
+    case FileDiffStatus::Removed: return ImVec4(1.0f, 0.4f, 0.4f, 1.0f);
+    case FileDiffStatus::Changed: return ImVec4(1.0f, 0.8f, 0.3f, 1.0f);
+    case FileDiffStatus::Unreadable: return ImVec4(1.0f, 0.4f, 0.4f, 1.0f);
+    case FileDiffStatus::Identical: break;
+    }
+    return ImVec4(0.6f, 0.6f, 0.6f, 1.0f);
+}
+
+ImVec4 kindColor(RecordChangeKind kind) {
+    switch (kind) {
+    case RecordChangeKind::Added: return ImVec4(0.4f, 0.9f, 0.4f, 1.0f);
+    case RecordChangeKind::Removed: return ImVec4(1.0f, 0.4f, 0.4f, 1.0f);
+    case RecordChangeKind::Changed: break;
+    }
+    return ImVec4(1.0f, 0.8f, 0.3f, 1.0f);
+}
+
+} // namespace
+
+StructuralDiffView::StructuralDiffView() : View("Structural Diff") {
+    open_ = false;
+}
+
+void StructuralDiffView::setGameDirectory(const std::string& dir) {
+    if (basePath_[0] == '\0') std::snprintf(basePath_, sizeof(basePath_), "%s", dir.c_str());
+}
+
+void StructuralDiffView::drawPathInput(const char* label, char* buffer, size_t size) {
+    ImGui::PushID(label);
+    ImGui::SetNextItemWidth(-220.0f);
+    ImGui::InputTextWithHint("##path", label, buffer, size);
+    ImGui::SameLine();
+    if (ImGui::Button("Folder...")) {
+        if (auto path = FileDialog::openFolder()) std::snprintf(buffer, size, "%s", path->c_str());
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("File...")) {
+        if (auto path = FileDialog::openFile("*.sox;*.stg")) std::snprintf(buffer, size, "%s", path->c_str());
+    }
+    ImGui::PopID();
+}
+
+void StructuralDiffView::drawContent() {
+    KUF_PROFILE_ZONE("StructuralDiffView::drawContent");
+    if (task_.state() == AsyncTaskState::Completed || task_.state() == AsyncTaskState::Failed) {
+        if (task_.state() == AsyncTaskState::Completed && pending_) {
+            result_ = std::move(*pending_);
+            selectFile(-1);
+        }
+        pending_.reset();
+        task_.reset();
+    }
+
+    drawPathInput("Base (older version)", basePath_, sizeof(basePath_));
+    drawPathInput("Modified (newer version)", modifiedPath_, sizeof(modifiedPath_));
+
+    ImGui::BeginDisabled(busy() || basePath_[0] == '\0' || modifiedPath_[0] == '\0');
+    if (ImGui::Button("Compare")) startCompare();
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    if (busy()) {
+        ImGui::ProgressBar(task_.progress(), ImVec2(200.0f, 0.0f), "Comparing...");
+    } else if (!result_.files.empty()) {
+        size_t changed = 0;
+        for (const auto& file : result_.files) {
+            if (file.status != FileDiffStatus::Identical) ++changed;
+        }
+        ImGui::TextDisabled("%zu of %zu files differ (%.2f s)", changed, result_.files.size(), result_.seconds);
+        ImGui::SameLine();
+        ImGui::Checkbox("Hide identical", &hideIdentical_);
+    }
+
+    ImGui::Separator();
+    if (ImGui::BeginTable("DiffLayout", 2, ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Files", ImGuiTableColumnFlags_WidthFixed, 320.0f);
+        ImGui::TableSetupColumn("Records", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        drawFileList();
+        ImGui::TableNextColumn();
+        drawRecords();
+        ImGui::EndTable();
+    }
+}
+
+void StructuralDiffView::startCompare() {
+    std::string base = basePath_;
+    std::string modified = modifiedPath_;
+    std::error_code ec;
+    comparedModified_ = modified;
+    comparedDirectories_ = std::filesystem::is_directory(base, ec) && std::filesystem::is_directory(modified, ec);
+
+    auto result = std::make_shared<CompareResult>();
+    pending_ = result;
+    task_.start([result, base, modified](AsyncTask& t) {
+        t.setProgress(0.0f, "Comparing...");
+        auto start = std::chrono::steady_clock::now();
+        result->files = diffPaths(base, modified, [&t](size_t done, size_t total) {
+            t.setProgress(static_cast<float>(done) / static_cast<float>(total), "Comparing...");
+        });
+        result->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    });
+}
+
+void StructuralDiffView::selectFile(int index) {
+    selectedFile_ = index;
+    rows_.clear();
+    if (index < 0 || !result_.files[index].diff) return;
+    const auto& records = result_.files[index].diff->records;
+    for (size_t r = 0; r < records.size(); ++r) {
+        if (records[r].fields.empty()) {
+            rows_.emplace_back(static_cast<int>(r), -1);
+            continue;
+        }
+        for (size_t f = 0; f < records[r].fields.size(); ++f) {
+            rows_.emplace_back(static_cast<int>(r), static_cast<int>(f));
+        }
+    }
+}
+
+void StructuralDiffView::drawFileList() {
+    std::vector<int> visible;
+    visible.reserve(result_.files.size());
+    for (size_t i = 0; i < result_.files.size(); ++i) {
+        if (!hideIdentical_ || result_.files[i].status != FileDiffStatus::Identical) {
+            visible.push_back(static_cast<int>(i));
+        }
+    }
+
+    if (!ImGui::BeginTable("DiffFiles", 3,
+            ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_BordersInnerH)) {
+        return;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("File", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+    ImGui::TableSetupColumn("Records", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+    ImGui::TableHeadersRow();
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(visible.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            int index = visible[row];
+            const auto& file = result_.files[index];
+            ImGui::TableNextRow();
+            ImGui::PushID(index);
+
+            ImGui::TableNextColumn();
+            if (ImGui::Selectable(file.path.c_str(), selectedFile_ == index,
+                    ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick)) {
+                selectFile(index);
+                bool openable = file.status == FileDiffStatus::Changed || file.status == FileDiffStatus::Added;
+                if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && openable && onOpenFile_) {
+                    onOpenFile_(comparedDirectories_
+                                    ? (std::filesystem::path(comparedModified_) / file.path).string()
+                                    : comparedModified_);
+                }
+            }
+
+            ImGui::TableNextColumn();
+            ImGui::TextColored(statusColor(file.status), "%s", fileDiffStatusName(file.status).data());
+
+            ImGui::TableNextColumn();
+            if (file.diff) {
+                ImGui::Text("%zu", file.diff->records.size());
+            } else if (file.status == FileDiffStatus::Changed) {
+                ImGui::TextDisabled("bytes");
+            }
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndTable();
+}
+
+void StructuralDiffView::drawRecords() {
+    if (selectedFile_ < 0) {
+        ImGui::TextDisabled("Select a file to see its changed records.");
+        return;
+    }
+    const auto& file = result_.files[selectedFile_];
+    if (!file.diff) {
+        if (file.status == FileDiffStatus::Changed) {
+            ImGui::TextDisabled("No record structure is known for this file; it differs as a whole.");
+        } else {
+            ImGui::TextDisabled("File is %s.", fileDiffStatusName(file.status).data());
+        }
+        return;
+    }
+
+    const auto& diff = *file.diff;
+    ImGui::Text("%s: %zu changed records, %zu unchanged", diff.format.c_str(), diff.records.size(), diff.unchanged);
+    if (!ImGui::BeginTable("DiffRecords", 5,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable)) {
+        return;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Record", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+    ImGui::TableSetupColumn("Change", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+    ImGui::TableSetupColumn("Field", ImGuiTableColumnFlags_WidthFixed, 180.0f);
+    ImGui::TableSetupColumn("Before", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("After", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(rows_.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            auto [r, f] = rows_[row];
+            const auto& record = diff.records[r];
+            ImGui::TableNextRow();
+
+            // The record key is only shown on its first row.
+            ImGui::TableNextColumn();
+            if (f <= 0) ImGui::TextUnformatted(record.key.c_str());
+            ImGui::TableNextColumn();
+            if (f <= 0) ImGui::TextColored(kindColor(record.kind), "%s", recordChangeKindName(record.kind).data());
+            if (f < 0) continue;
+
+            const auto& field = record.fields[f];
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(field.field.c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(field.before.c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(field.after.c_str());
+        }
+    }
+    ImGui::EndTable();
+}
+
+} // namespace kuf
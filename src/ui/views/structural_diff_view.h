@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ui/views/view.h"
+#include "core/async_task.h"
+#include "formats/structural_diff.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace kuf {
+
+// Record-aware comparison of two SOX/STG files or two game directories,
+// such as the data folders of two game versions. Files are diffed on a task
+// thread; the view lists changed files and the fields of their records.
+class StructuralDiffView : public View {
+public:
+    StructuralDiffView();
+
+    void drawContent() override;
+
+    // Prefills the base path for a new comparison.
+    void setGameDirectory(const std::string& dir);
+
+    // Called with the full modified path when a file is double-clicked.
+    void setOnOpenFile(std::function<void(const std::string& path)> cb) { onOpenFile_ = std::move(cb); }
+
+    bool busy() const { return task_.state() == AsyncTaskState::Running; }
+
+private:
+    struct CompareResult {
+        std::vector<FileDiff> files;
+        double seconds = 0.0;
+    };
+
+    void drawPathInput(const char* label, char* buffer, size_t size);
+    void startCompare();
+    void drawFileList();
+    void drawRecords();
+    void selectFile(int index);
+
+    char basePath_[512] = {};
+    char modifiedPath_[512] = {};
+
+    AsyncTask task_;
+    std::shared_ptr<CompareResult> pending_;
+    CompareResult result_;
+    std::string comparedModified_;
+    bool comparedDirectories_ = false;
+    bool hideIdentical_ = true;
+    int selectedFile_ = -1;
+
+    // (record, field) pairs of the selected file, one per table row. A
+    // record without fields has one row with field -1.
+    std::vector<std::pair<int, int>> rows_;
+
+    std::function<void(const std::string&)> onOpenFile_;
+};
+
+} // namespace kuf
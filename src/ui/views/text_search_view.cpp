@@ -0,0 +1,247 @@
+#include "ui/views/text_search_view.h"
+#include "core/profiler.h"
+
+#include <imgui.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <variant>
+
+namespace kuf {
+
+TextSearchView::TextSearchView()
+    : View("Text Search"), index_(std::make_shared<TextSearchIndex>()) {
+    open_ = false;
+}
+
+void TextSearchView::setGameDirectory(const std::string& dir) {
+    gameDirectory_ = dir;
+    if (indexRequested_) refresh();
+}
+
+void TextSearchView::refresh() {
+    if (!indexRequested_ || gameDirectory_.empty()) return;
+    if (busy()) {
+        refreshPending_ = true;
+        return;
+    }
+    startRefresh();
+}
+
+void TextSearchView::startRefresh() {
+    auto index = index_;
+    std::string dir = gameDirectory_;
+    task_.start([index, dir](AsyncTask& t) {
+        t.setProgress(0.0f, "Indexing text files...");
+        index->refresh(dir, [&t](size_t done, size_t total) {
+            t.setProgress(static_cast<float>(done) / static_cast<float>(total), "Indexing text files...");
+        });
+        return true;
+    });
+}
+
+void TextSearchView::drawContent() {
+    KUF_PROFILE_ZONE("TextSearchView::drawContent");
+    if (!indexRequested_) {
+        indexRequested_ = true;
+        refresh();
+    }
+
+    // A finished refresh may have changed any file, so search again.
+    if (task_.state() == AsyncTaskState::Completed || task_.state() == AsyncTaskState::Failed) {
+        task_.reset();
+        searchStale_ = true;
+        if (refreshPending_) {
+            refreshPending_ = false;
+            startRefresh();
+        }
+    }
+
+    if (gameDirectory_.empty()) {
+        ImGui::TextDisabled("Select a game directory to search its text files.");
+        return;
+    }
+
+    ImGui::Text("%zu text files, %zu entries", index_->fileCount(), index_->entryCount());
+    ImGui::SameLine();
+    if (busy()) {
+        ImGui::ProgressBar(task_.progress(), ImVec2(160.0f, 0.0f), "Indexing...");
+    } else if (ImGui::SmallButton("Refresh")) {
+        refresh();
+    }
+
+    ImGui::SetNextItemWidth(-200.0f);
+    ImGui::InputTextWithHint("##query", "Search text", query_, sizeof(query_));
+    ImGui::SameLine();
+    ImGui::Checkbox("Regex", &regex_);
+    ImGui::SameLine();
+    ImGui::Checkbox("Match case", &matchCase_);
+
+    ImGui::SetNextItemWidth(-200.0f);
+    ImGui::InputTextWithHint("##replacement", regex_ ? "Replace with ($1 for groups)" : "Replace with",
+                             replacement_, sizeof(replacement_));
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!compiled_ || result_.hits.empty() || !onReplace_ || busy());
+    if (ImGui::Button("Replace All...")) {
+        replaceFiles_ = index_->filesMatching(*compiled_);
+        showReplaceConfirm_ = !replaceFiles_.empty();
+    }
+    ImGui::EndDisabled();
+
+    if (searchStale_ || searchedQuery_ != query_ || searchedOptions_.regex != regex_ ||
+        searchedOptions_.matchCase != matchCase_) {
+        runSearch();
+    }
+
+    if (!error_.empty()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", error_.c_str());
+    } else if (compiled_) {
+        ImGui::TextDisabled("%zu%s matching entries (%zu checked, %.2f ms)", result_.hits.size(),
+                            result_.truncated ? "+" : "", result_.candidates, searchMs_);
+    }
+    if (!replaceStatus_.empty()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("| %s", replaceStatus_.c_str());
+    }
+
+    ImGui::Separator();
+    drawResults();
+    drawReplaceConfirm();
+}
+
+void TextSearchView::runSearch() {
+    KUF_PROFILE_ZONE("TextSearchView::runSearch");
+    searchedQuery_ = query_;
+    searchedOptions_ = {regex_, matchCase_};
+    searchStale_ = false;
+    compiled_.reset();
+    error_.clear();
+    result_ = {};
+    selectedHit_ = -1;
+    if (searchedQuery_.empty()) return;
+
+    auto query = TextQuery::compile(searchedQuery_, searchedOptions_);
+    if (auto* error = std::get_if<std::string>(&query)) {
+        error_ = std::move(*error);
+        return;
+    }
+    compiled_.emplace(std::move(std::get<TextQuery>(query)));
+
+    auto start = std::chrono::steady_clock::now();
+    result_ = index_->search(*compiled_);
+    searchMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void TextSearchView::drawResults() {
+    if (!ImGui::BeginTable("TextSearchResults", 3,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+        return;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("File", ImGuiTableColumnFlags_WidthFixed, 200.0f);
+    ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+    ImGui::TableSetupColumn("Text", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableHeadersRow();
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(result_.hits.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const auto& hit = result_.hits[row];
+            ImGui::TableNextRow();
+            ImGui::PushID(row);
+
+            ImGui::TableNextColumn();
+            bool selected = selectedHit_ == row;
+            if (ImGui::Selectable(hit.path.c_str(), selected,
+                    ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick)) {
+                selectedHit_ = row;
+                if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && onOpenEntry_) {
+                    onOpenEntry_((std::filesystem::path(gameDirectory_) / hit.path).string(), hit.entry);
+                }
+            }
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", hit.entry);
+
+            // The match is drawn highlighted between the text around it.
+            ImGui::TableNextColumn();
+            const char* text = hit.text.c_str();
+            ImGui::TextUnformatted(text, text + hit.offset);
+            ImGui::SameLine(0.0f, 0.0f);
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "%.*s", static_cast<int>(hit.length),
+                               text + hit.offset);
+            ImGui::SameLine(0.0f, 0.0f);
+            ImGui::TextUnformatted(text + hit.offset + hit.length, text + hit.text.size());
+
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndTable();
+}
+
+void TextSearchView::drawReplaceConfirm() {
+    if (showReplaceConfirm_) {
+        ImGui::OpenPopup("Replace in Files");
+        showReplaceConfirm_ = false;
+    }
+    if (!ImGui::BeginPopupModal("Replace in Files", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) return;
+
+    ImGui::Text("Replace \"%s\" with \"%s\" in %zu file(s)?", searchedQuery_.c_str(), replacement_,
+                replaceFiles_.size());
+    ImGui::TextDisabled("Each file is changed as one undo step in its tab and saved,");
+    ImGui::TextDisabled("unless it already has unsaved edits.");
+    ImGui::BeginChild("ReplaceFiles", ImVec2(420.0f, 120.0f), true);
+    for (const auto& path : replaceFiles_) ImGui::TextUnformatted(path.c_str());
+    ImGui::EndChild();
+
+    if (ImGui::Button("Replace", ImVec2(120, 0))) {
+        applyReplace();
+        ImGui::CloseCurrentPopup();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Cancel", ImVec2(120, 0))) {
+        ImGui::CloseCurrentPopup();
+    }
+    ImGui::EndPopup();
+}
+
+void TextSearchView::applyReplace() {
+    KUF_PROFILE_ZONE("TextSearchView::applyReplace");
+    size_t entries = 0;
+    size_t files = 0;
+    size_t failed = 0;
+    size_t skipped = 0;
+    size_t blocked = 0;
+    size_t unsaved = 0;
+    for (const auto& path : replaceFiles_) {
+        auto result = onReplace_((std::filesystem::path(gameDirectory_) / path).string(), *compiled_, replacement_);
+        if (!result) {
+            ++failed;
+            continue;
+        }
+        skipped += result->skipped;
+        if (result->blocked) {
+            ++blocked;
+        } else if (result->changed > 0) {
+            entries += result->changed;
+            ++files;
+            if (result->unsaved) ++unsaved;
+        }
+    }
+    replaceFiles_.clear();
+
+    char status[128];
+    std::snprintf(status, sizeof(status), "Replaced %zu entries in %zu file(s)", entries, files);
+    replaceStatus_ = status;
+    if (skipped > 0) replaceStatus_ += ", " + std::to_string(skipped) + " skipped as empty or too long";
+    if (blocked > 0) replaceStatus_ += ", " + std::to_string(blocked) + " not saved due to validation errors";
+    if (unsaved > 0) replaceStatus_ += ", " + std::to_string(unsaved) + " left unsaved with earlier edits";
+    if (failed > 0) replaceStatus_ += ", " + std::to_string(failed) + " could not be opened";
+
+    // The saved files have new sizes or timestamps, so only they are re-read.
+    refresh();
+}
+
+} // namespace kuf
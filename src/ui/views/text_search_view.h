@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ui/views/view.h"
+#include "core/async_task.h"
+#include "formats/text_search_index.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kuf {
+
+// Project-wide search and replace over every text SOX in the game directory.
+// The trigram index is built on a task thread and refreshed incrementally;
+// queries run on the UI thread against it as the user types.
+class TextSearchView : public View {
+public:
+    // Applies a replacement to one file through the editor's save path.
+    // Returns nullopt if the file could not be opened.
+    using ReplaceFn = std::function<std::optional<TextReplaceResult>(
+        const std::string& path, const TextQuery& query, std::string_view replacement)>;
+
+    TextSearchView();
+
+    void drawContent() override;
+
+    // The index is rebuilt for the new directory the next time the view draws.
+    void setGameDirectory(const std::string& dir);
+
+    // Re-reads files changed on disk since the last refresh. Cheap when
+    // nothing changed; a no-op until the view has been opened once.
+    void refresh();
+
+    void setOnOpenEntry(std::function<void(const std::string& path, size_t entry)> cb) {
+        onOpenEntry_ = std::move(cb);
+    }
+    void setOnReplace(ReplaceFn cb) { onReplace_ = std::move(cb); }
+
+    // True while the index is being built or refreshed.
+    bool busy() const { return task_.state() == AsyncTaskState::Running; }
+
+private:
+    void startRefresh();
+    void runSearch();
+    void drawResults();
+    void drawReplaceConfirm();
+    void applyReplace();
+
+    std::string gameDirectory_;
+    std::shared_ptr<TextSearchIndex> index_;
+    AsyncTask task_;
+    bool indexRequested_ = false;
+    bool refreshPending_ = false;
+
+    char query_[256] = {};
+    char replacement_[256] = {};
+    bool regex_ = false;
+    bool matchCase_ = false;
+
+    // Last search, redone when the query, options or index change.
+    std::string searchedQuery_;
+    TextSearchOptions searchedOptions_;
+    bool searchStale_ = true;
+    std::optional<TextQuery> compiled_;
+    std::string error_;
+    TextSearchResult result_;
+    double searchMs_ = 0.0;
+    int selectedHit_ = -1;
+
+    std::vector<std::string> replaceFiles_;
+    bool showReplaceConfirm_ = false;
+    std::string replaceStatus_;
+
+    std::function<void(const std::string&, size_t)> onOpenEntry_;
+    ReplaceFn onReplace_;
+};
+
+} // namespace kuf
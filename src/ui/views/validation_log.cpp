@@ -1,4 +1,5 @@
 #include "ui/views/validation_log.h"
+#include "core/profiler.h"
 
 #include <imgui.h>
 
@@ -17,6 +18,7 @@ void ValidationLogView::clear() {
 }
 
 void ValidationLogView::drawContent() {
+    KUF_PROFILE_ZONE("ValidationLogView::drawContent");
     if (issues_.empty()) {
         ImGui::TextDisabled("No validation issues");
         return;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "formats/bulk_edit.h"
+#include "undo/bulk_field_command.h"
+#include "undo/undo_stack.h"
+
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace kuf {
+
+// Applies a bulk edit plan as one undo step. Returns false, recording
+// nothing, when the plan changes no field.
+inline bool executeBulkEdit(UndoStack& undo, const BulkEditPlan& plan, const std::string& description) {
+    if (plan.empty()) return false;
+
+    auto record = [&](const auto& changes) {
+        if (changes.empty()) return;
+        using T = std::remove_pointer_t<typename std::decay_t<decltype(changes)>::value_type::first_type>;
+        auto cmd = std::make_unique<BulkFieldCommand<T>>(description);
+        cmd->reserve(changes.size());
+        for (const auto& [field, value] : changes) cmd->add(field, value);
+        undo.execute(std::move(cmd));
+    };
+
+    UndoTransaction tx(undo, description);
+    record(plan.floats);
+    record(plan.ints);
+    record(plan.uints);
+    record(plan.bytes);
+    tx.commit();
+    return true;
+}
+
+} // namespace kuf
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "undo/command.h"
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace kuf {
+
+// Sets many fields of one type as a single command. Changes live in one
+// contiguous array rather than one heap-allocated command per field, so
+// applying or reverting n changes is one linear pass.
+template<typename T>
+class BulkFieldCommand : public ICommand {
+public:
+    explicit BulkFieldCommand(std::string desc) : description_(std::move(desc)) {}
+
+    void reserve(size_t count) { changes_.reserve(count); }
+
+    // Records a change to field; its current value is kept for undo. Nothing is
+    // written until the command executes.
+    void add(T* field, T newValue) {
+        changes_.push_back({field, *field, std::move(newValue)});
+    }
+
+    size_t size() const { return changes_.size(); }
+    bool empty() const { return changes_.empty(); }
+
+    void execute() override {
+        for (auto& change : changes_) {
+            *change.field = change.newValue;
+        }
+    }
+
+    // Reverse order, so a field recorded twice ends at its first old value.
+    void undo() override {
+        for (auto it = changes_.rbegin(); it != changes_.rend(); ++it) {
+            *it->field = it->oldValue;
+        }
+    }
+
+    std::string description() const override {
+        return description_;
+    }
+
+    size_t sizeEstimate() const override {
+        size_t bytes = sizeof(*this) + changes_.capacity() * sizeof(Change) + heapBytes(description_);
+        if constexpr (!std::is_trivially_copyable_v<T>) {
+            for (const auto& change : changes_) {
+                bytes += heapBytes(change.oldValue) + heapBytes(change.newValue);
+            }
+        }
+        return bytes;
+    }
+
+private:
+    struct Change {
+        T* field;
+        T oldValue;
+        T newValue;
+    };
+
+    std::vector<Change> changes_;
+    std::string description_;
+};
+
+} // namespace kuf
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace kuf {
 
@@ -12,8 +15,35 @@ public:
     virtual void execute() = 0;
     virtual void undo() = 0;
     virtual std::string description() const = 0;
+
+    // Folds other, which has just been executed, into this command so one
+    // continuous edit undoes as a single step. Returns false if the commands
+    // are unrelated, leaving both unchanged.
+    virtual bool mergeWith(const ICommand& /*other*/) { return false; }
+
+    // Approximate bytes held by the command, for the undo history budget.
+    virtual size_t sizeEstimate() const { return sizeof(ICommand); }
 };
 
 using CommandPtr = std::unique_ptr<ICommand>;
 
+// Heap bytes owned by a value, for sizeEstimate implementations.
+template<typename T>
+size_t heapBytes(const T&) { return 0; }
+
+inline size_t heapBytes(const std::string& s) {
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
+// Elements count through their own overloads, so records holding strings or
+// nested lists (see undo/format_heap_bytes.h) are included.
+template<typename T>
+size_t heapBytes(const std::vector<T>& v) {
+    size_t bytes = v.capacity() * sizeof(T);
+    if constexpr (!std::is_trivially_copyable_v<T>) {
+        for (const auto& item : v) bytes += heapBytes(item);
+    }
+    return bytes;
+}
+
 } // namespace kuf
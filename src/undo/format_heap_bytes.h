@@ -0,0 +1,52 @@
+#pragma once
+
+#include "formats/sox_skill_info.h"
+#include "formats/stg_format.h"
+#include "undo/command.h"
+
+namespace kuf {
+
+// heapBytes for game records that own strings or lists, so commands holding
+// copies of them are charged for those against the undo budget.
+
+inline size_t heapBytes(const StgParamValue& param) {
+    return heapBytes(param.stringValue);
+}
+
+inline size_t heapBytes(const StgScriptEntry& entry) {
+    return heapBytes(entry.params);
+}
+
+inline size_t heapBytes(const StgEvent& event) {
+    return heapBytes(event.description) + heapBytes(event.conditions) + heapBytes(event.actions) +
+           heapBytes(event.rawData);
+}
+
+inline size_t heapBytes(const StgEventBlock& block) {
+    return heapBytes(block.events);
+}
+
+inline size_t heapBytes(const StgVariable& variable) {
+    return heapBytes(variable.name) + heapBytes(variable.initialValue);
+}
+
+inline size_t heapBytes(const StgArea& area) {
+    return heapBytes(area.description);
+}
+
+inline size_t heapBytes(const StgUnit& unit) {
+    return heapBytes(unit.unitName);
+}
+
+inline size_t heapBytes(const StgHeader& header) {
+    return heapBytes(header.mapFile) + heapBytes(header.bitmapFile) + heapBytes(header.defaultCameraFile) +
+           heapBytes(header.userCameraFile) + heapBytes(header.settingsFile) +
+           heapBytes(header.skyCloudEffects) + heapBytes(header.aiScriptFile) +
+           heapBytes(header.cubemapTexture);
+}
+
+inline size_t heapBytes(const SkillInfo& skill) {
+    return heapBytes(skill.locKey) + heapBytes(skill.iconPath);
+}
+
+} // namespace kuf
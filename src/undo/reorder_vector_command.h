@@ -30,6 +30,10 @@ public:
         return description_;
     }
 
+    size_t sizeEstimate() const override {
+        return sizeof(*this) + heapBytes(description_);
+    }
+
 private:
     void moveElement(int from, int to) {
         auto item = std::move((*vec_)[from]);
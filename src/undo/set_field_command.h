@@ -7,7 +7,8 @@
 
 namespace kuf {
 
-// Generic command for setting any field value.
+// Generic command for setting any field value. Consecutive commands on the
+// same field merge, keeping the first old value and the last new one.
 template<typename T>
 class SetFieldCommand : public ICommand {
 public:
@@ -29,6 +30,17 @@ public:
         return description_;
     }
 
+    bool mergeWith(const ICommand& other) override {
+        auto* next = dynamic_cast<const SetFieldCommand*>(&other);
+        if (!next || next->field_ != field_) return false;
+        newValue_ = next->newValue_;
+        return true;
+    }
+
+    size_t sizeEstimate() const override {
+        return sizeof(*this) + heapBytes(oldValue_) + heapBytes(newValue_) + heapBytes(description_);
+    }
+
 private:
     T* field_;
     T oldValue_;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "formats/sox_text.h"
+#include "undo/command.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace kuf {
+
+// Replaces the text of one or more SoxText entries as a single command.
+// Entries live in the text's string pool rather than as fields, so changes
+// go through SoxText::setText instead of a field pointer.
+class SetTextCommand : public ICommand {
+public:
+    SetTextCommand(SoxText* text, std::string desc) : text_(text), description_(std::move(desc)) {}
+
+    // Records a new text for entry; its current text is kept for undo.
+    // Nothing is written until the command executes.
+    void add(size_t entry, std::string newText) {
+        changes_.push_back({entry, std::string(text_->text(entry)), std::move(newText)});
+    }
+
+    size_t size() const { return changes_.size(); }
+    bool empty() const { return changes_.empty(); }
+
+    void execute() override {
+        for (const auto& change : changes_) {
+            text_->setText(change.entry, change.newText);
+        }
+    }
+
+    // Reverse order, so an entry recorded twice ends at its first old text.
+    void undo() override {
+        for (auto it = changes_.rbegin(); it != changes_.rend(); ++it) {
+            text_->setText(it->entry, it->oldText);
+        }
+    }
+
+    std::string description() const override {
+        return description_;
+    }
+
+    // Consecutive edits of the same single entry undo as one step.
+    bool mergeWith(const ICommand& other) override {
+        auto* next = dynamic_cast<const SetTextCommand*>(&other);
+        if (!next || next->text_ != text_ || changes_.size() != 1 || next->changes_.size() != 1 ||
+            next->changes_[0].entry != changes_[0].entry) {
+            return false;
+        }
+        changes_[0].newText = next->changes_[0].newText;
+        return true;
+    }
+
+    size_t sizeEstimate() const override {
+        size_t bytes = sizeof(*this) + changes_.capacity() * sizeof(Change) + heapBytes(description_);
+        for (const auto& change : changes_) {
+            bytes += heapBytes(change.oldText) + heapBytes(change.newText);
+        }
+        return bytes;
+    }
+
+private:
+    struct Change {
+        size_t entry;
+        std::string oldText;
+        std::string newText;
+    };
+
+    SoxText* text_;
+    std::vector<Change> changes_;
+    std::string description_;
+};
+
+} // namespace kuf
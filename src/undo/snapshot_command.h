@@ -0,0 +1,52 @@
+#pragma once
+
+#include "undo/command.h"
+
+#include <string>
+#include <utility>
+
+namespace kuf {
+
+// Replaces a whole parsed file with another version of it, e.g. one reloaded
+// from disk. A format keeps most of its memory in private containers, so the
+// two versions' serialized sizes stand in for it, measured once up front.
+template<typename T>
+class SnapshotCommand : public ICommand {
+public:
+    SnapshotCommand(T* target, T newValue, std::string desc)
+        : target_(target)
+        , oldValue_(*target)
+        , newValue_(std::move(newValue))
+        , description_(std::move(desc))
+        , snapshotBytes_(oldValue_.save().size() + newValue_.save().size()) {}
+
+    void execute() override {
+        *target_ = newValue_;
+    }
+
+    void undo() override {
+        *target_ = oldValue_;
+    }
+
+    std::string description() const override {
+        return description_;
+    }
+
+    size_t sizeEstimate() const override {
+        return sizeof(*this) + snapshotBytes_ + heapBytes(description_);
+    }
+
+private:
+    T* target_;
+    T oldValue_;
+    T newValue_;
+    std::string description_;
+    size_t snapshotBytes_;
+};
+
+template<typename T>
+CommandPtr makeSnapshotCommand(T* target, T newValue, std::string desc) {
+    return std::make_unique<SnapshotCommand<T>>(target, std::move(newValue), std::move(desc));
+}
+
+} // namespace kuf
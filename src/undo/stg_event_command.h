@@ -0,0 +1,82 @@
+#pragma once
+
+#include "formats/stg_format.h"
+#include "undo/command.h"
+#include "undo/format_heap_bytes.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace kuf {
+
+// Inserts, removes or replaces one mission event. The event is addressed by
+// block and position, resolved when the command runs, so no command in the
+// history holds a pointer into the event vectors this one reallocates.
+//
+// Without oldEvent the command inserts newEvent at index, adding the block
+// when block is one past the last; without newEvent it removes the event at
+// index; with both it replaces it, e.g. after adding or reordering entries.
+class StgEventCommand : public ICommand {
+public:
+    StgEventCommand(StgFormat* stg, size_t block, size_t index, std::optional<StgEvent> oldEvent,
+                    std::optional<StgEvent> newEvent, std::string desc)
+        : stg_(stg)
+        , block_(block)
+        , index_(index)
+        , oldEvent_(std::move(oldEvent))
+        , newEvent_(std::move(newEvent))
+        , description_(std::move(desc)) {}
+
+    void execute() override {
+        put(oldEvent_, newEvent_);
+    }
+
+    void undo() override {
+        put(newEvent_, oldEvent_);
+    }
+
+    std::string description() const override {
+        return description_;
+    }
+
+    size_t sizeEstimate() const override {
+        size_t bytes = sizeof(*this) + heapBytes(description_);
+        if (oldEvent_) bytes += heapBytes(*oldEvent_);
+        if (newEvent_) bytes += heapBytes(*newEvent_);
+        return bytes;
+    }
+
+private:
+    // Turns the slot holding from (or nothing) into one holding to (or nothing).
+    void put(const std::optional<StgEvent>& from, const std::optional<StgEvent>& to) {
+        auto& blocks = stg_->eventBlocks();
+        if (!from) {
+            if (block_ == blocks.size()) {
+                blocks.push_back({});
+                addedBlock_ = true;
+            }
+            auto& events = blocks[block_].events;
+            events.insert(events.begin() + index_, *to);
+        } else if (!to) {
+            auto& events = blocks[block_].events;
+            events.erase(events.begin() + index_);
+            if (addedBlock_ && events.empty()) {
+                blocks.pop_back();
+                addedBlock_ = false;
+            }
+        } else {
+            blocks[block_].events[index_] = *to;
+        }
+    }
+
+    StgFormat* stg_;
+    size_t block_;
+    size_t index_;
+    std::optional<StgEvent> oldEvent_;
+    std::optional<StgEvent> newEvent_;
+    std::string description_;
+    bool addedBlock_ = false;
+};
+
+} // namespace kuf
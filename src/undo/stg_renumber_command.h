@@ -0,0 +1,61 @@
+#pragma once
+
+#include "formats/stg_reference_index.h"
+#include "undo/command.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace kuf {
+
+// Applies a renumber plan as one command. The plan addresses fields by index,
+// resolved each time the command runs, so the history stays valid while event
+// vectors reallocate; structural edits go through the undo stack as well (see
+// StgEventCommand), so the indices match whenever this command is undone.
+class StgRenumberCommand : public ICommand {
+public:
+    StgRenumberCommand(StgFormat* stg, StgRenumberPlan plan, std::string desc)
+        : stg_(stg)
+        , plan_(std::move(plan))
+        , description_(std::move(desc)) {
+        wasModified_.reserve(plan_.modifiedEvents.size());
+        for (const auto& slot : plan_.modifiedEvents) {
+            wasModified_.push_back(eventAt(slot).modified);
+        }
+    }
+
+    void execute() override {
+        applyRenumberPlan(*stg_, plan_, plan_.to);
+        for (const auto& slot : plan_.modifiedEvents) eventAt(slot).modified = true;
+    }
+
+    void undo() override {
+        applyRenumberPlan(*stg_, plan_, plan_.from);
+        for (size_t i = 0; i < plan_.modifiedEvents.size(); ++i) {
+            eventAt(plan_.modifiedEvents[i]).modified = wasModified_[i];
+        }
+    }
+
+    std::string description() const override {
+        return description_;
+    }
+
+    size_t sizeEstimate() const override {
+        return sizeof(*this) + heapBytes(plan_.definitions) + heapBytes(plan_.eventDefinitions) +
+               heapBytes(plan_.params) + heapBytes(plan_.modifiedEvents) +
+               wasModified_.capacity() / 8 + heapBytes(description_);
+    }
+
+private:
+    StgEvent& eventAt(const StgEventSlot& slot) {
+        return stg_->eventBlocks()[slot.block].events[slot.event];
+    }
+
+    StgFormat* stg_;
+    StgRenumberPlan plan_;
+    std::vector<bool> wasModified_;
+    std::string description_;
+};
+
+} // namespace kuf
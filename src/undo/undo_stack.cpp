@@ -1,34 +1,134 @@
 #include "undo/undo_stack.h"
 
+#include <utility>
+
 namespace kuf {
 
+namespace {
+
+// The commands of one committed transaction.
+class TransactionCommand : public ICommand {
+public:
+    TransactionCommand(std::vector<CommandPtr> commands, std::string desc)
+        : commands_(std::move(commands)), description_(std::move(desc)) {}
+
+    void execute() override {
+        for (auto& cmd : commands_) cmd->execute();
+    }
+
+    void undo() override {
+        for (auto it = commands_.rbegin(); it != commands_.rend(); ++it) (*it)->undo();
+    }
+
+    std::string description() const override {
+        return description_;
+    }
+
+    size_t sizeEstimate() const override {
+        size_t bytes = sizeof(*this) + commands_.capacity() * sizeof(CommandPtr) + heapBytes(description_);
+        for (const auto& cmd : commands_) bytes += cmd->sizeEstimate();
+        return bytes;
+    }
+
+private:
+    std::vector<CommandPtr> commands_;
+    std::string description_;
+};
+
+} // namespace
+
 void UndoStack::execute(CommandPtr cmd) {
     cmd->execute();
+
+    if (inTransaction()) {
+        // Repeated edits of one field inside a transaction still collapse.
+        if (transactionCommands_.empty() || !transactionCommands_.back()->mergeWith(*cmd)) {
+            transactionCommands_.push_back(std::move(cmd));
+        }
+        return;
+    }
+
+    clearRedo();
+    if (mergeOpen_ && !undoStack_.empty()) {
+        auto& last = undoStack_.back();
+        size_t before = last->sizeEstimate();
+        if (last->mergeWith(*cmd)) {
+            memoryUsage_ = memoryUsage_ - before + last->sizeEstimate();
+            notifyChange();
+            return;
+        }
+    }
+
+    memoryUsage_ += cmd->sizeEstimate();
     undoStack_.push_back(std::move(cmd));
-    redoStack_.clear();
+    mergeOpen_ = mergeActive_;
+    enforceBudget();
     notifyChange();
 }
 
 void UndoStack::undo() {
-    if (undoStack_.empty()) return;
+    if (undoStack_.empty() || inTransaction()) return;
 
     auto cmd = std::move(undoStack_.back());
     undoStack_.pop_back();
     cmd->undo();
     redoStack_.push_back(std::move(cmd));
+    mergeOpen_ = false;
     notifyChange();
 }
 
 void UndoStack::redo() {
-    if (redoStack_.empty()) return;
+    if (redoStack_.empty() || inTransaction()) return;
 
     auto cmd = std::move(redoStack_.back());
     redoStack_.pop_back();
     cmd->execute();
     undoStack_.push_back(std::move(cmd));
+    mergeOpen_ = false;
+    notifyChange();
+}
+
+void UndoStack::beginMerge() {
+    if (mergeActive_) return;
+    mergeActive_ = true;
+    mergeOpen_ = false;
+}
+
+void UndoStack::sealMerge() {
+    mergeActive_ = false;
+    mergeOpen_ = false;
+}
+
+void UndoStack::beginTransaction(std::string description) {
+    if (transactionDepth_++ > 0) return;
+    transactionDescription_ = std::move(description);
+    transactionCommands_.clear();
+}
+
+void UndoStack::commitTransaction() {
+    if (transactionDepth_ == 0 || --transactionDepth_ > 0) return;
+    if (transactionCommands_.empty()) return;
+
+    CommandPtr group = std::make_unique<TransactionCommand>(std::move(transactionCommands_),
+                                                            std::move(transactionDescription_));
+    transactionCommands_.clear();
+    clearRedo();
+    memoryUsage_ += group->sizeEstimate();
+    undoStack_.push_back(std::move(group));
+    mergeOpen_ = false;
+    enforceBudget();
     notifyChange();
 }
 
+void UndoStack::rollbackTransaction() {
+    if (transactionDepth_ == 0) return;
+    for (auto it = transactionCommands_.rbegin(); it != transactionCommands_.rend(); ++it) {
+        (*it)->undo();
+    }
+    transactionCommands_.clear();
+    transactionDepth_ = 0;
+}
+
 std::string UndoStack::undoDescription() const {
     if (undoStack_.empty()) return {};
     return undoStack_.back()->description();
@@ -39,16 +139,37 @@ std::string UndoStack::redoDescription() const {
     return redoStack_.back()->description();
 }
 
+void UndoStack::setMemoryBudget(size_t bytes) {
+    memoryBudget_ = bytes;
+    enforceBudget();
+}
+
 void UndoStack::clear() {
     undoStack_.clear();
     redoStack_.clear();
+    memoryUsage_ = 0;
+    mergeActive_ = false;
+    mergeOpen_ = false;
     notifyChange();
 }
 
 void UndoStack::notifyChange() {
+    ++revision_;
     if (onChange_) {
         onChange_();
     }
 }
 
+void UndoStack::clearRedo() {
+    for (const auto& cmd : redoStack_) memoryUsage_ -= cmd->sizeEstimate();
+    redoStack_.clear();
+}
+
+void UndoStack::enforceBudget() {
+    while (memoryUsage_ > memoryBudget_ && undoStack_.size() > 1) {
+        memoryUsage_ -= undoStack_.front()->sizeEstimate();
+        undoStack_.pop_front();
+    }
+}
+
 } // namespace kuf
@@ -2,33 +2,109 @@
 
 #include "undo/command.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <string>
 #include <vector>
 
 namespace kuf {
 
 class UndoStack {
 public:
+    static constexpr size_t kDefaultMemoryBudget = 64 * 1024 * 1024;
+
+    // Executes cmd and records it. Inside an interaction (see beginMerge) the
+    // command is folded into the previous one when that accepts it.
     void execute(CommandPtr cmd);
+    // Ignored while a transaction is open.
     void undo();
     void redo();
 
+    // Groups every command executed until commitTransaction into one undo
+    // step with one change notification. Transactions nest; only the
+    // outermost commit records the step. An empty transaction records
+    // nothing.
+    void beginTransaction(std::string description);
+    void commitTransaction();
+    // Undoes the commands executed since the outermost beginTransaction and
+    // discards them, closing every nested level. The redo history survives.
+    void rollbackTransaction();
+    bool inTransaction() const { return transactionDepth_ > 0; }
+
+    // Starts an interaction such as a widget drag: the next command starts a
+    // new undo step and the commands after it fold into that step until
+    // sealMerge. Repeated calls within one interaction are ignored. Outside an
+    // interaction every command is its own undo step.
+    void beginMerge();
+    // Ends the current interaction. Call when a widget is released.
+    void sealMerge();
+
     bool canUndo() const { return !undoStack_.empty(); }
     bool canRedo() const { return !redoStack_.empty(); }
+    size_t undoCount() const { return undoStack_.size(); }
+    size_t redoCount() const { return redoStack_.size(); }
 
     std::string undoDescription() const;
     std::string redoDescription() const;
 
+    // Upper bound on the estimated size of the history. The oldest undo
+    // steps are dropped once it is exceeded; the newest is always kept.
+    void setMemoryBudget(size_t bytes);
+    size_t memoryBudget() const { return memoryBudget_; }
+    size_t memoryUsage() const { return memoryUsage_; }
+
     void clear();
 
     void setOnChange(std::function<void()> callback) { onChange_ = std::move(callback); }
 
+    // Increments whenever the document changes through this stack, including
+    // undo and redo. Views holding derived data compare it to spot changes.
+    uint64_t revision() const { return revision_; }
+
 private:
     void notifyChange();
+    void clearRedo();
+    void enforceBudget();
 
-    std::vector<CommandPtr> undoStack_;
+    std::deque<CommandPtr> undoStack_;
     std::vector<CommandPtr> redoStack_;
     std::function<void()> onChange_;
+    size_t memoryBudget_ = kDefaultMemoryBudget;
+    size_t memoryUsage_ = 0;
+    bool mergeActive_ = false;
+    bool mergeOpen_ = false;
+    uint64_t revision_ = 0;
+
+    int transactionDepth_ = 0;
+    std::string transactionDescription_;
+    std::vector<CommandPtr> transactionCommands_;
+};
+
+// Opens a transaction for its lifetime. Rolls back unless commit() is called,
+// so an early return or exception leaves the document unchanged.
+class UndoTransaction {
+public:
+    UndoTransaction(UndoStack& stack, std::string description) : stack_(stack) {
+        stack_.beginTransaction(std::move(description));
+    }
+    ~UndoTransaction() {
+        if (!done_) stack_.rollbackTransaction();
+    }
+
+    UndoTransaction(const UndoTransaction&) = delete;
+    UndoTransaction& operator=(const UndoTransaction&) = delete;
+
+    void commit() {
+        if (done_) return;
+        done_ = true;
+        stack_.commitTransaction();
+    }
+
+private:
+    UndoStack& stack_;
+    bool done_ = false;
 };
 
 } // namespace kuf
@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "mods/backup_manager.h"
+#include "test_fixtures.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace kuf::test;
+
+namespace {
+
+// A backup of a small game directory and a game directory that matches it.
+struct BackupFixture {
+    TempDir dir{"kuf_backup_manager_test"};
+    fs::path game = dir.path / "game";
+    kuf::BackupInfo backup;
+
+    BackupFixture() {
+        backup.path = (dir.path / "backup").string();
+        for (const auto& root : {fs::path(backup.path), game}) {
+            writeFile(root / "SOX" / "TroopInfo.sox", createTroopSox(3));
+            writeFile(root / "Missions" / "E1001.stg", createTwoUnitStg());
+            writeFile(root / "readme.txt", std::string("Kingdom Under Fire"));
+        }
+        writeFile(fs::path(backup.path) / "backup.json", std::string("{}"));
+    }
+};
+
+std::vector<std::string> sorted(std::vector<std::string> paths) {
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+} // namespace
+
+TEST_CASE("planRestore lists only files that differ from the backup", "[backup_manager]") {
+    BackupFixture fx;
+    kuf::AsyncTask task;
+
+    // Same contents with a newer timestamp is still unchanged.
+    auto troops = fx.game / "SOX" / "TroopInfo.sox";
+    fs::last_write_time(troops, fs::last_write_time(troops) + std::chrono::hours(1));
+    writeFile(fx.game / "Missions" / "E1001.stg", createStg({100, 101, 102}));
+    fs::remove(fx.game / "readme.txt");
+    writeFile(fx.game / "extra.txt", std::string("not in the backup"));
+
+    auto plan = kuf::BackupManager::planRestore(fx.backup, fx.game.string(), task);
+    REQUIRE(plan.has_value());
+    REQUIRE(sorted(plan->changedFiles) == std::vector<std::string>{"Missions/E1001.stg", "readme.txt"});
+    REQUIRE(plan->unchangedCount == 1);
+    REQUIRE(plan->bytesToCopy == createTwoUnitStg().size() + std::string("Kingdom Under Fire").size());
+}
+
+TEST_CASE("Delta restore rewrites only the changed files", "[backup_manager]") {
+    BackupFixture fx;
+    kuf::AsyncTask task;
+
+    auto troops = fx.game / "SOX" / "TroopInfo.sox";
+    auto troopsTime = fs::last_write_time(troops);
+    writeFile(fx.game / "Missions" / "E1001.stg", createStg({100, 101, 102}));
+    fs::remove(fx.game / "readme.txt");
+
+    REQUIRE(kuf::BackupManager::restoreBackup(fx.backup, fx.game.string(), task, kuf::RestoreMode::Delta));
+    REQUIRE(readFile(fx.game / "Missions" / "E1001.stg") ==
+            readFile(fs::path(fx.backup.path) / "Missions" / "E1001.stg"));
+    REQUIRE(readFile(fx.game / "readme.txt") == "Kingdom Under Fire");
+    REQUIRE(fs::last_write_time(troops) == troopsTime);
+    REQUIRE_FALSE(fs::exists(fx.game / "backup.json"));
+
+    // Restored files carry the backup's timestamps, so the next plan is empty.
+    auto plan = kuf::BackupManager::planRestore(fx.backup, fx.game.string(), task);
+    REQUIRE(plan->changedFiles.empty());
+    REQUIRE(plan->unchangedCount == 3);
+    REQUIRE(kuf::BackupManager::restoreBackup(fx.backup, fx.game.string(), task, kuf::RestoreMode::Delta));
+}
+
+TEST_CASE("Full restore copies every backed up file", "[backup_manager]") {
+    BackupFixture fx;
+    kuf::AsyncTask task;
+    writeFile(fx.game / "SOX" / "TroopInfo.sox", createTroopSox(1));
+
+    REQUIRE(kuf::BackupManager::restoreBackup(fx.backup, fx.game.string(), task, kuf::RestoreMode::Full));
+    REQUIRE(readFile(fx.game / "SOX" / "TroopInfo.sox") ==
+            readFile(fs::path(fx.backup.path) / "SOX" / "TroopInfo.sox"));
+
+    kuf::BackupInfo empty;
+    empty.path = (fx.dir.path / "empty").string();
+    fs::create_directories(empty.path);
+    REQUIRE_FALSE(kuf::BackupManager::restoreBackup(empty, fx.game.string(), task, kuf::RestoreMode::Delta));
+    REQUIRE(task.error() == "Backup contains no game files");
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/bulk_edit.h"
+#include "undo/bulk_edit_command.h"
+#include "undo/undo_stack.h"
+
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace kuf;
+
+namespace {
+
+BulkEdit compile(std::string_view source, BulkEditTarget target) {
+    auto result = BulkEdit::compile(source, target);
+    if (auto* error = std::get_if<std::string>(&result)) {
+        FAIL("compile failed: " << *error);
+    }
+    return std::move(std::get<BulkEdit>(result));
+}
+
+std::string compileError(std::string_view source, BulkEditTarget target) {
+    auto result = BulkEdit::compile(source, target);
+    auto* error = std::get_if<std::string>(&result);
+    return error ? *error : std::string();
+}
+
+std::vector<TroopInfo> makeTroops(size_t count) {
+    std::vector<TroopInfo> troops(count);
+    for (size_t i = 0; i < count; ++i) {
+        troops[i] = TroopInfo{};
+        troops[i].job = static_cast<int32_t>(i % 4);
+        troops[i].defaultUnitHp = 100.0f + static_cast<float>(i);
+        troops[i].resistFire = 250.0f + static_cast<float>(i * 10);
+        troops[i].resistIce = 400.0f;
+        troops[i].defaultUnitNumX = 4;
+    }
+    return troops;
+}
+
+} // namespace
+
+TEST_CASE("BulkEdit applies arithmetic to the records a where clause selects", "[bulk_edit]") {
+    auto troops = makeTroops(1000);
+    auto edit = compile("defaultUnitHp *= 1 + 20%, defaultUnitNumX += 1 where job == 2", BulkEditTarget::Troops);
+
+    auto plan = edit.plan(troops);
+    REQUIRE(plan.records == 1000);
+    REQUIRE(plan.matched == 250);
+    REQUIRE(plan.floats.size() == 250);
+    REQUIRE(plan.ints.size() == 250);
+    // Planning alone writes nothing.
+    REQUIRE(troops[2].defaultUnitHp == 102.0f);
+
+    UndoStack undo;
+    REQUIRE(executeBulkEdit(undo, plan, "Bulk edit"));
+    REQUIRE(undo.undoCount() == 1);
+    REQUIRE(troops[2].defaultUnitHp == static_cast<float>(102.0 * 1.2));
+    REQUIRE(troops[2].defaultUnitNumX == 5);
+    REQUIRE(troops[3].defaultUnitHp == 103.0f);
+    REQUIRE(troops[3].defaultUnitNumX == 4);
+
+    undo.undo();
+    REQUIRE(troops[2].defaultUnitHp == 102.0f);
+    REQUIRE(troops[2].defaultUnitNumX == 4);
+}
+
+TEST_CASE("BulkEdit patterns assign every matching field", "[bulk_edit]") {
+    auto troops = makeTroops(3);
+    auto edit = compile("resist* = min(resist*, 300)", BulkEditTarget::Troops);
+
+    auto plan = edit.plan(troops);
+    // resistFire is 250, 260 and 270; resistIce is 400 in every record. The
+    // other resistances are 0 and stay put.
+    REQUIRE(plan.floats.size() == 3);
+    UndoStack undo;
+    executeBulkEdit(undo, plan, "Cap resistances");
+    REQUIRE(troops[0].resistFire == 250.0f);
+    REQUIRE(troops[2].resistIce == 300.0f);
+    REQUIRE(troops[1].resistMelee == 0.0f);
+}
+
+TEST_CASE("BulkEdit reads values from before the edit", "[bulk_edit]") {
+    std::vector<TroopInfo> troops(1);
+    troops[0] = TroopInfo{};
+    troops[0].attackRangeMin = 10.0f;
+    troops[0].attackRangeMax = 20.0f;
+
+    auto plan = compile("attackRangeMin = attackRangeMax, attackRangeMax = attackRangeMin", BulkEditTarget::Troops)
+                    .plan(troops);
+    UndoStack undo;
+    executeBulkEdit(undo, plan, "Swap");
+    REQUIRE(troops[0].attackRangeMin == 20.0f);
+    REQUIRE(troops[0].attackRangeMax == 10.0f);
+}
+
+TEST_CASE("BulkEdit filters STG units by UCD and clamps integer fields", "[bulk_edit]") {
+    std::vector<StgUnit> units(600);
+    for (size_t i = 0; i < units.size(); ++i) {
+        units[i].ucd = (i % 3 == 0) ? UCD::Enemy : UCD::Player;
+        units[i].unitHpOverride = (i % 2 == 0) ? 1000.0f : -1.0f;
+        units[i].leaderLevel = 10;
+    }
+
+    auto plan = compile("unitHpOverride *= 1.5, leaderLevel = leaderLevel * 100 "
+                        "where ucd == enemy and unitHpOverride > 0 and index < 300",
+                        BulkEditTarget::Units)
+                    .plan(units);
+    REQUIRE(plan.matched == 50);
+    REQUIRE(plan.floats.size() == 50);
+    REQUIRE(plan.bytes.size() == 50);
+    REQUIRE(plan.bytes.front().second == 255);
+
+    UndoStack undo;
+    executeBulkEdit(undo, plan, "Buff enemies");
+    REQUIRE(units[0].unitHpOverride == 1500.0f);
+    REQUIRE(units[3].unitHpOverride == -1.0f);
+    REQUIRE(units[300].unitHpOverride == 1000.0f);
+}
+
+TEST_CASE("BulkEdit skips non-finite results and unchanged fields", "[bulk_edit]") {
+    auto troops = makeTroops(4);
+    auto plan = compile("defaultUnitHp /= job, defaultUnitNumX = 4", BulkEditTarget::Troops).plan(troops);
+    REQUIRE(plan.nonFinite == 1);
+    REQUIRE(plan.floats.size() == 2); // job 1 leaves the value as it was.
+    REQUIRE(plan.ints.empty());
+
+    UndoStack undo;
+    auto none = compile("defaultUnitNumX = 4", BulkEditTarget::Troops).plan(troops);
+    REQUIRE_FALSE(executeBulkEdit(undo, none, "Nothing"));
+    REQUIRE_FALSE(undo.canUndo());
+}
+
+TEST_CASE("BulkEdit reports errors with their column", "[bulk_edit]") {
+    REQUIRE(compileError("speed = 1", BulkEditTarget::Troops) == "Unknown field 'speed' at column 1");
+    REQUIRE(compileError("defense = (1 + 2", BulkEditTarget::Troops) == "Expected ')' at column 17");
+    REQUIRE(compileError("uniqueId = 5", BulkEditTarget::Units) == "Field 'uniqueId' is read-only at column 1");
+    REQUIRE(compileError("ucd = enemy", BulkEditTarget::Units) == "Field 'ucd' is read-only at column 1");
+    REQUIRE(compileError("defense = 1, defense = 2", BulkEditTarget::Troops) ==
+            "Field 'defense' is assigned twice at column 14");
+    REQUIRE(compileError("defense = resist*", BulkEditTarget::Troops).starts_with("Pattern 'resist*'"));
+    REQUIRE(compileError("defense = 1 where ucd == enemy", BulkEditTarget::Troops) ==
+            "Unknown field 'ucd' at column 19");
+    REQUIRE(compileError("defense = pow(2)", BulkEditTarget::Troops) == "Unknown function 'pow' at column 11");
+    REQUIRE(compileError("defense = 1 $", BulkEditTarget::Troops) == "Unexpected '$' at column 13");
+
+    // A unit edit does nothing to troops.
+    auto edit = compile("positionX += 1", BulkEditTarget::Units);
+    auto troops = makeTroops(2);
+    REQUIRE(edit.plan(troops).records == 0);
+}
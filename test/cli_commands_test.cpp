@@ -0,0 +1,212 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "cli/commands.h"
+#include "mods/mod_manager.h"
+#include "test_fixtures.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace kuf::test;
+using kuf::cli::kExitError;
+using kuf::cli::kExitFailed;
+using kuf::cli::kExitOk;
+using kuf::cli::kExitUsage;
+
+namespace {
+
+// Parses words as they would follow the subcommand name.
+kuf::cli::CommandArgs parseArgs(std::vector<std::string> words) {
+    std::vector<char*> argv;
+    for (auto& word : words) argv.push_back(word.data());
+    return kuf::cli::CommandArgs::parse(static_cast<int>(argv.size()), argv.data(), 0);
+}
+
+// Exit code and JSON lines of one command run.
+struct CommandRun {
+    int exitCode = 0;
+    std::vector<std::string> lines;
+
+    const std::string& summary() const { return lines.back(); }
+};
+
+using CommandFn = int (*)(const kuf::cli::CommandArgs&, std::FILE*);
+
+// Runs command with its output captured instead of written to stdout.
+CommandRun runCommand(CommandFn command, std::vector<std::string> words) {
+    std::FILE* out = std::tmpfile();
+    REQUIRE(out != nullptr);
+    CommandRun run;
+    run.exitCode = command(parseArgs(std::move(words)), out);
+
+    std::rewind(out);
+    std::string text;
+    char buffer[4096];
+    for (size_t n; (n = std::fread(buffer, 1, sizeof(buffer), out)) > 0;) text.append(buffer, n);
+    std::fclose(out);
+
+    for (size_t start = 0; start < text.size();) {
+        size_t end = text.find('\n', start);
+        run.lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return run;
+}
+
+// JsonLine writes fields without spaces, so one field is a plain substring.
+bool hasField(const std::string& line, const std::string& field) {
+    return line.find(field) != std::string::npos;
+}
+
+std::string bytes(const std::vector<std::byte>& data) {
+    return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+size_t libraryArchiveCount() {
+    size_t count = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(kuf::ModManager::modsDirectory(), ec)) {
+        if (entry.path().extension() == ".zip") ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST_CASE("CommandArgs separates positionals, options and flags", "[cli]") {
+    auto args = parseArgs({"--out=dir", "a.sox", "--fields", "--", "--literal"});
+    REQUIRE(args.positional == std::vector<std::string>{"a.sox", "--literal"});
+    REQUIRE(args.option("out") == "dir");
+    REQUIRE(args.option("to", "same") == "same");
+    REQUIRE(args.flag("fields"));
+    REQUIRE_FALSE(args.flag("out"));
+}
+
+TEST_CASE("Commands return the usage exit code for bad arguments", "[cli]") {
+    using namespace kuf::cli;
+    std::vector<std::pair<CommandFn, std::vector<std::string>>> cases = {
+        {runValidate, {}},
+        {runConvert, {"a.sox"}},
+        {runConvert, {"--out=x", "--to=zip", "a.sox"}},
+        {runDumpJson, {}},
+        {runDiff, {"a.sox"}},
+        {runMerge, {"a", "b", "c"}},
+        {runMerge, {"--out=x", "--prefer=both", "a", "b", "c"}},
+        {runBackup, {}},
+        {runApplyMod, {"mod.zip"}},
+        {runBench, {}},
+        {runCorpus, {}},
+    };
+    for (const auto& [command, words] : cases) {
+        auto run = runCommand(command, words);
+        REQUIRE(run.exitCode == kExitUsage);
+        // Usage errors go to stderr only.
+        REQUIRE(run.lines.empty());
+    }
+}
+
+TEST_CASE("validate and diff report failures through the exit code", "[cli]") {
+    TempDir dir("kuf_cli_commands_test");
+    auto base = dir.path / "base" / "TroopInfo.sox";
+    auto same = dir.path / "same" / "TroopInfo.sox";
+    auto changed = dir.path / "changed" / "TroopInfo.sox";
+    writeFile(base, createTroopSox(3));
+    writeFile(same, createTroopSox(3));
+    writeFile(changed, createTroopSox(4));
+    auto text = dir.path / "Text.sox";
+    writeFile(text, createTextSox({"Hello", "World"}));
+    writeFile(dir.path / "bad" / "Broken.sox", std::string("not a sox file"));
+
+    auto valid = runCommand(kuf::cli::runValidate, {text.string()});
+    REQUIRE(valid.exitCode == kExitOk);
+    REQUIRE(valid.lines.size() == 2);
+    REQUIRE(hasField(valid.lines[0], R"("format":"Text SOX")"));
+    REQUIRE(hasField(valid.lines[0], R"("status":"ok")"));
+    REQUIRE(hasField(valid.summary(), R"({"summary":"validate","files":1,"failed":0,"errors":0)"));
+
+    // Zeroed troops have no HP, which validate reports as errors.
+    auto invalid = runCommand(kuf::cli::runValidate, {base.string()});
+    REQUIRE(invalid.exitCode == kExitFailed);
+    REQUIRE(hasField(invalid.lines[0], R"("status":"invalid")"));
+    REQUIRE(hasField(invalid.lines[0], R"("severity":"error")"));
+    REQUIRE(hasField(invalid.summary(), R"("failed":1)"));
+
+    auto broken = runCommand(kuf::cli::runValidate, {(dir.path / "bad").string()});
+    REQUIRE(broken.exitCode == kExitFailed);
+    REQUIRE(hasField(broken.lines[0], R"("status":"unrecognized")"));
+
+    auto identical = runCommand(kuf::cli::runDiff, {base.string(), same.string()});
+    REQUIRE(identical.exitCode == kExitOk);
+    REQUIRE(hasField(identical.lines[0], R"("status":"identical")"));
+    REQUIRE(hasField(identical.summary(), R"({"summary":"diff","files":1,"changed":0,"failed":0)"));
+
+    auto different = runCommand(kuf::cli::runDiff, {base.string(), changed.string()});
+    REQUIRE(different.exitCode == kExitFailed);
+    REQUIRE(hasField(different.lines[0], R"("status":"changed")"));
+    REQUIRE(hasField(different.summary(), R"("changed":1)"));
+
+    REQUIRE(runCommand(kuf::cli::runDiff, {(dir.path / "base").string(), (dir.path / "same").string()})
+                .exitCode == kExitOk);
+    auto dirs = runCommand(kuf::cli::runDiff, {(dir.path / "base").string(), (dir.path / "changed").string()});
+    REQUIRE(dirs.exitCode == kExitFailed);
+    REQUIRE(hasField(dirs.lines[0], R"("file":"TroopInfo.sox")"));
+
+    // An input that cannot be read is an error, not a usage mistake.
+    auto missing = runCommand(kuf::cli::runDiff, {(dir.path / "missing.sox").string(), same.string()});
+    REQUIRE(missing.exitCode == kExitError);
+    REQUIRE(hasField(missing.summary(), R"("failed":1)"));
+}
+
+TEST_CASE("convert writes every input below --out", "[cli]") {
+    TempDir dir("kuf_cli_commands_test");
+    writeFile(dir.path / "in" / "SOX" / "TroopInfo.sox", createTroopSox(2));
+    auto out = dir.path / "out";
+
+    auto run = runCommand(kuf::cli::runConvert, {"--out=" + out.string(), (dir.path / "in").string()});
+    REQUIRE(run.exitCode == kExitOk);
+    REQUIRE(hasField(run.summary(), R"({"summary":"convert","files":1,"failed":0)"));
+    REQUIRE(readFile(out / "SOX" / "TroopInfo.sox") == bytes(createTroopSox(2)));
+}
+
+TEST_CASE("apply-mod installs without importing unless asked", "[cli]") {
+    TempDir dir("kuf_cli_commands_test");
+    ScopedConfigHome home(dir.path / "config");
+    fs::path game = dir.path / "game";
+    writeFile(game / "SOX" / "TroopInfo.sox", createTroopSox(2));
+
+    fs::path source = dir.path / "source";
+    writeFile(source / "SOX" / "TroopInfo.sox", createTroopSox(3));
+    kuf::ModMetadata meta;
+    meta.name = "Faster Troops";
+    meta.version = "1.0";
+    meta.game = "crusaders";
+    meta.files = {"SOX/TroopInfo.sox"};
+    std::string zipPath = (dir.path / "faster.zip").string();
+    kuf::AsyncTask task;
+    REQUIRE(kuf::ModManager::createMod(meta, source.string(), meta.files, zipPath, task));
+
+    auto installed = runCommand(kuf::cli::runApplyMod, {zipPath, game.string()});
+    REQUIRE(installed.exitCode == kExitOk);
+    REQUIRE(installed.lines.size() == 1);
+    REQUIRE(hasField(installed.summary(),
+                     R"({"summary":"apply-mod","status":"ok","name":"Faster Troops","version":"1.0")"));
+    REQUIRE(readFile(game / "SOX" / "TroopInfo.sox") == bytes(createTroopSox(3)));
+    REQUIRE(libraryArchiveCount() == 0);
+    auto mods = kuf::ModManager::listInstalledMods();
+    REQUIRE(mods.size() == 1);
+    REQUIRE(mods[0].zipPath == zipPath);
+
+    auto imported = runCommand(kuf::cli::runApplyMod, {"--import", zipPath, game.string()});
+    REQUIRE(imported.exitCode == kExitOk);
+    REQUIRE(hasField(imported.summary(), R"("status":"ok")"));
+    REQUIRE(libraryArchiveCount() == 1);
+    REQUIRE(kuf::ModManager::listInstalledMods().size() == 1);
+
+    writeFile(dir.path / "empty.zip", std::string("not a zip"));
+    auto failed = runCommand(kuf::cli::runApplyMod, {(dir.path / "empty.zip").string(), game.string()});
+    REQUIRE(failed.exitCode == kExitFailed);
+    REQUIRE(hasField(failed.summary(), R"({"summary":"apply-mod","status":"failed","error":)"));
+}
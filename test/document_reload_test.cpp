@@ -0,0 +1,195 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/document_reload.h"
+#include "undo/set_field_command.h"
+#include "undo/set_text_command.h"
+#include "test_fixtures.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace kuf::test;
+
+namespace {
+
+void setFloat(std::vector<std::byte>& data, size_t offset, float value) {
+    std::memcpy(data.data() + offset, &value, 4);
+}
+
+std::string tempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// An open document as TabManager would load it from path.
+std::shared_ptr<kuf::OpenDocument> openDocument(const std::string& path, const std::vector<std::byte>& data) {
+    writeFile(path, data);
+    auto doc = std::make_shared<kuf::OpenDocument>();
+    doc->path = path;
+    doc->rawData = data;
+    if (path.ends_with(".stg")) {
+        doc->stgData = std::make_shared<kuf::StgFormat>();
+        REQUIRE(doc->stgData->load(data));
+    } else {
+        doc->textData = std::make_shared<kuf::SoxText>();
+        REQUIRE(doc->textData->load(data));
+    }
+    doc->undoStack->setOnChange([d = doc.get()]() { d->dirty = true; });
+    return doc;
+}
+
+kuf::DocumentReload reload(const kuf::OpenDocument& doc) {
+    auto request = kuf::makeReloadRequest(doc);
+    REQUIRE(request);
+    return kuf::prepareReload(*request);
+}
+
+} // namespace
+
+TEST_CASE("Reloading merges disk changes into unsaved edits", "[document_reload]") {
+    auto path = tempPath("kuf_reload_merge.stg");
+    auto base = createStg({100, 101});
+    auto doc = openDocument(path, base);
+
+    // The editor moves unit 100 while another tool changes unit 101's HP.
+    auto& units = doc->stgData->units();
+    doc->undoStack->execute(kuf::makeSetFieldCommand(&units[0].positionX, 500.0f, "Move"));
+    auto disk = base;
+    setFloat(disk, stgUnitOffset(1) + 0x2C, 80.0f);
+    writeFile(path, disk);
+
+    auto prepared = reload(*doc);
+    REQUIRE(prepared.error.empty());
+    REQUIRE(prepared.conflicts.empty());
+    REQUIRE_FALSE(prepared.replaceAll);
+    REQUIRE(prepared.records.size() == 1);
+    REQUIRE(prepared.records[0].kind == kuf::ReloadRecord::Kind::Unit);
+    REQUIRE(prepared.records[0].index == 1);
+
+    REQUIRE(kuf::applyReload(*doc, prepared));
+    REQUIRE(units[0].positionX == 500.0f);
+    REQUIRE(units[1].unitHpOverride == 80.0f);
+    REQUIRE(doc->dirty); // The move is still unsaved.
+    REQUIRE(doc->rawData == disk);
+
+    // The reload is one undo step, and the edit before it still undoes.
+    REQUIRE(doc->undoStack->undoDescription() == "Reload kuf_reload_merge.stg from disk");
+    doc->undoStack->undo();
+    REQUIRE(units[1].unitHpOverride == 0.0f);
+    doc->undoStack->undo();
+    REQUIRE(units[0].positionX == 0.0f);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Reloading a clean document takes the file on disk", "[document_reload]") {
+    auto path = tempPath("kuf_reload_clean.sox");
+    auto doc = openDocument(path, createTextSox({"Knight", "Archer"}));
+    auto disk = createTextSox({"Knight", "Bowman"});
+    writeFile(path, disk);
+
+    auto prepared = reload(*doc);
+    REQUIRE(prepared.records.size() == 1);
+    REQUIRE(prepared.matchesDisk);
+    REQUIRE(kuf::applyReload(*doc, prepared));
+    REQUIRE(doc->textData->text(1) == "Bowman");
+    REQUIRE_FALSE(doc->dirty);
+
+    // Another event for the same contents changes nothing.
+    auto again = reload(*doc);
+    REQUIRE(again.diskUnchanged);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Reloading keeps the editor's side of a conflict", "[document_reload]") {
+    auto path = tempPath("kuf_reload_conflict.sox");
+    auto doc = openDocument(path, createTextSox({"Knight", "Archer", "Mage"}));
+    auto command = std::make_unique<kuf::SetTextCommand>(doc->textData.get(), "Edit");
+    command->add(1, "Ranger");
+    doc->undoStack->execute(std::move(command));
+    writeFile(path, createTextSox({"Paladin", "Bowman", "Mage"}));
+
+    auto prepared = reload(*doc);
+    REQUIRE(prepared.conflicts == std::vector<std::string>{"text:1"});
+    REQUIRE(kuf::applyReload(*doc, prepared));
+    REQUIRE(doc->textData->text(0) == "Paladin");
+    REQUIRE(doc->textData->text(1) == "Ranger");
+    REQUIRE(doc->dirty);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Reloading a structural change replaces the document", "[document_reload]") {
+    auto path = tempPath("kuf_reload_structure.stg");
+    auto doc = openDocument(path, createStg({100, 101}));
+    doc->undoStack->execute(kuf::makeSetFieldCommand(&doc->stgData->units()[0].positionX, 7.0f, "Move"));
+    writeFile(path, createStg({100, 101, 102}));
+
+    auto prepared = reload(*doc);
+    REQUIRE(prepared.replaceAll);
+    REQUIRE(kuf::applyReload(*doc, prepared));
+    REQUIRE(doc->stgData->unitCount() == 3);
+    REQUIRE(doc->stgData->units()[0].positionX == 7.0f);
+    // History before the replacement pointed into the old records.
+    REQUIRE(doc->undoStack->undoCount() == 1);
+    doc->undoStack->undo();
+    REQUIRE(doc->stgData->unitCount() == 2);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Reloading a changed event keeps history unless its counts change", "[document_reload]") {
+    auto path = tempPath("kuf_reload_event.stg");
+    kuf::test::StgSpec spec;
+    spec.units = {{100}};
+    spec.events = {{10, 1}, {11, 2}};
+    auto doc = openDocument(path, createStg(spec));
+    auto& units = doc->stgData->units();
+    doc->undoStack->execute(kuf::makeSetFieldCommand(&units[0].positionX, 3.0f, "Move"));
+
+    // Same shape, new parameter value: replaced by position, history kept.
+    spec.events = {{10, 1}, {11, 9}};
+    writeFile(path, createStg(spec));
+    auto prepared = reload(*doc);
+    REQUIRE_FALSE(prepared.replaceAll);
+    REQUIRE(prepared.records.size() == 1);
+    REQUIRE(prepared.records[0].kind == kuf::ReloadRecord::Kind::Event);
+    REQUIRE(kuf::applyReload(*doc, prepared));
+    const auto& events = doc->stgData->eventBlocks()[0].events;
+    REQUIRE(events[1].actions[0].params[0].intValue == 9);
+    REQUIRE(doc->undoStack->undoCount() == 2);
+    doc->undoStack->undo();
+    REQUIRE(doc->stgData->eventBlocks()[0].events[1].actions[0].params[0].intValue == 2);
+    doc->undoStack->redo();
+
+    // An event losing its action is structural: the document is replaced.
+    spec.events = {{10, 1}, {11, std::nullopt}};
+    writeFile(path, createStg(spec));
+    prepared = reload(*doc);
+    REQUIRE(prepared.replaceAll);
+    REQUIRE(kuf::applyReload(*doc, prepared));
+    REQUIRE(doc->stgData->eventBlocks()[0].events[1].actions.empty());
+    REQUIRE(doc->stgData->units()[0].positionX == 3.0f);
+    REQUIRE(doc->undoStack->undoCount() == 1);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Reloading waits for edits made after the request", "[document_reload]") {
+    auto path = tempPath("kuf_reload_stale.stg");
+    auto base = createStg({100});
+    auto doc = openDocument(path, base);
+    auto disk = base;
+    setFloat(disk, stgUnitOffset(0) + 0x2C, 80.0f);
+    writeFile(path, disk);
+
+    auto prepared = reload(*doc);
+    doc->undoStack->execute(kuf::makeSetFieldCommand(&doc->stgData->units()[0].positionX, 1.0f, "Move"));
+    REQUIRE_FALSE(kuf::applyReload(*doc, prepared));
+    REQUIRE(doc->stgData->units()[0].unitHpOverride == 0.0f);
+
+    std::filesystem::remove(path);
+    auto missing = reload(*doc);
+    REQUIRE_FALSE(missing.error.empty());
+    REQUIRE(kuf::applyReload(*doc, missing));
+    REQUIRE(doc->stgData->units()[0].positionX == 1.0f);
+}
@@ -0,0 +1,37 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_io.h"
+#include "test_fixtures.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace kuf::test;
+
+TEST_CASE("lowerExtension takes the last component's extension", "[file_io]") {
+    REQUIRE(kuf::lowerExtension("TroopInfo.SOX") == ".sox");
+    REQUIRE(kuf::lowerExtension("Data/Missions/E1001.stg") == ".stg");
+    REQUIRE(kuf::lowerExtension("archive.tar.GZ") == ".gz");
+    REQUIRE(kuf::lowerExtension("Data.v2/readme").empty());
+    REQUIRE(kuf::lowerExtension("C:\\Game.dir\\README").empty());
+    REQUIRE(kuf::lowerExtension("noextension").empty());
+}
+
+TEST_CASE("readFileBytes reads whole files", "[file_io]") {
+    TempDir dir("kuf_file_io_test");
+    auto path = dir.path / "data.bin";
+    auto data = createTroopSox(3);
+    writeFile(path, data);
+
+    auto read = kuf::readFileBytes(path);
+    REQUIRE(read.has_value());
+    REQUIRE(*read == data);
+
+    // The buffer form reuses the caller's vector.
+    std::vector<std::byte> buffer(4096, std::byte{7});
+    REQUIRE(kuf::readFileBytes(path, buffer));
+    REQUIRE(buffer == data);
+
+    REQUIRE_FALSE(kuf::readFileBytes(dir.path / "missing.bin").has_value());
+}
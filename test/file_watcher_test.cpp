@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_watcher.h"
+#include "test_fixtures.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace kuf::test;
+
+namespace {
+
+// Collects changes until expected shows up or a generous timeout passes.
+std::vector<std::string> waitForChange(kuf::FileWatcher& watcher, const std::string& expected) {
+    std::vector<std::string> seen;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (auto& path : watcher.takeChanges()) seen.push_back(std::move(path));
+        if (std::find(seen.begin(), seen.end(), expected) != seen.end()) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return seen;
+}
+
+bool contains(const std::vector<std::string>& paths, const std::string& path) {
+    return std::find(paths.begin(), paths.end(), path) != paths.end();
+}
+
+void checkBackend(kuf::FileWatcher::Backend backend, const char* dirName) {
+    TempDir dir(dirName);
+    auto open = dir.path / "open.stg";
+    auto other = dir.path / "other.stg";
+    writeFile(open, "one");
+    writeFile(other, "one");
+
+    kuf::FileWatcher watcher(backend, std::chrono::milliseconds(20));
+    std::atomic<int> notified{0};
+    watcher.setOnChange([&notified]() { ++notified; });
+    watcher.watchFile(open.string());
+    // Let the poller take its baseline with the file watched.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    writeFile(other, "two, unwatched");
+    writeFile(open, "two, watched");
+    std::string expected = kuf::FileWatcher::normalize(open.string());
+    auto seen = waitForChange(watcher, expected);
+    REQUIRE(contains(seen, expected));
+    REQUIRE_FALSE(contains(seen, kuf::FileWatcher::normalize(other.string())));
+    REQUIRE(notified.load() > 0);
+
+    // Replacing a file by rename, as many tools save, is still a change.
+    auto temp = dir.path / "open.stg.tmp";
+    writeFile(temp, "three, renamed over");
+    fs::rename(temp, open);
+    REQUIRE(contains(waitForChange(watcher, expected), expected));
+
+    watcher.unwatchFile(open.string());
+    writeFile(open, "four, no longer watched");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    REQUIRE_FALSE(contains(watcher.takeChanges(), expected));
+}
+
+} // namespace
+
+TEST_CASE("FileWatcher reports changes to watched files", "[file_watcher]") {
+    SECTION("native") {
+        checkBackend(kuf::FileWatcher::Backend::Native, "kuf_file_watcher_native");
+    }
+    SECTION("polling") {
+        checkBackend(kuf::FileWatcher::Backend::Polling, "kuf_file_watcher_polling");
+    }
+}
+
+TEST_CASE("FileWatcher watches a directory tree", "[file_watcher]") {
+    for (auto backend : {kuf::FileWatcher::Backend::Native, kuf::FileWatcher::Backend::Polling}) {
+        TempDir dir("kuf_file_watcher_tree");
+        fs::create_directories(dir.path / "Data" / "SOX");
+        writeFile(dir.path / "Data" / "SOX" / "TroopInfo.sox", "one");
+
+        kuf::FileWatcher watcher(backend, std::chrono::milliseconds(20));
+        watcher.watchDirectory(dir.path.string());
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        REQUIRE(watcher.takeChanges().empty());
+
+        auto troops = kuf::FileWatcher::normalize((dir.path / "Data" / "SOX" / "TroopInfo.sox").string());
+        writeFile(troops, "two");
+        REQUIRE(contains(waitForChange(watcher, troops), troops));
+
+        // Files in directories created after watching started are seen too.
+        fs::create_directories(dir.path / "Data" / "Mission");
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto mission = kuf::FileWatcher::normalize((dir.path / "Data" / "Mission" / "E1140.stg").string());
+        writeFile(mission, "new");
+        REQUIRE(contains(waitForChange(watcher, mission), mission));
+
+        fs::remove(troops);
+        REQUIRE(contains(waitForChange(watcher, troops), troops));
+
+        watcher.watchDirectory("");
+        writeFile(mission, "changed after unwatching");
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        REQUIRE(watcher.takeChanges().empty());
+    }
+}
+
+TEST_CASE("FileWatcher::isUnder needs a separator after the directory", "[file_watcher]") {
+    auto dir = kuf::FileWatcher::normalize("games/kuf");
+    auto sep = std::string(1, static_cast<char>(fs::path::preferred_separator));
+    REQUIRE(kuf::FileWatcher::isUnder(dir + sep + "SOX" + sep + "TroopInfo.sox", dir));
+    REQUIRE(kuf::FileWatcher::isUnder(dir + sep + "a.sox", dir + sep));
+    REQUIRE_FALSE(kuf::FileWatcher::isUnder(dir + "2" + sep + "a.sox", dir));
+    REQUIRE_FALSE(kuf::FileWatcher::isUnder(dir, dir));
+    REQUIRE_FALSE(kuf::FileWatcher::isUnder(dir + sep + "a.sox", ""));
+}
@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/frame_pacer.h"
+
+using namespace kuf;
+
+namespace {
+
+FrameActivity idle() { return {}; }
+
+// Draws the settle frames that follow startup or input.
+void settle(FramePacer& pacer) {
+    for (int i = 0; i < FramePacer::kSettleFrames; ++i) {
+        REQUIRE(pacer.nextWait(idle()) == 0.0);
+    }
+}
+
+} // namespace
+
+TEST_CASE("FramePacer draws at full rate while there is input", "[frame_pacer]") {
+    FramePacer pacer;
+    settle(pacer);
+    REQUIRE(pacer.nextWait(idle()) == FramePacer::kIdleInterval);
+
+    FrameActivity input;
+    input.inputEvents = true;
+    REQUIRE(pacer.nextWait(input) == 0.0);
+    settle(pacer);
+    REQUIRE(pacer.nextWait(idle()) == FramePacer::kIdleInterval);
+
+    FrameActivity dragging;
+    dragging.interacting = true;
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(pacer.nextWait(dragging) == 0.0);
+    }
+}
+
+TEST_CASE("FramePacer slows down for background work and hover", "[frame_pacer]") {
+    FramePacer pacer;
+    settle(pacer);
+
+    FrameActivity busy;
+    busy.backgroundWork = true;
+    REQUIRE(pacer.nextWait(busy) == FramePacer::kBusyInterval);
+
+    FrameActivity hover;
+    hover.hovering = true;
+    REQUIRE(pacer.nextWait(hover) == FramePacer::kHoverInterval);
+}
+
+TEST_CASE("FramePacer never waits when disabled", "[frame_pacer]") {
+    FramePacer pacer;
+    pacer.setEnabled(false);
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(pacer.nextWait(idle()) == 0.0);
+    }
+}
+
+TEST_CASE("FramePacer counts refreshes spent waiting as skipped frames", "[frame_pacer]") {
+    FramePacer pacer(100.0);
+
+    // One second at 100 Hz is 100 refreshes; the frame drawn after it covers one.
+    pacer.recordWait(1.0);
+    REQUIRE(pacer.skippedFrames() == 99);
+
+    // Waits shorter than a refresh skip nothing.
+    pacer.recordWait(0.005);
+    REQUIRE(pacer.skippedFrames() == 99);
+
+    // Partial refreshes carry over between waits.
+    pacer.recordWait(0.015);
+    pacer.recordWait(0.015);
+    REQUIRE(pacer.skippedFrames() == 100);
+}
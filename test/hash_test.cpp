@@ -0,0 +1,39 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/hash.h"
+
+#include <cstring>
+#include <vector>
+
+TEST_CASE("hash64 matches XXH64 reference values", "[hash]") {
+    REQUIRE(kuf::hash64("", 0) == 0xEF46DB3751D8E999ULL);
+    REQUIRE(kuf::hash64("a", 1) == 0xD24EC4F1A98C6E5BULL);
+    REQUIRE(kuf::hash64("abc", 3) == 0x44BC2CF5AD770999ULL);
+
+    std::vector<unsigned char> bytes(200);
+    for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<unsigned char>(i);
+    REQUIRE(kuf::hash64(bytes.data(), bytes.size()) == 0x50DC1079B99E879CULL);
+}
+
+TEST_CASE("Hash64 streaming matches one-shot for any split", "[hash]") {
+    std::vector<unsigned char> bytes(1000);
+    for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<unsigned char>(i * 31 + 7);
+    uint64_t expected = kuf::hash64(bytes.data(), bytes.size());
+
+    for (size_t chunk : {1u, 3u, 31u, 32u, 33u, 100u, 999u}) {
+        kuf::Hash64 hasher;
+        for (size_t pos = 0; pos < bytes.size(); pos += chunk) {
+            hasher.update(bytes.data() + pos, std::min(chunk, bytes.size() - pos));
+        }
+        REQUIRE(hasher.digest() == expected);
+    }
+}
+
+TEST_CASE("hash64 distinguishes seeds and single-byte changes", "[hash]") {
+    std::vector<unsigned char> bytes(64, 0x5A);
+    uint64_t base = kuf::hash64(bytes.data(), bytes.size());
+    REQUIRE(kuf::hash64(bytes.data(), bytes.size(), 1) != base);
+
+    bytes[40] ^= 1;
+    REQUIRE(kuf::hash64(bytes.data(), bytes.size()) != base);
+}
@@ -0,0 +1,56 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/mapped_file.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::string writeTempFile(const char* name, const std::string& contents) {
+    auto path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+    return path;
+}
+
+} // namespace
+
+TEST_CASE("MappedFile exposes file contents", "[mapped_file]") {
+    std::string contents(100000, '\0');
+    for (size_t i = 0; i < contents.size(); ++i) contents[i] = static_cast<char>(i * 7);
+    auto path = writeTempFile("kuf_mapped_file_test.bin", contents);
+
+    kuf::MappedFile mapped;
+    REQUIRE(mapped.open(path));
+    REQUIRE(mapped.isOpen());
+    REQUIRE(mapped.size() == contents.size());
+    REQUIRE(std::memcmp(mapped.data().data(), contents.data(), contents.size()) == 0);
+
+    kuf::MappedFile moved = std::move(mapped);
+    REQUIRE_FALSE(mapped.isOpen());
+    REQUIRE(moved.size() == contents.size());
+
+    moved.close();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("MappedFile opens empty files", "[mapped_file]") {
+    auto path = writeTempFile("kuf_mapped_file_empty.bin", "");
+
+    kuf::MappedFile mapped;
+    REQUIRE(mapped.open(path));
+    REQUIRE(mapped.size() == 0);
+    REQUIRE(mapped.data().empty());
+
+    mapped.close();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("MappedFile fails on missing files", "[mapped_file]") {
+    kuf::MappedFile mapped;
+    REQUIRE_FALSE(mapped.open("/nonexistent/kuf_mapped_file_missing.bin"));
+    REQUIRE_FALSE(mapped.isOpen());
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "mods/mod_conflict_index.h"
+#include "test_fixtures.h"
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace kuf::test;
+
+namespace {
+
+// TroopInfo.sox with three troops and the given ones sped up.
+std::vector<std::byte> troopsWithFaster(const std::vector<int>& troops) {
+    auto data = createTroopSox(3);
+    for (int i : troops) {
+        int32_t moveSpeed = 500 + i;
+        std::memcpy(data.data() + 8 + 148 * i + 0x08, &moveSpeed, 4);
+    }
+    return data;
+}
+
+// Packs one file, under the given archive path, into a mod at zipPath.
+kuf::ModInfo makeMod(const std::string& name, const fs::path& dir, const std::string& gamePath,
+                     const std::vector<std::byte>& data) {
+    fs::path source = dir / name;
+    writeFile(source / gamePath, data);
+
+    kuf::ModInfo mod;
+    mod.metadata.name = name;
+    mod.metadata.version = "1.0";
+    mod.metadata.game = "crusaders";
+    mod.metadata.files = {gamePath};
+    mod.zipPath = (dir / (name + ".zip")).string();
+
+    kuf::AsyncTask task;
+    REQUIRE(kuf::ModManager::createMod(mod.metadata, source.string(), {gamePath}, mod.zipPath,
+                                       task));
+    mod.fileSize = fs::file_size(mod.zipPath);
+    return mod;
+}
+
+} // namespace
+
+TEST_CASE("Record conflicts match paths regardless of case", "[mod_conflict_index]") {
+    TempDir dir("kuf_mod_conflict_index_test");
+    fs::path game = dir.path / "game";
+    writeFile(game / "SOX" / "TroopInfo.sox", createTroopSox(3));
+
+    kuf::ModConflictIndex index;
+    auto first = makeMod("First", dir.path, "sox/troopinfo.sox", troopsWithFaster({0, 1}));
+    auto second = makeMod("Second", dir.path, "Sox\\TROOPINFO.SOX", troopsWithFaster({1, 2}));
+    index.addMod(first);
+    index.addMod(second);
+
+    REQUIRE(index.modsTouching("SOX/TroopInfo.sox").size() == 2);
+    auto conflicts = index.recordConflictsFor(first.zipPath, game.string());
+    REQUIRE(conflicts.size() == 1);
+    REQUIRE(conflicts[0].otherMod == "Second");
+    REQUIRE_FALSE(conflicts[0].wholeFile);
+    REQUIRE(conflicts[0].records == std::vector<std::string>{"troop:1"});
+}
+
+TEST_CASE("A shared file missing from the game is one whole-file conflict", "[mod_conflict_index]") {
+    TempDir dir("kuf_mod_conflict_index_test");
+    fs::path game = dir.path / "game";
+    fs::create_directories(game);
+
+    kuf::ModConflictIndex index;
+    auto first = makeMod("First", dir.path, "SOX/TroopInfo.sox", troopsWithFaster({0}));
+    auto second = makeMod("Second", dir.path, "SOX/TroopInfo.sox", troopsWithFaster({2}));
+    index.addMod(first);
+    index.addMod(second);
+
+    auto conflicts = index.recordConflictsFor(first.zipPath, game.string());
+    REQUIRE(conflicts.size() == 1);
+    REQUIRE(conflicts[0].wholeFile);
+    REQUIRE(conflicts[0].records.empty());
+}
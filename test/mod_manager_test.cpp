@@ -0,0 +1,265 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/json.h"
+#include "mods/mod_manager.h"
+#include "test_fixtures.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace kuf::test;
+
+namespace {
+
+kuf::ModMetadata makeMetadata(const std::string& name, const std::vector<std::string>& files) {
+    kuf::ModMetadata meta;
+    meta.name = name;
+    meta.version = "1.0";
+    meta.author = "tester";
+    meta.game = "crusaders";
+    meta.files = files;
+    return meta;
+}
+
+// Packs the given game files, as they are now, into a mod archive at zipPath.
+void createMod(const std::string& name, const fs::path& gameDir,
+               const std::vector<std::string>& files, const fs::path& zipPath) {
+    kuf::AsyncTask task;
+    fs::create_directories(zipPath.parent_path());
+    bool created = kuf::ModManager::createMod(makeMetadata(name, files), gameDir.string(), files,
+                                              zipPath.string(), task);
+    INFO(task.error());
+    REQUIRE(created);
+}
+
+// A mod whose archive holds the files under sourceDir, as an installed copy
+// of the game would have them.
+kuf::ModInfo makeMod(const std::string& name, const fs::path& sourceDir,
+                     const std::vector<std::string>& files, const fs::path& zipPath) {
+    createMod(name, sourceDir, files, zipPath);
+    kuf::ModInfo mod;
+    mod.metadata = makeMetadata(name, files);
+    mod.zipPath = zipPath.string();
+    return mod;
+}
+
+// A game directory with two files, plus two mods that both replace TroopInfo.sox.
+struct InstallFixture {
+    TempDir dir{"kuf_mod_install_test"};
+    ScopedConfigHome home{dir.path / "config"};
+    fs::path game = dir.path / "game";
+    kuf::ModInfo first;
+    kuf::ModInfo second;
+
+    InstallFixture() {
+        writeFile(game / "SOX" / "TroopInfo.sox", createTroopSox(2));
+        writeFile(game / "Missions" / "E1001.stg", createTwoUnitStg());
+
+        fs::path a = dir.path / "first";
+        writeFile(a / "SOX" / "TroopInfo.sox", createTroopSox(3));
+        writeFile(a / "Missions" / "E9001.stg", createStg({7}));
+        first = makeMod("First", a, {"SOX/TroopInfo.sox", "Missions/E9001.stg"},
+                        dir.path / "first.zip");
+
+        fs::path b = dir.path / "second";
+        writeFile(b / "SOX" / "TroopInfo.sox", createTroopSox(4));
+        writeFile(b / "Missions" / "E1001.stg", createStg({100, 101, 102}));
+        second = makeMod("Second", b, {"SOX/TroopInfo.sox", "Missions/E1001.stg"},
+                         dir.path / "second.zip");
+    }
+
+    std::string troops() const { return readFile(game / "SOX" / "TroopInfo.sox"); }
+};
+
+std::string bytes(const std::vector<std::byte>& data) {
+    return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+} // namespace
+
+TEST_CASE("Mod index JSON round-trips", "[mod_manager]") {
+    kuf::ModIndexEntry entry;
+    entry.mod.metadata = makeMetadata("Faster Troops", {"SOX/TroopInfo.sox"});
+    entry.mod.metadata.description = "Line one\nLine \"two\"";
+    entry.mod.zipPath = "/mods/faster.zip";
+    entry.mod.fileSize = 1234;
+    entry.modifiedTime = 638400000000000000;
+
+    auto parsed = kuf::parseModIndexJson(kuf::serializeModIndexJson({entry}));
+    REQUIRE(parsed.size() == 1);
+    REQUIRE(parsed[0].mod.metadata.name == "Faster Troops");
+    REQUIRE(parsed[0].mod.metadata.description == entry.mod.metadata.description);
+    REQUIRE(parsed[0].mod.metadata.files == entry.mod.metadata.files);
+    REQUIRE(parsed[0].mod.zipPath == entry.mod.zipPath);
+    REQUIRE(parsed[0].mod.fileSize == 1234);
+    REQUIRE(parsed[0].modifiedTime == entry.modifiedTime);
+
+    REQUIRE(kuf::parseModIndexJson("not json").empty());
+
+    kuf::ModIndexEntry broken;
+    broken.mod.zipPath = "/mods/broken.zip";
+    broken.invalid = true;
+    parsed = kuf::parseModIndexJson(kuf::serializeModIndexJson({broken}));
+    REQUIRE(parsed.size() == 1);
+    REQUIRE(parsed[0].invalid);
+    REQUIRE(parsed[0].mod.zipPath == broken.mod.zipPath);
+}
+
+TEST_CASE("listMods reuses the library index until an archive changes", "[mod_manager]") {
+    TempDir dir("kuf_mod_library_test");
+    ScopedConfigHome home(dir.path / "config");
+    fs::path game = dir.path / "game";
+    writeFile(game / "SOX" / "TroopInfo.sox", createTroopSox(2));
+    writeFile(game / "Missions" / "E1001.stg", createTwoUnitStg());
+
+    fs::path mods = kuf::ModManager::modsDirectory();
+    createMod("Alpha", game, {"SOX/TroopInfo.sox"}, mods / "alpha.zip");
+    createMod("Beta", game, {"Missions/E1001.stg"}, mods / "beta.zip");
+
+    auto listed = kuf::ModManager::listMods();
+    REQUIRE(listed.size() == 2);
+    REQUIRE(listed[0].metadata.name == "Alpha");
+    REQUIRE(listed[1].metadata.name == "Beta");
+    REQUIRE(fs::exists(kuf::ModManager::libraryIndexPath()));
+
+    // Rename Alpha in the index only: an unchanged archive is not reopened, so
+    // the cached name wins.
+    auto index = kuf::parseModIndexJson(readFile(kuf::ModManager::libraryIndexPath()));
+    REQUIRE(index.size() == 2);
+    for (auto& entry : index) {
+        if (entry.mod.metadata.name == "Alpha") entry.mod.metadata.name = "Cached Alpha";
+    }
+    writeFile(kuf::ModManager::libraryIndexPath(), kuf::serializeModIndexJson(index));
+    listed = kuf::ModManager::listMods();
+    REQUIRE(listed.size() == 2);
+    REQUIRE(listed[1].metadata.name == "Cached Alpha");
+
+    // A new modification time invalidates the cached entry.
+    auto alpha = mods / "alpha.zip";
+    fs::last_write_time(alpha, fs::last_write_time(alpha) + std::chrono::seconds(5));
+    listed = kuf::ModManager::listMods();
+    REQUIRE(listed.size() == 2);
+    REQUIRE(listed[0].metadata.name == "Alpha");
+
+    // Removed archives drop out of the index.
+    fs::remove(mods / "beta.zip");
+    listed = kuf::ModManager::listMods();
+    REQUIRE(listed.size() == 1);
+    REQUIRE(kuf::parseModIndexJson(readFile(kuf::ModManager::libraryIndexPath())).size() == 1);
+}
+
+TEST_CASE("listMods does not reopen an unchanged broken archive", "[mod_manager]") {
+    TempDir dir("kuf_mod_library_test");
+    ScopedConfigHome home(dir.path / "config");
+    fs::path game = dir.path / "game";
+    writeFile(game / "SOX" / "TroopInfo.sox", createTroopSox(2));
+
+    fs::path mods = kuf::ModManager::modsDirectory();
+    createMod("Alpha", game, {"SOX/TroopInfo.sox"}, mods / "alpha.zip");
+    writeFile(mods / "broken.zip", std::string("not a zip"));
+
+    auto listed = kuf::ModManager::listMods();
+    REQUIRE(listed.size() == 1);
+    auto index = kuf::parseModIndexJson(readFile(kuf::ModManager::libraryIndexPath()));
+    REQUIRE(index.size() == 2);
+    REQUIRE(std::count_if(index.begin(), index.end(), [](const auto& e) { return e.invalid; }) == 1);
+
+    // Re-reading the broken archive would rewrite the index; a marker appended
+    // to the file shows it was left alone.
+    std::string marked = kuf::serializeModIndexJson(index) + "\n";
+    writeFile(kuf::ModManager::libraryIndexPath(), marked);
+    REQUIRE(kuf::ModManager::listMods().size() == 1);
+    REQUIRE(readFile(kuf::ModManager::libraryIndexPath()) == marked);
+
+    // Once it changes, it is read again.
+    createMod("Broken No More", game, {"SOX/TroopInfo.sox"}, mods / "broken.zip");
+    listed = kuf::ModManager::listMods();
+    REQUIRE(listed.size() == 2);
+    REQUIRE(listed[1].metadata.name == "Broken No More");
+}
+
+TEST_CASE("Uninstall restores overwritten files and removes added ones", "[mod_manager]") {
+    InstallFixture fx;
+    kuf::AsyncTask task;
+
+    REQUIRE(kuf::ModManager::installMod(fx.first, fx.game.string(), task));
+    REQUIRE(fx.troops() == bytes(createTroopSox(3)));
+    REQUIRE(fs::exists(fx.game / "Missions" / "E9001.stg"));
+    REQUIRE_FALSE(kuf::ModManager::hasInterruptedInstall());
+    REQUIRE(kuf::ModManager::listInstalledMods().size() == 1);
+
+    std::vector<std::string> conflicts;
+    REQUIRE(kuf::ModManager::uninstallMod("First", task, &conflicts));
+    REQUIRE(conflicts.empty());
+    REQUIRE(fx.troops() == bytes(createTroopSox(2)));
+    REQUIRE_FALSE(fs::exists(fx.game / "Missions" / "E9001.stg"));
+    REQUIRE(kuf::ModManager::listInstalledMods().empty());
+    REQUIRE(fs::is_empty(kuf::ModManager::preimageDirectory()));
+}
+
+TEST_CASE("Uninstall keeps files a later mod changed", "[mod_manager]") {
+    InstallFixture fx;
+    kuf::AsyncTask task;
+
+    REQUIRE(kuf::ModManager::installMod(fx.first, fx.game.string(), task));
+    REQUIRE(kuf::ModManager::installMod(fx.second, fx.game.string(), task));
+    // Edited by hand after the install.
+    writeFile(fx.game / "Missions" / "E9001.stg", createStg({8}));
+
+    std::vector<std::string> conflicts;
+    REQUIRE(kuf::ModManager::uninstallMod("First", task, &conflicts));
+    std::sort(conflicts.begin(), conflicts.end());
+    REQUIRE(conflicts == std::vector<std::string>{"Missions/E9001.stg", "SOX/TroopInfo.sox"});
+    REQUIRE(fx.troops() == bytes(createTroopSox(4)));
+    REQUIRE(readFile(fx.game / "Missions" / "E9001.stg") == bytes(createStg({8})));
+
+    REQUIRE(kuf::ModManager::uninstallMod("Second", task, &conflicts));
+    REQUIRE(readFile(fx.game / "Missions" / "E1001.stg") == bytes(createTwoUnitStg()));
+}
+
+TEST_CASE("An interrupted install is rolled back on recovery", "[mod_manager]") {
+    InstallFixture fx;
+    kuf::AsyncTask task;
+
+    // Leave the state an install has between applying the files and recording
+    // the mod: files applied, journal on disk, installed.json without it.
+    REQUIRE(kuf::ModManager::installMod(fx.first, fx.game.string(), task));
+    auto installed = kuf::ModManager::listInstalledMods();
+    REQUIRE(installed.size() == 1);
+    REQUIRE(kuf::ModManager::markUninstalled("First"));
+    writeFile(kuf::ModManager::installJournalPath(),
+              "First\n" + fx.game.string() + "\n" + installed[0].preimagePath + "\n");
+
+    REQUIRE(kuf::ModManager::hasInterruptedInstall());
+    REQUIRE(kuf::ModManager::recoverInterruptedInstall(task));
+    REQUIRE_FALSE(kuf::ModManager::hasInterruptedInstall());
+    REQUIRE(fx.troops() == bytes(createTroopSox(2)));
+    REQUIRE_FALSE(fs::exists(fx.game / "Missions" / "E9001.stg"));
+    REQUIRE_FALSE(fs::exists(installed[0].preimagePath));
+}
+
+TEST_CASE("Recovery keeps an install that was already recorded", "[mod_manager]") {
+    InstallFixture fx;
+    kuf::AsyncTask task;
+
+    // Only the journal cleanup was lost.
+    REQUIRE(kuf::ModManager::installMod(fx.first, fx.game.string(), task));
+    auto installed = kuf::ModManager::listInstalledMods();
+    writeFile(kuf::ModManager::installJournalPath(),
+              "First\n" + fx.game.string() + "\n" + installed[0].preimagePath + "\n");
+
+    REQUIRE(kuf::ModManager::recoverInterruptedInstall(task));
+    REQUIRE_FALSE(kuf::ModManager::hasInterruptedInstall());
+    REQUIRE(fx.troops() == bytes(createTroopSox(3)));
+    REQUIRE(kuf::ModManager::listInstalledMods().size() == 1);
+
+    // A journal too short to parse is discarded.
+    writeFile(kuf::ModManager::installJournalPath(), std::string("First\n"));
+    REQUIRE(kuf::ModManager::recoverInterruptedInstall(task));
+    REQUIRE_FALSE(kuf::ModManager::hasInterruptedInstall());
+    REQUIRE(fx.troops() == bytes(createTroopSox(3)));
+}
@@ -0,0 +1,102 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+using namespace kuf;
+
+namespace {
+
+const profiler::ZoneSummary* findZone(const std::vector<profiler::ZoneSummary>& zones, std::string_view name) {
+    auto it = std::find_if(zones.begin(), zones.end(), [&](const auto& z) { return z.name == name; });
+    return it == zones.end() ? nullptr : &*it;
+}
+
+void spin() {
+    volatile int sink = 0;
+    for (int i = 0; i < 10000; ++i) sink = sink + i;
+}
+
+} // namespace
+
+TEST_CASE("Profiler summarizes zones per frame", "[profiler]") {
+    profiler::endFrame();
+    for (int i = 0; i < 3; ++i) {
+        KUF_PROFILE_ZONE("test.outer");
+        spin();
+        {
+            KUF_PROFILE_ZONE("test.inner");
+            spin();
+        }
+    }
+    profiler::endFrame();
+
+    auto zones = profiler::summaries();
+    const auto* outer = findZone(zones, "test.outer");
+    const auto* inner = findZone(zones, "test.inner");
+    REQUIRE(outer != nullptr);
+    REQUIRE(inner != nullptr);
+    REQUIRE(outer->lastMs > 0.0);
+    // Times are inclusive, so the outer zone covers the inner one.
+    REQUIRE(outer->lastMs >= inner->lastMs);
+    REQUIRE(outer->maxMs >= outer->lastMs);
+
+    // A frame without the zone leaves it out of the latest column.
+    profiler::endFrame();
+    zones = profiler::summaries();
+    outer = findZone(zones, "test.outer");
+    REQUIRE(outer != nullptr);
+    REQUIRE(outer->lastMs == 0.0);
+}
+
+TEST_CASE("Profiler exports captured zones from every thread as a Chrome trace", "[profiler]") {
+    profiler::endFrame();
+    profiler::startCapture();
+    REQUIRE(profiler::capturing());
+
+    { KUF_PROFILE_ZONE("test.main"); }
+    std::thread worker([] {
+        KUF_PROFILE_THREAD("test worker");
+        KUF_PROFILE_ZONE("test.worker");
+    });
+    worker.join();
+
+    profiler::endFrame();
+    profiler::stopCapture();
+    REQUIRE_FALSE(profiler::capturing());
+    REQUIRE(profiler::capturedEvents() >= 2);
+
+    std::string json = profiler::chromeTraceJson();
+    REQUIRE(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+    REQUIRE(json.find("\"name\":\"test.main\",\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(json.find("\"name\":\"test.worker\",\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(json.find("\"args\":{\"name\":\"test worker\"}") != std::string::npos);
+
+    // Zones after the capture stopped are not added.
+    size_t captured = profiler::capturedEvents();
+    { KUF_PROFILE_ZONE("test.late"); }
+    profiler::endFrame();
+    REQUIRE(profiler::capturedEvents() == captured);
+}
+
+TEST_CASE("Profiler drops events when a thread's ring is full", "[profiler]") {
+    profiler::endFrame();
+    uint64_t before = profiler::droppedEvents();
+
+    std::thread producer([] {
+        for (int i = 0; i < 20000; ++i) {
+            KUF_PROFILE_ZONE("test.flood");
+        }
+    });
+    producer.join();
+
+    REQUIRE(profiler::droppedEvents() > before);
+    profiler::endFrame();
+    auto zones = profiler::summaries();
+    const auto* flood = findZone(zones, "test.flood");
+    REQUIRE(flood != nullptr);
+    REQUIRE(flood->callsPerFrame > 0.0);
+}
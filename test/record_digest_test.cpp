@@ -0,0 +1,58 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/record_digest.h"
+#include "formats/stg_format.h"
+#include "test_fixtures.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace kuf::test;
+
+TEST_CASE("digestRecords splits troop SOX into records", "[record_digest]") {
+    auto data = createTroopSox(3);
+    auto records = kuf::digestRecords("TroopInfo.sox", data);
+    REQUIRE(records.has_value());
+    REQUIRE(records->size() == 4);
+    REQUIRE((*records)[0].key == "troop:0");
+    REQUIRE((*records)[3].key == "footer");
+}
+
+TEST_CASE("changedRecords reports only the edited troop", "[record_digest]") {
+    auto base = createTroopSox(3);
+    auto modified = base;
+    int32_t defense = 50;
+    std::memcpy(modified.data() + 8 + 148 + 0x30, &defense, 4);
+
+    auto changed = kuf::changedRecords(*kuf::digestRecords("TroopInfo.sox", base),
+                                       *kuf::digestRecords("TroopInfo.sox", modified));
+    REQUIRE(changed == std::vector<std::string>{"troop:1"});
+}
+
+TEST_CASE("changedRecords reports added and removed records", "[record_digest]") {
+    auto base = *kuf::digestRecords("TroopInfo.sox", createTroopSox(2));
+    auto grown = *kuf::digestRecords("TroopInfo.sox", createTroopSox(3));
+
+    REQUIRE(kuf::changedRecords(base, grown) == std::vector<std::string>{"troop:2"});
+    REQUIRE(kuf::changedRecords(grown, base) == std::vector<std::string>{"troop:2"});
+}
+
+TEST_CASE("digestRecords keys STG units by uniqueId", "[record_digest]") {
+    auto base = createTwoUnitStg();
+    auto modified = base;
+    float posX = 1234.0f;
+    std::memcpy(modified.data() + kuf::kStgHeaderSize + kuf::kStgUnitSize + 0x44, &posX, 4);
+
+    auto baseRecords = kuf::digestRecords("E1001.stg", base);
+    REQUIRE(baseRecords.has_value());
+    REQUIRE((*baseRecords)[1].key == "unit:100");
+    REQUIRE((*baseRecords)[2].key == "unit:101");
+
+    auto changed = kuf::changedRecords(*baseRecords, *kuf::digestRecords("E1001.stg", modified));
+    REQUIRE(changed == std::vector<std::string>{"unit:101"});
+}
+
+TEST_CASE("digestRecords rejects files without record structure", "[record_digest]") {
+    std::vector<std::byte> data(64, std::byte{1});
+    REQUIRE_FALSE(kuf::digestRecords("texture.dds", data).has_value());
+}
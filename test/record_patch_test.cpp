@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/record_patch.h"
+#include "formats/stg_format.h"
+#include "test_fixtures.h"
+
+#include <cstring>
+#include <variant>
+#include <vector>
+
+using namespace kuf::test;
+
+namespace {
+
+void setTroopField(std::vector<std::byte>& data, int32_t troop, size_t field, int32_t value) {
+    std::memcpy(data.data() + 8 + 148 * troop + field, &value, 4);
+}
+
+std::vector<std::byte> applyOrFail(const char* name, const std::vector<std::byte>& data,
+                                   const kuf::RecordPatch& patch) {
+    auto result = kuf::applyRecordPatch(name, data, patch);
+    REQUIRE(std::holds_alternative<std::vector<std::byte>>(result));
+    return std::get<std::vector<std::byte>>(result);
+}
+
+} // namespace
+
+TEST_CASE("RecordPatch stores only the changed troop fields", "[record_patch]") {
+    auto base = createTroopSox(50);
+    auto modified = base;
+    setTroopField(modified, 7, 0x30, 55);
+    setTroopField(modified, 7, 0x38, 90);
+
+    auto patch = kuf::diffRecordPatch("TroopInfo.sox", base, modified);
+    REQUIRE(patch.has_value());
+    REQUIRE(patch->edits.size() == 1);
+    REQUIRE(patch->edits[0].key == "troop:7");
+    REQUIRE_FALSE(patch->edits[0].replace);
+    REQUIRE(patch->edits[0].runs.size() == 1);
+
+    auto bytes = kuf::serializeRecordPatch(*patch);
+    REQUIRE(bytes.size() < 100);
+    REQUIRE(bytes.size() * 50 < base.size());
+
+    auto parsed = kuf::parseRecordPatch(bytes);
+    REQUIRE(parsed.has_value());
+    REQUIRE(applyOrFail("TroopInfo.sox", base, *parsed) == modified);
+}
+
+TEST_CASE("RecordPatches on different records compose", "[record_patch]") {
+    auto base = createTroopSox(4);
+    auto modA = base;
+    setTroopField(modA, 1, 0x30, 11);
+    auto modB = base;
+    setTroopField(modB, 2, 0x30, 22);
+
+    auto patchA = kuf::diffRecordPatch("TroopInfo.sox", base, modA);
+    auto patchB = kuf::diffRecordPatch("TroopInfo.sox", base, modB);
+    REQUIRE(patchA.has_value());
+    REQUIRE(patchB.has_value());
+
+    auto merged = applyOrFail("TroopInfo.sox", applyOrFail("TroopInfo.sox", base, *patchA), *patchB);
+    auto expected = base;
+    setTroopField(expected, 1, 0x30, 11);
+    setTroopField(expected, 2, 0x30, 22);
+    REQUIRE(merged == expected);
+}
+
+TEST_CASE("RecordPatch refuses records changed by something else", "[record_patch]") {
+    auto base = createTroopSox(2);
+    auto modA = base;
+    setTroopField(modA, 0, 0x30, 11);
+    auto modB = base;
+    setTroopField(modB, 0, 0x34, 22);
+
+    auto patchB = kuf::diffRecordPatch("TroopInfo.sox", base, modB);
+    REQUIRE(patchB.has_value());
+    REQUIRE(std::holds_alternative<std::string>(kuf::applyRecordPatch("TroopInfo.sox", modA, *patchB)));
+
+    // Reapplying onto an already patched file is a no-op.
+    REQUIRE(applyOrFail("TroopInfo.sox", modB, *patchB) == modB);
+}
+
+TEST_CASE("RecordPatch falls back when records are added", "[record_patch]") {
+    auto base = createTroopSox(2);
+    auto grown = createTroopSox(3);
+    REQUIRE_FALSE(kuf::diffRecordPatch("TroopInfo.sox", base, grown).has_value());
+}
+
+TEST_CASE("RecordPatch patches STG units by uniqueId", "[record_patch]") {
+    auto base = createTwoUnitStg();
+    auto modified = base;
+    float posX = 1234.0f;
+    std::memcpy(modified.data() + kuf::kStgHeaderSize + kuf::kStgUnitSize + 0x44, &posX, 4);
+
+    auto patch = kuf::diffRecordPatch("E1001.stg", base, modified);
+    REQUIRE(patch.has_value());
+    REQUIRE(patch->edits.size() == 1);
+    REQUIRE(patch->edits[0].key == "unit:101");
+    REQUIRE(applyOrFail("E1001.stg", base, *patch) == modified);
+}
+
+TEST_CASE("parseRecordPatch rejects truncated input", "[record_patch]") {
+    auto base = createTroopSox(2);
+    auto modified = base;
+    setTroopField(modified, 1, 0x30, 5);
+    auto bytes = kuf::serializeRecordPatch(*kuf::diffRecordPatch("TroopInfo.sox", base, modified));
+
+    bytes.pop_back();
+    REQUIRE_FALSE(kuf::parseRecordPatch(bytes).has_value());
+}
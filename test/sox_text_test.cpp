@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/sox_text.h"
+#include "undo/set_text_command.h"
+#include "undo/undo_stack.h"
+#include "test_fixtures.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace kuf::test;
+
+TEST_CASE("SoxText loads entries and round-trips", "[sox_text]") {
+    auto data = createTextSox({"Knight", "Archer\tCaptain", "Line one\r\nLine two"});
+    kuf::SoxText sox;
+    REQUIRE(sox.load(data));
+    REQUIRE(sox.entryCount() == 3);
+    REQUIRE(sox.text(1) == "Archer\tCaptain");
+    REQUIRE(sox.maxLength(2) == 18);
+    REQUIRE(sox.save() == data);
+}
+
+TEST_CASE("SoxText rejects non-text data", "[sox_text]") {
+    kuf::SoxText sox;
+    REQUIRE_FALSE(sox.load(createTextSox({"Fine", std::string("Bad\x01", 4)})));
+    REQUIRE_FALSE(sox.load(createTextSox({"Fine", "Caf\xC3\xA9"})));
+    REQUIRE_FALSE(sox.load(createTextSox({"Fine", ""})));
+    REQUIRE_FALSE(sox.load(createTextSox({})));
+}
+
+TEST_CASE("SoxText edits texts in the pool", "[sox_text]") {
+    auto data = createTextSox({"Alpha", "Bravo", "Charlie"});
+    kuf::SoxText sox;
+    REQUIRE(sox.load(data));
+
+    sox.setText(0, "Al");
+    sox.setText(1, "Bravo Company");
+    REQUIRE(sox.text(0) == "Al");
+    REQUIRE(sox.text(1) == "Bravo Company");
+    REQUIRE(sox.text(2) == "Charlie");
+    // Longer than the slot the file reserved for it.
+    REQUIRE(sox.validate().size() == 1);
+
+    // Copying one entry onto another reads from the pool being written.
+    sox.setText(0, sox.text(2));
+    REQUIRE(sox.text(0) == "Charlie");
+
+    kuf::SoxText reloaded;
+    REQUIRE(reloaded.load(sox.save()));
+    REQUIRE(reloaded.text(0) == "Charlie");
+    REQUIRE(reloaded.text(1) == "Bravo Company");
+    REQUIRE(reloaded.text(2) == "Charlie");
+}
+
+TEST_CASE("SoxText compacts the pool after many edits", "[sox_text]") {
+    std::vector<std::string> texts(100, "Entry");
+    kuf::SoxText sox;
+    REQUIRE(sox.load(createTextSox(texts)));
+
+    for (int round = 0; round < 50; ++round) {
+        for (size_t i = 0; i < texts.size(); ++i) {
+            sox.setText(i, "Entry " + std::to_string(round) + " of " + std::to_string(i));
+        }
+    }
+    for (size_t i = 0; i < texts.size(); ++i) {
+        REQUIRE(sox.text(i) == "Entry 49 of " + std::to_string(i));
+    }
+    // The pool never holds more than twice the live text plus slack.
+    size_t live = 0;
+    for (const auto& entry : sox.entries()) live += entry.length;
+    size_t end = 0;
+    for (const auto& entry : sox.entries()) end = std::max<size_t>(end, entry.offset + entry.length);
+    REQUIRE(end <= 2 * live + 4096 + 64);
+}
+
+TEST_CASE("SoxText loads tables beyond 10000 entries", "[sox_text]") {
+    std::vector<std::string> texts;
+    for (size_t i = 0; i < 150000; ++i) texts.push_back("Text " + std::to_string(i));
+    auto data = createTextSox(texts);
+
+    kuf::SoxText sox;
+    REQUIRE(sox.load(data));
+    REQUIRE(sox.entryCount() == 150000);
+    REQUIRE(sox.text(123456) == "Text 123456");
+    REQUIRE(sox.save() == data);
+}
+
+TEST_CASE("SoxText stops at the end of the data when the count is corrupt", "[sox_text]") {
+    auto data = createTextSox({"Alpha", "Bravo"});
+    int32_t count = INT32_MAX;
+    std::memcpy(data.data() + 4, &count, 4);
+
+    kuf::SoxText sox;
+    REQUIRE(sox.load(data));
+    REQUIRE(sox.entryCount() == 2);
+    REQUIRE(sox.text(1) == "Bravo");
+}
+
+TEST_CASE("SetTextCommand replaces entries as one undo step", "[sox_text]") {
+    kuf::SoxText sox;
+    REQUIRE(sox.load(createTextSox({"Alpha", "Bravo", "Charlie"})));
+    kuf::UndoStack stack;
+
+    auto command = std::make_unique<kuf::SetTextCommand>(&sox, "Replace");
+    command->add(0, "Alpha Company");
+    command->add(2, "C");
+    stack.execute(std::move(command));
+    REQUIRE(sox.text(0) == "Alpha Company");
+    REQUIRE(sox.text(2) == "C");
+
+    stack.undo();
+    REQUIRE(sox.text(0) == "Alpha");
+    REQUIRE(sox.text(1) == "Bravo");
+    REQUIRE(sox.text(2) == "Charlie");
+    stack.redo();
+    REQUIRE(sox.text(0) == "Alpha Company");
+}
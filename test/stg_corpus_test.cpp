@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/stg_corpus.h"
+#include "test_fixtures.h"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace kuf::test;
+
+namespace {
+
+std::vector<std::pair<std::string, std::vector<std::byte>>> createCorpus() {
+    return {
+        {"missions/E1002.stg", createStg({.units = {{1, 4}, {2, 4, 0, true, 33, 1}, {3, -1, 3}},
+                                          .variables = {{"stage", 0}, {"bossDead", 1}},
+                                          .events = {{1}, {2}, {3}}})},
+        {"missions/E1001.stg", createStg({.units = {{1, 4}, {2, 7, 0, true, 33, 1}},
+                                          .variables = {{"stage", 0}},
+                                          .events = {{1}}})},
+        {"missions/broken.stg", std::vector<std::byte>(16, std::byte{0})},
+    };
+}
+
+} // namespace
+
+TEST_CASE("effectiveTroopInfoIndex falls back to the formation default", "[stg_corpus]") {
+    kuf::StgUnit unit;
+    unit.troopInfoIndex = 11;
+    REQUIRE(kuf::effectiveTroopInfoIndex(unit) == 11);
+
+    unit.troopInfoIndex = -1;
+    unit.formationType = 3;
+    REQUIRE(kuf::effectiveTroopInfoIndex(unit) == 7);
+    unit.formationType = 0x26;
+    REQUIRE(kuf::effectiveTroopInfoIndex(unit) == 42);
+    unit.formationType = 200;
+    REQUIRE(kuf::effectiveTroopInfoIndex(unit) == 2);
+}
+
+TEST_CASE("StgCorpus loads missions in path order and records failures", "[stg_corpus]") {
+    kuf::StgCorpus corpus;
+    REQUIRE(corpus.loadFromMemory(createCorpus()) == 2);
+
+    REQUIRE(corpus.missions().size() == 2);
+    REQUIRE(corpus.missions()[0].path == "missions/E1001.stg");
+    REQUIRE(corpus.missions()[1].path == "missions/E1002.stg");
+    REQUIRE(corpus.missions()[1].eventCount == 3);
+    REQUIRE(corpus.totalUnitCount() == 5);
+    REQUIRE(corpus.totalEventCount() == 4);
+
+    REQUIRE(corpus.failures().size() == 1);
+    REQUIRE(corpus.failures()[0].path == "missions/broken.stg");
+
+    REQUIRE(corpus.findMission("missions/E1002.stg") == &corpus.missions()[1]);
+    REQUIRE(corpus.findMission("missions/E9999.stg") == nullptr);
+}
+
+TEST_CASE("StgCorpus indexes troop types across missions", "[stg_corpus]") {
+    kuf::StgCorpus corpus;
+    corpus.loadFromMemory(createCorpus());
+
+    REQUIRE(corpus.troopTypes() == std::vector<int32_t>{4, 7});
+
+    auto users = corpus.unitsWithTroop(4);
+    REQUIRE(users.size() == 3);
+    REQUIRE(corpus.unit(users[0]).uniqueId == 1);
+    REQUIRE(corpus.missionsWithTroop(4) == std::vector<uint32_t>{0, 1});
+    // E1002's third unit has no TroopInfo index and falls back to 7.
+    REQUIRE(corpus.missionsWithTroop(7) == std::vector<uint32_t>{0, 1});
+    REQUIRE(corpus.unitsWithTroop(7).size() == 2);
+    REQUIRE(corpus.unitsWithTroop(99).empty());
+}
+
+TEST_CASE("StgCorpus groups hero appearances by identity", "[stg_corpus]") {
+    kuf::StgCorpus corpus;
+    corpus.loadFromMemory(createCorpus());
+
+    REQUIRE(corpus.heroes().size() == 1);
+    const auto& hero = corpus.heroes()[0];
+    REQUIRE(hero.jobType == 33);
+    REQUIRE(hero.modelId == 1);
+    REQUIRE(hero.units.size() == 2);
+    REQUIRE(hero.units[0].mission == 0);
+    REQUIRE(hero.units[1].mission == 1);
+}
+
+TEST_CASE("StgCorpus indexes variable names", "[stg_corpus]") {
+    kuf::StgCorpus corpus;
+    corpus.loadFromMemory(createCorpus());
+
+    REQUIRE(corpus.variableNames() == std::vector<std::string>{"bossDead", "stage"});
+    auto stage = corpus.missionsWithVariable("stage");
+    REQUIRE(std::vector<uint32_t>(stage.begin(), stage.end()) == std::vector<uint32_t>{0, 1});
+    REQUIRE(corpus.missionsWithVariable("missing").empty());
+}
+
+TEST_CASE("StgCorpus loads every STG below a directory", "[stg_corpus]") {
+    auto dir = std::filesystem::temp_directory_path() / "kuf_stg_corpus_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "Data" / "Missions");
+
+    for (const auto& [path, data] : createCorpus()) {
+        auto name = std::filesystem::path(path).filename();
+        std::ofstream out(dir / "Data" / "Missions" / name, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+    std::ofstream(dir / "Data" / "readme.txt") << "not a mission";
+
+    kuf::StgCorpus corpus;
+    // Progress arrives on worker threads; check it after the load returns.
+    std::atomic<size_t> progressCalls{0};
+    std::atomic<size_t> reportedTotal{0};
+    REQUIRE(corpus.load(dir.string(), [&](size_t, size_t total) {
+        reportedTotal = total;
+        ++progressCalls;
+    }) == 2);
+    REQUIRE(progressCalls == 3);
+    REQUIRE(reportedTotal == 3);
+    REQUIRE(corpus.missions()[0].path == "Data/Missions/E1001.stg");
+    REQUIRE(corpus.failures().size() == 1);
+
+    std::filesystem::remove_all(dir);
+}
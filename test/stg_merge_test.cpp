@@ -0,0 +1,155 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/stg_format.h"
+#include "formats/stg_merge.h"
+#include "test_fixtures.h"
+
+#include <cstring>
+#include <variant>
+#include <vector>
+
+using namespace kuf::test;
+
+namespace {
+
+// Every merge fixture declares variable 7 and gives each event one action.
+std::vector<std::byte> buildStg(const std::vector<uint32_t>& units, std::vector<uint32_t> areas,
+                                std::vector<StgEventSpec> events) {
+    StgSpec spec;
+    for (uint32_t id : units) spec.units.push_back({id});
+    spec.areas = std::move(areas);
+    spec.variables = {{"", 7}};
+    spec.events = std::move(events);
+    return createStg(spec);
+}
+
+kuf::StgMergeResult merge(const std::vector<std::byte>& base, const std::vector<std::byte>& ours,
+                          const std::vector<std::byte>& theirs,
+                          kuf::StgMergePrefer prefer = kuf::StgMergePrefer::Ours) {
+    auto result = kuf::mergeStg(base, ours, theirs, prefer);
+    REQUIRE(std::holds_alternative<kuf::StgMergeResult>(result));
+    return std::get<kuf::StgMergeResult>(std::move(result));
+}
+
+kuf::StgFormat load(const std::vector<std::byte>& data) {
+    kuf::StgFormat stg;
+    REQUIRE(stg.load(data));
+    REQUIRE(stg.tailParsed());
+    return stg;
+}
+
+} // namespace
+
+TEST_CASE("mergeStg combines edits to different records", "[stg_merge]") {
+    auto base = buildStg({100, 101}, {1}, {{10, 1}, {11, 1}});
+    auto ours = base;
+    auto theirs = base;
+    float posX = 500.0f;
+    writeAt(ours, stgUnitOffset(0) + 0x44, &posX, 4);
+    float hp = 80.0f;
+    writeAt(theirs, stgUnitOffset(1) + 0x2C, &hp, 4);
+
+    auto result = merge(base, ours, theirs);
+    REQUIRE(result.clean());
+    REQUIRE(result.takenFromTheirs == 1);
+    auto merged = load(result.merged);
+    REQUIRE(merged.units()[0].positionX == 500.0f);
+    REQUIRE(merged.units()[1].unitHpOverride == 80.0f);
+
+    // With nothing changed on one side the merge is the other side.
+    REQUIRE(merge(base, base, theirs).merged == theirs);
+    REQUIRE(merge(base, ours, base).merged == ours);
+}
+
+TEST_CASE("mergeStg merges different fields of one unit", "[stg_merge]") {
+    auto base = buildStg({100}, {}, {});
+    auto ours = base;
+    auto theirs = base;
+    float posX = 500.0f;
+    writeAt(ours, stgUnitOffset(0) + 0x44, &posX, 4);
+    uint32_t gridX = 4;
+    writeAt(theirs, stgUnitOffset(0) + 0x190, &gridX, 4);
+
+    auto result = merge(base, ours, theirs);
+    REQUIRE(result.clean());
+    REQUIRE(result.fieldMerged == 1);
+    auto merged = load(result.merged);
+    REQUIRE(merged.units()[0].positionX == 500.0f);
+    REQUIRE(merged.units()[0].gridX == 4);
+}
+
+TEST_CASE("mergeStg flags fields changed on both sides", "[stg_merge]") {
+    auto base = buildStg({100}, {}, {{10, 1}});
+    auto ours = buildStg({100}, {}, {{10, 2}});
+    auto theirs = buildStg({100}, {}, {{10, 3}});
+    float oursX = 1.0f, theirsX = 2.0f;
+    writeAt(ours, stgUnitOffset(0) + 0x44, &oursX, 4);
+    writeAt(theirs, stgUnitOffset(0) + 0x44, &theirsX, 4);
+
+    auto result = merge(base, ours, theirs);
+    REQUIRE(result.conflicts.size() == 2);
+    REQUIRE(result.conflicts[0].key == "unit:100");
+    REQUIRE(result.conflicts[0].fields == std::vector<std::string>{"positionX"});
+    REQUIRE(result.conflicts[1].key == "event:10");
+    REQUIRE(load(result.merged).units()[0].positionX == 1.0f);
+
+    auto preferTheirs = merge(base, ours, theirs, kuf::StgMergePrefer::Theirs);
+    auto merged = load(preferTheirs.merged);
+    REQUIRE(merged.units()[0].positionX == 2.0f);
+    REQUIRE(merged.eventBlocks()[0].events[0].actions[0].params[0].intValue == 3);
+}
+
+TEST_CASE("mergeStg applies additions and removals from both sides", "[stg_merge]") {
+    auto base = buildStg({100, 101, 102}, {1, 2}, {{10, 1}, {11, 1}});
+    // Ours removes unit 101 and adds event 12; theirs adds unit 103 after 100
+    // and removes area 2.
+    auto ours = buildStg({100, 102}, {1, 2}, {{10, 1}, {11, 1}, {12, 5}});
+    auto theirs = buildStg({100, 103, 101, 102}, {1}, {{10, 1}, {11, 1}});
+
+    auto result = merge(base, ours, theirs);
+    REQUIRE(result.clean());
+    auto merged = load(result.merged);
+    REQUIRE(merged.units().size() == 3);
+    REQUIRE(merged.units()[0].uniqueId == 100);
+    REQUIRE(merged.units()[1].uniqueId == 103);
+    REQUIRE(merged.units()[2].uniqueId == 102);
+    REQUIRE(merged.areas().size() == 1);
+    REQUIRE(merged.totalEventCount() == 3);
+    REQUIRE(merged.variables().size() == 1);
+
+    // A record one side removed and the other changed is a conflict.
+    auto edited = theirs;
+    float posX = 9.0f;
+    writeAt(edited, stgUnitOffset(2) + 0x44, &posX, 4);
+    auto conflicted = merge(base, ours, edited);
+    REQUIRE(conflicted.conflicts.size() == 1);
+    REQUIRE(conflicted.conflicts[0].key == "unit:101");
+    REQUIRE(conflicted.conflicts[0].reason == "removed in ours, changed in theirs");
+}
+
+TEST_CASE("mergeStg places a long run of added records in order", "[stg_merge]") {
+    // Every added area follows the previous one, a chain as long as the section.
+    constexpr uint32_t kAdded = 50000;
+    std::vector<uint32_t> theirsAreas = {1};
+    for (uint32_t id = 2; id <= kAdded + 1; ++id) theirsAreas.push_back(id);
+    auto base = buildStg({100}, {1}, {{10, 1}});
+    auto ours = buildStg({100, 101}, {1}, {{10, 1}});
+    auto theirs = buildStg({100}, theirsAreas, {{10, 1}});
+
+    auto result = merge(base, ours, theirs);
+    REQUIRE(result.clean());
+    auto merged = load(result.merged);
+    REQUIRE(merged.units().size() == 2);
+    REQUIRE(merged.areas().size() == theirsAreas.size());
+    for (size_t i = 0; i < theirsAreas.size(); ++i) {
+        if (merged.areas()[i].areaId != theirsAreas[i]) FAIL("area " << i << " out of order");
+    }
+}
+
+TEST_CASE("mergeStg rejects files that are not missions", "[stg_merge]") {
+    auto base = buildStg({100}, {}, {});
+    std::vector<std::byte> garbage(32, std::byte{1});
+    auto result = kuf::mergeStg(base, garbage, base);
+    REQUIRE(std::holds_alternative<std::string>(result));
+    REQUIRE(std::get<std::string>(result) == "ours is not a valid STG mission");
+}
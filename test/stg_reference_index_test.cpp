@@ -0,0 +1,244 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/stg_reference_index.h"
+#include "undo/stg_event_command.h"
+#include "undo/stg_renumber_command.h"
+#include "undo/undo_stack.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+kuf::StgParamValue intParam(int32_t value) {
+    kuf::StgParamValue param;
+    param.type = kuf::StgParamType::Int;
+    param.intValue = value;
+    return param;
+}
+
+kuf::StgScriptEntry entry(uint32_t typeId, std::vector<int32_t> params) {
+    kuf::StgScriptEntry e;
+    e.typeId = typeId;
+    for (int32_t p : params) e.params.push_back(intParam(p));
+    return e;
+}
+
+// Two units (ids 10 and 11), one area (5), one variable (3) and two events:
+//   event 100: CON_AREA(10, 5)              -> ACT_VAR_INT_SET(3, 1)
+//   event 101: CON_EVENT_TRIGGERED(100)     -> ACT_MOVE_TO_AREA(11, 5), ACT_KILL_TROOP(10)
+kuf::StgFormat createMission() {
+    std::vector<std::byte> data(kuf::kStgHeaderSize + 2 * kuf::kStgUnitSize, std::byte{0});
+    uint32_t magic = 0x3E9;
+    std::memcpy(data.data(), &magic, 4);
+    uint32_t unitCount = 2;
+    std::memcpy(data.data() + 0x270, &unitCount, 4);
+
+    kuf::StgFormat stg;
+    stg.load(data);
+    stg.units()[0].uniqueId = 10;
+    stg.units()[1].uniqueId = 11;
+
+    kuf::StgArea area;
+    area.areaId = 5;
+    stg.areas().push_back(area);
+
+    kuf::StgVariable var;
+    var.name = "stage";
+    var.variableId = 3;
+    stg.variables().push_back(var);
+
+    kuf::StgEventBlock block;
+    kuf::StgEvent first;
+    first.eventId = 100;
+    first.conditions.push_back(entry(5, {10, 5}));
+    first.actions.push_back(entry(55, {3, 1}));
+    kuf::StgEvent second;
+    second.eventId = 101;
+    second.conditions.push_back(entry(16, {100}));
+    second.actions.push_back(entry(9, {11, 5}));
+    second.actions.push_back(entry(2, {10}));
+    block.events = {first, second};
+    stg.eventBlocks().push_back(block);
+    return stg;
+}
+
+} // namespace
+
+TEST_CASE("Reference kinds come from catalog parameter names", "[stg_refs]") {
+    REQUIRE(kuf::referenceKindForParam("TroopID") == kuf::StgRefKind::Troop);
+    REQUIRE(kuf::referenceKindForParam("TargetID") == kuf::StgRefKind::Troop);
+    REQUIRE(kuf::referenceKindForParam("AreaID") == kuf::StgRefKind::Area);
+    REQUIRE(kuf::referenceKindForParam("VariableID") == kuf::StgRefKind::Variable);
+    REQUIRE(kuf::referenceKindForParam("EventID") == kuf::StgRefKind::Event);
+    REQUIRE_FALSE(kuf::referenceKindForParam("Percent"));
+    REQUIRE_FALSE(kuf::referenceKindForParam(""));
+
+    // CON_HP_UNDER(TroopID, Percent).
+    REQUIRE(kuf::referenceKind(false, 3, 0) == kuf::StgRefKind::Troop);
+    REQUIRE_FALSE(kuf::referenceKind(false, 3, 1));
+    // ACT_TRIGGER_EVENT(EventID).
+    REQUIRE(kuf::referenceKind(true, 87, 0) == kuf::StgRefKind::Event);
+    REQUIRE_FALSE(kuf::referenceKind(true, 9999, 0));
+}
+
+TEST_CASE("StgReferenceIndex finds every reference site", "[stg_refs]") {
+    auto stg = createMission();
+    kuf::StgReferenceIndex index;
+    index.build(stg);
+
+    auto troop10 = index.find(kuf::StgRefKind::Troop, 10);
+    REQUIRE(troop10.size() == 2);
+    REQUIRE(troop10[0] == kuf::StgRefSite{0, 0, false, 0, 0});
+    REQUIRE(troop10[1] == kuf::StgRefSite{0, 1, true, 1, 0});
+
+    REQUIRE(index.count(kuf::StgRefKind::Area, 5) == 2);
+    REQUIRE(index.count(kuf::StgRefKind::Variable, 3) == 1);
+    REQUIRE(index.count(kuf::StgRefKind::Event, 100) == 1);
+    REQUIRE(index.count(kuf::StgRefKind::Troop, 11) == 1);
+
+    // The value 1 in ACT_VAR_INT_SET is not an ID.
+    REQUIRE(index.count(kuf::StgRefKind::Troop, 1) == 0);
+    REQUIRE(index.count(kuf::StgRefKind::Variable, 1) == 0);
+}
+
+TEST_CASE("StgReferenceIndex updates one event incrementally", "[stg_refs]") {
+    auto stg = createMission();
+    kuf::StgReferenceIndex index;
+    index.build(stg);
+
+    auto& event = stg.eventBlocks()[0].events[1];
+    REQUIRE_FALSE(index.reindexEvent(stg, 0, 1));
+
+    event.actions[1].params[0].intValue = 11;
+    REQUIRE_FALSE(index.sitesMatch(stg, kuf::StgRefKind::Troop, 10));
+    REQUIRE(index.reindexEvent(stg, 0, 1));
+    REQUIRE(index.sitesMatch(stg, kuf::StgRefKind::Troop, 10));
+    REQUIRE(index.count(kuf::StgRefKind::Troop, 10) == 1);
+    REQUIRE(index.count(kuf::StgRefKind::Troop, 11) == 2);
+
+    // Changing the entry type changes what its parameters mean.
+    event.conditions[0].typeId = 6; // CON_TIME_ELAPSED(Seconds).
+    REQUIRE(index.reindexEvent(stg, 0, 1));
+    REQUIRE(index.count(kuf::StgRefKind::Event, 100) == 0);
+}
+
+TEST_CASE("StgReferenceIndex reindexes a block after removing an event", "[stg_refs]") {
+    auto stg = createMission();
+    kuf::StgReferenceIndex index;
+    index.build(stg);
+
+    auto& events = stg.eventBlocks()[0].events;
+    events.erase(events.begin());
+    index.reindexBlock(stg, 0);
+
+    REQUIRE(index.count(kuf::StgRefKind::Variable, 3) == 0);
+    auto troop10 = index.find(kuf::StgRefKind::Troop, 10);
+    REQUIRE(troop10.size() == 1);
+    REQUIRE(troop10[0].event == 0);
+}
+
+TEST_CASE("StgReferenceIndex renumbers definitions and references", "[stg_refs]") {
+    auto stg = createMission();
+    kuf::StgReferenceIndex index;
+    index.build(stg);
+
+    // Target already defined, or source missing.
+    REQUIRE_FALSE(index.renumber(stg, kuf::StgRefKind::Troop, 10, 11));
+    REQUIRE_FALSE(index.renumber(stg, kuf::StgRefKind::Troop, 99, 12));
+
+    REQUIRE(index.renumber(stg, kuf::StgRefKind::Troop, 10, 20));
+    REQUIRE(stg.units()[0].uniqueId == 20);
+    REQUIRE(stg.eventBlocks()[0].events[0].conditions[0].params[0].intValue == 20);
+    REQUIRE(stg.eventBlocks()[0].events[1].actions[1].params[0].intValue == 20);
+    REQUIRE(stg.eventBlocks()[0].events[0].modified);
+    REQUIRE(index.count(kuf::StgRefKind::Troop, 10) == 0);
+    REQUIRE(index.count(kuf::StgRefKind::Troop, 20) == 2);
+
+    REQUIRE(index.renumber(stg, kuf::StgRefKind::Event, 100, 200));
+    REQUIRE(stg.eventBlocks()[0].events[0].eventId == 200);
+    REQUIRE(stg.eventBlocks()[0].events[1].conditions[0].params[0].intValue == 200);
+
+    // The index stays consistent with a fresh build.
+    kuf::StgReferenceIndex rebuilt;
+    rebuilt.build(stg);
+    REQUIRE(rebuilt.count(kuf::StgRefKind::Troop, 20) == index.count(kuf::StgRefKind::Troop, 20));
+    REQUIRE_FALSE(index.reindexEvent(stg, 0, 0));
+    REQUIRE_FALSE(index.reindexEvent(stg, 0, 1));
+}
+
+TEST_CASE("StgReferenceIndex plans a renumber without applying it", "[stg_refs]") {
+    auto stg = createMission();
+    kuf::StgReferenceIndex index;
+    index.build(stg);
+
+    REQUIRE_FALSE(index.planRenumber(stg, kuf::StgRefKind::Troop, 10, 11));
+
+    auto plan = index.planRenumber(stg, kuf::StgRefKind::Troop, 10, 20);
+    REQUIRE(plan);
+    REQUIRE(plan->definitions == std::vector<uint32_t>{0});
+    REQUIRE(plan->params.size() == 2);
+    REQUIRE(plan->modifiedEvents.size() == 2);
+    REQUIRE(stg.units()[0].uniqueId == 10);
+
+    kuf::applyRenumberPlan(stg, *plan, plan->to);
+    kuf::StgReferenceIndex rebuilt;
+    rebuilt.build(stg);
+    REQUIRE(rebuilt.count(kuf::StgRefKind::Troop, 20) == 2);
+    REQUIRE(rebuilt.count(kuf::StgRefKind::Troop, 10) == 0);
+}
+
+TEST_CASE("A renumber undoes correctly after events are added and removed", "[stg_refs]") {
+    auto stg = createMission();
+    kuf::StgReferenceIndex index;
+    index.build(stg);
+    kuf::UndoStack undo;
+
+    auto plan = index.planRenumber(stg, kuf::StgRefKind::Event, 100, 200);
+    REQUIRE(plan);
+    undo.execute(std::make_unique<kuf::StgRenumberCommand>(&stg, std::move(*plan), "Renumber"));
+    REQUIRE(stg.eventBlocks()[0].events[1].conditions[0].params[0].intValue == 200);
+
+    // Growing the block reallocates its events; removing one shifts the rest.
+    for (int i = 0; i < 8; ++i) {
+        kuf::StgEvent added;
+        added.eventId = 300 + i;
+        undo.execute(std::make_unique<kuf::StgEventCommand>(&stg, 0, 2, std::nullopt, added, "Add event"));
+    }
+    undo.execute(std::make_unique<kuf::StgEventCommand>(&stg, 0, 0, stg.eventBlocks()[0].events[0],
+                                                        std::nullopt, "Delete event"));
+    REQUIRE(stg.eventBlocks()[0].events.size() == 9);
+    REQUIRE(stg.eventBlocks()[0].events[0].eventId == 101);
+
+    for (int i = 0; i < 9; ++i) undo.undo();
+    REQUIRE(stg.eventBlocks()[0].events.size() == 2);
+    REQUIRE(stg.eventBlocks()[0].events[0].eventId == 200);
+
+    undo.undo();
+    const auto& events = stg.eventBlocks()[0].events;
+    REQUIRE(events[0].eventId == 100);
+    REQUIRE_FALSE(events[0].modified);
+    REQUIRE(events[1].conditions[0].params[0].intValue == 100);
+    REQUIRE_FALSE(events[1].modified);
+
+    undo.redo();
+    REQUIRE(events[0].eventId == 200);
+    REQUIRE(events[1].modified);
+}
+
+TEST_CASE("StgEventCommand adds a block for the first event and removes it on undo", "[stg_refs]") {
+    kuf::StgFormat stg;
+    kuf::UndoStack undo;
+    kuf::StgEvent added;
+    added.eventId = 7;
+
+    undo.execute(std::make_unique<kuf::StgEventCommand>(&stg, 0, 0, std::nullopt, added, "Add event"));
+    REQUIRE(stg.eventBlocks().size() == 1);
+    REQUIRE(stg.eventBlocks()[0].events[0].eventId == 7);
+
+    undo.undo();
+    REQUIRE(stg.eventBlocks().empty());
+    undo.redo();
+    REQUIRE(stg.eventBlocks()[0].events.size() == 1);
+}
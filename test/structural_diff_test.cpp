@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/stg_format.h"
+#include "formats/structural_diff.h"
+#include "test_fixtures.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace kuf::test;
+
+TEST_CASE("diffStructure reports changed troop fields", "[structural_diff]") {
+    auto base = createTroopSox(3);
+    auto modified = base;
+    // Defense is stored as an integer and read as a float.
+    int32_t defense = 50;
+    std::memcpy(modified.data() + 8 + 148 + 0x30, &defense, 4);
+
+    auto diff = kuf::diffStructure("TroopInfo.sox", base, modified);
+    REQUIRE(diff.has_value());
+    REQUIRE(diff->format == "Binary SOX");
+    REQUIRE(diff->unchanged == 3);
+    REQUIRE(diff->records.size() == 1);
+    const auto& record = diff->records[0];
+    REQUIRE(record.kind == kuf::RecordChangeKind::Changed);
+    REQUIRE(record.key == "troop:1");
+    REQUIRE(record.fields.size() == 1);
+    REQUIRE(record.fields[0].field == "defense");
+    REQUIRE(record.fields[0].before == "0");
+    REQUIRE(record.fields[0].after == "50");
+
+    REQUIRE(kuf::diffStructure("TroopInfo.sox", base, base)->identical());
+}
+
+TEST_CASE("diffStructure reports added and removed records", "[structural_diff]") {
+    auto grown = kuf::diffStructure("TroopInfo.sox", createTroopSox(2), createTroopSox(3));
+    REQUIRE(grown.has_value());
+    REQUIRE(grown->records.size() == 1);
+    REQUIRE(grown->records[0].kind == kuf::RecordChangeKind::Added);
+    REQUIRE(grown->records[0].key == "troop:2");
+
+    auto shrunk = kuf::diffStructure("TroopInfo.sox", createTroopSox(3), createTroopSox(2));
+    REQUIRE(shrunk->records.size() == 1);
+    REQUIRE(shrunk->records[0].kind == kuf::RecordChangeKind::Removed);
+}
+
+TEST_CASE("diffStructure falls back to byte ranges for unmodelled data", "[structural_diff]") {
+    auto base = createTroopSox(1);
+    auto modified = base;
+    modified[8 + 148 + 0x10] = std::byte{0xAB};
+    modified[8 + 148 + 0x12] = std::byte{0xCD};
+
+    auto diff = kuf::diffStructure("TroopInfo.sox", base, modified);
+    REQUIRE(diff->records.size() == 1);
+    REQUIRE(diff->records[0].key == "footer");
+    REQUIRE(diff->records[0].fields.size() == 1);
+    REQUIRE(diff->records[0].fields[0].field == "bytes[0x10..0x13)");
+    REQUIRE(diff->records[0].fields[0].before == "00 00 00");
+    REQUIRE(diff->records[0].fields[0].after == "ab 00 cd");
+}
+
+TEST_CASE("diffStructure matches STG units by uniqueId", "[structural_diff]") {
+    auto base = createTwoUnitStg();
+    auto modified = base;
+    float posX = 1234.0f;
+    std::memcpy(modified.data() + kuf::kStgHeaderSize + kuf::kStgUnitSize + 0x44, &posX, 4);
+
+    auto diff = kuf::diffStructure("E1001.stg", base, modified);
+    REQUIRE(diff.has_value());
+    REQUIRE(diff->records.size() == 1);
+    REQUIRE(diff->records[0].key == "unit:101");
+    REQUIRE(diff->records[0].fields.size() == 1);
+    REQUIRE(diff->records[0].fields[0].field == "positionX");
+    REQUIRE(diff->records[0].fields[0].after == "1234");
+
+    std::vector<std::byte> opaque(64, std::byte{1});
+    REQUIRE_FALSE(kuf::diffStructure("texture.dds", opaque, opaque).has_value());
+    REQUIRE_FALSE(kuf::diffStructure("E1001.stg", base, opaque).has_value());
+}
+
+TEST_CASE("diffPaths compares directories by relative path", "[structural_diff]") {
+    auto dir = std::filesystem::temp_directory_path() / "kuf_structural_diff_test";
+    std::filesystem::remove_all(dir);
+    auto troops = createTroopSox(2);
+    auto edited = troops;
+    float sight = 900.0f;
+    std::memcpy(edited.data() + 8 + 0x18, &sight, 4);
+
+    writeFile(dir / "base" / "SOX" / "TroopInfo.sox", troops);
+    writeFile(dir / "base" / "SOX" / "Same.sox", troops);
+    writeFile(dir / "base" / "Old.stg", createTwoUnitStg());
+    writeFile(dir / "modified" / "SOX" / "TroopInfo.sox", edited);
+    writeFile(dir / "modified" / "SOX" / "Same.sox", troops);
+    writeFile(dir / "modified" / "New.stg", createTwoUnitStg());
+    writeFile(dir / "modified" / "notes.txt", troops);
+
+    auto files = kuf::diffPaths((dir / "base").string(), (dir / "modified").string());
+    REQUIRE(files.size() == 4);
+    REQUIRE(files[0].path == "New.stg");
+    REQUIRE(files[0].status == kuf::FileDiffStatus::Added);
+    REQUIRE(files[1].path == "Old.stg");
+    REQUIRE(files[1].status == kuf::FileDiffStatus::Removed);
+    REQUIRE(files[2].path == "SOX/Same.sox");
+    REQUIRE(files[2].status == kuf::FileDiffStatus::Identical);
+    REQUIRE(files[3].path == "SOX/TroopInfo.sox");
+    REQUIRE(files[3].status == kuf::FileDiffStatus::Changed);
+    REQUIRE(files[3].diff.has_value());
+    REQUIRE(files[3].diff->records.size() == 1);
+    REQUIRE(files[3].diff->records[0].fields[0].field == "sightRange");
+
+    // Two plain files are compared directly.
+    auto single = kuf::diffPaths((dir / "base" / "SOX" / "TroopInfo.sox").string(),
+                                 (dir / "modified" / "SOX" / "TroopInfo.sox").string());
+    REQUIRE(single.size() == 1);
+    REQUIRE(single[0].status == kuf::FileDiffStatus::Changed);
+
+    std::filesystem::remove_all(dir);
+}
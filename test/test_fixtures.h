@@ -0,0 +1,235 @@
+#pragma once
+
+// Builders for the synthetic game files the tests load, diff, patch and merge.
+
+#include "formats/stg_format.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kuf::test {
+
+inline void appendU32(std::vector<std::byte>& v, uint32_t val) {
+    size_t pos = v.size();
+    v.resize(pos + 4);
+    std::memcpy(v.data() + pos, &val, 4);
+}
+
+inline void writeAt(std::vector<std::byte>& v, size_t offset, const void* value, size_t size) {
+    std::memcpy(v.data() + offset, value, size);
+}
+
+// TroopInfo.sox with count zeroed records; record i has moveSpeed 100 + i so
+// every record hashes differently.
+inline std::vector<std::byte> createTroopSox(int32_t count) {
+    std::vector<std::byte> data(8 + 148 * count + 64, std::byte{0});
+    int32_t version = 100;
+    std::memcpy(data.data(), &version, 4);
+    std::memcpy(data.data() + 4, &count, 4);
+    for (int32_t i = 0; i < count; ++i) {
+        int32_t moveSpeed = 100 + i;
+        std::memcpy(data.data() + 8 + 148 * i + 0x08, &moveSpeed, 4);
+    }
+    return data;
+}
+
+// A text SOX with one entry per string, indexed in order.
+inline std::vector<std::byte> createTextSox(const std::vector<std::string>& texts) {
+    std::vector<std::byte> data;
+    appendU32(data, 100);
+    appendU32(data, static_cast<uint32_t>(texts.size()));
+    for (size_t i = 0; i < texts.size(); ++i) {
+        appendU32(data, static_cast<uint32_t>(i));
+        uint16_t length = static_cast<uint16_t>(texts[i].size());
+        size_t pos = data.size();
+        data.resize(pos + 2 + texts[i].size());
+        std::memcpy(data.data() + pos, &length, 2);
+        std::memcpy(data.data() + pos + 2, texts[i].data(), texts[i].size());
+    }
+    return data;
+}
+
+struct StgUnitSpec {
+    uint32_t uniqueId = 0;
+    int32_t troopInfoIndex = 0;
+    uint32_t formationType = 0;
+    bool isHero = false;
+    uint8_t jobType = 0;
+    uint8_t modelId = 0;
+};
+
+struct StgVariableSpec {
+    std::string name{};
+    uint32_t variableId = 0;
+};
+
+// An event with no conditions; with actionParam set it has one action
+// (type 42) taking that int.
+struct StgEventSpec {
+    uint32_t eventId = 0;
+    std::optional<int32_t> actionParam{};
+};
+
+struct StgSpec {
+    std::vector<StgUnitSpec> units{};
+    std::vector<uint32_t> areas{};
+    std::vector<StgVariableSpec> variables{};
+    std::vector<StgEventSpec> events{};
+    bool tail = true; // Without it the file ends after the units.
+};
+
+// Header, units and, unless spec.tail is false, a parsed tail: areas,
+// variables, one event block and an empty footer.
+inline std::vector<std::byte> createStg(const StgSpec& spec) {
+    std::vector<std::byte> data(kStgHeaderSize + spec.units.size() * kStgUnitSize, std::byte{0});
+    uint32_t magic = 0x3E9;
+    writeAt(data, 0, &magic, 4);
+    uint32_t unitCount = static_cast<uint32_t>(spec.units.size());
+    writeAt(data, 0x270, &unitCount, 4);
+
+    for (size_t i = 0; i < spec.units.size(); ++i) {
+        const auto& u = spec.units[i];
+        size_t unit = kStgHeaderSize + i * kStgUnitSize;
+        writeAt(data, unit + 0x20, &u.uniqueId, 4);
+        data[unit + 0x25] = std::byte{u.isHero ? uint8_t{1} : uint8_t{0}};
+        data[unit + 0x54] = std::byte{u.jobType};
+        data[unit + 0x55] = std::byte{u.modelId};
+        writeAt(data, unit + 0x1C0, &u.troopInfoIndex, 4);
+        writeAt(data, unit + 0x1C4, &u.formationType, 4);
+    }
+    if (!spec.tail) return data;
+
+    appendU32(data, static_cast<uint32_t>(spec.areas.size()));
+    for (uint32_t id : spec.areas) {
+        size_t start = data.size();
+        data.resize(start + kStgAreaIdEntrySize, std::byte{0});
+        writeAt(data, start + 0x40, &id, 4);
+    }
+
+    appendU32(data, static_cast<uint32_t>(spec.variables.size()));
+    for (const auto& var : spec.variables) {
+        size_t pos = data.size();
+        data.resize(pos + kStgVariableNameSize, std::byte{0});
+        std::memcpy(data.data() + pos, var.name.data(), var.name.size());
+        appendU32(data, var.variableId);
+        appendU32(data, 0); // Int initial value.
+        appendU32(data, 0);
+    }
+
+    appendU32(data, 1); // Block count.
+    appendU32(data, 0); // Block header.
+    appendU32(data, static_cast<uint32_t>(spec.events.size()));
+    for (const auto& event : spec.events) {
+        data.resize(data.size() + kStgEventDescriptionSize, std::byte{0});
+        appendU32(data, event.eventId);
+        appendU32(data, 0); // Conditions.
+        appendU32(data, event.actionParam ? 1 : 0);
+        if (event.actionParam) {
+            appendU32(data, 42);
+            appendU32(data, 1);
+            appendU32(data, 0); // Int.
+            appendU32(data, static_cast<uint32_t>(*event.actionParam));
+        }
+    }
+
+    appendU32(data, 0); // Footer.
+    return data;
+}
+
+// Units with the given ids and nothing else of interest.
+inline std::vector<std::byte> createStg(const std::vector<uint32_t>& unitIds, bool tail = true) {
+    StgSpec spec;
+    for (uint32_t id : unitIds) spec.units.push_back({id});
+    spec.tail = tail;
+    return createStg(spec);
+}
+
+// Header plus units 100 and 101 and no tail.
+inline std::vector<std::byte> createTwoUnitStg() {
+    return createStg({100, 101}, false);
+}
+
+inline size_t stgUnitOffset(size_t index) {
+    return kStgHeaderSize + index * kStgUnitSize;
+}
+
+inline void writeFile(const std::filesystem::path& path, const std::vector<std::byte>& data) {
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+inline void writeFile(const std::filesystem::path& path, const std::string& contents) {
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << contents;
+}
+
+inline std::string readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+// A fresh directory under the system temp directory, removed on scope exit.
+struct TempDir {
+    std::filesystem::path path;
+
+    explicit TempDir(const char* name) : path(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+};
+
+// Points getConfigDir() below dir while in scope, so tests that back up,
+// import or install never touch the user's real config directory.
+class ScopedConfigHome {
+public:
+    explicit ScopedConfigHome(const std::filesystem::path& dir) {
+        if (const char* old = std::getenv(kVariable)) previous_ = old;
+        set(dir.string().c_str());
+    }
+    ~ScopedConfigHome() {
+        set(previous_ ? previous_->c_str() : nullptr);
+    }
+
+    ScopedConfigHome(const ScopedConfigHome&) = delete;
+    ScopedConfigHome& operator=(const ScopedConfigHome&) = delete;
+
+private:
+#if defined(__APPLE__)
+    static constexpr const char* kVariable = "HOME";
+#elif defined(_WIN32)
+    static constexpr const char* kVariable = "APPDATA";
+#else
+    static constexpr const char* kVariable = "XDG_CONFIG_HOME";
+#endif
+
+    static void set(const char* value) {
+#ifdef _WIN32
+        _putenv_s(kVariable, value ? value : "");
+#else
+        if (value) {
+            setenv(kVariable, value, 1);
+        } else {
+            unsetenv(kVariable);
+        }
+#endif
+    }
+
+    std::optional<std::string> previous_;
+};
+
+} // namespace kuf::test
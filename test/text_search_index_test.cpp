@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/text_search_index.h"
+#include "test_fixtures.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+using namespace kuf::test;
+
+namespace {
+
+kuf::TextQuery compile(std::string_view pattern, kuf::TextSearchOptions options = {}) {
+    auto result = kuf::TextQuery::compile(pattern, options);
+    REQUIRE(std::holds_alternative<kuf::TextQuery>(result));
+    return std::get<kuf::TextQuery>(std::move(result));
+}
+
+} // namespace
+
+TEST_CASE("TextSearchIndex finds substrings across files", "[text_search]") {
+    kuf::TextSearchIndex index;
+    REQUIRE(index.addFile("ENG/units.sox", createTextSox({"Knight Captain", "Archer", "Dark Knight"})));
+    REQUIRE(index.addFile("ENG/items.sox", createTextSox({"Knife", "Knight's Sword"})));
+    REQUIRE_FALSE(index.addFile("ENG/troops.sox", std::vector<std::byte>(64, std::byte{0})));
+    REQUIRE(index.fileCount() == 2);
+    REQUIRE(index.entryCount() == 5);
+
+    auto result = index.search(compile("knight"));
+    REQUIRE(result.hits.size() == 3);
+    REQUIRE(result.hits[0].path == "ENG/items.sox");
+    REQUIRE(result.hits[0].entry == 1);
+    REQUIRE(result.hits[1].path == "ENG/units.sox");
+    REQUIRE(result.hits[1].entry == 0);
+    REQUIRE(result.hits[2].entry == 2);
+    REQUIRE(result.hits[2].offset == 5);
+    REQUIRE(result.hits[2].length == 6);
+    // Only entries holding every trigram of the query are checked.
+    REQUIRE(result.candidates == 3);
+
+    REQUIRE(index.search(compile("knight", {false, true})).hits.empty());
+    REQUIRE(index.search(compile("Kn")).hits.size() == 4);
+
+    auto limited = index.search(compile("Kn"), 2);
+    REQUIRE(limited.hits.size() == 2);
+    REQUIRE(limited.truncated);
+}
+
+TEST_CASE("TextSearchIndex narrows regex queries by their literals", "[text_search]") {
+    kuf::TextSearchIndex index;
+    REQUIRE(index.addFile("text.sox", createTextSox({"Gold: 100", "Gold: none", "Silver: 20", "Golden 7"})));
+
+    auto result = index.search(compile("gold: \\d+", {true, false}));
+    REQUIRE(result.hits.size() == 1);
+    REQUIRE(result.hits[0].entry == 0);
+    REQUIRE(result.candidates == 2);
+
+    // Optional characters and alternations are not required literals.
+    REQUIRE(index.search(compile("Golde?n? \\d", {true, true})).hits.size() == 1);
+    REQUIRE(index.search(compile("Silver|Golden", {true, true})).hits.size() == 2);
+
+    auto bad = kuf::TextQuery::compile("(unclosed", {true, false});
+    REQUIRE(std::holds_alternative<std::string>(bad));
+}
+
+TEST_CASE("TextQuery replaces every match", "[text_search]") {
+    auto literal = compile("knight");
+    REQUIRE(literal.replace("Knight and knight", "Paladin") == "Paladin and Paladin");
+    REQUIRE_FALSE(literal.replace("Archer", "Paladin"));
+
+    auto exact = compile("Knight", {false, true});
+    REQUIRE(exact.replace("Knight and knight", "Paladin") == "Paladin and knight");
+
+    auto regex = compile("(\\d+) gold", {true, false});
+    REQUIRE(regex.replace("Costs 100 Gold", "$1 crowns") == "Costs 100 crowns");
+}
+
+TEST_CASE("TextSearchIndex refresh re-reads only changed files", "[text_search]") {
+    auto dir = std::filesystem::temp_directory_path() / "kuf_text_search_test";
+    std::filesystem::remove_all(dir);
+    writeFile(dir / "ENG" / "a.sox", createTextSox({"Alpha company"}));
+    writeFile(dir / "ENG" / "b.sox", createTextSox({"Bravo company"}));
+    writeFile(dir / "ENG" / "troops.sox", std::vector<std::byte>(32, std::byte{0}));
+
+    kuf::TextSearchIndex index;
+    REQUIRE(index.refresh(dir.string()) == 3);
+    REQUIRE(index.files() == std::vector<std::string>{"ENG/a.sox", "ENG/b.sox"});
+    REQUIRE(index.refresh(dir.string()) == 0);
+
+    // A different size is enough to notice the change without relying on
+    // timestamp resolution.
+    writeFile(dir / "ENG" / "b.sox", createTextSox({"Bravo battalion"}));
+    std::filesystem::remove(dir / "ENG" / "a.sox");
+    REQUIRE(index.refresh(dir.string()) == 1);
+    REQUIRE(index.files() == std::vector<std::string>{"ENG/b.sox"});
+    REQUIRE(index.search(compile("company")).hits.empty());
+    REQUIRE(index.search(compile("battalion")).hits.size() == 1);
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,260 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "formats/sox_text.h"
+#include "test_fixtures.h"
+#include "undo/bulk_field_command.h"
+#include "undo/format_heap_bytes.h"
+#include "undo/set_field_command.h"
+#include "undo/snapshot_command.h"
+#include "undo/undo_stack.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace kuf;
+
+TEST_CASE("UndoStack undoes and redoes field edits", "[undo]") {
+    UndoStack stack;
+    int changes = 0;
+    stack.setOnChange([&] { ++changes; });
+    int value = 1;
+
+    stack.execute(makeSetFieldCommand(&value, 2, "Set value"));
+    REQUIRE(value == 2);
+    REQUIRE(stack.undoDescription() == "Set value");
+
+    stack.undo();
+    REQUIRE(value == 1);
+    REQUIRE(stack.canRedo());
+
+    stack.redo();
+    REQUIRE(value == 2);
+    REQUIRE(changes == 3);
+}
+
+TEST_CASE("UndoStack merges consecutive edits of one field until sealed", "[undo]") {
+    UndoStack stack;
+    float speed = 100.0f;
+
+    // One drag: a command per frame.
+    for (float v : {101.0f, 105.0f, 112.0f}) {
+        stack.beginMerge();
+        stack.execute(makeSetFieldCommand(&speed, v, "Edit Move Speed"));
+    }
+    REQUIRE(stack.undoCount() == 1);
+    REQUIRE(speed == 112.0f);
+
+    // Released, then dragged again.
+    stack.sealMerge();
+    stack.beginMerge();
+    stack.execute(makeSetFieldCommand(&speed, 120.0f, "Edit Move Speed"));
+    REQUIRE(stack.undoCount() == 2);
+
+    stack.undo();
+    REQUIRE(speed == 112.0f);
+    stack.undo();
+    REQUIRE(speed == 100.0f);
+}
+
+TEST_CASE("UndoStack keeps separate edits apart outside an interaction", "[undo]") {
+    UndoStack stack;
+    int value = 0;
+
+    // Two separate commits to one field, e.g. Enter pressed twice.
+    stack.execute(makeSetFieldCommand(&value, 1, "Set value"));
+    stack.execute(makeSetFieldCommand(&value, 2, "Set value"));
+    REQUIRE(stack.undoCount() == 2);
+
+    // An interaction does not fold into the step before it.
+    stack.beginMerge();
+    stack.execute(makeSetFieldCommand(&value, 3, "Set value"));
+    stack.execute(makeSetFieldCommand(&value, 4, "Set value"));
+    stack.sealMerge();
+    REQUIRE(stack.undoCount() == 3);
+
+    stack.undo();
+    REQUIRE(value == 2);
+    stack.undo();
+    REQUIRE(value == 1);
+}
+
+TEST_CASE("UndoStack does not merge edits of different fields or after undo", "[undo]") {
+    UndoStack stack;
+    int a = 0, b = 0;
+
+    stack.execute(makeSetFieldCommand(&a, 1, "Set a"));
+    stack.execute(makeSetFieldCommand(&b, 1, "Set b"));
+    REQUIRE(stack.undoCount() == 2);
+
+    stack.undo();
+    stack.execute(makeSetFieldCommand(&a, 2, "Set a"));
+    REQUIRE(stack.undoCount() == 2);
+    REQUIRE_FALSE(stack.canRedo());
+
+    stack.undo();
+    REQUIRE(a == 1);
+}
+
+TEST_CASE("UndoStack evicts the oldest history over its memory budget", "[undo]") {
+    UndoStack stack;
+    std::string text;
+    std::string big(1000, 'x');
+
+    for (int i = 0; i < 100; ++i) {
+        stack.sealMerge();
+        stack.execute(makeSetFieldCommand(&text, big + std::to_string(i), "Set text"));
+    }
+    REQUIRE(stack.undoCount() == 100);
+    size_t perCommand = stack.memoryUsage() / 100;
+    REQUIRE(perCommand > 1000);
+
+    stack.setMemoryBudget(perCommand * 10);
+    REQUIRE(stack.undoCount() <= 10);
+    REQUIRE(stack.memoryUsage() <= stack.memoryBudget());
+
+    // The newest steps survive.
+    stack.undo();
+    REQUIRE(text == big + "98");
+
+    // The newest step is kept even when it alone exceeds the budget.
+    stack.setMemoryBudget(1);
+    REQUIRE(stack.undoCount() == 1);
+
+    stack.clear();
+    REQUIRE(stack.memoryUsage() == 0);
+}
+
+TEST_CASE("UndoStack transactions undo and redo as one step", "[undo]") {
+    UndoStack stack;
+    int changes = 0;
+    stack.setOnChange([&] { ++changes; });
+    std::vector<int> values(1000, 0);
+
+    stack.beginTransaction("Bulk edit");
+    for (size_t i = 0; i < values.size(); ++i) {
+        stack.execute(makeSetFieldCommand(&values[i], static_cast<int>(i), "Set"));
+    }
+    REQUIRE(changes == 0);
+    stack.commitTransaction();
+
+    REQUIRE(changes == 1);
+    REQUIRE(stack.undoCount() == 1);
+    REQUIRE(stack.undoDescription() == "Bulk edit");
+    REQUIRE(values[999] == 999);
+
+    stack.undo();
+    REQUIRE(values[999] == 0);
+    REQUIRE(values[1] == 0);
+    stack.redo();
+    REQUIRE(values[1] == 1);
+}
+
+TEST_CASE("UndoStack nested transactions commit once", "[undo]") {
+    UndoStack stack;
+    int a = 0, b = 0;
+
+    stack.beginTransaction("Outer");
+    stack.execute(makeSetFieldCommand(&a, 1, "Set a"));
+    stack.beginTransaction("Inner");
+    stack.execute(makeSetFieldCommand(&b, 1, "Set b"));
+    stack.commitTransaction();
+    REQUIRE(stack.undoCount() == 0);
+    stack.commitTransaction();
+
+    REQUIRE(stack.undoCount() == 1);
+    REQUIRE(stack.undoDescription() == "Outer");
+    stack.undo();
+    REQUIRE(a == 0);
+    REQUIRE(b == 0);
+
+    // Empty transactions record nothing.
+    stack.beginTransaction("Nothing");
+    stack.commitTransaction();
+    REQUIRE(stack.undoCount() == 0);
+    REQUIRE(stack.canRedo());
+}
+
+TEST_CASE("UndoTransaction rolls back unless committed", "[undo]") {
+    UndoStack stack;
+    int a = 0;
+    stack.execute(makeSetFieldCommand(&a, 1, "Set a"));
+    stack.undo();
+    uint64_t revision = stack.revision();
+
+    {
+        UndoTransaction tx(stack, "Abandoned");
+        stack.execute(makeSetFieldCommand(&a, 5, "Set a"));
+        REQUIRE(a == 5);
+    }
+    REQUIRE(a == 0);
+    REQUIRE_FALSE(stack.inTransaction());
+    REQUIRE(stack.canRedo());
+    REQUIRE(stack.revision() == revision);
+
+    {
+        UndoTransaction tx(stack, "Kept");
+        stack.execute(makeSetFieldCommand(&a, 7, "Set a"));
+        tx.commit();
+    }
+    REQUIRE(a == 7);
+    REQUIRE(stack.undoDescription() == "Kept");
+    REQUIRE_FALSE(stack.canRedo());
+}
+
+TEST_CASE("BulkFieldCommand applies and reverts many fields", "[undo]") {
+    UndoStack stack;
+    std::vector<float> hp(5000, 100.0f);
+
+    auto bulk = std::make_unique<BulkFieldCommand<float>>("Scale HP");
+    bulk->reserve(hp.size());
+    for (auto& v : hp) bulk->add(&v, v * 1.5f);
+    // The same field twice: undo still restores the first old value.
+    bulk->add(&hp[0], 1.0f);
+    REQUIRE(bulk->size() == hp.size() + 1);
+    REQUIRE(hp[0] == 100.0f);
+
+    stack.execute(std::move(bulk));
+    REQUIRE(hp[0] == 1.0f);
+    REQUIRE(hp[4999] == 150.0f);
+
+    stack.undo();
+    REQUIRE(hp[0] == 100.0f);
+    REQUIRE(hp[4999] == 100.0f);
+    REQUIRE(stack.memoryUsage() > hp.size() * sizeof(float));
+}
+
+TEST_CASE("Commands holding records count their nested data", "[undo]") {
+    StgEvent event;
+    event.description = std::string(200, 'd');
+    event.actions.resize(4);
+    for (auto& action : event.actions) {
+        action.params.resize(3);
+        action.params[0].type = StgParamType::String;
+        action.params[0].stringValue = std::string(100, 's');
+    }
+
+    size_t nested = 4 * sizeof(StgScriptEntry) + 4 * (3 * sizeof(StgParamValue) + 100);
+    StgEvent target;
+    auto command = makeSetFieldCommand(&target, event, "Replace event");
+    REQUIRE(command->sizeEstimate() >= sizeof(SetFieldCommand<StgEvent>) + 200 + nested);
+
+    std::vector<std::string> names(10, std::string(64, 'n'));
+    std::vector<std::string> target2;
+    REQUIRE(makeSetFieldCommand(&target2, names, "Rename")->sizeEstimate() >= 10 * 64);
+}
+
+TEST_CASE("SnapshotCommand counts both versions' serialized size", "[undo]") {
+    std::vector<std::string> texts(50, std::string(40, 't'));
+    SoxText before, after;
+    REQUIRE(before.load(test::createTextSox({"a"})));
+    REQUIRE(after.load(test::createTextSox(texts)));
+
+    UndoStack stack;
+    stack.execute(makeSnapshotCommand(&before, after, "Reload"));
+    REQUIRE(before.entryCount() == 50);
+    REQUIRE(stack.memoryUsage() >= after.save().size());
+
+    stack.undo();
+    REQUIRE(before.entryCount() == 1);
+}
@@ -0,0 +1,36 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/worker_pool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("WorkerPool visits every index exactly once", "[worker_pool]") {
+    kuf::WorkerPool pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+
+    pool.parallelFor(hits.size(), [&](size_t i) { hits[i].fetch_add(1); });
+
+    for (const auto& h : hits) {
+        REQUIRE(h.load() == 1);
+    }
+}
+
+TEST_CASE("WorkerPool supports nested loops", "[worker_pool]") {
+    kuf::WorkerPool pool(2);
+    std::atomic<int> total{0};
+
+    pool.parallelFor(8, [&](size_t) {
+        pool.parallelFor(8, [&](size_t) { total.fetch_add(1); });
+    });
+
+    REQUIRE(total.load() == 64);
+}
+
+TEST_CASE("WorkerPool rethrows exceptions from the loop body", "[worker_pool]") {
+    kuf::WorkerPool pool(2);
+    REQUIRE_THROWS_AS(pool.parallelFor(16, [](size_t i) {
+        if (i == 5) throw std::runtime_error("boom");
+    }), std::runtime_error);
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/zip_archive.h"
+#include "test_fixtures.h"
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace kuf::test;
+
+namespace {
+
+std::vector<std::byte> randomBytes(size_t size) {
+    std::mt19937 rng(42);
+    std::vector<std::byte> data(size);
+    for (auto& b : data) b = static_cast<std::byte>(rng() & 0xFF);
+    return data;
+}
+
+std::string bytes(const std::vector<std::byte>& data) {
+    return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+} // namespace
+
+TEST_CASE("addFiles keeps the smaller of stored and deflated", "[zip_archive]") {
+    TempDir dir("kuf_zip_archive_test");
+    auto noise = randomBytes(64 * 1024);
+    writeFile(dir.path / "noise.bin", noise);
+    writeFile(dir.path / "troops.sox", createTroopSox(200));
+    // A compressed extension is no reason to store a file that still deflates.
+    writeFile(dir.path / "flat.png", createTroopSox(50));
+
+    std::vector<kuf::ZipFileSource> files = {
+        {(dir.path / "noise.bin").string(), "noise.bin"},
+        {(dir.path / "troops.sox").string(), "troops.sox"},
+        {(dir.path / "flat.png").string(), "flat.png"},
+        {(dir.path / "noise.bin").string(), "forced.bin", kuf::ZipCompression::Deflate},
+        {(dir.path / "troops.sox").string(), "stored.sox", kuf::ZipCompression::Store},
+    };
+
+    std::string zipPath = (dir.path / "out.zip").string();
+    {
+        kuf::ZipWriter writer;
+        REQUIRE(writer.create(zipPath));
+        std::vector<size_t> progress;
+        REQUIRE(writer.addFiles(files, [&](size_t i) { progress.push_back(i); }));
+        REQUIRE(writer.finalize());
+        REQUIRE(progress == std::vector<size_t>{0, 1, 2, 3, 4});
+    }
+
+    kuf::ZipReader reader;
+    REQUIRE(reader.open(zipPath));
+    for (const auto& info : reader.entryInfos()) {
+        INFO(info.name);
+        if (info.name == "noise.bin" || info.name == "stored.sox") {
+            REQUIRE(info.stored);
+        } else {
+            REQUIRE_FALSE(info.stored);
+        }
+        if (!info.stored && info.name != "forced.bin") {
+            REQUIRE(info.compressedSize < info.uncompressedSize);
+        }
+    }
+    REQUIRE(bytes(*reader.readEntry("noise.bin")) == bytes(noise));
+    REQUIRE(bytes(*reader.readEntry("forced.bin")) == bytes(noise));
+    REQUIRE(bytes(*reader.readEntry("troops.sox")) == bytes(createTroopSox(200)));
+    REQUIRE(bytes(*reader.readEntry("stored.sox")) == bytes(createTroopSox(200)));
+}
+
+TEST_CASE("addFiles writes many files in order", "[zip_archive]") {
+    TempDir dir("kuf_zip_archive_test");
+    std::vector<kuf::ZipFileSource> files;
+    for (int i = 0; i < 100; ++i) {
+        std::string name = "file" + std::to_string(i) + ".txt";
+        writeFile(dir.path / name, std::string(100 + i, static_cast<char>('a' + i % 26)));
+        files.push_back({(dir.path / name).string(), name});
+    }
+
+    std::string zipPath = (dir.path / "out.zip").string();
+    {
+        kuf::ZipWriter writer;
+        REQUIRE(writer.create(zipPath));
+        REQUIRE(writer.addFiles(files));
+        REQUIRE(writer.finalize());
+    }
+
+    kuf::ZipReader reader;
+    REQUIRE(reader.open(zipPath));
+    auto names = reader.entries();
+    REQUIRE(names.size() == files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        REQUIRE(names[i] == files[i].archiveName);
+    }
+    REQUIRE(bytes(*reader.readEntry("file99.txt")) == std::string(199, 'a' + 99 % 26));
+
+    size_t failed = 0;
+    kuf::ZipWriter writer;
+    REQUIRE(writer.create((dir.path / "missing.zip").string()));
+    files[3].diskPath = (dir.path / "missing.txt").string();
+    REQUIRE_FALSE(writer.addFiles(files, {}, &failed));
+    REQUIRE(failed == 3);
+}